@@ -26,157 +26,484 @@ UINT8 chip_reg_read(void *param, UINT8 ChipType, UINT8 ChipID, UINT8 Port, UINT8
 	return 0;
 }
 
-void chip_reg_write(void *param, UINT8 ChipType, UINT8 ChipID,
-					UINT8 Port, UINT8 Offset, UINT8 Data)
+// Register writes of all chips, the parameter is the chip's state (e.g. p->ym2612[ChipID]).
+// chip_reg_setup picks one of these (or a function of the emulation core, if the chip
+// has several cores), so that every write is a single indirect call.
+static void null_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	return;
+}
+
+static void sn764xx_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	sn764xx_w(chip, Port, Data);
+}
+
+static void ym2413_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2413_w(chip, 0x00, Offset);
+	ym2413_w(chip, 0x01, Data);
+}
+
+static void ym2612_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2612_w(chip, (Port << 1) | 0x00, Offset);
+	ym2612_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void ym2151_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2151_w(chip, 0x00, Offset);
+	ym2151_w(chip, 0x01, Data);
+}
+
+static void rf5c68_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	rf5c68_w(chip, Offset, Data);
+}
+
+static void ym2203_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2203_w(chip, 0x00, Offset);
+	ym2203_w(chip, 0x01, Data);
+}
+
+static void ym2608_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2608_w(chip, (Port << 1) | 0x00, Offset);
+	ym2608_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void ym2610_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2610_w(chip, (Port << 1) | 0x00, Offset);
+	ym2610_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void ym3812_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym3812_w(chip, 0x00, Offset);
+	ym3812_w(chip, 0x01, Data);
+}
+
+static void ym3526_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym3526_w(chip, 0x00, Offset);
+	ym3526_w(chip, 0x01, Data);
+}
+
+static void y8950_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	y8950_w(chip, 0x00, Offset);
+	y8950_w(chip, 0x01, Data);
+}
+
+static void ymf262_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ymf262_w(chip, (Port << 1) | 0x00, Offset);
+	ymf262_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void ymf278b_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ymf278b_w(chip, (Port << 1) | 0x00, Offset);
+	ymf278b_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void ymf271_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ymf271_w(chip, (Port << 1) | 0x00, Offset);
+	ymf271_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void ymz280b_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ymz280b_w(chip, 0x00, Offset);
+	ymz280b_w(chip, 0x01, Data);
+}
+
+static void rf5c164_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	rf5c164_w(chip, Offset, Data);
+}
+
+static void pwm_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	pwm_chn_w(chip, Port, (Offset << 8) | (Data << 0));
+}
+
+static void ayxx_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ayxx_w(chip, 0x00, Offset);
+	ayxx_w(chip, 0x01, Data);
+}
+
+static void gb_sound_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	gb_sound_w(chip, Offset, Data);
+}
+
+static void nes_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	nes_w(chip, Offset, Data);
+}
+
+static void multipcm_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	multipcm_w(chip, Offset, Data);
+}
+
+static void upd7759_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	upd7759_write(chip, Offset, Data);
+}
+
+static void okim6258_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	okim6258_write(chip, Offset, Data);
+}
+
+static void okim6295_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	okim6295_w(chip, Offset, Data);
+}
+
+static void k051649_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	k051649_w(chip, (Port << 1) | 0x00, Offset);
+	k051649_w(chip, (Port << 1) | 0x01, Data);
+}
+
+static void k054539_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	k054539_w(chip, (Port << 8) | (Offset << 0), Data);
+}
+
+static void c6280_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	c6280_w(chip, Offset, Data);
+}
+
+static void c140_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
 {
+	c140_w(chip, (Port << 8) | (Offset << 0), Data);
+}
+
+static void k053260_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	k053260_w(chip, Offset, Data);
+}
+
+static void pokey_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	pokey_w(chip, Offset, Data);
+}
+
+static void qsound_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	qsound_w(chip, 0x00, Port);		// Data MSB
+	qsound_w(chip, 0x01, Offset);	// Data LSB
+	qsound_w(chip, 0x02, Data);		// Register
+}
+
+static void scsp_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	scsp_w(chip, (Port << 8) | (Offset << 0), Data);
+}
+
+static void ws_audio_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ws_audio_port_write(chip, 0x80 | Offset, Data);
+}
+
+static void vsu_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	VSU_Write(chip, (Port << 8) | (Offset << 0), Data);
+}
+
+static void saa1099_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	saa1099_control_w(chip, 0, Offset);
+	saa1099_data_w(chip, 0, Data);
+}
+
+static void es5503_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	es5503_w(chip, Offset, Data);
+}
+
+static void es550x_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	if (Port & 0x80)
+		es550x_w16(chip, Port & 0x7F, (Offset << 8) | (Data << 0));
+	else
+		es550x_w(chip, Port, Data);
+}
+
+static void seta_sound_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	seta_sound_w(chip, (Port << 8) | (Offset << 0), Data);
+}
+
+static void c352_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	c352_w(chip, Port, (Offset << 8) | (Data << 0));
+}
+
+static void irem_ga20_reg_w(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	irem_ga20_w(chip, Offset, Data);
+}
+
+void chip_reg_setup(void *param, UINT8 ChipType, UINT8 ChipID)
+{
+	// resolves the write function of a chip, call it after the chip was started
 	VGM_PLAYER* p = (VGM_PLAYER *) param;
+	CAUD_ATTR* CAA = (CAUD_ATTR*)&p->ChipAudio[ChipID] + ChipType;
+	REGW_CALLBACK Write;
+	void* Chip;
+
+	Write = NULL;
+	Chip = NULL;
+	if (CAA->ChipType != 0xFF)
+	{
 		switch(ChipType)
 		{
 		case 0x00:	// SN76496
-			sn764xx_w(p->sn764xx[ChipID], Port, Data);
+			Chip = p->sn764xx[ChipID];
+			Write = sn764xx_get_reg_write(Chip, &Chip);
+			if (Write == NULL)
+				Write = &sn764xx_reg_w;
 			break;
 		case 0x01:	// YM2413
-			ym2413_w(p->ym2413[ChipID], 0x00, Offset);
-			ym2413_w(p->ym2413[ChipID], 0x01, Data);
+			Chip = p->ym2413[ChipID];
+			Write = ym2413_get_reg_write(Chip, &Chip);
+			if (Write == NULL)
+				Write = &ym2413_reg_w;
 			break;
 		case 0x02:	// YM2612
-			ym2612_w(p->ym2612[ChipID], (Port << 1) | 0x00, Offset);
-			ym2612_w(p->ym2612[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->ym2612[ChipID];
+			Write = ym2612_get_reg_write(Chip, &Chip);
+			if (Write == NULL)
+				Write = &ym2612_reg_w;
 			break;
 		case 0x03:	// YM2151
-			ym2151_w(p->ym2151[ChipID], 0x00, Offset);
-			ym2151_w(p->ym2151[ChipID], 0x01, Data);
+			Chip = p->ym2151[ChipID];
+			Write = &ym2151_reg_w;
 			break;
 		case 0x04:	// SegaPCM
 			break;
 		case 0x05:	// RF5C68
-			rf5c68_w(p->rf5c68, Offset, Data);
+			Chip = p->rf5c68;
+			Write = &rf5c68_reg_w;
 			break;
 		case 0x06:	// YM2203
-			ym2203_w(p->ym2203[ChipID], 0x00, Offset);
-			ym2203_w(p->ym2203[ChipID], 0x01, Data);
+			Chip = p->ym2203[ChipID];
+			Write = &ym2203_reg_w;
 			break;
 		case 0x07:	// YM2608
-			ym2608_w(p->ym2608[ChipID], (Port << 1) | 0x00, Offset);
-			ym2608_w(p->ym2608[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->ym2608[ChipID];
+			Write = &ym2608_reg_w;
 			break;
 		case 0x08:	// YM2610/YM2610B
-			ym2610_w(p->ym2610[ChipID], (Port << 1) | 0x00, Offset);
-			ym2610_w(p->ym2610[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->ym2610[ChipID];
+			Write = &ym2610_reg_w;
 			break;
 		case 0x09:	// YM3812
-			ym3812_w(p->ym3812[ChipID], 0x00, Offset);
-			ym3812_w(p->ym3812[ChipID], 0x01, Data);
+			Chip = p->ym3812[ChipID];
+			Write = ym3812_get_reg_write(Chip, &Chip);
+			if (Write == NULL)
+				Write = &ym3812_reg_w;
 			break;
 		case 0x0A:	// YM3526
-			ym3526_w(p->ym3526[ChipID], 0x00, Offset);
-			ym3526_w(p->ym3526[ChipID], 0x01, Data);
+			Chip = p->ym3526[ChipID];
+			Write = &ym3526_reg_w;
 			break;
 		case 0x0B:	// Y8950
-			y8950_w(p->y8950[ChipID], 0x00, Offset);
-			y8950_w(p->y8950[ChipID], 0x01, Data);
+			Chip = p->y8950[ChipID];
+			Write = &y8950_reg_w;
 			break;
 		case 0x0C:	// YMF262
-			ymf262_w(p->ymf262[ChipID], (Port << 1) | 0x00, Offset);
-			ymf262_w(p->ymf262[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->ymf262[ChipID];
+			Write = ymf262_get_reg_write(Chip, &Chip);
+			if (Write == NULL)
+				Write = &ymf262_reg_w;
 			break;
 		case 0x0D:	// YMF278B
-			ymf278b_w(p->ymf278b[ChipID], (Port << 1) | 0x00, Offset);
-			ymf278b_w(p->ymf278b[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->ymf278b[ChipID];
+			Write = &ymf278b_reg_w;
 			break;
 		case 0x0E:	// YMF271
-			ymf271_w(p->ymf271[ChipID], (Port << 1) | 0x00, Offset);
-			ymf271_w(p->ymf271[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->ymf271[ChipID];
+			Write = &ymf271_reg_w;
 			break;
 		case 0x0F:	// YMZ280B
-			ymz280b_w(p->ymz280b[ChipID], 0x00, Offset);
-			ymz280b_w(p->ymz280b[ChipID], 0x01, Data);
+			Chip = p->ymz280b[ChipID];
+			Write = &ymz280b_reg_w;
 			break;
 		case 0x10:	// RF5C164
-			rf5c164_w(p->rf5c164, Offset, Data);
+			Chip = p->rf5c164;
+			Write = &rf5c164_reg_w;
 			break;
 		case 0x11:	// PWM
-			pwm_chn_w(p->pwm, Port, (Offset << 8) | (Data << 0));
+			Chip = p->pwm;
+			Write = &pwm_reg_w;
 			break;
 		case 0x12:	// AY8910
-			ayxx_w(p->ay8910[ChipID], 0x00, Offset);
-			ayxx_w(p->ay8910[ChipID], 0x01, Data);
+			Chip = p->ay8910[ChipID];
+			Write = &ayxx_reg_w;
 			break;
 		case 0x13:	// GameBoy
-			gb_sound_w(p->gbdmg[ChipID], Offset, Data);
+			Chip = p->gbdmg[ChipID];
+			Write = &gb_sound_reg_w;
 			break;
 		case 0x14:	// NES APU
-			nes_w(p->nesapu[ChipID], Offset, Data);
+			Chip = p->nesapu[ChipID];
+			Write = &nes_reg_w;
 			break;
 		case 0x15:	// MultiPCM
-			multipcm_w(p->multipcm[ChipID], Offset, Data);
+			Chip = p->multipcm[ChipID];
+			Write = &multipcm_reg_w;
 			break;
 		case 0x16:	// UPD7759
-			upd7759_write(p->upd7759[ChipID], Offset, Data);
+			Chip = p->upd7759[ChipID];
+			Write = &upd7759_reg_w;
 			break;
 		case 0x17:	// OKIM6258
-			okim6258_write(p->okim6258[ChipID], Offset, Data);
+			Chip = p->okim6258[ChipID];
+			Write = &okim6258_reg_w;
 			break;
 		case 0x18:	// OKIM6295
-			okim6295_w(p->okim6295[ChipID], Offset, Data);
+			Chip = p->okim6295[ChipID];
+			Write = &okim6295_reg_w;
 			break;
 		case 0x19:	// K051649 / SCC1
-			k051649_w(p->k051649[ChipID], (Port << 1) | 0x00, Offset);
-			k051649_w(p->k051649[ChipID], (Port << 1) | 0x01, Data);
+			Chip = p->k051649[ChipID];
+			Write = &k051649_reg_w;
 			break;
 		case 0x1A:	// K054539
-			k054539_w(p->k054539[ChipID], (Port << 8) | (Offset << 0), Data);
+			Chip = p->k054539[ChipID];
+			Write = &k054539_reg_w;
 			break;
 		case 0x1B:	// HuC6280
-			c6280_w(p->huc6280[ChipID], Offset, Data);
+			Chip = p->huc6280[ChipID];
+			Write = &c6280_reg_w;
 			break;
 		case 0x1C:	// C140
-			c140_w(p->c140[ChipID], (Port << 8) | (Offset << 0), Data);
+			Chip = p->c140[ChipID];
+			Write = &c140_reg_w;
 			break;
 		case 0x1D:	// K053260
-			k053260_w(p->k053260[ChipID], Offset, Data);
+			Chip = p->k053260[ChipID];
+			Write = &k053260_reg_w;
 			break;
 		case 0x1E:	// Pokey
-			pokey_w(p->pokey[ChipID], Offset, Data);
+			Chip = p->pokey[ChipID];
+			Write = &pokey_reg_w;
 			break;
 		case 0x1F:	// QSound
-			qsound_w(p->qsound[ChipID], 0x00, Port);	// Data MSB
-			qsound_w(p->qsound[ChipID], 0x01, Offset);	// Data LSB
-			qsound_w(p->qsound[ChipID], 0x02, Data);	// Register
+			Chip = p->qsound[ChipID];
+			Write = &qsound_reg_w;
 			break;
 		case 0x20:	// YMF292/SCSP
-			scsp_w(p->scsp[ChipID], (Port << 8) | (Offset << 0), Data);
+			Chip = p->scsp[ChipID];
+			Write = &scsp_reg_w;
 			break;
 		case 0x21:	// WonderSwan
-			ws_audio_port_write(p->wswan[ChipID], 0x80 | Offset, Data);
+			Chip = p->wswan[ChipID];
+			Write = &ws_audio_reg_w;
 			break;
 		case 0x22:	// VSU
-			VSU_Write(p->vsu[ChipID], (Port << 8) | (Offset << 0), Data);
+			Chip = p->vsu[ChipID];
+			Write = &vsu_reg_w;
 			break;
 		case 0x23:	// SAA1099
-			saa1099_control_w(p->saa1099[ChipID], 0, Offset);
-			saa1099_data_w(p->saa1099[ChipID], 0, Data);
+			Chip = p->saa1099[ChipID];
+			Write = &saa1099_reg_w;
 			break;
 		case 0x24:	// ES5503
-			es5503_w(p->es5503[ChipID], Offset, Data);
+			Chip = p->es5503[ChipID];
+			Write = &es5503_reg_w;
 			break;
 		case 0x25:	// ES5506
-			if (Port & 0x80)
-				es550x_w16(p->es550x[ChipID], Port & 0x7F, (Offset << 8) | (Data << 0));
-			else
-				es550x_w(p->es550x[ChipID], Port, Data);
+			Chip = p->es550x[ChipID];
+			Write = &es550x_reg_w;
 			break;
 		case 0x26:	// X1-010
-			seta_sound_w(p->x1_010[ChipID], (Port << 8) | (Offset << 0), Data);
+			Chip = p->x1_010[ChipID];
+			Write = &seta_sound_reg_w;
 			break;
 		case 0x27:	// C352
-			c352_w(p->c352[ChipID], Port, (Offset << 8) | (Data << 0));
+			Chip = p->c352[ChipID];
+			Write = &c352_reg_w;
 			break;
 		case 0x28:	// GA20
-			irem_ga20_w(p->ga20[ChipID], Offset, Data);
+			Chip = p->ga20[ChipID];
+			Write = &irem_ga20_reg_w;
 			break;
 //		case 0x##:	// OKIM6376
 //			break;
 		}
+	}
+	if (Write == NULL)
+	{
+		// writes to chips that aren't there are ignored
+		Write = &null_reg_w;
+		Chip = NULL;
+	}
+	CAA->RegWrite = Write;
+	CAA->RegWriteParam = Chip;
+
+	return;
+}
+
+#ifdef ENABLE_CHIP_STATS
+static void stats_reg_w(void* param, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	CAUD_ATTR* CAA = (CAUD_ATTR*)param;
+
+	CAA->StatWrites ++;
+	CAA->RegWrite(CAA->RegWriteParam, Port, Offset, Data);
+
+	return;
+}
+#endif
+
+REGW_CALLBACK chip_reg_get_write(void *param, UINT8 ChipType, UINT8 ChipID, void** RetParam)
+{
+	// for callers that write to the same chip all the time (e.g. DAC Stream Control)
+	VGM_PLAYER* p = (VGM_PLAYER *) param;
+	CAUD_ATTR* CAA;
+
+	if (ChipType >= CHIP_COUNT)
+	{
+		*RetParam = NULL;
+		return &null_reg_w;
+	}
+	CAA = (CAUD_ATTR*)&p->ChipAudio[ChipID] + ChipType;
+#ifdef ENABLE_CHIP_STATS
+	// the writes go through stats_reg_w, so they are counted as well
+	*RetParam = CAA;
+	return &stats_reg_w;
+#else
+	*RetParam = CAA->RegWriteParam;
+	return CAA->RegWrite;
+#endif
+}
+
+void chip_reg_write(void *param, UINT8 ChipType, UINT8 ChipID,
+					UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	VGM_PLAYER* p = (VGM_PLAYER *) param;
+	CAUD_ATTR* CAA;
+
+	if (ChipType >= CHIP_COUNT)
+		return;
+	CAA = (CAUD_ATTR*)&p->ChipAudio[ChipID] + ChipType;
+#ifdef ENABLE_CHIP_STATS
+	CAA->StatWrites ++;
+#endif
+	CAA->RegWrite(CAA->RegWriteParam, Port, Offset, Data);
+
 	return;
 }
@@ -1,2 +1,4 @@
 UINT8 chip_reg_read(void *, UINT8 ChipType, UINT8 ChipID, UINT8 Port, UINT8 Offset);
 void chip_reg_write(void *, UINT8 ChipType, UINT8 ChipID, UINT8 Port, UINT8 Offset, UINT8 Data);
+void chip_reg_setup(void *, UINT8 ChipType, UINT8 ChipID);
+REGW_CALLBACK chip_reg_get_write(void *, UINT8 ChipType, UINT8 ChipID, void** RetParam);
@@ -0,0 +1,292 @@
+// SampleWriter.c: block-oriented output for the rendering tools
+//
+// Writing sample by sample with fputc costs about as much time as rendering the
+// simpler chips, so the tools convert whole buffers in place and write them with
+// a single fwrite. The writes can run on a thread of their own.
+
+#include <stdlib.h>
+#include <string.h>
+#include "stdbool.h"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// SSE2 is part of x86-64, NEON of ARM64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SWAP_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define SWAP_NEON
+#include <arm_neon.h>
+#endif
+
+#include "chips/mamedef.h"
+#include "SampleWriter.h"
+
+#ifdef WIN32
+typedef HANDLE				SW_THREAD;
+typedef CRITICAL_SECTION	SW_MUTEX;
+typedef CONDITION_VARIABLE	SW_COND;
+#define SW_MutexInit(m)		InitializeCriticalSection(m)
+#define SW_MutexDeinit(m)	DeleteCriticalSection(m)
+#define SW_Lock(m)			EnterCriticalSection(m)
+#define SW_Unlock(m)		LeaveCriticalSection(m)
+#define SW_CondInit(c)		InitializeConditionVariable(c)
+#define SW_CondDeinit(c)
+#define SW_CondWait(c, m)	SleepConditionVariableCS(c, m, INFINITE)
+#define SW_CondSignal(c)	WakeConditionVariable(c)
+#else
+typedef pthread_t			SW_THREAD;
+typedef pthread_mutex_t		SW_MUTEX;
+typedef pthread_cond_t		SW_COND;
+#define SW_MutexInit(m)		pthread_mutex_init(m, NULL)
+#define SW_MutexDeinit(m)	pthread_mutex_destroy(m)
+#define SW_Lock(m)			pthread_mutex_lock(m)
+#define SW_Unlock(m)		pthread_mutex_unlock(m)
+#define SW_CondInit(c)		pthread_cond_init(c, NULL)
+#define SW_CondDeinit(c)	pthread_cond_destroy(c)
+#define SW_CondWait(c, m)	pthread_cond_wait(c, m)
+#define SW_CondSignal(c)	pthread_cond_signal(c)
+#endif
+
+struct sample_writer
+{
+	FILE* hFile;
+	UINT8* Buffers[0x02];
+	UINT8 CurBuf;		// the buffer the tool fills
+	bool Async;
+	bool Error;
+
+	// owned by the thread while Pending is set
+	SW_THREAD Thread;
+	SW_MUTEX Lock;
+	SW_COND WorkCond;
+	SW_COND DoneCond;
+	bool Pending;
+	bool Quit;
+	UINT8 PendBuf;
+	UINT32 PendLen;
+};
+
+#ifdef WIN32
+static DWORD WINAPI WriterThread(void* Arg)
+#else
+static void* WriterThread(void* Arg)
+#endif
+{
+	SMPL_WRITER* SWrt = (SMPL_WRITER*)Arg;
+	const UINT8* Data;
+	UINT32 Len;
+	bool Failed;
+
+	SW_Lock(&SWrt->Lock);
+	while(true)
+	{
+		while(! SWrt->Pending && ! SWrt->Quit)
+			SW_CondWait(&SWrt->WorkCond, &SWrt->Lock);
+		if (! SWrt->Pending)
+			break;	// Quit
+		Data = SWrt->Buffers[SWrt->PendBuf];
+		Len = SWrt->PendLen;
+		SW_Unlock(&SWrt->Lock);
+
+		Failed = (fwrite(Data, 1, Len, SWrt->hFile) < Len);
+
+		SW_Lock(&SWrt->Lock);
+		if (Failed)
+			SWrt->Error = true;
+		SWrt->Pending = false;
+		SW_CondSignal(&SWrt->DoneCond);
+	}
+	SW_Unlock(&SWrt->Lock);
+
+	return 0;
+}
+
+SMPL_WRITER* OpenSampleWriter(FILE* hFile, UINT32 BufSize, bool Async)
+{
+	SMPL_WRITER* SWrt;
+	bool ThreadOK;
+
+	SWrt = (SMPL_WRITER*)calloc(1, sizeof(SMPL_WRITER));
+	if (SWrt == NULL)
+		return NULL;
+	SWrt->hFile = hFile;
+	SWrt->Buffers[0x00] = (UINT8*)malloc(BufSize);
+	SWrt->Buffers[0x01] = Async ? (UINT8*)malloc(BufSize) : NULL;
+	if (SWrt->Buffers[0x00] == NULL || (Async && SWrt->Buffers[0x01] == NULL))
+	{
+		free(SWrt->Buffers[0x00]);
+		free(SWrt->Buffers[0x01]);
+		free(SWrt);
+		return NULL;
+	}
+	SWrt->CurBuf = 0x00;
+	SWrt->Async = false;
+	SWrt->Error = false;
+	if (! Async)
+		return SWrt;
+
+	SW_MutexInit(&SWrt->Lock);
+	SW_CondInit(&SWrt->WorkCond);
+	SW_CondInit(&SWrt->DoneCond);
+	SWrt->Pending = false;
+	SWrt->Quit = false;
+#ifdef WIN32
+	SWrt->Thread = CreateThread(NULL, 0, &WriterThread, SWrt, 0, NULL);
+	ThreadOK = (SWrt->Thread != NULL);
+#else
+	ThreadOK = ! pthread_create(&SWrt->Thread, NULL, &WriterThread, SWrt);
+#endif
+	if (! ThreadOK)
+	{
+		// fall back to writing on the caller's thread
+		SW_CondDeinit(&SWrt->DoneCond);
+		SW_CondDeinit(&SWrt->WorkCond);
+		SW_MutexDeinit(&SWrt->Lock);
+		return SWrt;
+	}
+	SWrt->Async = true;
+
+	return SWrt;
+}
+
+void* GetWriteBuffer(SMPL_WRITER* SWrt)
+{
+	return SWrt->Buffers[SWrt->CurBuf];
+}
+
+bool WriteSamples(SMPL_WRITER* SWrt, UINT32 Bytes)
+{
+	bool RetVal;
+
+	if (! Bytes)
+		return ! SWrt->Error;
+	if (! SWrt->Async)
+	{
+		if (fwrite(SWrt->Buffers[SWrt->CurBuf], 1, Bytes, SWrt->hFile) < Bytes)
+			SWrt->Error = true;
+		return ! SWrt->Error;
+	}
+
+	SW_Lock(&SWrt->Lock);
+	while(SWrt->Pending)
+		SW_CondWait(&SWrt->DoneCond, &SWrt->Lock);
+	SWrt->PendBuf = SWrt->CurBuf;
+	SWrt->PendLen = Bytes;
+	SWrt->Pending = true;
+	SW_CondSignal(&SWrt->WorkCond);
+	RetVal = ! SWrt->Error;
+	SW_Unlock(&SWrt->Lock);
+	SWrt->CurBuf ^= 0x01;
+
+	return RetVal;
+}
+
+bool CloseSampleWriter(SMPL_WRITER* SWrt)
+{
+	bool RetVal;
+
+	if (SWrt->Async)
+	{
+		SW_Lock(&SWrt->Lock);
+		SWrt->Quit = true;
+		SW_CondSignal(&SWrt->WorkCond);
+		SW_Unlock(&SWrt->Lock);
+#ifdef WIN32
+		WaitForSingleObject(SWrt->Thread, INFINITE);
+		CloseHandle(SWrt->Thread);
+#else
+		pthread_join(SWrt->Thread, NULL);
+#endif
+		SW_CondDeinit(&SWrt->DoneCond);
+		SW_CondDeinit(&SWrt->WorkCond);
+		SW_MutexDeinit(&SWrt->Lock);
+	}
+	if (fflush(SWrt->hFile))
+		SWrt->Error = true;
+
+	RetVal = ! SWrt->Error;
+	free(SWrt->Buffers[0x00]);
+	free(SWrt->Buffers[0x01]);
+	free(SWrt);
+
+	return RetVal;
+}
+
+void SwapBytes16(void* Data, UINT32 Count)
+{
+	UINT16* Buf = (UINT16*)Data;
+	UINT32 CurVal;
+
+	CurVal = 0;
+#if defined(SWAP_SSE2)
+	for (; CurVal + 8 <= Count; CurVal += 8)
+	{
+		__m128i Val = _mm_loadu_si128((const __m128i*)&Buf[CurVal]);
+		Val = _mm_or_si128(_mm_slli_epi16(Val, 8), _mm_srli_epi16(Val, 8));
+		_mm_storeu_si128((__m128i*)&Buf[CurVal], Val);
+	}
+#elif defined(SWAP_NEON)
+	for (; CurVal + 8 <= Count; CurVal += 8)
+		vst1q_u16(&Buf[CurVal], vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(vld1q_u16(&Buf[CurVal])))));
+#endif
+	for (; CurVal < Count; CurVal ++)
+		Buf[CurVal] = (UINT16)((Buf[CurVal] << 8) | (Buf[CurVal] >> 8));
+
+	return;
+}
+
+void SwapBytes32(void* Data, UINT32 Count)
+{
+	UINT32* Buf = (UINT32*)Data;
+	UINT32 CurVal;
+
+	CurVal = 0;
+#if defined(SWAP_SSE2)
+	for (; CurVal + 4 <= Count; CurVal += 4)
+	{
+		__m128i Val = _mm_loadu_si128((const __m128i*)&Buf[CurVal]);
+		// swap the 16-bit halves, then the bytes inside of them
+		Val = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Val, 0xB1), 0xB1);
+		Val = _mm_or_si128(_mm_slli_epi16(Val, 8), _mm_srli_epi16(Val, 8));
+		_mm_storeu_si128((__m128i*)&Buf[CurVal], Val);
+	}
+#elif defined(SWAP_NEON)
+	for (; CurVal + 4 <= Count; CurVal += 4)
+		vst1q_u32(&Buf[CurVal], vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(&Buf[CurVal])))));
+#endif
+	for (; CurVal < Count; CurVal ++)
+		Buf[CurVal] = (Buf[CurVal] << 24) | ((Buf[CurVal] & 0xFF00) << 8) |
+						((Buf[CurVal] >> 8) & 0xFF00) | (Buf[CurVal] >> 24);
+
+	return;
+}
+
+void ConvertLE16(void* Data, UINT32 Count)
+{
+#ifdef VGM_BIG_ENDIAN
+	SwapBytes16(Data, Count);
+#endif
+	return;
+}
+
+void ConvertBE16(void* Data, UINT32 Count)
+{
+#ifndef VGM_BIG_ENDIAN
+	SwapBytes16(Data, Count);
+#endif
+	return;
+}
+
+void ConvertLE32(void* Data, UINT32 Count)
+{
+#ifdef VGM_BIG_ENDIAN
+	SwapBytes32(Data, Count);
+#endif
+	return;
+}
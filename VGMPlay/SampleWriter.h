@@ -0,0 +1,37 @@
+// SampleWriter.h: block-oriented output for the rendering tools
+//
+// A writer owns two buffers of BufSize bytes. The tool fills the one returned by
+// GetWriteBuffer and hands it over with WriteSamples. With Async set, a thread
+// writes it to the file while the next block is rendered into the other buffer.
+// (include mamedef.h and stdbool.h first)
+
+#ifndef __SAMPLEWRITER_H__
+#define __SAMPLEWRITER_H__
+
+#include <stdio.h>
+
+typedef struct sample_writer SMPL_WRITER;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SMPL_WRITER* OpenSampleWriter(FILE* hFile, UINT32 BufSize, bool Async);
+void* GetWriteBuffer(SMPL_WRITER* SWrt);
+bool WriteSamples(SMPL_WRITER* SWrt, UINT32 Bytes);
+// waits for all writes to finish, the file stays open (e.g. for patching the header)
+bool CloseSampleWriter(SMPL_WRITER* SWrt);
+
+// in-place byte order conversion of whole buffers
+void SwapBytes16(void* Data, UINT32 Count);
+void SwapBytes32(void* Data, UINT32 Count);
+// 16-bit samples from/to little/big endian, a no-op if the host has the same order
+void ConvertLE16(void* Data, UINT32 Count);
+void ConvertBE16(void* Data, UINT32 Count);
+void ConvertLE32(void* Data, UINT32 Count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// __SAMPLEWRITER_H__
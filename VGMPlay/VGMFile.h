@@ -141,6 +141,7 @@ typedef struct _vgm_pcm_bank
 	UINT8* Data;
 	UINT32 DataPos;
 	UINT32 BnkPos;
+	UINT8 DataRef;	// Data points into the VGM data and isn't allocated
 } VGM_PCM_BANK;
 
 #define FCC_VGM	0x206D6756	// 'Vgm '
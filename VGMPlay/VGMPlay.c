@@ -31,6 +31,16 @@
 #include <wchar.h>
 #include "stdbool.h"
 #include <math.h>	// for pow()
+#ifdef WIN32
+#include <windows.h>	// for the render threads and file mappings
+#else
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>	// for the render profile
+#endif
 
 #ifndef NO_ZLIB
 #include <zlib.h>
@@ -38,6 +48,15 @@
 
 #include "resampler.h"
 
+// vector versions of the output conversion (SSE2 is part of x86-64, NEON of ARM64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+
 #include "chips/mamedef.h"
 
 // integer types for fast integer calculation
@@ -81,8 +100,13 @@ static UINT32 gcd(UINT32 x, UINT32 y);
 //UINT32 GetGZFileLength(const char* FileName);
 //UINT32 GetGZFileLengthW(const wchar_t* FileName);
 static UINT32 GetGZFileLength_Internal(FILE* hFile);
+static UINT8* MapFile(const char* FileName, UINT32* RetSize);
+static void UnmapFile(UINT8* Data, UINT32 Size);
 //bool OpenVGMFile(const char* FileName);
-static bool OpenVGMFile_Internal(VGM_PLAYER*, VGM_FILE* hFile, UINT32 FileSize);
+static bool OpenVGMFile_Internal(VGM_PLAYER*, VGM_FILE* hFile, UINT32 FileSize, UINT8* FileData,
+								 void* Stream);
+static bool FillVGMStream(VGM_PLAYER*, UINT32 Pos, UINT32 Len);
+static const UINT8* ReadVGMStreamBlock(VGM_PLAYER*, UINT32 Pos, UINT32 Len);
 static void ReadVGMHeader(VGM_FILE* hFile, VGM_HEADER* RetVGMHead);
 static UINT8 ReadGD3Tag(VGM_FILE* hFile, UINT32 GD3Offset, GD3_TAG* RetGD3Tag);
 static void ReadChipExtraData32(VGM_PLAYER*, UINT32 StartOffset, VGMX_CHP_EXTRA32* ChpExtra);
@@ -104,6 +128,13 @@ static UINT16 GetChipVolume(VGM_PLAYER*, UINT8 ChipID, UINT8 ChipNum, UINT8 Chip
 
 static void RestartPlaying(VGM_PLAYER*);
 static void Chips_GeneralActions(VGM_PLAYER*, UINT8 Mode);
+static UINT32 SaveChipStates(VGM_PLAYER*, UINT8* Buffer);
+static void LoadChipStates(VGM_PLAYER*, const UINT8* Buffer);
+static void StartSeekIndex(VGM_PLAYER*);
+static void StopSeekIndex(VGM_PLAYER*);
+INLINE void CheckSeekIndex(VGM_PLAYER*);
+static void AddSeekPoint(VGM_PLAYER*);
+static bool LoadSeekPoint(VGM_PLAYER*, INT32 MinSample, INT32 MaxSample);
 
 INLINE INT32 SampleVGM2Pbk_I(VGM_PLAYER*, INT32 SampleVal);	// inline functions
 INLINE INT32 SamplePbk2VGM_I(VGM_PLAYER*, INT32 SampleVal);
@@ -112,6 +143,9 @@ INLINE INT32 SamplePbk2VGM_I(VGM_PLAYER*, INT32 SampleVal);
 //static bool SetMuteControl(VGM_PLAYER*, bool mute);
 
 static void InterpretFile(VGM_PLAYER*, UINT32 SampleCount);
+static void InterpretSeek(VGM_PLAYER*, UINT32 SampleCount);
+static bool IsNextSampleIdle(VGM_PLAYER*);
+INLINE bool IsInVGMData(VGM_PLAYER*, const UINT8* Data, UINT32 DataSize);
 static void AddPCMData(VGM_PLAYER*, UINT8 Type, UINT32 DataSize, const UINT8* Data);
 //INLINE FUINT16 ReadBits(UINT8* Data, UINT32* Pos, FUINT8* BitPos, FUINT8 BitsToRead);
 static bool DecompressDataBlk(VGM_PLAYER* p, VGM_PCM_DATA* Bank, UINT32 DataSize, const UINT8* Data);
@@ -119,12 +153,20 @@ static UINT8 GetDACFromPCMBank(VGM_PLAYER*);
 static UINT8* GetPointerFromPCMBank(VGM_PLAYER*, UINT8 Type, UINT32 DataPos);
 static void ReadPCMTable(VGM_PLAYER*, UINT32 DataSize, const UINT8* Data);
 static void InterpretVGM(VGM_PLAYER*, UINT32 SampleCount);
+static void InterpretVGMCommand(VGM_PLAYER*);
+static void CompileVGMEvents(VGM_PLAYER*);
+static void FreeVGMEvents(VGM_PLAYER*);
+static void InterpretVGMEvents(VGM_PLAYER*, UINT32 SampleCount);
 #ifdef ADDITIONAL_FORMATS
 extern void InterpretOther(VGM_PLAYER*, UINT32 SampleCount);
 #endif
 
 static void GeneralChipLists(VGM_PLAYER*);
 static void SetupResampler(VGM_PLAYER*, CAUD_ATTR* CAA);
+static double GetResampleGain(VGM_PLAYER*, UINT32 SmpRate);
+static bool CanBlockUpdate(VGM_PLAYER*, const CAUD_ATTR* CAA);
+static bool CanRenderThreaded(VGM_PLAYER*, UINT8 ChipType, UINT8 ChipID);
+static UINT8 GetSpeakerPairs(VGM_PLAYER*);
 static void ChangeChipSampleRate(void* DataPtr, UINT32 NewSmplRate);
 
 INLINE INT16 Limit2Short(INT32 Value);
@@ -135,8 +177,35 @@ struct dual_opl2_info
     int ChipID;
 };
 static void dual_opl2_stereo(void *param, stream_sample_t **outputs, int samples);
+static void SelectChipCores(VGM_PLAYER*);
+static void UpdateRenderBudget(VGM_PLAYER*, UINT64 RenderTime, UINT32 Samples);
+static void RenderChipStream(VGM_PLAYER*, CAUD_ATTR* CAA, INT32** StreamBufs, INT32* OutBuf,
+							UINT32 Length);
+static UINT8 GetResamplePath(VGM_PLAYER*, const CAUD_ATTR* CAA);
+static void HandOverResampler(VGM_PLAYER*, CAUD_ATTR* CAA, UINT8 NewPath);
+static void FreeResampleCarry(CAUD_ATTR* CAA);
+static bool IsStreamSilent(CAUD_ATTR* CAA);
+static void UpdateChipStream(CAUD_ATTR* CAA, INT32** StreamBufs, UINT32 Samples);
+static void RenderChipStreamPath(VGM_PLAYER*, CAUD_ATTR* CAA, INT32** StreamBufs, INT32* OutBuf,
+							UINT32 Length);
+static void RenderChipStreamLQ(VGM_PLAYER*, CAUD_ATTR* CAA, INT32** StreamBufs, INT32* OutBuf,
+							UINT32 Length);
+static void MixChipStream(VGM_PLAYER*, const CAUD_ATTR* CAA, const INT32* ChipBuf,
+							WAVE_32BS* RetSample, UINT32 Length);
 static void ResampleChipStream(VGM_PLAYER*, CA_LIST* CLst, WAVE_32BS* RetSample, UINT32 Length);
+static UINT8 SetVoiceOutput(VGM_PLAYER*, CAUD_ATTR* CAA, INT32** VoiceOut);
+static void StartStems(VGM_PLAYER*);
+static void StopStems(VGM_PLAYER*);
+static void MixChipStems(VGM_PLAYER*, const CAUD_ATTR* CAA, const INT32* ChipBuf, UINT32 Length);
+static void StartRenderThreads(VGM_PLAYER*);
+static void StopRenderThreads(VGM_PLAYER*);
+static bool IsChipAudible(const CHIP_OPTS* COpts);
+static void RenderChips(VGM_PLAYER*, WAVE_32BS* RetSample, UINT32 Length);
 static INT32 RecalcFadeVolume(VGM_PLAYER*);
+static void ConvertBlock(VGM_PLAYER*, const WAVE_32BS* MixBuf, const INT32* BlkVol, void* Buffer,
+						UINT8 Format, bool InvRight, UINT32 Length);
+static UINT32 RenderBuffer(VGM_PLAYER*, void* Buffer, UINT8 Format, WAVE_16BS** StemBufs,
+						UINT8 SpkPairs, UINT32 BufferSize);
 //UINT32 FillBuffer(void *, WAVE_16BS* Buffer, UINT32 BufferSize)
 
 // Options and such moved to VGM_PLAYER structure
@@ -167,6 +236,17 @@ void * VGMPlay_Init(void)
 	p->CMFMaxLoop = 0x01;
 #endif
 	p->ResampleMode = 0x00;
+	p->BlockRender = true;
+	p->RenderThreads = 0;
+	p->SeekIndexTime = 0;
+	p->StemRender = false;
+	p->PreDecode = false;
+	p->StepSynth = false;
+	p->RenderProfile = false;
+	p->RenderBudget = 0.0f;
+	p->GovResampleMode = 0xFF;
+	memset(p->GovUserCores, 0xFF, sizeof(p->GovUserCores));
+	p->OutChannels = 2;
 	p->CHIP_SAMPLING_MODE = 0x00;
 	p->CHIP_SAMPLE_RATE = 0x00000000;
 	p->DoubleSSGVol = false;
@@ -229,10 +309,14 @@ void * VGMPlay_Init(void)
 void VGMPlay_Init2(void *_p)
 {
     VGM_PLAYER* p = (VGM_PLAYER*)_p;
+	UINT8 CurBuf;
 	// has to be called after the configuration is loaded
 
-	p->StreamBufs[0x00] = (INT32*)malloc(SMPL_BUFSIZE * sizeof(INT32));
-	p->StreamBufs[0x01] = (INT32*)malloc(SMPL_BUFSIZE * sizeof(INT32));
+	for (CurBuf = 0x00; CurBuf < OUT_PAIRS_MAX * 2; CurBuf ++)
+		p->StreamBufs[CurBuf] = (INT32*)malloc(SMPL_BUFSIZE * sizeof(INT32));
+	p->MixBuf = (WAVE_32BS*)malloc(OUT_PAIRS_MAX * SMPL_BUFSIZE * sizeof(WAVE_32BS));
+	p->ChipBuf = (INT32*)malloc(OUT_PAIRS_MAX * SMPL_BUFSIZE * 0x02 * sizeof(INT32));
+	p->MixPairs = 0x01;
 
 	if (p->CHIP_SAMPLE_RATE <= 0)
 		p->CHIP_SAMPLE_RATE = p->SampleRate;
@@ -249,8 +333,14 @@ void VGMPlay_Deinit(void *_p)
 
     VGM_PLAYER* p = (VGM_PLAYER*)_p;
 
-	free(p->StreamBufs[0x00]);	p->StreamBufs[0x00] = NULL;
-	free(p->StreamBufs[0x01]);	p->StreamBufs[0x01] = NULL;
+	for (CurChip = 0x00; CurChip < OUT_PAIRS_MAX * 2; CurChip ++)
+	{
+		free(p->StreamBufs[CurChip]);	p->StreamBufs[CurChip] = NULL;
+	}
+	free(p->MixBuf);	p->MixBuf = NULL;
+	free(p->ChipBuf);	p->ChipBuf = NULL;
+	free(p->CoreProfile);	p->CoreProfile = NULL;
+	StopRenderThreads(p);
 
 	for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
 	{
@@ -394,6 +484,12 @@ void PlayVGM(void *_p)
 	p->FadePlay = false;
 	p->MasterVol = 1.0f;
 	p->ForceVGMExec = false;
+	memset(&p->Profile, 0x00, sizeof(RENDER_PROFILE));
+	p->GovTime = 0;
+	p->GovSamples = 0;
+	p->GovOverloads = 0;
+	if (p->RenderBudget > 0.0f)
+		SelectChipCores(p);	// has to be done before the chips start
 	p->FadeStart = 0;
 	p->ForceVGMExec = true;
 
@@ -450,6 +546,9 @@ void PlayVGM(void *_p)
 
 	Chips_GeneralActions(p, 0x00);	// Start chips
 	// also does Reset (0x01), Muting Mask (0x10) and Panning (0x20)
+	StartSeekIndex(p);
+	StartStems(p);
+	CompileVGMEvents(p);
 
 	p->Last95Drum = 0xFFFF;
 	p->Last95Freq = 0;
@@ -466,13 +565,32 @@ void PlayVGM(void *_p)
 
 void StopVGM(void *_p)
 {
+	UINT8 CurChip;
+
     VGM_PLAYER* p = (VGM_PLAYER*)_p;
 	if (p->PlayingMode == 0xFF)
 		return;
 
+	StopSeekIndex(p);
+	StopStems(p);
+	FreeVGMEvents(p);
 	Chips_GeneralActions(p, 0x02);	// Stop chips
 	p->PlayingMode = 0xFF;
 
+	// the render budget's choices only last for one song
+	for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++)
+	{
+		if (p->GovUserCores[CurChip] == 0xFF)
+			continue;
+		((CHIP_OPTS*)&p->ChipOpts[0x00] + CurChip)->EmuCore = p->GovUserCores[CurChip];
+		p->GovUserCores[CurChip] = 0xFF;
+	}
+	if (p->GovResampleMode != 0xFF)
+	{
+		p->ResampleMode = p->GovResampleMode;
+		p->GovResampleMode = 0xFF;
+	}
+
 	return;
 }
 
@@ -492,6 +610,7 @@ void SeekVGM(void *_p, bool Relative, INT32 PlayBkSamples)
 {
 	INT32 Samples;
 	UINT32 LoopSmpls;
+	INT32 CurPos;
 
     VGM_PLAYER* p = (VGM_PLAYER*)_p;
 
@@ -504,16 +623,25 @@ void SeekVGM(void *_p, bool Relative, INT32 PlayBkSamples)
 	else
 		Samples = PlayBkSamples;
 
+	CurPos = LoopSmpls + p->VGMSmplPlayed;
 	if (Samples < 0)
 	{
-		Samples = LoopSmpls + p->VGMSmplPlayed + Samples;
+		Samples = CurPos + Samples;
 		if (Samples < 0)
 			Samples = 0;
-		RestartPlaying(p);
+		if (LoadSeekPoint(p, -1, Samples))
+			Samples -= p->VGMSmplPlayed;
+		else
+			RestartPlaying(p);
+	}
+	else if (LoadSeekPoint(p, CurPos, CurPos + Samples))
+	{
+		// skip to the last checkpoint before the target
+		Samples = CurPos + Samples - p->VGMSmplPlayed;
 	}
 
 	p->ForceVGMExec = true;
-	InterpretFile(p, Samples);
+	InterpretSeek(p, Samples);
 	p->ForceVGMExec = false;
 
 	return;
@@ -567,6 +695,33 @@ void RefreshPlaybackOptions(void *_p)
 	return;
 }
 
+bool CanPlayConcurrently(void *_p)
+{
+	// Tells if the song can be played while other players run on other threads.
+	// (valid after OpenVGMFile)
+	// Cores that aren't thread-safe share their state between all players and
+	// the GameBoy/NES cores draw noise from rand(), which would make the output
+	// depend on the other players.
+	VGM_PLAYER* p = (VGM_PLAYER*)_p;
+	UINT8 CurChip;
+	UINT8 CurCSet;
+
+	for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++)
+	{
+		if (! GetChipClock(p, CurChip, NULL))
+			continue;
+		if (CurChip == 0x13 || CurChip == 0x14)	// GameBoy DMG, NES APU
+			return false;
+		for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+		{
+			if (! CanRenderThreaded(p, CurChip, CurCSet))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 
 UINT32 GetGZFileLength(const char* FileName)
 {
@@ -694,7 +849,7 @@ bool OpenVGMFile(void *_p, const char* FileName)
 	vgmFile.hFile = hFile;
 	vgmFile.Size = FileSize;
 
-	RetVal = OpenVGMFile_Internal(p, (VGM_FILE *)&vgmFile, FileSize);
+	RetVal = OpenVGMFile_Internal(p, (VGM_FILE *)&vgmFile, FileSize, NULL, NULL);
 
 	gzclose(hFile);
 	return RetVal;
@@ -741,7 +896,7 @@ bool OpenVGMFileW(void *_p, const wchar_t* FileName)
 	vgmFile.hFile = hFile;
 	vgmFile.Size = FileSize;
 
-	RetVal = OpenVGMFile_Internal(p, (VGM_FILE *)&vgmFile, FileSize);
+	RetVal = OpenVGMFile_Internal(p, (VGM_FILE *)&vgmFile, FileSize, NULL, NULL);
 
 	gzclose(hFile);
 	return RetVal;
@@ -752,11 +907,309 @@ bool OpenVGMFileW(void *_p, const wchar_t* FileName)
 bool OpenVGMFile_Handle(void* _p, VGM_FILE* hFile)
 {
 	UINT32 FileSize = hFile->GetSize(hFile);
-	return OpenVGMFile_Internal((VGM_PLAYER*)_p, hFile, FileSize);
+	return OpenVGMFile_Internal((VGM_PLAYER*)_p, hFile, FileSize, NULL, NULL);
+}
+
+bool OpenVGMFile_Stream(void *_p, const char* FileName)
+{
+	// Inflates the file while it's played, keeping only a small window of it in memory.
+	// The GD3 tag isn't read (it's at the end of the file), use GetVGMFileInfo for it.
+#ifdef NO_ZLIB
+	return false;
+#else
+	gzFile hFile;
+	UINT32 FileSize;
+	bool RetVal;
+
+	VGM_PLAYER* p = (VGM_PLAYER*)_p;
+
+	FileSize = GetGZFileLength(FileName);
+
+	hFile = gzopen(FileName, "rb");
+	if (hFile == NULL)
+		return false;
+
+	VGM_FILE_gz vgmFile;
+
+	vgmFile.vf.Read = VGMF_gzread;
+	vgmFile.vf.Seek = VGMF_gzseek;
+	vgmFile.vf.GetSize = VGMF_gzgetsize;
+	vgmFile.vf.Tell = VGMF_gztell;
+	vgmFile.hFile = hFile;
+	vgmFile.Size = FileSize;
+
+	RetVal = OpenVGMFile_Internal(p, (VGM_FILE *)&vgmFile, FileSize, NULL, hFile);
+	if (! RetVal)
+		gzclose(hFile);	// else it's closed by CloseVGMFile
+	return RetVal;
+#endif
+}
+
+#define VGM_STREAM_WINDOW	0x10000	// file data inflated ahead of the play position
+
+static bool FillVGMStream(VGM_PLAYER* p, UINT32 Pos, UINT32 Len)
+{
+	// makes the file data Pos .. Pos+Len available at VGMData[Pos - VGMDataOfs]
+#ifdef NO_ZLIB
+	return false;
+#else
+	gzFile hFile = (gzFile)p->VGMStream;
+	UINT32 WinSize;
+	UINT32 ReadLen;
+	int RetVal;
+
+	if (Pos >= p->VGMDataOfs && Pos + Len <= p->VGMDataOfs + p->VGMDataFill)
+		return true;
+
+	if (Pos < p->VGMDataOfs || Pos > p->VGMDataOfs + p->VGMDataFill)
+	{
+		// jumped (loop, restart) - continue inflating from there
+		if (gzseek(hFile, Pos, SEEK_SET) < 0)
+			return false;
+		p->VGMDataOfs = Pos;
+		p->VGMDataFill = 0x00;
+	}
+	else if (Pos > p->VGMDataOfs)
+	{
+		// drop the data that was played already
+		p->VGMDataFill -= Pos - p->VGMDataOfs;
+		memmove(p->VGMData, &p->VGMData[Pos - p->VGMDataOfs], p->VGMDataFill);
+		p->VGMDataOfs = Pos;
+	}
+
+	// The window grows for large data blocks and shrinks back after them.
+	WinSize = VGM_STREAM_WINDOW;
+	if (WinSize < Len)
+		WinSize = Len;
+	if (WinSize < p->VGMDataFill)
+		WinSize = p->VGMDataFill;
+	if (WinSize != p->VGMDataAlloc)
+	{
+		UINT8* NewData = (UINT8*)realloc(p->VGMData, WinSize);
+		if (NewData == NULL)
+			return false;
+		p->VGMData = NewData;
+		p->VGMDataAlloc = WinSize;
+	}
+
+	ReadLen = p->VGMDataAlloc - p->VGMDataFill;
+	if (p->VGMDataOfs + p->VGMDataFill >= p->VGMDataLen)
+		ReadLen = 0x00;
+	else if (ReadLen > p->VGMDataLen - (p->VGMDataOfs + p->VGMDataFill))
+		ReadLen = p->VGMDataLen - (p->VGMDataOfs + p->VGMDataFill);
+	if (ReadLen)
+	{
+		RetVal = gzread(hFile, &p->VGMData[p->VGMDataFill], ReadLen);
+		if (RetVal > 0)
+			p->VGMDataFill += RetVal;
+	}
+	if (p->VGMDataFill < Len)
+	{
+		// past the end of the file
+		memset(&p->VGMData[p->VGMDataFill], 0x00, Len - p->VGMDataFill);
+		p->VGMDataFill = Len;
+	}
+
+	return true;
+#endif
+}
+
+static const UINT8* ReadVGMStreamBlock(VGM_PLAYER* p, UINT32 Pos, UINT32 Len)
+{
+	// Returns the data block at Pos. Blocks larger than the window get their own buffer
+	// (VGMStreamBlk), which AddPCMData can take over, so that they aren't held twice.
+#ifdef NO_ZLIB
+	return NULL;
+#else
+	gzFile hFile = (gzFile)p->VGMStream;
+	UINT8* Block;
+	UINT32 BlkFill;
+	UINT32 ReadLen;
+	int RetVal;
+
+	if (Len <= VGM_STREAM_WINDOW)
+	{
+		if (! FillVGMStream(p, Pos, Len))
+			return NULL;
+		return &p->VGMData[Pos - p->VGMDataOfs];
+	}
+	if (! FillVGMStream(p, Pos, 0x10))
+		return NULL;
+
+	Block = (UINT8*)malloc(Len);
+	if (Block == NULL)
+		return NULL;
+	// the window has the beginning of the block, the rest is read directly
+	BlkFill = p->VGMDataOfs + p->VGMDataFill - Pos;
+	if (BlkFill > Len)
+		BlkFill = Len;
+	memcpy(Block, &p->VGMData[Pos - p->VGMDataOfs], BlkFill);
+	ReadLen = Len - BlkFill;
+	if (p->VGMDataOfs + p->VGMDataFill >= p->VGMDataLen)
+		ReadLen = 0x00;
+	else if (ReadLen > p->VGMDataLen - (p->VGMDataOfs + p->VGMDataFill))
+		ReadLen = p->VGMDataLen - (p->VGMDataOfs + p->VGMDataFill);
+	if (ReadLen)
+	{
+		RetVal = gzread(hFile, &Block[BlkFill], ReadLen);
+		if (RetVal > 0)
+			BlkFill += RetVal;
+	}
+	if (BlkFill < Len)
+		memset(&Block[BlkFill], 0x00, Len - BlkFill);
+
+	// the window continues after the block
+	p->VGMDataOfs = Pos + Len;
+	p->VGMDataFill = 0x00;
+	p->VGMStreamBlk = Block;
+	return Block;
+#endif
+}
+
+static UINT8* MapFile(const char* FileName, UINT32* RetSize)
+{
+	UINT8* Data;
+#ifdef WIN32
+	HANDLE hFile;
+	HANDLE hMap;
+	DWORD FileSizeHi;
+	DWORD FileSize;
+
+	hFile = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+						FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return NULL;
+	FileSize = GetFileSize(hFile, &FileSizeHi);
+	if (FileSize == INVALID_FILE_SIZE || FileSizeHi || ! FileSize)
+	{
+		CloseHandle(hFile);
+		return NULL;
+	}
+	hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (hMap == NULL)
+		return NULL;
+	// the view keeps the mapping open
+	Data = (UINT8*)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMap);
+	if (Data == NULL)
+		return NULL;
+#else
+	int hFile;
+	struct stat FileStat;
+	UINT32 FileSize;
+
+	hFile = open(FileName, O_RDONLY);
+	if (hFile < 0)
+		return NULL;
+	if (fstat(hFile, &FileStat) || FileStat.st_size <= 0 || FileStat.st_size > 0xFFFFFFFF)
+	{
+		close(hFile);
+		return NULL;
+	}
+	Data = (UINT8*)mmap(NULL, (size_t)FileStat.st_size, PROT_READ, MAP_PRIVATE, hFile, 0);
+	close(hFile);
+	if (Data == (UINT8*)MAP_FAILED)
+		return NULL;
+	FileSize = (UINT32)FileStat.st_size;
+#endif
+
+	*RetSize = FileSize;
+	return Data;
+}
+
+static void UnmapFile(UINT8* Data, UINT32 Size)
+{
+#ifdef WIN32
+	UnmapViewOfFile(Data);
+#else
+	munmap(Data, Size);
+#endif
+
+	return;
+}
+
+typedef struct vgm_file_mem
+{
+	VGM_FILE vf;
+	const UINT8* Data;
+	UINT32 Size;
+	UINT32 Pos;
+} VGM_FILE_mem;
+
+static int VGMF_memread(VGM_FILE* hFile, void* ptr, UINT32 count)
+{
+	VGM_FILE_mem* File = (VGM_FILE_mem *)hFile;
+
+	if (count > File->Size - File->Pos)
+		count = File->Size - File->Pos;
+	memcpy(ptr, File->Data + File->Pos, count);
+	File->Pos += count;
+	return count;
+}
+
+static int VGMF_memseek(VGM_FILE* hFile, UINT32 offset)
+{
+	VGM_FILE_mem* File = (VGM_FILE_mem *)hFile;
+
+	if (offset > File->Size)
+		return -1;
+	File->Pos = offset;
+	return 0;
+}
+
+static UINT32 VGMF_memgetsize(VGM_FILE* hFile)
+{
+	VGM_FILE_mem* File = (VGM_FILE_mem *)hFile;
+	return File->Size;
+}
+
+static UINT32 VGMF_memtell(VGM_FILE* hFile)
+{
+	VGM_FILE_mem* File = (VGM_FILE_mem *)hFile;
+	return File->Pos;
+}
+
+bool OpenVGMFile_Mapped(void* _p, const char* FileName)
+{
+	// Maps uncompressed files into memory and plays them from there, without copying the
+	// command data or the ROM images. Compressed files are loaded with OpenVGMFile.
+	UINT8* FileData;
+	UINT32 FileSize;
+	bool RetVal;
+
+	VGM_PLAYER* p = (VGM_PLAYER*)_p;
+
+	FileData = MapFile(FileName, &FileSize);
+	if (FileData == NULL)
+		return OpenVGMFile(p, FileName);
+	if (FileSize < 0x04 || ReadLE32(FileData) != FCC_VGM)
+	{
+		UnmapFile(FileData, FileSize);
+		return OpenVGMFile(p, FileName);
+	}
+
+	VGM_FILE_mem vgmFile;
+
+	vgmFile.vf.Read = VGMF_memread;
+	vgmFile.vf.Seek = VGMF_memseek;
+	vgmFile.vf.GetSize = VGMF_memgetsize;
+	vgmFile.vf.Tell = VGMF_memtell;
+	vgmFile.Data = FileData;
+	vgmFile.Size = FileSize;
+	vgmFile.Pos = 0x00;
+
+	RetVal = OpenVGMFile_Internal(p, (VGM_FILE *)&vgmFile, FileSize, FileData, NULL);
+	if (! RetVal)
+		UnmapFile(FileData, FileSize);
+	return RetVal;
 }
 
-static bool OpenVGMFile_Internal(VGM_PLAYER* p, VGM_FILE* hFile, UINT32 FileSize)
+static bool OpenVGMFile_Internal(VGM_PLAYER* p, VGM_FILE* hFile, UINT32 FileSize, UINT8* FileData,
+								 void* Stream)
 {
+	// FileData - the whole file in memory (mapped, it's released by CloseVGMFile), or NULL
+	// Stream - gzFile to read the data from during playback (closed by CloseVGMFile), or NULL
 	UINT32 fccHeader;
 	UINT32 CurPos;
 	UINT32 HdrLimit;
@@ -803,11 +1256,36 @@ static bool OpenVGMFile_Internal(VGM_PLAYER* p, VGM_FILE* hFile, UINT32 FileSize
 
 	// Read Data
 	p->VGMDataLen = p->VGMHead.lngEOFOffset;
-	p->VGMData = (UINT8*)malloc(p->VGMDataLen);
-	if (p->VGMData == NULL)
-		return false;
-	hFile->Seek(hFile, 0x00);
-	hFile->Read(hFile, p->VGMData, p->VGMDataLen);
+	p->VGMDataOfs = 0x00;
+	p->VGMMapLen = 0x00;
+	if (FileData != NULL)
+	{
+		p->VGMData = FileData;
+		p->VGMMapLen = FileSize;
+	}
+	else if (Stream != NULL)
+	{
+		// only the header for now, the rest follows during playback
+		p->VGMStream = Stream;
+		p->VGMData = NULL;
+		p->VGMDataFill = 0x00;
+		p->VGMDataAlloc = 0x00;
+		hFile->Seek(hFile, 0x00);
+		if (! FillVGMStream(p, 0x00, p->VGMHead.lngDataOffset))
+		{
+			free(p->VGMData);	p->VGMData = NULL;
+			p->VGMStream = NULL;
+			return false;
+		}
+	}
+	else
+	{
+		p->VGMData = (UINT8*)malloc(p->VGMDataLen);
+		if (p->VGMData == NULL)
+			return false;
+		hFile->Seek(hFile, 0x00);
+		hFile->Read(hFile, p->VGMData, p->VGMDataLen);
+	}
 
 	// Read Extra Header Data
 	if (p->VGMHead.lngExtraOffset)
@@ -837,13 +1315,13 @@ static bool OpenVGMFile_Internal(VGM_PLAYER* p, VGM_FILE* hFile, UINT32 FileSize
 	}
 
 	// Read GD3 Tag
-	HdrLimit = ReadGD3Tag(hFile, p->VGMHead.lngGD3Offset, &p->VGMTag);
+	HdrLimit = ReadGD3Tag(hFile, (Stream == NULL) ? p->VGMHead.lngGD3Offset : 0x00, &p->VGMTag);
 	if (HdrLimit == 0x10)
 	{
 		p->VGMHead.lngGD3Offset = 0x00000000;
 		//return false;
 	}
-	if (! p->VGMHead.lngGD3Offset)
+	if (! p->VGMHead.lngGD3Offset || Stream != NULL)
 	{
 		// replace all NULL pointers with empty strings
 		p->VGMTag.strTrackNameE = MakeEmptyWStr();
@@ -1130,7 +1608,17 @@ void CloseVGMFile(void *_p)
 	p->VGMHead.fccVGM = 0x00;
 	free(p->VGMH_Extra.Clocks.CCData);		p->VGMH_Extra.Clocks.CCData = NULL;
 	free(p->VGMH_Extra.Volumes.CCData);	p->VGMH_Extra.Volumes.CCData = NULL;
-	free(p->VGMData);	p->VGMData = NULL;
+	if (p->VGMMapLen)
+		UnmapFile(p->VGMData, p->VGMMapLen);
+	else
+		free(p->VGMData);
+	p->VGMData = NULL;	p->VGMMapLen = 0x00;
+#ifndef NO_ZLIB
+	if (p->VGMStream != NULL)
+	{
+		gzclose((gzFile)p->VGMStream);	p->VGMStream = NULL;
+	}
+#endif
 
 	if (p->FileMode == 0x00)
 	FreeGD3Tag(&p->VGMTag);
@@ -1966,46 +2454,473 @@ static void RestartPlaying(VGM_PLAYER* p)
 	return;
 }
 
-static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
+// Seek Index
+// While the first run through the song is interpreted (seeking, BuildSeekIndex) or played,
+// the states of all chips and DAC streams are saved every SeekIndexTime msec.
+// SeekVGM restores the last checkpoint before the target and only interprets the rest.
+typedef struct seek_point
 {
-	UINT32 AbsVol;
-	//UINT16 ChipVol;
+	INT32 SmplPlayed;	// playback sample of the checkpoint (within the first run)
+	UINT32 VGMPos;
+	INT32 VGMSmplPos;
+	UINT16 Last95Drum;
+	UINT32 Last95Freq;
+	UINT16 Last95Max;
+	UINT32 BnkPos[PCM_BANK_COUNT];
+	UINT32 DataPos[PCM_BANK_COUNT];
+	UINT8 DacCount;	// DAC streams that were set up (the first entries of DacCtrlUsg)
+	UINT8* State;	// chip states, followed by bank and state of every DAC stream
+} SEEK_POINT;
+
+typedef struct seek_index
+{
+	UINT32 Step;	// checkpoint distance in playback samples
+	UINT32 SampleRate;	// the checkpoints are invalid after the playback rate changed
+	UINT32 VGMSmplRateMul;
+	UINT32 VGMSmplRateDiv;
+	UINT32 ChipStateSize;
+	UINT32 DacStateSize;
+	UINT32 Count;
+	UINT32 Alloc;
+	SEEK_POINT* Points;
+} SEEK_INDEX;
+
+static UINT32 SaveChipState(VGM_PLAYER* p, UINT8 ChipType, UINT8 ChipID, UINT8* Buffer)
+{
+	// returns the size of the chip's state or 0, if the chip doesn't support this
+	switch(ChipType)
+	{
+	case 0x00:
+		return device_save_state_sn764xx(p->sn764xx[ChipID], Buffer);
+	case 0x02:
+		return device_save_state_ym2612(p->ym2612[ChipID], Buffer);
+	case 0x04:
+		return segapcm_save_state(p->segapcm[ChipID], Buffer);
+	case 0x05:
+		return rf5c68_save_state(p->rf5c68, Buffer);
+	case 0x10:
+		return rf5c164_save_state(p->rf5c164, Buffer);
+	case 0x11:
+		return pwm_save_state(p->pwm, Buffer);
+	case 0x1C:
+		return c140_save_state(p->c140[ChipID], Buffer);
+	case 0x1F:
+		return qsound_save_state(p->qsound[ChipID], Buffer);
+	}
+
+	return 0x00;
+}
+
+static void LoadChipState(VGM_PLAYER* p, UINT8 ChipType, UINT8 ChipID, const UINT8* Buffer)
+{
+	switch(ChipType)
+	{
+	case 0x00:
+		device_load_state_sn764xx(p->sn764xx[ChipID], Buffer);
+		break;
+	case 0x02:
+		device_load_state_ym2612(p->ym2612[ChipID], Buffer);
+		break;
+	case 0x04:
+		segapcm_load_state(p->segapcm[ChipID], Buffer);
+		break;
+	case 0x05:
+		rf5c68_load_state(p->rf5c68, Buffer);
+		break;
+	case 0x10:
+		rf5c164_load_state(p->rf5c164, Buffer);
+		break;
+	case 0x11:
+		pwm_load_state(p->pwm, Buffer);
+		break;
+	case 0x1C:
+		c140_load_state(p->c140[ChipID], Buffer);
+		break;
+	case 0x1F:
+		qsound_load_state(p->qsound[ChipID], Buffer);
+		break;
+	}
+
+	return;
+}
+
+static UINT32 SaveChipStates(VGM_PLAYER* p, UINT8* Buffer)
+{
+	// returns the size of all chip states or 0, if one of the chips can't save its state
 	CAUD_ATTR* CAA;
-	CHIP_OPTS* COpt;
-	UINT8 ChipCnt;
 	UINT8 CurChip;
-	UINT8 CurCSet;	// Chip Set
-	UINT32 MaskVal;
-	UINT32 ChipClk;
+	UINT8 CurCSet;
+	UINT32 StateSize;
+	UINT32 ChipSize;
 
-	switch(Mode)
+	StateSize = 0x00;
+	for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
 	{
-	case 0x00:	// Start Chips
-		for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+		CAA = (CAUD_ATTR*)&p->ChipAudio[CurCSet];
+		for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++, CAA ++)
 		{
-			CAA = (CAUD_ATTR*)&p->ChipAudio[CurCSet];
-			for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++, CAA ++)
-			{
-				CAA->SmpRate = 0x00;
-				CAA->Volume = 0x00;
-				CAA->ChipType = 0xFF;
-				CAA->ChipID = CurCSet;
-				CAA->Resampler = 0x00;
-				CAA->StreamUpdate = &null_update;
-                CAA->StreamUpdateParam = NULL;
-				CAA->Paired = NULL;
-			}
-			CAA = p->CA_Paired[CurCSet];
-			for (CurChip = 0x00; CurChip < 0x03; CurChip ++, CAA ++)
-			{
-				CAA->SmpRate = 0x00;
-				CAA->Volume = 0x00;
-				CAA->ChipType = 0xFF;
-				CAA->ChipID = CurCSet;
-				CAA->Resampler = 0x00;
+			if (CAA->ChipType == 0xFF)	// chip unused
+				continue;
+			ChipSize = SaveChipState(p, CAA->ChipType, CurCSet, Buffer ? Buffer + StateSize : NULL);
+			if (! ChipSize)
+				return 0x00;
+			StateSize += ChipSize;
+		}
+	}
+
+	return StateSize;
+}
+
+static void LoadChipStates(VGM_PLAYER* p, const UINT8* Buffer)
+{
+	CAUD_ATTR* CAA;
+	UINT8 CurChip;
+	UINT8 CurCSet;
+
+	for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+	{
+		CAA = (CAUD_ATTR*)&p->ChipAudio[CurCSet];
+		for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++, CAA ++)
+		{
+			if (CAA->ChipType == 0xFF)	// chip unused
+				continue;
+			LoadChipState(p, CAA->ChipType, CurCSet, Buffer);
+			Buffer += SaveChipState(p, CAA->ChipType, CurCSet, NULL);
+		}
+	}
+
+	return;
+}
+
+static UINT8 GetStatelessChip(VGM_PLAYER* p)
+{
+	// returns the first chip that can't save its state (0xFF - none)
+	CAUD_ATTR* CAA;
+	UINT8 CurChip;
+	UINT8 CurCSet;
+
+	for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+	{
+		CAA = (CAUD_ATTR*)&p->ChipAudio[CurCSet];
+		for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++, CAA ++)
+		{
+			if (CAA->ChipType != 0xFF && ! SaveChipState(p, CAA->ChipType, CurCSet, NULL))
+				return CAA->ChipType;
+		}
+	}
+
+	return 0xFF;
+}
+
+static void StartSeekIndex(VGM_PLAYER* p)
+{
+	SEEK_INDEX* SIdx;
+	UINT32 ChipStateSize;
+
+	StopSeekIndex(p);
+	if (! p->SeekIndexTime || p->FileMode)
+		return;
+
+	ChipStateSize = SaveChipStates(p, NULL);
+	if (! ChipStateSize)
+	{
+		// fall back to replaying the song from the beginning
+		printf("Warning! No seek index: The %s emulation can't save its state.\n",
+				GetChipName(GetStatelessChip(p)));
+		return;
+	}
+
+	SIdx = (SEEK_INDEX*)calloc(1, sizeof(SEEK_INDEX));
+	if (SIdx == NULL)
+		return;
+	SIdx->Step = (UINT32)((UINT64)p->SeekIndexTime * p->SampleRate / 1000);
+	if (! SIdx->Step)
+		SIdx->Step = 1;
+	SIdx->SampleRate = p->SampleRate;
+	SIdx->VGMSmplRateMul = p->VGMSmplRateMul;
+	SIdx->VGMSmplRateDiv = p->VGMSmplRateDiv;
+	SIdx->ChipStateSize = ChipStateSize;
+	SIdx->DacStateSize = 0x01 + device_save_state_daccontrol(NULL, NULL);
+	p->SeekIndex = SIdx;
+
+	return;
+}
+
+static void StopSeekIndex(VGM_PLAYER* p)
+{
+	SEEK_INDEX* SIdx = (SEEK_INDEX*)p->SeekIndex;
+	UINT32 CurPnt;
+
+	if (SIdx == NULL)
+		return;
+
+	for (CurPnt = 0; CurPnt < SIdx->Count; CurPnt ++)
+		free(SIdx->Points[CurPnt].State);
+	free(SIdx->Points);
+	free(SIdx);
+	p->SeekIndex = NULL;
+
+	return;
+}
+
+INLINE void CheckSeekIndex(VGM_PLAYER* p)
+{
+	// adds a checkpoint if the current position is a step behind the last one
+	SEEK_INDEX* SIdx = (SEEK_INDEX*)p->SeekIndex;
+	INT32 NextPos;
+
+	if (SIdx == NULL || p->VGMCurLoop || p->VGMEnd)
+		return;
+
+	NextPos = (SIdx->Count ? SIdx->Points[SIdx->Count - 1].SmplPlayed : 0) + SIdx->Step;
+	if (p->VGMSmplPlayed >= NextPos)
+		AddSeekPoint(p);
+
+	return;
+}
+
+static void AddSeekPoint(VGM_PLAYER* p)
+{
+	SEEK_INDEX* SIdx = (SEEK_INDEX*)p->SeekIndex;
+	SEEK_POINT* SPnt;
+	UINT8* StatePtr;
+	UINT8 CurDAC;
+	UINT8 CurBnk;
+
+	if (SIdx->SampleRate != p->SampleRate || SIdx->VGMSmplRateMul != p->VGMSmplRateMul ||
+		SIdx->VGMSmplRateDiv != p->VGMSmplRateDiv)
+	{
+		// The playback rate changed, so all checkpoints are at the wrong position now.
+		// Start over with the current position.
+		StartSeekIndex(p);
+		SIdx = (SEEK_INDEX*)p->SeekIndex;
+		if (SIdx == NULL)
+			return;
+	}
+
+	if (SIdx->Count >= SIdx->Alloc)
+	{
+		SPnt = (SEEK_POINT*)realloc(SIdx->Points, sizeof(SEEK_POINT) * (SIdx->Alloc + 0x40));
+		if (SPnt == NULL)
+			return;
+		SIdx->Points = SPnt;
+		SIdx->Alloc += 0x40;
+	}
+	SPnt = &SIdx->Points[SIdx->Count];
+	SPnt->State = (UINT8*)malloc(SIdx->ChipStateSize + SIdx->DacStateSize * p->DacCtrlUsed);
+	if (SPnt->State == NULL)
+		return;
+
+	SPnt->SmplPlayed = p->VGMSmplPlayed;
+	SPnt->VGMPos = p->VGMPos;
+	SPnt->VGMSmplPos = p->VGMSmplPos;
+	SPnt->Last95Drum = p->Last95Drum;
+	SPnt->Last95Freq = p->Last95Freq;
+	SPnt->Last95Max = p->Last95Max;
+	for (CurBnk = 0x00; CurBnk < PCM_BANK_COUNT; CurBnk ++)
+	{
+		SPnt->BnkPos[CurBnk] = p->PCMBank[CurBnk].BnkPos;
+		SPnt->DataPos[CurBnk] = p->PCMBank[CurBnk].DataPos;
+	}
+
+	if (! SaveChipStates(p, SPnt->State))
+	{
+		// a chip can't save its state at the moment, try again at the next check
+		free(SPnt->State);
+		return;
+	}
+	StatePtr = SPnt->State + SIdx->ChipStateSize;
+	SPnt->DacCount = p->DacCtrlUsed;
+	for (CurDAC = 0x00; CurDAC < p->DacCtrlUsed; CurDAC ++, StatePtr += SIdx->DacStateSize)
+	{
+		StatePtr[0x00] = p->DacCtrl[p->DacCtrlUsg[CurDAC]].Bank;
+		device_save_state_daccontrol(p->daccontrol[p->DacCtrlUsg[CurDAC]], StatePtr + 0x01);
+	}
+	SIdx->Count ++;
+
+	return;
+}
+
+static bool LoadSeekPoint(VGM_PLAYER* p, INT32 MinSample, INT32 MaxSample)
+{
+	// restores the last checkpoint with MinSample < position <= MaxSample
+	SEEK_INDEX* SIdx = (SEEK_INDEX*)p->SeekIndex;
+	const SEEK_POINT* SPnt;
+	const UINT8* StatePtr;
+	UINT32 CurPnt;
+	UINT32 PntLo;
+	UINT32 PntHi;
+	UINT8 CurDAC;
+	UINT8 CurBnk;
+	UINT8 DacID;
+	VGM_PCM_BANK* TempPCM;
+
+	if (SIdx == NULL || ! SIdx->Count)
+		return false;
+	if (SIdx->SampleRate != p->SampleRate || SIdx->VGMSmplRateMul != p->VGMSmplRateMul ||
+		SIdx->VGMSmplRateDiv != p->VGMSmplRateDiv)
+		return false;
+
+	// binary search for the last checkpoint <= MaxSample
+	PntLo = 0;
+	PntHi = SIdx->Count;
+	while(PntLo < PntHi)
+	{
+		CurPnt = (PntLo + PntHi) / 2;
+		if (SIdx->Points[CurPnt].SmplPlayed <= MaxSample)
+			PntLo = CurPnt + 1;
+		else
+			PntHi = CurPnt;
+	}
+	if (! PntLo)
+		return false;
+	SPnt = &SIdx->Points[PntLo - 1];
+	if (SPnt->SmplPlayed <= MinSample)
+		return false;
+
+	// like RestartPlaying, but with the state of the checkpoint
+	Chips_GeneralActions(p, 0x01);	// Reset Chips
+	// also does Muting Mask (0x10) and Panning (0x20)
+
+	p->VGMPos = SPnt->VGMPos;
+	p->VGMSmplPos = SPnt->VGMSmplPos;
+	p->VGMSmplPlayed = SPnt->SmplPlayed;
+	p->VGMEnd = false;
+	p->EndPlay = false;
+	p->VGMCurLoop = 0x00;
+	p->Last95Drum = SPnt->Last95Drum;
+	p->Last95Freq = SPnt->Last95Freq;
+	p->Last95Max = SPnt->Last95Max;
+	for (CurBnk = 0x00; CurBnk < PCM_BANK_COUNT; CurBnk ++)
+	{
+		p->PCMBank[CurBnk].BnkPos = SPnt->BnkPos[CurBnk];
+		p->PCMBank[CurBnk].DataPos = SPnt->DataPos[CurBnk];
+	}
+
+	LoadChipStates(p, SPnt->State);
+	StatePtr = SPnt->State + SIdx->ChipStateSize;
+	for (CurDAC = 0x00; CurDAC < SPnt->DacCount; CurDAC ++, StatePtr += SIdx->DacStateSize)
+	{
+		// DAC streams that were set up later stay in their reset state
+		DacID = p->DacCtrlUsg[CurDAC];
+		p->DacCtrl[DacID].Bank = StatePtr[0x00];
+		device_load_state_daccontrol(p->daccontrol[DacID], StatePtr + 0x01);
+		TempPCM = &p->PCMBank[p->DacCtrl[DacID].Bank];
+		daccontrol_refresh_data(p->daccontrol[DacID], TempPCM->Data, TempPCM->DataSize);
+	}
+
+	return true;
+}
+
+void BuildSeekIndex(void *_p)
+{
+	// interprets the whole song once to set up all checkpoints, the position stays the same
+	INT32 CurPos;
+	UINT32 PlayingTime;
+	bool FadePlay;
+	UINT32 FadeStart;
+	SEEK_INDEX* SIdx;
+	VGM_PLAYER* p = (VGM_PLAYER*)_p;
+
+	if (p->PlayingMode == 0xFF || p->SeekIndex == NULL)
+		return;
+
+	CurPos = p->VGMCurLoop * SampleVGM2Pbk_I(p, p->VGMHead.lngLoopSamples) + p->VGMSmplPlayed;
+	PlayingTime = p->PlayingTime;
+	FadePlay = p->FadePlay;
+	FadeStart = p->FadeStart;
+	SIdx = (SEEK_INDEX*)p->SeekIndex;
+	if (SIdx->Count)
+		LoadSeekPoint(p, -1, SIdx->Points[SIdx->Count - 1].SmplPlayed);
+	else
+		RestartPlaying(p);
+
+	p->ForceVGMExec = true;
+	while(! p->VGMEnd && ! p->VGMCurLoop && p->SeekIndex != NULL)
+	{
+		SIdx = (SEEK_INDEX*)p->SeekIndex;
+		InterpretSeek(p, SIdx->Step);
+	}
+	p->ForceVGMExec = false;
+
+	SeekVGM(p, false, CurPos);
+	p->PlayingTime = PlayingTime;
+	p->FadePlay = FadePlay;
+	p->FadeStart = FadeStart;
+
+	return;
+}
+
+static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
+{
+	UINT32 AbsVol;
+	//UINT16 ChipVol;
+	CAUD_ATTR* CAA;
+	CHIP_OPTS* COpt;
+	UINT8 ChipCnt;
+	UINT8 CurChip;
+	UINT8 CurCSet;	// Chip Set
+	UINT8 CurPair;
+	UINT32 MaskVal;
+	UINT32 ChipClk;
+	UINT32 StepRate;
+
+	switch(Mode)
+	{
+	case 0x00:	// Start Chips
+		for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+		{
+			CAA = (CAUD_ATTR*)&p->ChipAudio[CurCSet];
+			for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++, CAA ++)
+			{
+				CAA->SmpRate = 0x00;
+				CAA->Volume = 0x00;
+				CAA->ChipType = 0xFF;
+				CAA->ChipID = CurCSet;
+				CAA->Resampler = 0x00;
+				CAA->StreamUpdate = &null_update;
+                CAA->StreamUpdateParam = NULL;
+				CAA->IsSilent = NULL;
+				CAA->StepSynth = false;
+				CAA->Paired = NULL;
+				CAA->Stems = NULL;
+				CAA->OutPairs = 0x01;
+				CAA->ProfUpdate = 0;
+				CAA->ProfResample = 0;
+				CAA->LQPos = 0;
+				memset(CAA->LQPrev, 0x00, sizeof(CAA->LQPrev));
+				memset(CAA->LQLast, 0x00, sizeof(CAA->LQLast));
+				CAA->RsmpPath = 0xFF;
+				CAA->Carry = NULL;
+				CAA->StatWrites = 0;
+				CAA->StatSamples = 0;
+				CAA->StatFrames = 0;
+			}
+			CAA = p->CA_Paired[CurCSet];
+			for (CurChip = 0x00; CurChip < 0x03; CurChip ++, CAA ++)
+			{
+				CAA->SmpRate = 0x00;
+				CAA->Volume = 0x00;
+				CAA->ChipType = 0xFF;
+				CAA->ChipID = CurCSet;
+				CAA->Resampler = 0x00;
 				CAA->StreamUpdate = &null_update;
                 CAA->StreamUpdateParam = NULL;
+				CAA->IsSilent = NULL;
+				CAA->StepSynth = false;
 				CAA->Paired = NULL;
+				CAA->Stems = NULL;
+				CAA->OutPairs = 0x01;
+				CAA->ProfUpdate = 0;
+				CAA->ProfResample = 0;
+				CAA->LQPos = 0;
+				memset(CAA->LQPrev, 0x00, sizeof(CAA->LQPrev));
+				memset(CAA->LQLast, 0x00, sizeof(CAA->LQLast));
+				CAA->RsmpPath = 0xFF;
+				CAA->Carry = NULL;
+				CAA->StatWrites = 0;
+				CAA->StatSamples = 0;
+				CAA->StatFrames = 0;
 			}
 		}
 
@@ -2035,6 +2950,16 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
                                                     (p->VGMHead.bytPSG_Flags & 0x01) >> 0);
                 CAA->StreamUpdate = &sn764xx_stream_update;
                 CAA->StreamUpdateParam = p->sn764xx[CurChip];
+				if (p->StepSynth && ! p->StemRender && ! (p->VGMHead.lngHzPSG & 0x80000000))
+				{
+					// not possible with the other cores and the T6W28 (NGP) mode
+					StepRate = sn764xx_set_step_synth(p->sn764xx[CurChip], p->SampleRate);
+					if (StepRate)
+					{
+						CAA->SmpRate = StepRate;
+						CAA->StepSynth = true;
+					}
+				}
 
                 CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
                 if (! CurChip || ! (ChipClk & 0x80000000))
@@ -2117,6 +3042,7 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_segapcm(&p->segapcm[CurChip], ChipClk, p->VGMHead.lngSPCMIntf);
 				CAA->StreamUpdate = &SEGAPCM_update;
                 CAA->StreamUpdateParam = p->segapcm[CurChip];
+				CAA->IsSilent = &segapcm_is_silent;
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
 				AbsVol += CAA->Volume;
@@ -2452,6 +3378,16 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
                                                  p->CHIP_SAMPLING_MODE, p->CHIP_SAMPLE_RATE);
                 CAA->StreamUpdate = &ayxx_stream_update;
                 CAA->StreamUpdateParam = p->ay8910[CurChip];
+				if (p->StepSynth)
+				{
+					// only the EMU2149 core
+					StepRate = ayxx_set_step_synth(p->ay8910[CurChip], p->SampleRate);
+					if (StepRate)
+					{
+						CAA->SmpRate = StepRate;
+						CAA->StepSynth = true;
+					}
+				}
 
                 CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
                 AbsVol += CAA->Volume * 2;
@@ -2516,6 +3452,7 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_multipcm(&p->multipcm[CurChip], ChipClk);
 				CAA->StreamUpdate = &MultiPCM_update;
                 CAA->StreamUpdateParam = p->multipcm[CurChip];
+				CAA->IsSilent = &multipcm_is_silent;
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
 				AbsVol += CAA->Volume * 4;
@@ -2582,6 +3519,7 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_okim6295(&p->okim6295[CurChip], ChipClk);
 				CAA->StreamUpdate = &okim6295_update;
                 CAA->StreamUpdateParam = p->okim6295[CurChip];
+				CAA->IsSilent = &okim6295_is_silent;
 				okim6295_set_srchg_cb(p->okim6295[CurChip], &ChangeChipSampleRate, CAA);
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
@@ -2601,6 +3539,15 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_k051649(&p->k051649[CurChip], ChipClk);
 				CAA->StreamUpdate = &k051649_update;
                 CAA->StreamUpdateParam = p->k051649[CurChip];
+				if (p->StepSynth)
+				{
+					StepRate = k051649_set_step_synth(p->k051649[CurChip], p->SampleRate);
+					if (StepRate)
+					{
+						CAA->SmpRate = StepRate;
+						CAA->StepSynth = true;
+					}
+				}
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
 				AbsVol += CAA->Volume;
@@ -2698,6 +3645,16 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_pokey(&p->pokey[CurChip], ChipClk);
 				CAA->StreamUpdate = &pokey_update;
                 CAA->StreamUpdateParam = p->pokey[CurChip];
+				if (p->StepSynth)
+				{
+					StepRate = pokey_set_step_synth(p->pokey[CurChip], p->SampleRate,
+													GetResampleGain(p, CAA->SmpRate));
+					if (StepRate)
+					{
+						CAA->SmpRate = StepRate;
+						CAA->StepSynth = true;
+					}
+				}
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
 				AbsVol += CAA->Volume;
@@ -2716,6 +3673,7 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_qsound(&p->qsound[CurChip], ChipClk);
 				CAA->StreamUpdate = &qsound_update;
                 CAA->StreamUpdateParam = p->qsound[CurChip];
+				CAA->IsSilent = &qsound_is_silent;
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
 				AbsVol += CAA->Volume;
@@ -2825,7 +3783,12 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->ChipType = 0x25;
 
 				ChipClk = GetChipClock(p, (CurChip << 7) | CAA->ChipType, NULL);
-				CAA->SmpRate = device_start_es5506(&p->es550x[CurChip], ChipClk, p->VGMHead.bytES5506Chns);
+				// The voices are assigned to the chip's channel pairs modulo the
+				// pair count, so passing fewer pairs folds the rest in.
+				CAA->OutPairs = GetSpeakerPairs(p);
+				if (CAA->OutPairs > p->VGMHead.bytES5506Chns)
+					CAA->OutPairs = p->VGMHead.bytES5506Chns ? p->VGMHead.bytES5506Chns : 0x01;
+				CAA->SmpRate = device_start_es5506(&p->es550x[CurChip], ChipClk, CAA->OutPairs);
 				CAA->StreamUpdate = &es5506_update;
                 CAA->StreamUpdateParam = p->es550x[CurChip];
 				es5506_set_srchg_cb(p->es550x[CurChip], &ChangeChipSampleRate, CAA);
@@ -2866,6 +3829,10 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				CAA->SmpRate = device_start_c352(&p->c352[CurChip], ChipClk, p->VGMHead.bytC352ClkDiv * 4);
 				CAA->StreamUpdate = &c352_update;
                 CAA->StreamUpdateParam = p->c352[CurChip];
+				CAA->IsSilent = &c352_is_silent;
+				// front and rear speakers
+				CAA->OutPairs = (GetSpeakerPairs(p) > 0x01) ? 0x02 : 0x01;
+				c352_set_rear_output(p->c352[CurChip], CAA->OutPairs > 0x01);
 
 				CAA->Volume = GetChipVolume(p, CAA->ChipType, CurChip, ChipCnt);
 				AbsVol += CAA->Volume * 8;
@@ -2944,6 +3911,13 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 				SetupResampler(p, CAA);
 		}
 
+		// Resolve the register write functions
+		for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+		{
+			for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++)
+				chip_reg_setup(p, CurChip, CurCSet);
+		}
+
 		GeneralChipLists(p);
 		break;
 	case 0x01:	// Reset chips
@@ -3160,9 +4134,19 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 
 		  resampler_destroy(CAA->Resampler);
 			CAA->Resampler = 0x00;
+			FreeResampleCarry(CAA);
+			for (CurPair = 0x00; CurPair < OUT_PAIRS_MAX - 1; CurPair ++)
+			{
+				if (CAA->PairResamplers[CurPair] != NULL)
+					resampler_destroy(CAA->PairResamplers[CurPair]);
+				CAA->PairResamplers[CurPair] = NULL;
+			}
 
 			CAA->ChipType = 0xFF;	// mark as "unused"
 		}	// end for CurChip
+		CAA = p->CA_Paired[CurCSet];
+		for (CurChip = 0x00; CurChip < 0x03; CurChip ++, CAA ++)
+			FreeResampleCarry(CAA);
 
 		}	// end for CurCSet
 
@@ -3177,7 +4161,8 @@ static void Chips_GeneralActions(VGM_PLAYER* p, UINT8 Mode)
 		for (CurChip = 0x00; CurChip < PCM_BANK_COUNT; CurChip ++)
 		{
 			free(p->PCMBank[CurChip].Bank);
-			free(p->PCMBank[CurChip].Data);
+			if (! p->PCMBank[CurChip].DataRef)
+				free(p->PCMBank[CurChip].Data);
 		}
 		//memset(PCMBank, 0x00, sizeof(VGM_PCM_BANK) * PCM_BANK_COUNT);
 		free(p->PCMTbl.Entries);
@@ -3371,6 +4356,63 @@ static void InterpretFile(VGM_PLAYER* p, UINT32 SampleCount)
 	return;
 }
 
+static void InterpretSeek(VGM_PLAYER* p, UINT32 SampleCount)
+{
+	// InterpretFile in steps, so that the seek index gets its checkpoints on the way
+	SEEK_INDEX* SIdx;
+	INT32 StepSmpls;
+
+	CheckSeekIndex(p);
+	while(SampleCount && p->SeekIndex != NULL && ! p->VGMCurLoop && ! p->VGMEnd)
+	{
+		SIdx = (SEEK_INDEX*)p->SeekIndex;
+		StepSmpls = (SIdx->Count ? SIdx->Points[SIdx->Count - 1].SmplPlayed : 0) + SIdx->Step;
+		StepSmpls -= p->VGMSmplPlayed;
+		if (StepSmpls <= 0)
+			break;	// couldn't add the checkpoint
+		if ((UINT32)StepSmpls > SampleCount)
+			StepSmpls = SampleCount;
+		InterpretFile(p, StepSmpls);
+		SampleCount -= StepSmpls;
+		CheckSeekIndex(p);
+	}
+	if (SampleCount)
+		InterpretFile(p, SampleCount);
+
+	return;
+}
+
+static bool IsNextSampleIdle(VGM_PLAYER* p)
+{
+	// returns true if InterpretFile(p, 1) won't write to any chip
+	UINT8 CurChip;
+
+	if (p->FileMode)
+		return false;	// other formats can't be looked ahead
+	if (! p->VGMEnd && p->VGMSmplPos <= SamplePbk2VGM_I(p, p->VGMSmplPlayed + 1))
+		return false;
+	for (CurChip = 0x00; CurChip < p->DacCtrlUsed; CurChip ++)
+	{
+		if (daccontrol_send_pending(p->daccontrol[p->DacCtrlUsg[CurChip]]))
+			return false;
+	}
+
+	return true;
+}
+
+INLINE bool IsInVGMData(VGM_PLAYER* p, const UINT8* Data, UINT32 DataSize)
+{
+	// Data blocks that lie completely within the file data can be used in place.
+	UINT32 DataPos;
+
+	if (p->VGMStream != NULL)
+		return false;	// the stream window gets overwritten
+	if (Data < p->VGMData)
+		return false;
+	DataPos = (UINT32)(Data - p->VGMData);
+	return DataPos <= p->VGMDataLen && DataSize <= p->VGMDataLen - DataPos;
+}
+
 static void AddPCMData(VGM_PLAYER* p, UINT8 Type, UINT32 DataSize, const UINT8* Data)
 {
 	UINT32 CurBnk;
@@ -3406,14 +4448,45 @@ static void AddPCMData(VGM_PLAYER* p, UINT8 Type, UINT32 DataSize, const UINT8*
 		BankSize = DataSize;
 	else
 		BankSize = ReadLE32(&Data[0x01]);
-	TempPCM->Data = realloc(TempPCM->Data, TempPCM->DataSize + BankSize);
+	if (! TempPCM->DataSize && ! (Type & 0x40) && IsInVGMData(p, Data, DataSize))
+	{
+		// The first block of a bank is used in place, the file data stays until it's closed.
+		if (! TempPCM->DataRef)
+			free(TempPCM->Data);
+		TempPCM->Data = (UINT8*)Data;
+		TempPCM->DataRef = 0x01;
+	}
+	else if (! TempPCM->DataSize && ! (Type & 0x40) && p->VGMStreamBlk != NULL)
+	{
+		// take over the buffer of a large streamed block
+		if (! TempPCM->DataRef)
+			free(TempPCM->Data);
+		memmove(p->VGMStreamBlk, Data, DataSize);
+		TempPCM->Data = p->VGMStreamBlk;
+		TempPCM->DataRef = 0x00;
+		p->VGMStreamBlk = NULL;
+		Data = TempPCM->Data;
+	}
+	else if (TempPCM->DataRef)
+	{
+		// more blocks follow - the bank needs its own buffer now
+		UINT8* NewData = (UINT8*)malloc(TempPCM->DataSize + BankSize);
+		memcpy(NewData, TempPCM->Data, TempPCM->DataSize);
+		TempPCM->Data = NewData;
+		TempPCM->DataRef = 0x00;
+	}
+	else
+	{
+		TempPCM->Data = realloc(TempPCM->Data, TempPCM->DataSize + BankSize);
+	}
 	TempBnk = &TempPCM->Bank[CurBnk];
 	TempBnk->DataStart = TempPCM->DataSize;
 	if (! (Type & 0x40))
 	{
 		TempBnk->DataSize = DataSize;
 		TempBnk->Data = TempPCM->Data + TempBnk->DataStart;
-		memcpy(TempBnk->Data, Data, DataSize);
+		if (TempBnk->Data != Data)
+			memcpy(TempBnk->Data, Data, DataSize);
 	}
 	else
 	{
@@ -3857,978 +4930,1239 @@ static void ReadPCMTable(VGM_PLAYER* p, UINT32 DataSize, const UINT8* Data)
 }
 
 #define CHIP_CHECK(name)	(p->ChipAudio[CurChip].name.ChipType != 0xFF)
-static void InterpretVGM(VGM_PLAYER* p, UINT32 SampleCount)
+
+// Pre-decoded Commands
+// With PreDecode set, PlayVGM decodes the whole command stream into a list of events
+// with the chip, register, data and VGM sample already resolved, so that playback only
+// walks the list. Commands that do more than a single write (data blocks, DAC stream
+// control, the end of the data, ...) are kept as raw events and run through
+// InterpretVGMCommand. The list doesn't change when looping or seeking, the event at
+// VGMPos is looked up and its time is adjusted to VGMSmplPos.
+#define VGMEVT_NONE	0x00	// write to a chip that isn't there
+#define VGMEVT_REG	0x01	// chip_reg_write
+#define VGMEVT_MEM	0x02	// memory write, the function depends on ChipType
+#define VGMEVT_DAC	0x03	// YM2612 DAC write from the PCM bank (Port: the chip is there)
+#define VGMEVT_RAW	0x04	// interpreted from the VGM data
+
+typedef struct vgm_event
 {
-	INT32 SmplPlayed;
+	INT32 Sample;	// VGM sample of the command (within the first run)
+	UINT32 Pos;		// file offset of the command
+	UINT16 Offset;
+	UINT16 Data;
+	UINT8 Type;
+	UINT8 ChipType;
+	UINT8 ChipID;
+	UINT8 Port;
+} VGM_EVENT;
+
+typedef struct event_list
+{
+	UINT32 Count;
+	UINT32 Cur;	// the event at VGMPos (a hint for FindVGMEvent)
+	VGM_EVENT* Events;
+} EVENT_LIST;
+
+INLINE void SetVGMEvent(VGM_EVENT* Evt, UINT8 Type, UINT8 ChipType, UINT8 ChipID,
+						UINT8 Port, UINT16 Offset, UINT16 Data)
+{
+	Evt->Type = Type;
+	Evt->ChipType = ChipType;
+	Evt->ChipID = ChipID;
+	Evt->Port = Port;
+	Evt->Offset = Offset;
+	Evt->Data = Data;
+
+	return;
+}
+
+static UINT32 DecodeVGMWrite(VGM_PLAYER* p, const UINT8* VGMPnt, VGM_EVENT* Evt)
+{
+	// decodes chip writes into Evt and returns the command length,
+	// returns 0 for all other commands
 	UINT8 Command;
-	UINT8 TempByt;
-	UINT16 TempSht;
-	UINT32 TempLng;
-	VGM_PCM_BANK* TempPCM;
-	VGM_PCM_DATA* TempBnk;
-	UINT32 ROMSize;
-	UINT32 DataStart;
-	UINT32 DataLen;
-	const UINT8* ROMData;
 	UINT8 CurChip;
-	const UINT8* VGMPnt;
 
-	if (p->VGMEnd)
-		return;
+	Command = VGMPnt[0x00];
+	Evt->Type = VGMEVT_NONE;
 
-	SmplPlayed = SamplePbk2VGM_I(p, p->VGMSmplPlayed + SampleCount);
-	while(p->VGMSmplPos <= SmplPlayed)
+	// Cheat Mode (to use 2 instances of 1 chip)
+	CurChip = 0x00;
+	switch(Command)
 	{
-		Command = p->VGMData[p->VGMPos + 0x00];
-		if (Command >= 0x70 && Command <= 0x8F)
+	case 0x30:
+		if (p->VGMHead.lngHzPSG & 0x40000000)
 		{
-			switch(Command & 0xF0)
-			{
-			case 0x70:
-				p->VGMSmplPos += (Command & 0x0F) + 0x01;
-				break;
-			case 0x80:
-				TempByt = GetDACFromPCMBank(p);
-				if (p->VGMHead.lngHzYM2612)
-				{
-					chip_reg_write(p, 0x02, 0x00, 0x00, 0x2A, TempByt);
-				}
-				p->VGMSmplPos += (Command & 0x0F);
-				break;
-			}
-			p->VGMPos += 0x01;
+			Command += 0x20;
+			CurChip = 0x01;
 		}
-		else
+		break;
+	case 0x3F:
+		if (p->VGMHead.lngHzPSG & 0x40000000)
+		{
+			Command += 0x10;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xA1:
+		if (p->VGMHead.lngHzYM2413 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xA2:
+	case 0xA3:
+		if (p->VGMHead.lngHzYM2612 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xA4:
+		if (p->VGMHead.lngHzYM2151 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xA5:
+		if (p->VGMHead.lngHzYM2203 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xA6:
+	case 0xA7:
+		if (p->VGMHead.lngHzYM2608 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xA8:
+	case 0xA9:
+		if (p->VGMHead.lngHzYM2610 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xAA:
+		if (p->VGMHead.lngHzYM3812 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xAB:
+		if (p->VGMHead.lngHzYM3526 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xAC:
+		if (p->VGMHead.lngHzY8950 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xAE:
+	case 0xAF:
+		if (p->VGMHead.lngHzYMF262 & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	case 0xAD:
+		if (p->VGMHead.lngHzYMZ280B & 0x40000000)
+		{
+			Command -= 0x50;
+			CurChip = 0x01;
+		}
+		break;
+	}
+
+	switch(Command)
+	{
+	case 0x50:	// SN76496 write
+		if (CHIP_CHECK(SN76496))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x00, CurChip, 0x00, 0x00, VGMPnt[0x01]);
+		return 0x02;
+	case 0x51:	// YM2413 write
+		if (CHIP_CHECK(YM2413))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x01, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x52:	// YM2612 write port 0
+	case 0x53:	// YM2612 write port 1
+		if (CHIP_CHECK(YM2612))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x02, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x4F:	// GG Stereo
+		if (CHIP_CHECK(SN76496))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x00, CurChip, 0x01, 0x00, VGMPnt[0x01]);
+		return 0x02;
+	case 0x54:	// YM2151 write
+		if (CHIP_CHECK(YM2151))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x03, CurChip, 0x01, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0xC0:	// Sega PCM memory write
+		CurChip = (VGMPnt[0x02] & 0x80) >> 7;
+		if (CHIP_CHECK(SegaPCM))
+			SetVGMEvent(Evt, VGMEVT_MEM, 0x04, CurChip, 0x00, ReadLE16(&VGMPnt[0x01]) & 0x7FFF,
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xB0:	// RF5C68 register write
+		if (CHIP_CHECK(RF5C68))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x05, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0xC1:	// RF5C68 memory write
+		if (CHIP_CHECK(RF5C68))
+			SetVGMEvent(Evt, VGMEVT_MEM, 0x05, CurChip, 0x00, ReadLE16(&VGMPnt[0x01]), VGMPnt[0x03]);
+		return 0x04;
+	case 0x55:	// YM2203
+		if (CHIP_CHECK(YM2203))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x06, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x56:	// YM2608 write port 0
+	case 0x57:	// YM2608 write port 1
+		if (CHIP_CHECK(YM2608))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x07, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x58:	// YM2610 write port 0
+	case 0x59:	// YM2610 write port 1
+		if (CHIP_CHECK(YM2610))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x08, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x5A:	// YM3812 write
+		if (CHIP_CHECK(YM3812))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x09, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x5B:	// YM3526 write
+		if (CHIP_CHECK(YM3526))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x0A, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x5C:	// Y8950 write
+		if (CHIP_CHECK(Y8950))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x0B, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x5E:	// YMF262 write port 0
+	case 0x5F:	// YMF262 write port 1
+		if (CHIP_CHECK(YMF262))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x0C, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0x5D:	// YMZ280B write
+		if (CHIP_CHECK(YMZ280B))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x0F, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0xD0:	// YMF278B write
+		if (CHIP_CHECK(YMF278B))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x0D, (VGMPnt[0x01] & 0x80) >> 7, VGMPnt[0x01] & 0x7F,
+						VGMPnt[0x02], VGMPnt[0x03]);
+		return 0x04;
+	case 0xD1:	// YMF271 write
+		if (CHIP_CHECK(YMF271))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x0E, (VGMPnt[0x01] & 0x80) >> 7, VGMPnt[0x01] & 0x7F,
+						VGMPnt[0x02], VGMPnt[0x03]);
+		return 0x04;
+	case 0xB1:	// RF5C164 register write
+		if (CHIP_CHECK(RF5C164))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x10, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+		return 0x03;
+	case 0xC2:	// RF5C164 memory write
+		if (CHIP_CHECK(RF5C164))
+			SetVGMEvent(Evt, VGMEVT_MEM, 0x10, CurChip, 0x00, ReadLE16(&VGMPnt[0x01]), VGMPnt[0x03]);
+		return 0x04;
+	case 0xB2:	// PWM channel write
+		if (CHIP_CHECK(PWM))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x11, CurChip, (VGMPnt[0x01] & 0xF0) >> 4,
+						VGMPnt[0x01] & 0x0F, VGMPnt[0x02]);
+		return 0x03;
+	}
+
+	if (Command < 0xA0)
+		return 0x00;
+
+	// the remaining writes select the chip with bit 7 of the first parameter
+	CurChip = (VGMPnt[0x01] & 0x80) >> 7;
+	switch(Command)
+	{
+	case 0xA0:	// AY8910 write
+		if (CHIP_CHECK(AY8910))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x12, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xB3:	// GameBoy DMG write
+		if (CHIP_CHECK(GameBoy))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x13, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xB4:	// NES APU write
+		if (CHIP_CHECK(NES))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x14, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xB5:	// MultiPCM write
+		if (CHIP_CHECK(MultiPCM))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x15, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xC3:	// MultiPCM memory write
+		if (CHIP_CHECK(MultiPCM))
+			SetVGMEvent(Evt, VGMEVT_MEM, 0x15, CurChip, VGMPnt[0x01] & 0x7F, ReadLE16(&VGMPnt[0x02]),
+						0x00);
+		return 0x04;
+	case 0xB6:	// UPD7759 write
+		if (CHIP_CHECK(UPD7759))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x16, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xB7:	// OKIM6258 write
+		if (CHIP_CHECK(OKIM6258))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x17, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xB8:	// OKIM6295 write
+		if (CHIP_CHECK(OKIM6295))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x18, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xD2:	// SCC1 write
+		if (CHIP_CHECK(K051649))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x19, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xD3:	// K054539 write
+		if (CHIP_CHECK(K054539))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x1A, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xB9:	// HuC6280 write
+		if (CHIP_CHECK(HuC6280))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x1B, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xD4:	// C140 write
+		if (CHIP_CHECK(C140))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x1C, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xBA:	// K053260 write
+		if (CHIP_CHECK(K053260))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x1D, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xBB:	// Pokey write
+		if (CHIP_CHECK(Pokey))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x1E, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xC4:	// QSound write
+		CurChip = 0x00;
+		if (CHIP_CHECK(QSound))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x1F, CurChip, VGMPnt[0x01], VGMPnt[0x02], VGMPnt[0x03]);
+		return 0x04;
+	case 0xC5:	// YMF292/SCSP write
+		if (CHIP_CHECK(SCSP))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x20, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xBC:	// WonderSwan write
+		if (CHIP_CHECK(WSwan))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x21, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xC6:	// WonderSwan memory write
+		if (CHIP_CHECK(WSwan))
+			SetVGMEvent(Evt, VGMEVT_MEM, 0x21, CurChip, 0x00, ReadBE16(&VGMPnt[0x01]) & 0x7FFF,
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xC7:	// VSU write
+		if (CHIP_CHECK(VSU))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x22, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xBD:	// SAA1099 write
+		if (CHIP_CHECK(SAA1099))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x23, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	case 0xD5:	// ES5503 write
+		if (CHIP_CHECK(ES5503))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x24, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+	case 0xBE:	// ES5506 write (8-bit data)
+		if (CHIP_CHECK(ES5506))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x25, CurChip, VGMPnt[0x01] & 0x7F, 0x00, VGMPnt[0x02]);
+		return 0x03;
+	case 0xD6:	// ES5506 write (16-bit data)
+		if (CHIP_CHECK(ES5506))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x25, CurChip, 0x80 | (VGMPnt[0x01] & 0x7F),
+						VGMPnt[0x02], VGMPnt[0x03]);
+		return 0x04;
+	case 0xC8:	// X1-010 write
+		if (CHIP_CHECK(X1_010))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x26, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
+						VGMPnt[0x03]);
+		return 0x04;
+#if 0	// for ctr's WIP rips
+	case 0xC9:	// C352 write
+		CurChip = 0x00;
+		if (CHIP_CHECK(C352))
+		{
+			if (VGMPnt[0x01] == 0x03 && VGMPnt[0x02] == 0xFF && VGMPnt[0x03] == 0xFF)
+				SetVGMEvent(Evt, VGMEVT_MEM, 0x27, CurChip, 0x00, 0x202, 0x0020);
+			else
+				SetVGMEvent(Evt, VGMEVT_REG, 0x27, CurChip, VGMPnt[0x01], VGMPnt[0x02],
+							VGMPnt[0x03]);
+		}
+		return 0x04;
+#endif
+	case 0xE1:	// C352 write
+		if (CHIP_CHECK(C352))
+			SetVGMEvent(Evt, VGMEVT_MEM, 0x27, CurChip, 0x00,
+						((VGMPnt[0x01] & 0x7F) << 8) | (VGMPnt[0x02] << 0),
+						(VGMPnt[0x03] << 8) | VGMPnt[0x04]);
+		return 0x05;
+	case 0xBF:	// GA20 write
+		if (CHIP_CHECK(GA20))
+			SetVGMEvent(Evt, VGMEVT_REG, 0x28, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+		return 0x03;
+	}
+
+	return 0x00;
+}
+
+INLINE void ExecuteVGMEvent(VGM_PLAYER* p, const VGM_EVENT* Evt)
+{
+	UINT8 TempByt;
+
+	switch(Evt->Type)
+	{
+	case VGMEVT_REG:
+		chip_reg_write(p, Evt->ChipType, Evt->ChipID, Evt->Port, (UINT8)Evt->Offset, (UINT8)Evt->Data);
+		break;
+	case VGMEVT_MEM:
+#ifdef ENABLE_CHIP_STATS
+		((CAUD_ATTR*)&p->ChipAudio[Evt->ChipID] + Evt->ChipType)->StatWrites ++;
+#endif
+		switch(Evt->ChipType)
 		{
-			VGMPnt = &p->VGMData[p->VGMPos];
+		case 0x04:	// SegaPCM
+			sega_pcm_w(p->segapcm[Evt->ChipID], Evt->Offset, (UINT8)Evt->Data);
+			break;
+		case 0x05:	// RF5C68
+			rf5c68_mem_w(p->rf5c68, Evt->Offset, (UINT8)Evt->Data);
+			break;
+		case 0x10:	// RF5C164
+			rf5c164_mem_w(p->rf5c164, Evt->Offset, (UINT8)Evt->Data);
+			break;
+		case 0x15:	// MultiPCM
+			multipcm_bank_write(p->multipcm[Evt->ChipID], Evt->Port, Evt->Offset);
+			break;
+		case 0x21:	// WonderSwan
+			ws_write_ram(p->wswan[Evt->ChipID], Evt->Offset, (UINT8)Evt->Data);
+			break;
+		case 0x27:	// C352
+			c352_w(p->c352[Evt->ChipID], Evt->Offset, Evt->Data);
+			break;
+		}
+		break;
+	case VGMEVT_DAC:
+		TempByt = GetDACFromPCMBank(p);
+		if (Evt->Port)
+			chip_reg_write(p, 0x02, 0x00, 0x00, 0x2A, TempByt);
+		break;
+	}
+
+	return;
+}
+
+static void InterpretVGMCommand(VGM_PLAYER* p)
+{
+	// runs the command at VGMPos
+	UINT8 Command;
+	UINT8 TempByt;
+	UINT16 TempSht;
+	UINT32 TempLng;
+	VGM_PCM_BANK* TempPCM;
+	VGM_PCM_DATA* TempBnk;
+	UINT32 ROMSize;
+	UINT32 DataStart;
+	UINT32 DataLen;
+	const UINT8* ROMData;
+	UINT8 CurChip;
+	const UINT8* VGMPnt;
+	VGM_EVENT Evt;
+	UINT32 CmdLen;
 
-			// Cheat Mode (to use 2 instances of 1 chip)
-			CurChip = 0x00;
-			switch(Command)
+	Command = p->VGMData[p->VGMPos - p->VGMDataOfs + 0x00];
+	if (Command >= 0x70 && Command <= 0x8F)
+	{
+		switch(Command & 0xF0)
+		{
+		case 0x70:
+			p->VGMSmplPos += (Command & 0x0F) + 0x01;
+			break;
+		case 0x80:
+			TempByt = GetDACFromPCMBank(p);
+			if (p->VGMHead.lngHzYM2612)
 			{
-			case 0x30:
-				if (p->VGMHead.lngHzPSG & 0x40000000)
-				{
-					Command += 0x20;
-					CurChip = 0x01;
-				}
-				break;
-			case 0x3F:
-				if (p->VGMHead.lngHzPSG & 0x40000000)
-				{
-					Command += 0x10;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xA1:
-				if (p->VGMHead.lngHzYM2413 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xA2:
-			case 0xA3:
-				if (p->VGMHead.lngHzYM2612 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xA4:
-				if (p->VGMHead.lngHzYM2151 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xA5:
-				if (p->VGMHead.lngHzYM2203 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xA6:
-			case 0xA7:
-				if (p->VGMHead.lngHzYM2608 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xA8:
-			case 0xA9:
-				if (p->VGMHead.lngHzYM2610 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xAA:
-				if (p->VGMHead.lngHzYM3812 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xAB:
-				if (p->VGMHead.lngHzYM3526 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xAC:
-				if (p->VGMHead.lngHzY8950 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xAE:
-			case 0xAF:
-				if (p->VGMHead.lngHzYMF262 & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
-			case 0xAD:
-				if (p->VGMHead.lngHzYMZ280B & 0x40000000)
-				{
-					Command -= 0x50;
-					CurChip = 0x01;
-				}
-				break;
+				chip_reg_write(p, 0x02, 0x00, 0x00, 0x2A, TempByt);
 			}
-
-			switch(Command)
+			p->VGMSmplPos += (Command & 0x0F);
+			break;
+		}
+		p->VGMPos += 0x01;
+	}
+	else
+	{
+		VGMPnt = &p->VGMData[p->VGMPos - p->VGMDataOfs];
+		CurChip = 0x00;
+		switch(Command)
+		{
+		case 0x66:	// End Of File
+			if (p->VGMHead.lngLoopOffset)
 			{
-			case 0x66:	// End Of File
-				if (p->VGMHead.lngLoopOffset)
-				{
-					p->VGMPos = p->VGMHead.lngLoopOffset;
-					p->VGMSmplPos -= p->VGMHead.lngLoopSamples;
-					p->VGMSmplPlayed -= SampleVGM2Pbk_I(p, p->VGMHead.lngLoopSamples);
-					SmplPlayed = SamplePbk2VGM_I(p, p->VGMSmplPlayed + SampleCount);
-					p->VGMCurLoop ++;
+				p->VGMPos = p->VGMHead.lngLoopOffset;
+				p->VGMSmplPos -= p->VGMHead.lngLoopSamples;
+				p->VGMSmplPlayed -= SampleVGM2Pbk_I(p, p->VGMHead.lngLoopSamples);
+				p->VGMCurLoop ++;
 
-					if (p->VGMMaxLoopM && p->VGMCurLoop >= p->VGMMaxLoopM)
+				if (p->VGMMaxLoopM && p->VGMCurLoop >= p->VGMMaxLoopM)
+				{
+					if (! p->FadePlay)
 					{
-						if (! p->FadePlay)
-						{
-							p->FadeStart = SampleVGM2Pbk_I(p, p->VGMHead.lngTotalSamples +
-															(p->VGMCurLoop - 1) * p->VGMHead.lngLoopSamples);
-						}
-						p->FadePlay = true;
+						p->FadeStart = SampleVGM2Pbk_I(p, p->VGMHead.lngTotalSamples +
+														(p->VGMCurLoop - 1) * p->VGMHead.lngLoopSamples);
 					}
-					if (p->FadePlay && ! p->FadeTime)
-						p->VGMEnd = true;
+					p->FadePlay = true;
 				}
-				else
+				if (p->FadePlay && ! p->FadeTime)
+					p->VGMEnd = true;
+			}
+			else
+			{
+				if (p->VGMHead.lngTotalSamples != (UINT32)p->VGMSmplPos)
 				{
-					if (p->VGMHead.lngTotalSamples != (UINT32)p->VGMSmplPos)
-					{
 #ifdef CONSOLE_MODE
-						printf("Warning! Header Samples: %u\t Counted Samples: %u\n",
-								p->VGMHead.lngTotalSamples, p->VGMSmplPos);
-						p->ErrorHappened = true;
+					printf("Warning! Header Samples: %u\t Counted Samples: %u\n",
+							p->VGMHead.lngTotalSamples, p->VGMSmplPos);
+					p->ErrorHappened = true;
 #endif
-						p->VGMHead.lngTotalSamples = p->VGMSmplPos;
-					}
-					
-					if (p->HardStopOldVGMs)
-					{
-						if (p->VGMHead.lngVersion < 0x150 ||
-							(p->VGMHead.lngVersion == 0x150 && p->HardStopOldVGMs == 0x02))
-						Chips_GeneralActions(p, 0x01); // reset all chips, for instant silence
-					}
-
-					p->VGMEnd = true;
-					break;
+					p->VGMHead.lngTotalSamples = p->VGMSmplPos;
 				}
-				break;
-			case 0x62:	// 1/60s delay
-				p->VGMSmplPos += 735;
-				p->VGMPos += 0x01;
-				break;
-			case 0x63:	// 1/50s delay
-				p->VGMSmplPos += 882;
-				p->VGMPos += 0x01;
-				break;
-			case 0x61:	// xx Sample Delay
-				TempSht = ReadLE16(&VGMPnt[0x01]);
-				p->VGMSmplPos += TempSht;
-				p->VGMPos += 0x03;
-				break;
-			case 0x50:	// SN76496 write
-				if (CHIP_CHECK(SN76496))
+				
+				if (p->HardStopOldVGMs)
 				{
-					chip_reg_write(p, 0x00, CurChip, 0x00, 0x00, VGMPnt[0x01]);
+					if (p->VGMHead.lngVersion < 0x150 ||
+						(p->VGMHead.lngVersion == 0x150 && p->HardStopOldVGMs == 0x02))
+					Chips_GeneralActions(p, 0x01); // reset all chips, for instant silence
 				}
-				p->VGMPos += 0x02;
+
+				p->VGMEnd = true;
 				break;
-			case 0x51:	// YM2413 write
-				if (CHIP_CHECK(YM2413))
+			}
+			break;
+		case 0x62:	// 1/60s delay
+			p->VGMSmplPos += 735;
+			p->VGMPos += 0x01;
+			break;
+		case 0x63:	// 1/50s delay
+			p->VGMSmplPos += 882;
+			p->VGMPos += 0x01;
+			break;
+		case 0x61:	// xx Sample Delay
+			TempSht = ReadLE16(&VGMPnt[0x01]);
+			p->VGMSmplPos += TempSht;
+			p->VGMPos += 0x03;
+			break;
+		case 0x67:	// PCM Data Stream
+			TempByt = VGMPnt[0x02];
+			TempLng = ReadLE32(&VGMPnt[0x03]);
+			if (TempLng & 0x80000000)
+			{
+				TempLng &= 0x7FFFFFFF;
+				CurChip = 0x01;
+			}
+			if (p->VGMStream != NULL)
+			{
+				VGMPnt = ReadVGMStreamBlock(p, p->VGMPos, 0x07 + TempLng);
+				if (VGMPnt == NULL)
 				{
-					chip_reg_write(p, 0x01, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+					p->VGMEnd = true;
+					break;
 				}
-				p->VGMPos += 0x03;
-				break;
-			case 0x52:	// YM2612 write port 0
-			case 0x53:	// YM2612 write port 1
-				if (CHIP_CHECK(YM2612))
+			}
+
+			switch(TempByt & 0xC0)
+			{
+			case 0x00:	// Database Block
+			case 0x40:
+				AddPCMData(p, TempByt, TempLng, &VGMPnt[0x07]);
+				/*switch(TempByt)
 				{
-					chip_reg_write(p, 0x02, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+				case 0x00:	// YM2612 PCM Database
+					break;
+				case 0x01:	// RF5C68 PCM Database
+					break;
+				case 0x02:	// RF5C164 PCM Database
+					break;
+				}*/
 				break;
-			case 0x67:	// PCM Data Stream
-				TempByt = VGMPnt[0x02];
-				TempLng = ReadLE32(&VGMPnt[0x03]);
-				if (TempLng & 0x80000000)
-				{
-					TempLng &= 0x7FFFFFFF;
-					CurChip = 0x01;
-				}
+			case 0x80:	// ROM/RAM Dump
+				if (p->VGMCurLoop)
+					break;
 
-				switch(TempByt & 0xC0)
+				ROMSize = ReadLE32(&VGMPnt[0x07]);
+				DataStart = ReadLE32(&VGMPnt[0x0B]);
+				DataLen = TempLng - 0x08;
+				ROMData = &VGMPnt[0x0F];
+				switch(TempByt)
 				{
-				case 0x00:	// Database Block
-				case 0x40:
-					AddPCMData(p, TempByt, TempLng, &VGMPnt[0x07]);
-					/*switch(TempByt)
-					{
-					case 0x00:	// YM2612 PCM Database
+				case 0x80:	// SegaPCM ROM
+					if (! CHIP_CHECK(SegaPCM))
 						break;
-					case 0x01:	// RF5C68 PCM Database
-						break;
-					case 0x02:	// RF5C164 PCM Database
-						break;
-					}*/
+					sega_pcm_write_rom(p->segapcm[CurChip], ROMSize, DataStart, DataLen, ROMData);
 					break;
-				case 0x80:	// ROM/RAM Dump
-					if (p->VGMCurLoop)
-						break;
-
-					ROMSize = ReadLE32(&VGMPnt[0x07]);
-					DataStart = ReadLE32(&VGMPnt[0x0B]);
-					DataLen = TempLng - 0x08;
-					ROMData = &VGMPnt[0x0F];
-					switch(TempByt)
-					{
-					case 0x80:	// SegaPCM ROM
-						if (! CHIP_CHECK(SegaPCM))
-							break;
-						sega_pcm_write_rom(p->segapcm[CurChip], ROMSize, DataStart, DataLen, ROMData);
+				case 0x81:	// YM2608 DELTA-T ROM Image
+					if (! CHIP_CHECK(YM2608))
 						break;
-					case 0x81:	// YM2608 DELTA-T ROM Image
-						if (! CHIP_CHECK(YM2608))
-							break;
-						ym2608_write_data_pcmrom(p->ym2608[CurChip], 0x02, ROMSize, DataStart, DataLen,
-												ROMData);
+					ym2608_write_data_pcmrom(p->ym2608[CurChip], 0x02, ROMSize, DataStart, DataLen,
+											ROMData);
+					break;
+				case 0x82:	// YM2610 ADPCM ROM Image
+				case 0x83:	// YM2610 DELTA-T ROM Image
+					if (! CHIP_CHECK(YM2610))
 						break;
-					case 0x82:	// YM2610 ADPCM ROM Image
-					case 0x83:	// YM2610 DELTA-T ROM Image
-						if (! CHIP_CHECK(YM2610))
-							break;
-						TempByt = 0x01 + (TempByt - 0x82);
-						ym2610_write_data_pcmrom(p->ym2610[CurChip], TempByt, ROMSize, DataStart, DataLen,
-												ROMData);
+					TempByt = 0x01 + (TempByt - 0x82);
+					ym2610_write_data_pcmrom(p->ym2610[CurChip], TempByt, ROMSize, DataStart, DataLen,
+											ROMData);
+					break;
+				case 0x84:	// YMF278B ROM Image
+					if (! CHIP_CHECK(YMF278B))
 						break;
-					case 0x84:	// YMF278B ROM Image
-						if (! CHIP_CHECK(YMF278B))
-							break;
-						ymf278b_write_rom(p->ymf278b[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					ymf278b_write_rom(p->ymf278b[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x85:	// YMF271 ROM Image
+					if (! CHIP_CHECK(YMF271))
 						break;
-					case 0x85:	// YMF271 ROM Image
-						if (! CHIP_CHECK(YMF271))
-							break;
-						ymf271_write_rom(p->ymf271[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					ymf271_write_rom(p->ymf271[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x86:	// YMZ280B ROM Image
+					if (! CHIP_CHECK(YMZ280B))
 						break;
-					case 0x86:	// YMZ280B ROM Image
-						if (! CHIP_CHECK(YMZ280B))
-							break;
-						ymz280b_write_rom(p->ymz280b[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					ymz280b_write_rom(p->ymz280b[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x87:	// YMF278B RAM Image
+					if (! CHIP_CHECK(YMF278B))
 						break;
-					case 0x87:	// YMF278B RAM Image
-						if (! CHIP_CHECK(YMF278B))
-							break;
-						//ymf278b_write_ram(CurChip, ROMSize, DataStart, DataLen, ROMData);
+					//ymf278b_write_ram(CurChip, ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x88:	// Y8950 DELTA-T ROM Image
+					if (! CHIP_CHECK(Y8950) || p->PlayingMode == 0x01)
 						break;
-					case 0x88:	// Y8950 DELTA-T ROM Image
-						if (! CHIP_CHECK(Y8950) || p->PlayingMode == 0x01)
-							break;
-						y8950_write_data_pcmrom(p->y8950[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					y8950_write_data_pcmrom(p->y8950[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x89:	// MultiPCM ROM Image
+					if (! CHIP_CHECK(MultiPCM))
 						break;
-					case 0x89:	// MultiPCM ROM Image
-						if (! CHIP_CHECK(MultiPCM))
-							break;
-						multipcm_write_rom(p->multipcm[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					multipcm_write_rom(p->multipcm[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x8A:	// UPD7759 ROM Image
+					if (! CHIP_CHECK(UPD7759))
 						break;
-					case 0x8A:	// UPD7759 ROM Image
-						if (! CHIP_CHECK(UPD7759))
-							break;
-						upd7759_write_rom(p->upd7759[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					upd7759_write_rom(p->upd7759[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x8B:	// OKIM6295 ROM Image
+					if (! CHIP_CHECK(OKIM6295))
 						break;
-					case 0x8B:	// OKIM6295 ROM Image
-						if (! CHIP_CHECK(OKIM6295))
-							break;
-						okim6295_write_rom(p->okim6295[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					okim6295_write_rom(p->okim6295[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x8C:	// K054539 ROM Image
+					if (! CHIP_CHECK(K054539))
 						break;
-					case 0x8C:	// K054539 ROM Image
-						if (! CHIP_CHECK(K054539))
-							break;
-						k054539_write_rom(p->k054539[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					k054539_write_rom(p->k054539[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x8D:	// C140 ROM Image
+					if (! CHIP_CHECK(C140))
 						break;
-					case 0x8D:	// C140 ROM Image
-						if (! CHIP_CHECK(C140))
-							break;
-						c140_write_rom(p->c140[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					c140_write_rom(p->c140[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x8E:	// K053260 ROM Image
+					if (! CHIP_CHECK(K053260))
 						break;
-					case 0x8E:	// K053260 ROM Image
-						if (! CHIP_CHECK(K053260))
-							break;
-						k053260_write_rom(p->k053260[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					k053260_write_rom(p->k053260[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x8F:	// QSound ROM Image
+					if (! CHIP_CHECK(QSound))
 						break;
-					case 0x8F:	// QSound ROM Image
-						if (! CHIP_CHECK(QSound))
-							break;
+					if (! DataStart && ROMSize && DataLen >= ROMSize &&
+						IsInVGMData(p, ROMData, ROMSize))
+						qsound_set_rom(p->qsound[CurChip], ROMSize, ROMData);
+					else
 						qsound_write_rom(p->qsound[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x90:	// ES5506 ROM Image
+					if (! CHIP_CHECK(ES5506))
 						break;
-					case 0x90:	// ES5506 ROM Image
-						if (! CHIP_CHECK(ES5506))
-							break;
-						es5506_write_rom(p->es550x[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					es5506_write_rom(p->es550x[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x91:	// X1-010 ROM Image
+					if (! CHIP_CHECK(X1_010))
 						break;
-					case 0x91:	// X1-010 ROM Image
-						if (! CHIP_CHECK(X1_010))
-							break;
-						x1_010_write_rom(p->x1_010[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					x1_010_write_rom(p->x1_010[CurChip], ROMSize, DataStart, DataLen, ROMData);
+					break;
+				case 0x92:	// C352 ROM Image
+					if (! CHIP_CHECK(C352))
 						break;
-					case 0x92:	// C352 ROM Image
-						if (! CHIP_CHECK(C352))
-							break;
+					if (! DataStart && ROMSize && DataLen >= ROMSize &&
+						IsInVGMData(p, ROMData, ROMSize))
+						c352_set_rom(p->c352[CurChip], ROMSize, ROMData);
+					else
 						c352_write_rom(p->c352[CurChip], ROMSize, DataStart, DataLen, ROMData);
-						break;
-					case 0x93:	// GA20 ROM Image
-						if (! CHIP_CHECK(GA20))
-							break;
-						iremga20_write_rom(p->ga20[CurChip], ROMSize, DataStart, DataLen, ROMData);
-						break;
-				//	case 0x8C:	// OKIM6376 ROM Image
-				//		if (! CHIP_CHECK(OKIM6376))
-				//			break;
-				//		break;
-					}
 					break;
-				case 0xC0:	// RAM Write
-					if (! (TempByt & 0x20))
-					{
-						DataStart = ReadLE16(&VGMPnt[0x07]);
-						DataLen = TempLng - 0x02;
-						ROMData = &VGMPnt[0x09];
-					}
-					else
-					{
-						DataStart = ReadLE32(&VGMPnt[0x07]);
-						DataLen = TempLng - 0x04;
-						ROMData = &VGMPnt[0x0B];
-					}
-					switch(TempByt)
-					{
-					case 0xC0:	// RF5C68 RAM Database
-						if (! CHIP_CHECK(RF5C68))
-							break;
-						rf5c68_write_ram(p->rf5c68, DataStart, DataLen, ROMData);
+				case 0x93:	// GA20 ROM Image
+					if (! CHIP_CHECK(GA20))
 						break;
-					case 0xC1:	// RF5C164 RAM Database
-						if (! CHIP_CHECK(RF5C164))
-							break;
-						rf5c164_write_ram(p->rf5c164, DataStart, DataLen, ROMData);
-						break;
-					case 0xC2:	// NES APU RAM
-						if (! CHIP_CHECK(NES))
-							break;
-						nes_write_ram(p->nesapu[CurChip], DataStart, DataLen, ROMData);
-						break;
-					case 0xE0:	// SCSP RAM
-						if (! CHIP_CHECK(SCSP))
-							break;
-						scsp_write_ram(p->scsp[CurChip], DataStart, DataLen, ROMData);
-						break;
-					case 0xE1:	// ES5503 RAM
-						if (! CHIP_CHECK(ES5503))
-							break;
-						es5503_write_ram(p->es5503[CurChip], DataStart, DataLen, ROMData);
-						break;
-					}
+					iremga20_write_rom(p->ga20[CurChip], ROMSize, DataStart, DataLen, ROMData);
 					break;
+			//	case 0x8C:	// OKIM6376 ROM Image
+			//		if (! CHIP_CHECK(OKIM6376))
+			//			break;
+			//		break;
 				}
-				p->VGMPos += 0x07 + TempLng;
-				break;
-			case 0xE0:	// Seek to PCM Data Bank Pos
-				p->PCMBank[0x00].DataPos = ReadLE32(&VGMPnt[0x01]);
-				p->VGMPos += 0x05;
-				break;
-			case 0x4F:	// GG Stereo
-				if (CHIP_CHECK(SN76496))
-				{
-					chip_reg_write(p, 0x00, CurChip, 0x01, 0x00, VGMPnt[0x01]);
-				}
-				p->VGMPos += 0x02;
 				break;
-			case 0x54:	// YM2151 write
-				if (CHIP_CHECK(YM2151))
+			case 0xC0:	// RAM Write
+				if (! (TempByt & 0x20))
 				{
-					chip_reg_write(p, 0x03, CurChip, 0x01, VGMPnt[0x01], VGMPnt[0x02]);
+					DataStart = ReadLE16(&VGMPnt[0x07]);
+					DataLen = TempLng - 0x02;
+					ROMData = &VGMPnt[0x09];
 				}
-				//p->VGMSmplPos += 80;
-				p->VGMPos += 0x03;
-				break;
-			case 0xC0:	// Sega PCM memory write
-				TempSht = ReadLE16(&VGMPnt[0x01]);
-				CurChip = (TempSht & 0x8000) >> 15;
-				if (CHIP_CHECK(SegaPCM))
+				else
 				{
-					sega_pcm_w(p->segapcm[CurChip], TempSht & 0x7FFF, VGMPnt[0x03]);
+					DataStart = ReadLE32(&VGMPnt[0x07]);
+					DataLen = TempLng - 0x04;
+					ROMData = &VGMPnt[0x0B];
 				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xB0:	// RF5C68 register write
-				if (CHIP_CHECK(RF5C68))
+				switch(TempByt)
 				{
-					chip_reg_write(p, 0x05, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
+				case 0xC0:	// RF5C68 RAM Database
+					if (! CHIP_CHECK(RF5C68))
+						break;
+					rf5c68_write_ram(p->rf5c68, DataStart, DataLen, ROMData);
+					break;
+				case 0xC1:	// RF5C164 RAM Database
+					if (! CHIP_CHECK(RF5C164))
+						break;
+					rf5c164_write_ram(p->rf5c164, DataStart, DataLen, ROMData);
+					break;
+				case 0xC2:	// NES APU RAM
+					if (! CHIP_CHECK(NES))
+						break;
+					nes_write_ram(p->nesapu[CurChip], DataStart, DataLen, ROMData);
+					break;
+				case 0xE0:	// SCSP RAM
+					if (! CHIP_CHECK(SCSP))
+						break;
+					scsp_write_ram(p->scsp[CurChip], DataStart, DataLen, ROMData);
+					break;
+				case 0xE1:	// ES5503 RAM
+					if (! CHIP_CHECK(ES5503))
+						break;
+					es5503_write_ram(p->es5503[CurChip], DataStart, DataLen, ROMData);
+					break;
 				}
-				p->VGMPos += 0x03;
 				break;
-			case 0xC1:	// RF5C68 memory write
-				if (CHIP_CHECK(RF5C68))
-				{
-					TempSht = ReadLE16(&VGMPnt[0x01]);
-					rf5c68_mem_w(p->rf5c68, TempSht, VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0x55:	// YM2203
-				if (CHIP_CHECK(YM2203))
-				{
-					chip_reg_write(p, 0x06, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0x56:	// YM2608 write port 0
-			case 0x57:	// YM2608 write port 1
-				if (CHIP_CHECK(YM2608))
-				{
-					chip_reg_write(p, 0x07, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			}
+			if (p->VGMStreamBlk != NULL)
+			{
+				free(p->VGMStreamBlk);	p->VGMStreamBlk = NULL;
+			}
+			p->VGMPos += 0x07 + TempLng;
+			break;
+		case 0xE0:	// Seek to PCM Data Bank Pos
+			p->PCMBank[0x00].DataPos = ReadLE32(&VGMPnt[0x01]);
+			p->VGMPos += 0x05;
+			break;
+		case 0x68:	// PCM RAM write
+			CurChip = (VGMPnt[0x02] & 0x80) >> 7;
+			TempByt =  VGMPnt[0x02] & 0x7F;
+
+			DataStart = ReadLE24(&VGMPnt[0x03]);
+			TempLng = ReadLE24(&VGMPnt[0x06]);
+			DataLen = ReadLE24(&VGMPnt[0x09]);
+			if (! DataLen)
+				DataLen += 0x01000000;
+			ROMData = GetPointerFromPCMBank(p, TempByt, DataStart);
+			if (ROMData == NULL)
+			{
+				p->VGMPos += 0x0C;
 				break;
-			case 0x58:	// YM2610 write port 0
-			case 0x59:	// YM2610 write port 1
-				if (CHIP_CHECK(YM2610))
-				{
-					chip_reg_write(p, 0x08, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			}
+
+			switch(TempByt)
+			{
+			case 0x01:
+				if (! CHIP_CHECK(RF5C68))
+					break;
+				rf5c68_write_ram(p->rf5c68, TempLng, DataLen, ROMData);
 				break;
-			case 0x5A:	// YM3812 write
-				if (CHIP_CHECK(YM3812))
-				{
-					chip_reg_write(p, 0x09, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			case 0x02:
+				if (! CHIP_CHECK(RF5C164))
+					break;
+				rf5c164_write_ram(p->rf5c164, TempLng, DataLen, ROMData);
 				break;
-			case 0x5B:	// YM3526 write
-				if (CHIP_CHECK(YM3526))
-				{
-					chip_reg_write(p, 0x0A, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			case 0x06:
+				if (! CHIP_CHECK(SCSP))
+					break;
+				scsp_write_ram(p->scsp[CurChip], TempLng, DataLen, ROMData);
 				break;
-			case 0x5C:	// Y8950 write
-				if (CHIP_CHECK(Y8950))
-				{
-					chip_reg_write(p, 0x0B, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			case 0x07:
+				if (! CHIP_CHECK(NES))
+					break;
+				p->Last95Drum = DataStart / DataLen - 1;
+				p->Last95Max = p->PCMBank[TempByt].DataSize / DataLen;
+				nes_write_ram(p->nesapu[CurChip], TempLng, DataLen, ROMData);
 				break;
-			case 0x5E:	// YMF262 write port 0
-			case 0x5F:	// YMF262 write port 1
-				if (CHIP_CHECK(YMF262))
-				{
-					chip_reg_write(p, 0x0C, CurChip, Command & 0x01, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			}
+			p->VGMPos += 0x0C;
+			break;
+		case 0x90:	// DAC Ctrl: Setup Chip
+			CurChip = VGMPnt[0x01];
+			if (CurChip == 0xFF)
+			{
+				p->VGMPos += 0x05;
 				break;
-			case 0x5D:	// YMZ280B write
-				if (CHIP_CHECK(YMZ280B))
-				{
-					chip_reg_write(p, 0x0F, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			}
+			if (! p->DacCtrl[CurChip].Enable)
+			{
+				device_start_daccontrol(&p->daccontrol[CurChip], p, p->SampleRate);
+				device_reset_daccontrol(p->daccontrol[CurChip]);
+				p->DacCtrl[CurChip].Enable = true;
+				p->DacCtrlUsg[p->DacCtrlUsed] = CurChip;
+				p->DacCtrlUsed ++;
+			}
+			TempByt = VGMPnt[0x02];	// Chip Type
+			TempSht = ReadBE16(&VGMPnt[0x03]);
+			daccontrol_setup_chip(p->daccontrol[CurChip], TempByt & 0x7F, (TempByt & 0x80) >> 7, TempSht);
+			p->VGMPos += 0x05;
+			break;
+		case 0x91:	// DAC Ctrl: Set Data
+			CurChip = VGMPnt[0x01];
+			if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable)
+			{
+				p->VGMPos += 0x05;
 				break;
-			case 0xD0:	// YMF278B write
-				if (CHIP_CHECK(YMF278B))
-				{
-					CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-					chip_reg_write(p, 0x0D, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02], VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
+			}
+			p->DacCtrl[CurChip].Bank = VGMPnt[0x02];
+			if (p->DacCtrl[CurChip].Bank >= PCM_BANK_COUNT)
+				p->DacCtrl[CurChip].Bank = 0x00;
+
+			TempPCM = &p->PCMBank[p->DacCtrl[CurChip].Bank];
+			p->Last95Max = TempPCM->BankCount;
+			daccontrol_set_data(p->daccontrol[CurChip], TempPCM->Data, TempPCM->DataSize,
+								VGMPnt[0x03], VGMPnt[0x04]);
+			p->VGMPos += 0x05;
+			break;
+		case 0x92:	// DAC Ctrl: Set Freq
+			CurChip = VGMPnt[0x01];
+			if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable)
+			{
+				p->VGMPos += 0x06;
 				break;
-			case 0xD1:	// YMF271 write
-				if (CHIP_CHECK(YMF271))
-				{
-					CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-					chip_reg_write(p, 0x0E, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02], VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
+			}
+			TempLng = ReadLE32(&VGMPnt[0x02]);
+			p->Last95Freq = TempLng;
+			daccontrol_set_frequency(p->daccontrol[CurChip], TempLng);
+			p->VGMPos += 0x06;
+			break;
+		case 0x93:	// DAC Ctrl: Play from Start Pos
+			CurChip = VGMPnt[0x01];
+			if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable ||
+				! p->PCMBank[p->DacCtrl[CurChip].Bank].BankCount)
+			{
+				p->VGMPos += 0x0B;
 				break;
-			case 0xB1:	// RF5C164 register write
-				if (CHIP_CHECK(RF5C164))
-				{
-					chip_reg_write(p, 0x10, CurChip, 0x00, VGMPnt[0x01], VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			}
+			DataStart = ReadLE32(&VGMPnt[0x02]);
+			p->Last95Drum = 0xFFFF;
+			TempByt = VGMPnt[0x06];
+			DataLen = ReadLE32(&VGMPnt[0x07]);
+			daccontrol_start(p->daccontrol[CurChip], DataStart, TempByt, DataLen);
+			p->VGMPos += 0x0B;
+			break;
+		case 0x94:	// DAC Ctrl: Stop immediately
+			CurChip = VGMPnt[0x01];
+			if (! p->DacCtrl[CurChip].Enable)
+			{
+				p->VGMPos += 0x02;
 				break;
-			case 0xC2:	// RF5C164 memory write
-				if (CHIP_CHECK(RF5C164))
-				{
-					TempSht = ReadLE16(&VGMPnt[0x01]);
-					rf5c164_mem_w(p->rf5c164, TempSht, VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
+			}
+			p->Last95Drum = 0xFFFF;
+			if (CurChip < 0xFF)
+			{
+				daccontrol_stop(p->daccontrol[CurChip]);
+			}
+			else
+			{
+				for (CurChip = 0x00; CurChip < 0xFF; CurChip ++)
+					daccontrol_stop(p->daccontrol[CurChip]);
+			}
+			p->VGMPos += 0x02;
+			break;
+		case 0x95:	// DAC Ctrl: Play Block (small)
+			CurChip = VGMPnt[0x01];
+			if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable ||
+				! p->PCMBank[p->DacCtrl[CurChip].Bank].BankCount)
+			{
+				p->VGMPos += 0x05;
 				break;
-			case 0xB2:	// PWM channel write
-				if (CHIP_CHECK(PWM))
-				{
-					chip_reg_write(p, 0x11, CurChip, (VGMPnt[0x01] & 0xF0) >> 4,
-									VGMPnt[0x01] & 0x0F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			}
+			TempPCM = &p->PCMBank[p->DacCtrl[CurChip].Bank];
+			TempSht = ReadLE16(&VGMPnt[0x02]);
+			p->Last95Drum = TempSht;
+			p->Last95Max = TempPCM->BankCount;
+			if (TempSht >= TempPCM->BankCount)
+				TempSht = 0x00;
+			TempBnk = &TempPCM->Bank[TempSht];
+
+			TempByt = DCTRL_LMODE_BYTES |
+						(VGMPnt[0x04] & 0x10) |			// Reverse Mode
+						((VGMPnt[0x04] & 0x01) << 7);	// Looping
+			daccontrol_start(p->daccontrol[CurChip], TempBnk->DataStart, TempByt, TempBnk->DataSize);
+			p->VGMPos += 0x05;
+			break;
+		default:
+			CmdLen = DecodeVGMWrite(p, VGMPnt, &Evt);
+			if (CmdLen)
+			{
+				ExecuteVGMEvent(p, &Evt);
+				p->VGMPos += CmdLen;
 				break;
-			case 0x68:	// PCM RAM write
-				CurChip = (VGMPnt[0x02] & 0x80) >> 7;
-				TempByt =  VGMPnt[0x02] & 0x7F;
-
-				DataStart = ReadLE24(&VGMPnt[0x03]);
-				TempLng = ReadLE24(&VGMPnt[0x06]);
-				DataLen = ReadLE24(&VGMPnt[0x09]);
-				if (! DataLen)
-					DataLen += 0x01000000;
-				ROMData = GetPointerFromPCMBank(p, TempByt, DataStart);
-				if (ROMData == NULL)
-				{
-					p->VGMPos += 0x0C;
-					break;
-				}
+			}
 
-				switch(TempByt)
-				{
-				case 0x01:
-					if (! CHIP_CHECK(RF5C68))
-						break;
-					rf5c68_write_ram(p->rf5c68, TempLng, DataLen, ROMData);
-					break;
-				case 0x02:
-					if (! CHIP_CHECK(RF5C164))
-						break;
-					rf5c164_write_ram(p->rf5c164, TempLng, DataLen, ROMData);
-					break;
-				case 0x06:
-					if (! CHIP_CHECK(SCSP))
-						break;
-					scsp_write_ram(p->scsp[CurChip], TempLng, DataLen, ROMData);
-					break;
-				case 0x07:
-					if (! CHIP_CHECK(NES))
-						break;
-					p->Last95Drum = DataStart / DataLen - 1;
-					p->Last95Max = p->PCMBank[TempByt].DataSize / DataLen;
-					nes_write_ram(p->nesapu[CurChip], TempLng, DataLen, ROMData);
-					break;
-				}
-				p->VGMPos += 0x0C;
+			switch(Command & 0xF0)
+			{
+			case 0x00:
+			case 0x10:
+			case 0x20:
+				p->VGMPos += 0x01;
 				break;
-			case 0xA0:	// AY8910 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(AY8910))
-				{
-					chip_reg_write(p, 0x12, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			case 0x30:
+				p->VGMPos += 0x02;
 				break;
-			case 0xB3:	// GameBoy DMG write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(GameBoy))
-				{
-					chip_reg_write(p, 0x13, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
+			case 0x40:
+			case 0x50:
+			case 0xA0:
+			case 0xB0:
 				p->VGMPos += 0x03;
 				break;
-			case 0xB4:	// NES APU write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(NES))
-				{
-					chip_reg_write(p, 0x14, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			case 0xC0:
+			case 0xD0:
+				p->VGMPos += 0x04;
 				break;
-			case 0xB5:	// MultiPCM write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(MultiPCM))
-				{
-					chip_reg_write(p, 0x15, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
+			case 0xE0:
+			case 0xF0:
+				p->VGMPos += 0x05;
+				break;
+			default:
+				p->VGMEnd = true;
+				p->EndPlay = true;
+				break;
+			}
+			break;
+		}
+	}
+
+	if (p->VGMPos >= p->VGMHead.lngEOFOffset)
+		p->VGMEnd = true;
+
+	return;
+}
+
+static void InterpretVGM(VGM_PLAYER* p, UINT32 SampleCount)
+{
+	INT32 SmplPlayed;
+	UINT32 CurLoop;
+
+	if (p->VGMEnd)
+		return;
+	if (p->EventList != NULL)
+	{
+		InterpretVGMEvents(p, SampleCount);
+		return;
+	}
+
+	SmplPlayed = SamplePbk2VGM_I(p, p->VGMSmplPlayed + SampleCount);
+	while(p->VGMSmplPos <= SmplPlayed)
+	{
+		// (commands other than data blocks are 0x10 bytes at most)
+		if (p->VGMStream != NULL && ! FillVGMStream(p, p->VGMPos, 0x10))
+		{
+			p->VGMEnd = true;
+			break;
+		}
+		CurLoop = p->VGMCurLoop;
+		InterpretVGMCommand(p);
+		if (p->VGMEnd)
+			break;
+		if (p->VGMCurLoop != CurLoop)
+			SmplPlayed = SamplePbk2VGM_I(p, p->VGMSmplPlayed + SampleCount);
+	}
+
+	return;
+}
+
+static UINT32 GetVGMCommandLen(const UINT8* VGMPnt)
+{
+	// returns the length of a command that isn't a chip write, 0 for invalid commands
+	switch(VGMPnt[0x00])
+	{
+	case 0x61:	// xx Sample Delay
+		return 0x03;
+	case 0x62:	// 1/60s delay
+	case 0x63:	// 1/50s delay
+	case 0x66:	// End Of File
+		return 0x01;
+	case 0x67:	// PCM Data Stream
+		return 0x07 + (ReadLE32(&VGMPnt[0x03]) & 0x7FFFFFFF);
+	case 0x68:	// PCM RAM write
+		return 0x0C;
+	case 0x90:	// DAC Ctrl: Setup Chip
+	case 0x91:	// DAC Ctrl: Set Data
+	case 0x95:	// DAC Ctrl: Play Block (small)
+		return 0x05;
+	case 0x92:	// DAC Ctrl: Set Freq
+		return 0x06;
+	case 0x93:	// DAC Ctrl: Play from Start Pos
+		return 0x0B;
+	case 0x94:	// DAC Ctrl: Stop immediately
+		return 0x02;
+	}
+
+	switch(VGMPnt[0x00] & 0xF0)
+	{
+	case 0x00:
+	case 0x10:
+	case 0x20:
+	case 0x70:
+	case 0x80:
+		return 0x01;
+	case 0x30:
+		return 0x02;
+	case 0x40:
+	case 0x50:
+	case 0xA0:
+	case 0xB0:
+		return 0x03;
+	case 0xC0:
+	case 0xD0:
+		return 0x04;
+	case 0xE0:
+	case 0xF0:
+		return 0x05;
+	default:
+		return 0x00;
+	}
+}
+
+static void FreeVGMEvents(VGM_PLAYER* p)
+{
+	EVENT_LIST* EList = (EVENT_LIST*)p->EventList;
+
+	if (EList == NULL)
+		return;
+
+	free(EList->Events);
+	free(EList);
+	p->EventList = NULL;
+
+	return;
+}
+
+static const VGM_EVENT* FindVGMEvent(VGM_PLAYER* p, UINT32 Pos)
+{
+	// returns the event at file offset Pos, NULL if there is none
+	EVENT_LIST* EList = (EVENT_LIST*)p->EventList;
+	UINT32 Min;
+	UINT32 Max;
+	UINT32 Mid;
+
+	if (EList->Cur < EList->Count && EList->Events[EList->Cur].Pos == Pos)
+		return &EList->Events[EList->Cur];
+
+	// the events are sorted by their position
+	Min = 0;
+	Max = EList->Count;
+	while(Min < Max)
+	{
+		Mid = Min + (Max - Min) / 2;
+		if (EList->Events[Mid].Pos < Pos)
+			Min = Mid + 1;
+		else
+			Max = Mid;
+	}
+	if (Min >= EList->Count || EList->Events[Min].Pos != Pos)
+		return NULL;
+	EList->Cur = Min;
+
+	return &EList->Events[Min];
+}
+
+static void CompileVGMEvents(VGM_PLAYER* p)
+{
+	EVENT_LIST* EList;
+	VGM_EVENT* NewEvts;
+	VGM_EVENT Evt;
+	UINT32 EvtAlloc;
+	UINT32 CurPos;
+	UINT32 CmdLen;
+	INT32 SmplPos;
+	UINT16 Delay;
+	const UINT8* VGMPnt;
+	bool LastCmd;
+
+	FreeVGMEvents(p);
+	if (! p->PreDecode || p->FileMode || p->VGMStream != NULL || p->VGMDataOfs)
+		return;	// the whole file must be in memory
+
+	EList = (EVENT_LIST*)calloc(1, sizeof(EVENT_LIST));
+	if (EList == NULL)
+		return;
+	EvtAlloc = 0x1000;
+	EList->Events = (VGM_EVENT*)malloc(EvtAlloc * sizeof(VGM_EVENT));
+	if (EList->Events == NULL)
+	{
+		free(EList);
+		return;
+	}
+
+	CurPos = p->VGMHead.lngDataOffset;
+	SmplPos = 0;
+	LastCmd = (CurPos >= p->VGMHead.lngEOFOffset);
+	while(! LastCmd)
+	{
+		VGMPnt = &p->VGMData[CurPos];
+		Evt.Type = VGMEVT_NONE;
+		Delay = 0;
+		switch(VGMPnt[0x00] & 0xF0)
+		{
+		case 0x70:
+			Delay = (VGMPnt[0x00] & 0x0F) + 0x01;
+			CmdLen = 0x01;
+			break;
+		case 0x80:
+			Delay = VGMPnt[0x00] & 0x0F;
+			CmdLen = 0x01;
+			Evt.Type = VGMEVT_DAC;
+			Evt.Port = p->VGMHead.lngHzYM2612 ? 0x01 : 0x00;
+			break;
+		default:
+			CmdLen = DecodeVGMWrite(p, VGMPnt, &Evt);
+			if (CmdLen)
 				break;
-			case 0xC3:	// MultiPCM memory write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(MultiPCM))
+			CmdLen = GetVGMCommandLen(VGMPnt);
+			if (VGMPnt[0x00] == 0x61)
+				Delay = ReadLE16(&VGMPnt[0x01]);
+			else if (VGMPnt[0x00] == 0x62)
+				Delay = 735;
+			else if (VGMPnt[0x00] == 0x63)
+				Delay = 882;
+			else
+				Evt.Type = VGMEVT_RAW;
+			break;
+		}
+		// The last command sets VGMEnd (or loops), so InterpretVGMCommand has to run it.
+		LastCmd = (! CmdLen || VGMPnt[0x00] == 0x66 || CmdLen >= p->VGMHead.lngEOFOffset - CurPos);
+		if (LastCmd)
+			Evt.Type = VGMEVT_RAW;
+
+		if (Evt.Type != VGMEVT_NONE)
+		{
+			if (EList->Count >= EvtAlloc)
+			{
+				EvtAlloc *= 2;
+				NewEvts = (VGM_EVENT*)realloc(EList->Events, EvtAlloc * sizeof(VGM_EVENT));
+				if (NewEvts == NULL)
 				{
-					TempSht = ReadLE16(&VGMPnt[0x02]);
-					multipcm_bank_write(p->multipcm[CurChip], VGMPnt[0x01] & 0x7F, TempSht);
+					free(EList->Events);
+					free(EList);
+					return;
 				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xB6:	// UPD7759 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(UPD7759))
+				EList->Events = NewEvts;
+			}
+			Evt.Sample = SmplPos;
+			Evt.Pos = CurPos;
+			EList->Events[EList->Count] = Evt;
+			EList->Count ++;
+		}
+		SmplPos += Delay;
+		CurPos += CmdLen;
+	}
+
+	p->EventList = EList;
+	FindVGMEvent(p, p->VGMPos);
+
+	return;
+}
+
+static void InterpretVGMEvents(VGM_PLAYER* p, UINT32 SampleCount)
+{
+	// InterpretVGM for pre-decoded commands
+	// VGMPos and VGMSmplPos are kept at the next event, so that the seek index,
+	// IsNextSampleIdle and RestartPlaying work the same way as with InterpretVGM.
+	EVENT_LIST* EList = (EVENT_LIST*)p->EventList;
+	const VGM_EVENT* Evt;
+	const VGM_EVENT* EvtEnd;
+	INT32 SmplPlayed;
+	INT32 SmplOfs;
+	UINT32 CurLoop;
+
+	EvtEnd = &EList->Events[EList->Count];
+	SmplPlayed = SamplePbk2VGM_I(p, p->VGMSmplPlayed + SampleCount);
+	while(p->VGMSmplPos <= SmplPlayed)
+	{
+		CurLoop = p->VGMCurLoop;
+		Evt = FindVGMEvent(p, p->VGMPos);
+		if (Evt == NULL)
+		{
+			// in between events after looping or loading a seek point
+			InterpretVGMCommand(p);
+		}
+		else
+		{
+			// the event times are from the first run, VGMSmplPos is reduced with every loop
+			SmplOfs = p->VGMSmplPos - Evt->Sample;
+			do
+			{
+				if (Evt->Type == VGMEVT_RAW)
 				{
-					chip_reg_write(p, 0x16, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+					p->VGMPos = Evt->Pos;
+					p->VGMSmplPos = Evt->Sample + SmplOfs;
+					InterpretVGMCommand(p);
+					if (p->VGMEnd || p->VGMCurLoop != CurLoop)
+						break;
 				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xB7:	// OKIM6258 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(OKIM6258))
+				else
 				{
-					chip_reg_write(p, 0x17, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+					ExecuteVGMEvent(p, Evt);
 				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xB8:	// OKIM6295 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(OKIM6295))
+				Evt ++;
+			} while(Evt < EvtEnd && Evt->Sample + SmplOfs <= SmplPlayed);
+
+			if (! p->VGMEnd && p->VGMCurLoop == CurLoop)
+			{
+				if (Evt < EvtEnd)
 				{
-					chip_reg_write(p, 0x18, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
+					p->VGMPos = Evt->Pos;
+					p->VGMSmplPos = Evt->Sample + SmplOfs;
+					EList->Cur = (UINT32)(Evt - EList->Events);
 				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xD2:	// SCC1 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(K051649))
+				else
 				{
-					chip_reg_write(p, 0x19, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
+					p->VGMEnd = true;	// (the last event always ends or loops)
 				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xD3:	// K054539 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(K054539))
-				{
-					chip_reg_write(p, 0x1A, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xB9:	// HuC6280 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(HuC6280))
-				{
-					chip_reg_write(p, 0x1B, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xD4:	// C140 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(C140))
-				{
-					chip_reg_write(p, 0x1C, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xBA:	// K053260 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(K053260))
-				{
-					chip_reg_write(p, 0x1D, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xBB:	// Pokey write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(Pokey))
-				{
-					chip_reg_write(p, 0x1E, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xC4:	// QSound write
-				if (CHIP_CHECK(QSound))
-				{
-					chip_reg_write(p, 0x1F, CurChip, VGMPnt[0x01], VGMPnt[0x02], VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xC5:	// YMF292/SCSP write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(SCSP))
-				{
-					chip_reg_write(p, 0x20, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xBC:	// WonderSwan write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(WSwan))
-				{
-					chip_reg_write(p, 0x21, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xC6:	// WonderSwan memory write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(WSwan))
-				{
-					TempSht = ReadBE16(&VGMPnt[0x01]) & 0x7FFF;
-					ws_write_ram(p->wswan[CurChip], TempSht, VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xC7:	// VSU write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(VSU))
-				{
-					chip_reg_write(p, 0x22, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xBD:	// SAA1099 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(SAA1099))
-				{
-					chip_reg_write(p, 0x23, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xD5:	// ES5503 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(ES5503))
-				{
-					chip_reg_write(p, 0x24, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xBE:	// ES5506 write (8-bit data)
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(ES5506))
-				{
-					chip_reg_write(p, 0x25, CurChip, VGMPnt[0x01] & 0x7F, 0x00, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0xD6:	// ES5506 write (16-bit data)
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(ES5506))
-				{
-					chip_reg_write(p, 0x25, CurChip, 0x80 | (VGMPnt[0x01] & 0x7F),
-									VGMPnt[0x02], VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-			case 0xC8:	// X1-010 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(X1_010))
-				{
-					chip_reg_write(p, 0x26, CurChip, VGMPnt[0x01] & 0x7F, VGMPnt[0x02],
-									VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-#if 0	// for ctr's WIP rips
-			case 0xC9:	// C352 write
-				CurChip = 0x00;
-				if (CHIP_CHECK(C352))
-				{
-					if (VGMPnt[0x01] == 0x03 && VGMPnt[0x02] == 0xFF && VGMPnt[0x03] == 0xFF)
-						c352_w(p->c352[CurChip], 0x202, 0x0020);
-					else
-						chip_reg_write(p, 0x27, CurChip, VGMPnt[0x01], VGMPnt[0x02],
-										VGMPnt[0x03]);
-				}
-				p->VGMPos += 0x04;
-				break;
-#endif
-			case 0xE1:	// C352 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(C352))
-				{
-					TempSht = ((VGMPnt[0x01] & 0x7F) << 8) | (VGMPnt[0x02] << 0);
-					c352_w(p->c352[CurChip], TempSht, (VGMPnt[0x03] << 8) | VGMPnt[0x04]);
-				}
-				p->VGMPos += 0x05;
-				break;
-			case 0xBF:	// GA20 write
-				CurChip = (VGMPnt[0x01] & 0x80) >> 7;
-				if (CHIP_CHECK(GA20))
-				{
-					chip_reg_write(p, 0x28, CurChip, 0x00, VGMPnt[0x01] & 0x7F, VGMPnt[0x02]);
-				}
-				p->VGMPos += 0x03;
-				break;
-			case 0x90:	// DAC Ctrl: Setup Chip
-				CurChip = VGMPnt[0x01];
-				if (CurChip == 0xFF)
-				{
-					p->VGMPos += 0x05;
-					break;
-				}
-				if (! p->DacCtrl[CurChip].Enable)
-				{
-					device_start_daccontrol(&p->daccontrol[CurChip], p, p->SampleRate);
-					device_reset_daccontrol(p->daccontrol[CurChip]);
-					p->DacCtrl[CurChip].Enable = true;
-					p->DacCtrlUsg[p->DacCtrlUsed] = CurChip;
-					p->DacCtrlUsed ++;
-				}
-				TempByt = VGMPnt[0x02];	// Chip Type
-				TempSht = ReadBE16(&VGMPnt[0x03]);
-				daccontrol_setup_chip(p->daccontrol[CurChip], TempByt & 0x7F, (TempByt & 0x80) >> 7, TempSht);
-				p->VGMPos += 0x05;
-				break;
-			case 0x91:	// DAC Ctrl: Set Data
-				CurChip = VGMPnt[0x01];
-				if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable)
-				{
-					p->VGMPos += 0x05;
-					break;
-				}
-				p->DacCtrl[CurChip].Bank = VGMPnt[0x02];
-				if (p->DacCtrl[CurChip].Bank >= PCM_BANK_COUNT)
-					p->DacCtrl[CurChip].Bank = 0x00;
-
-				TempPCM = &p->PCMBank[p->DacCtrl[CurChip].Bank];
-				p->Last95Max = TempPCM->BankCount;
-				daccontrol_set_data(p->daccontrol[CurChip], TempPCM->Data, TempPCM->DataSize,
-									VGMPnt[0x03], VGMPnt[0x04]);
-				p->VGMPos += 0x05;
-				break;
-			case 0x92:	// DAC Ctrl: Set Freq
-				CurChip = VGMPnt[0x01];
-				if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable)
-				{
-					p->VGMPos += 0x06;
-					break;
-				}
-				TempLng = ReadLE32(&VGMPnt[0x02]);
-				p->Last95Freq = TempLng;
-				daccontrol_set_frequency(p->daccontrol[CurChip], TempLng);
-				p->VGMPos += 0x06;
-				break;
-			case 0x93:	// DAC Ctrl: Play from Start Pos
-				CurChip = VGMPnt[0x01];
-				if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable ||
-					! p->PCMBank[p->DacCtrl[CurChip].Bank].BankCount)
-				{
-					p->VGMPos += 0x0B;
-					break;
-				}
-				DataStart = ReadLE32(&VGMPnt[0x02]);
-				p->Last95Drum = 0xFFFF;
-				TempByt = VGMPnt[0x06];
-				DataLen = ReadLE32(&VGMPnt[0x07]);
-				daccontrol_start(p->daccontrol[CurChip], DataStart, TempByt, DataLen);
-				p->VGMPos += 0x0B;
-				break;
-			case 0x94:	// DAC Ctrl: Stop immediately
-				CurChip = VGMPnt[0x01];
-				if (! p->DacCtrl[CurChip].Enable)
-				{
-					p->VGMPos += 0x02;
-					break;
-				}
-				p->Last95Drum = 0xFFFF;
-				if (CurChip < 0xFF)
-				{
-					daccontrol_stop(p->daccontrol[CurChip]);
-				}
-				else
-				{
-					for (CurChip = 0x00; CurChip < 0xFF; CurChip ++)
-						daccontrol_stop(p->daccontrol[CurChip]);
-				}
-				p->VGMPos += 0x02;
-				break;
-			case 0x95:	// DAC Ctrl: Play Block (small)
-				CurChip = VGMPnt[0x01];
-				if (CurChip == 0xFF || ! p->DacCtrl[CurChip].Enable ||
-					! p->PCMBank[p->DacCtrl[CurChip].Bank].BankCount)
-				{
-					p->VGMPos += 0x05;
-					break;
-				}
-				TempPCM = &p->PCMBank[p->DacCtrl[CurChip].Bank];
-				TempSht = ReadLE16(&VGMPnt[0x02]);
-				p->Last95Drum = TempSht;
-				p->Last95Max = TempPCM->BankCount;
-				if (TempSht >= TempPCM->BankCount)
-					TempSht = 0x00;
-				TempBnk = &TempPCM->Bank[TempSht];
-
-				TempByt = DCTRL_LMODE_BYTES |
-							(VGMPnt[0x04] & 0x10) |			// Reverse Mode
-							((VGMPnt[0x04] & 0x01) << 7);	// Looping
-				daccontrol_start(p->daccontrol[CurChip], TempBnk->DataStart, TempByt, TempBnk->DataSize);
-				p->VGMPos += 0x05;
-				break;
-			default:
-
-				switch(Command & 0xF0)
-				{
-				case 0x00:
-				case 0x10:
-				case 0x20:
-					p->VGMPos += 0x01;
-					break;
-				case 0x30:
-					p->VGMPos += 0x02;
-					break;
-				case 0x40:
-				case 0x50:
-				case 0xA0:
-				case 0xB0:
-					p->VGMPos += 0x03;
-					break;
-				case 0xC0:
-				case 0xD0:
-					p->VGMPos += 0x04;
-					break;
-				case 0xE0:
-				case 0xF0:
-					p->VGMPos += 0x05;
-					break;
-				default:
-					p->VGMEnd = true;
-					p->EndPlay = true;
-					break;
-				}
-				break;
 			}
 		}
-
-		if (p->VGMPos >= p->VGMHead.lngEOFOffset)
-			p->VGMEnd = true;
-
 		if (p->VGMEnd)
 			break;
+		if (p->VGMCurLoop != CurLoop)
+			SmplPlayed = SamplePbk2VGM_I(p, p->VGMSmplPlayed + SampleCount);
 	}
 
 	return;
@@ -4865,175 +6199,1612 @@ static void GeneralChipLists(VGM_PLAYER* p)
 				if (CLstOld == NULL)
 					p->ChipListAll = CLst;
 				else
-					CLstOld->next = CLst;
-
-				CLst->CAud = CAA;
-				CLst->COpts = (CHIP_OPTS*)&p->ChipOpts[CurCSet] + CurChip;
-				CLstOld = CLst;
+					CLstOld->next = CLst;
+
+				CLst->CAud = CAA;
+				CLst->COpts = (CHIP_OPTS*)&p->ChipOpts[CurCSet] + CurChip;
+				CLstOld = CLst;
+			}
+		}
+	}
+	if (CLstOld != NULL)
+		CLstOld->next = NULL;
+
+	/*// Go through the chip list and copy all chips to a new list, except for a few
+	// selected ones.
+	CLstOld = NULL;
+	CurLst = ChipListAll;
+	while(CurLst != NULL)
+	{
+		// don't emulate the RF5Cxx chips when paused+emulated
+		if (CurLst->CAud->ChipType != 0x05 && CurLst->CAud->ChipType != 0x10)
+		{
+			CLst = &p->ChipListBuffer[CurBufIdx];
+			CurBufIdx ++;
+			if (CLstOld == NULL)
+				p->ChipListPause = CLst;
+			else
+				CLstOld->next = CLst;
+
+			*CLst = *CurLst;
+			CLstOld = CLst;
+		}
+		CurLst = CurLst->next;
+	}
+	if (CLstOld != NULL)
+		CLstOld->next = NULL;*/
+
+	return;
+}
+
+static void SetupResampler(VGM_PLAYER* p, CAUD_ATTR* CAA)
+{
+	UINT8 CurPair;
+
+	if (! CAA->SmpRate)
+	{
+		CAA->Resampler = 0x00;
+		return;
+	}
+
+    CAA->TargetSmpRate = p->SampleRate;
+
+		CAA->Resampler = resampler_create();
+	for (CurPair = 0x00; CurPair < CAA->OutPairs - 1; CurPair ++)
+		CAA->PairResamplers[CurPair] = resampler_create();
+	CAA->LastSmpRate = 0;	// the new resampler still has to get its rate
+	CAA->BlockUpdate = CanBlockUpdate(p, CAA);
+	CAA->ThreadSafe = CanRenderThreaded(p, CAA->ChipType, CAA->ChipID);
+
+	return;
+}
+
+static double GetResampleGain(VGM_PLAYER* p, UINT32 SmpRate)
+{
+	// level of a chip at SmpRate after resampling, so that band-limited steps
+	// play as loud as the samples would
+	void* Resampler;
+	double Gain;
+
+	if (p->ResampleMode != 0x00 || ! SmpRate)
+		return 1.0;	// the LQ resampler keeps the level
+	Resampler = resampler_create();
+	if (Resampler == NULL)
+		return 1.0;
+	resampler_set_rate(Resampler, (double)SmpRate / (double)p->SampleRate);
+	Gain = resampler_get_gain(Resampler);
+	resampler_destroy(Resampler);
+	// (the sinc filter gets too narrow above 64:1 and doesn't let anything through)
+	return (Gain > 0.0) ? Gain : 1.0;
+}
+
+static bool CanBlockUpdate(VGM_PLAYER* p, const CAUD_ATTR* CAA)
+{
+	// Many cores do a part of their work once per update call (sample streaming,
+	// envelope checks, voice end ramps, ...), so their output depends on how the
+	// updates are split. Only the cores listed here can render a whole block with
+	// a single update and still produce the same output.
+	const CHIP_OPTS* COpt;
+
+	if (CAA->ChipType & 0x80)	// paired chip
+		return false;
+	COpt = (CHIP_OPTS*)&p->ChipOpts[CAA->ChipID] + CAA->ChipType;
+
+	switch(CAA->ChipType)
+	{
+	case 0x00:	// SN76496
+	case 0x01:	// YM2413
+	case 0x02:	// YM2612
+	case 0x12:	// AY8910
+	case 0x14:	// NES APU
+	case 0x1B:	// HuC6280
+		return (COpt->EmuCore == 0x00);	// only the default core
+	case 0x03:	// YM2151
+	case 0x04:	// SegaPCM
+	case 0x13:	// GameBoy
+	case 0x18:	// OKIM6295
+	case 0x19:	// K051649
+	case 0x15:	// MultiPCM
+	case 0x1E:	// Pokey
+	case 0x27:	// C352
+		return true;
+	}
+
+	return false;
+}
+
+static bool CanRenderThreaded(VGM_PLAYER* p, UINT8 ChipType, UINT8 ChipID)
+{
+	// These cores keep parts of their state (or scratch buffers) in global variables
+	// or take their noise from rand(), so they always render on the calling thread,
+	// one after another. (Paired chips share the core options with the main chip.)
+	const CHIP_OPTS* COpt;
+
+	COpt = (CHIP_OPTS*)&p->ChipOpts[ChipID] + (ChipType & 0x7F);
+
+	switch(ChipType & 0x7F)
+	{
+	case 0x02:	// YM2612
+		return (COpt->EmuCore != 0x01);	// Gens
+	case 0x06:	// YM2203
+	case 0x07:	// YM2608
+	case 0x08:	// YM2610
+	case 0x12:	// AY8910
+		return (COpt->EmuCore != 0x01);	// MAME AY8910
+	case 0x09:	// YM3812
+	case 0x0C:	// YMF262
+		return (COpt->EmuCore == 0x01);	// only MAME, AdLibEmu isn't safe
+	case 0x1B:	// HuC6280
+		return (COpt->EmuCore != 0x01);	// MAME
+	}
+
+	return true;
+}
+
+static UINT8 GetSpeakerPairs(VGM_PLAYER* p)
+{
+	// speaker pairs of the OutChannels setting (2 - stereo, 4 - quad, 6 - 5.1)
+	if (p->OutChannels < 0x04)
+		return 0x01;
+	else if (p->OutChannels < 0x06)
+		return 0x02;
+	else
+		return OUT_PAIRS_MAX;
+}
+
+static void ChangeChipSampleRate(void* DataPtr, UINT32 NewSmplRate)
+{
+	CAUD_ATTR* CAA = (CAUD_ATTR*)DataPtr;
+
+	if (CAA->SmpRate == NewSmplRate)
+		return;
+
+	CAA->SmpRate = NewSmplRate;
+
+	return;
+}
+
+
+INLINE INT16 Limit2Short(INT32 Value)
+{
+	INT32 NewValue;
+
+	NewValue = Value;
+	if (NewValue < -0x8000)
+		NewValue = -0x8000;
+	else if (NewValue > 0x7FFF)
+		NewValue = 0x7FFF;
+
+	return (INT16)NewValue;
+}
+
+INLINE INT32 LimitScaleAdd(INT32 Target, INT32 Value, UINT16 Scale)
+{
+	INT64 NewValue;
+
+	NewValue = (INT64)Value;
+	NewValue *= (INT64)Scale;
+	NewValue += (INT64)Target;
+
+	if (NewValue < -0x80000000LL)
+		NewValue = -0x80000000LL;
+	else if (NewValue > 0x7FFFFFFFLL)
+		NewValue = 0x7FFFFFFFLL;
+
+	return (INT32)NewValue;
+}
+
+static void null_update(void *param, stream_sample_t **outputs, int samples)
+{
+	memset(outputs[0x00], 0x00, sizeof(stream_sample_t) * samples);
+	memset(outputs[0x01], 0x00, sizeof(stream_sample_t) * samples);
+
+	return;
+}
+
+static void dual_opl2_stereo(void *param, stream_sample_t **outputs, int samples)
+{
+    struct dual_opl2_info * info = (struct dual_opl2_info *) param;
+
+	ym3812_stream_update(info->chip, outputs, samples);
+
+	// Dual-OPL with Stereo
+	if (info->ChipID & 0x01)
+		memset(outputs[0x00], 0x00, sizeof(stream_sample_t) * samples);	// Mute Left Chanel
+	else
+		memset(outputs[0x01], 0x00, sizeof(stream_sample_t) * samples);	// Mute Right Chanel
+
+	return;
+}
+
+// Stem Rendering
+// With StemRender on, every channel of the chips that can output single channels
+// (and every other chip as a whole) is mixed into a stem of its own as well.
+// The voice buffers run through resamplers of their own, so a stem sounds exactly
+// like the channel in the mix.
+#define STEM_MAX_VOICES	0x10
+
+struct chip_stems
+{
+	UINT32 FirstStem;
+	UINT8 VoiceCnt;		// 0 - the whole chip is one stem
+	INT32* VoiceBufs[STEM_MAX_VOICES * 2];	// chip output (chip sample rate)
+	INT32* VoicePtrs[STEM_MAX_VOICES * 2];	// where the chip writes to
+	void* Resamplers[STEM_MAX_VOICES];
+	INT32* VoiceOut[STEM_MAX_VOICES];		// resampled output (interleaved stereo)
+};
+
+typedef struct stem_entry
+{
+	CAUD_ATTR* CAA;
+	UINT8 Voice;	// 0xFF - whole chip
+} STEM_ENTRY;
+
+typedef struct stem_list
+{
+	UINT32 Count;
+	STEM_ENTRY* Stems;
+	WAVE_32BS* MixBufs;	// Count * SMPL_BUFSIZE
+} STEM_LIST;
+
+static UINT8 SetVoiceOutput(VGM_PLAYER* p, CAUD_ATTR* CAA, INT32** VoiceOut)
+{
+	UINT8 CurCSet;
+
+	CurCSet = CAA->ChipID;
+	switch(CAA->ChipType)
+	{
+	case 0x00:
+		return sn764xx_set_voice_output(p->sn764xx[CurCSet], VoiceOut);
+	case 0x02:
+		return ym2612_set_voice_output(p->ym2612[CurCSet], VoiceOut);
+	}
+
+	return 0x00;	// includes the paired chips (ChipType | 0x80)
+}
+
+static void StartStems(VGM_PLAYER* p)
+{
+	STEM_LIST* SList;
+	CA_LIST* CurCLst;
+	CAUD_ATTR* CAA;
+	CHIP_STEMS* Stems;
+	UINT32 CurStem;
+	UINT8 CurVoice;
+
+	p->StemList = NULL;
+	if (! p->StemRender)
+		return;
+
+	SList = (STEM_LIST*)calloc(1, sizeof(STEM_LIST));
+	for (CurCLst = p->ChipListAll; CurCLst != NULL; CurCLst = CurCLst->next)
+	{
+		for (CAA = CurCLst->CAud; CAA != NULL; CAA = CAA->Paired)
+		{
+			if (! CAA->Resampler)
+				continue;
+
+			Stems = (CHIP_STEMS*)calloc(1, sizeof(CHIP_STEMS));
+			Stems->FirstStem = SList->Count;
+			Stems->VoiceCnt = SetVoiceOutput(p, CAA, Stems->VoicePtrs);
+			if (Stems->VoiceCnt > STEM_MAX_VOICES)
+				Stems->VoiceCnt = STEM_MAX_VOICES;
+			for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt; CurVoice ++)
+			{
+				Stems->VoiceBufs[CurVoice * 2 + 0] = (INT32*)malloc(SMPL_BUFSIZE * sizeof(INT32));
+				Stems->VoiceBufs[CurVoice * 2 + 1] = (INT32*)malloc(SMPL_BUFSIZE * sizeof(INT32));
+				Stems->VoiceOut[CurVoice] = (INT32*)malloc(SMPL_BUFSIZE * 0x02 * sizeof(INT32));
+				Stems->Resamplers[CurVoice] = resampler_create();
+				if (CAA->LastSmpRate)
+					resampler_set_rate(Stems->Resamplers[CurVoice],
+										(double)CAA->SmpRate / (double)CAA->TargetSmpRate);
+			}
+			CAA->Stems = Stems;
+			SList->Count += Stems->VoiceCnt ? Stems->VoiceCnt : 1;
+		}
+	}
+
+	SList->Stems = (STEM_ENTRY*)malloc(SList->Count * sizeof(STEM_ENTRY));
+	SList->MixBufs = (WAVE_32BS*)malloc(SList->Count * SMPL_BUFSIZE * sizeof(WAVE_32BS));
+	CurStem = 0;
+	for (CurCLst = p->ChipListAll; CurCLst != NULL; CurCLst = CurCLst->next)
+	{
+		for (CAA = CurCLst->CAud; CAA != NULL; CAA = CAA->Paired)
+		{
+			if (CAA->Stems == NULL)
+				continue;
+
+			if (! CAA->Stems->VoiceCnt)
+			{
+				SList->Stems[CurStem].CAA = CAA;
+				SList->Stems[CurStem].Voice = 0xFF;
+				CurStem ++;
+			}
+			for (CurVoice = 0x00; CurVoice < CAA->Stems->VoiceCnt; CurVoice ++)
+			{
+				SList->Stems[CurStem].CAA = CAA;
+				SList->Stems[CurStem].Voice = CurVoice;
+				CurStem ++;
+			}
+		}
+	}
+	p->StemList = SList;
+
+	return;
+}
+
+static void StopStems(VGM_PLAYER* p)
+{
+	STEM_LIST* SList = (STEM_LIST*)p->StemList;
+	CA_LIST* CurCLst;
+	CAUD_ATTR* CAA;
+	CHIP_STEMS* Stems;
+	UINT8 CurVoice;
+
+	if (SList == NULL)
+		return;
+
+	for (CurCLst = p->ChipListAll; CurCLst != NULL; CurCLst = CurCLst->next)
+	{
+		for (CAA = CurCLst->CAud; CAA != NULL; CAA = CAA->Paired)
+		{
+			Stems = CAA->Stems;
+			if (Stems == NULL)
+				continue;
+
+			if (Stems->VoiceCnt)
+				SetVoiceOutput(p, CAA, NULL);
+			for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt; CurVoice ++)
+			{
+				free(Stems->VoiceBufs[CurVoice * 2 + 0]);
+				free(Stems->VoiceBufs[CurVoice * 2 + 1]);
+				free(Stems->VoiceOut[CurVoice]);
+				resampler_destroy(Stems->Resamplers[CurVoice]);
+			}
+			free(Stems);
+			CAA->Stems = NULL;
+		}
+	}
+
+	free(SList->Stems);
+	free(SList->MixBufs);
+	free(SList);
+	p->StemList = NULL;
+
+	return;
+}
+
+static void MixChipStems(VGM_PLAYER* p, const CAUD_ATTR* CAA, const INT32* ChipBuf, UINT32 Length)
+{
+	STEM_LIST* SList = (STEM_LIST*)p->StemList;
+	const CHIP_STEMS* Stems = CAA->Stems;
+	WAVE_32BS* MixBuf;
+	const INT32* VoiceBuf;
+	UINT32 CurSmpl;
+	UINT8 CurVoice;
+	UINT8 CurPair;
+
+	CurVoice = 0x00;
+	do
+	{
+		MixBuf = &SList->MixBufs[(Stems->FirstStem + CurVoice) * SMPL_BUFSIZE];
+		VoiceBuf = Stems->VoiceCnt ? Stems->VoiceOut[CurVoice] : ChipBuf;
+		for (CurSmpl = 0; CurSmpl < Length; CurSmpl ++)
+		{
+			MixBuf[CurSmpl].Left = LimitScaleAdd(0, VoiceBuf[CurSmpl * 2 + 0], CAA->Volume);
+			MixBuf[CurSmpl].Right = LimitScaleAdd(0, VoiceBuf[CurSmpl * 2 + 1], CAA->Volume);
+		}
+		CurVoice ++;
+	} while(CurVoice < Stems->VoiceCnt);
+
+	// the stems are stereo, so the other output pairs of the chip are folded in
+	for (CurPair = 0x01; ! Stems->VoiceCnt && CurPair < CAA->OutPairs; CurPair ++)
+	{
+		VoiceBuf = &ChipBuf[CurPair * SMPL_BUFSIZE * 2];
+		for (CurSmpl = 0; CurSmpl < Length; CurSmpl ++)
+		{
+			MixBuf[CurSmpl].Left = LimitScaleAdd(MixBuf[CurSmpl].Left,
+												VoiceBuf[CurSmpl * 2 + 0], CAA->Volume);
+			MixBuf[CurSmpl].Right = LimitScaleAdd(MixBuf[CurSmpl].Right,
+												VoiceBuf[CurSmpl * 2 + 1], CAA->Volume);
+		}
+	}
+
+	return;
+}
+
+UINT32 GetStemCount(void* vgmp)
+{
+	VGM_PLAYER* p = (VGM_PLAYER *)vgmp;
+
+	if (p->StemList == NULL)
+		return 0;
+	return ((STEM_LIST*)p->StemList)->Count;
+}
+
+bool GetStemInfo(void* vgmp, UINT32 Stem, UINT8* ChipType, UINT8* ChipID, UINT8* Channel)
+{
+	VGM_PLAYER* p = (VGM_PLAYER *)vgmp;
+	STEM_LIST* SList = (STEM_LIST*)p->StemList;
+	const STEM_ENTRY* SEntry;
+
+	if (SList == NULL || Stem >= SList->Count)
+		return false;
+
+	SEntry = &SList->Stems[Stem];
+	if (ChipType != NULL)
+		*ChipType = SEntry->CAA->ChipType;
+	if (ChipID != NULL)
+		*ChipID = SEntry->CAA->ChipID;
+	if (Channel != NULL)
+		*Channel = SEntry->Voice;
+	return true;
+}
+
+#ifdef ENABLE_CHIP_STATS
+#define CHIP_STAT_ADD(Stat, Value)	(Stat) += (Value)
+#else
+#define CHIP_STAT_ADD(Stat, Value)
+#endif
+
+static UINT64 GetProfileTime(void)
+{
+	// monotonic time in nanoseconds
+#ifdef WIN32
+	LARGE_INTEGER Freq;
+	LARGE_INTEGER Count;
+
+	QueryPerformanceFrequency(&Freq);
+	QueryPerformanceCounter(&Count);
+	return (UINT64)((double)Count.QuadPart * 1000000000.0 / Freq.QuadPart);
+#else
+	struct timespec TS;
+
+	clock_gettime(CLOCK_MONOTONIC, &TS);
+	return (UINT64)TS.tv_sec * 1000000000 + TS.tv_nsec;
+#endif
+}
+
+void GetRenderProfile(void* vgmp, RENDER_PROFILE* RetProfile)
+{
+	VGM_PLAYER* p = (VGM_PLAYER *)vgmp;
+	const CAUD_ATTR* CAA;
+	UINT8 CurCSet;
+	UINT8 CurChip;
+
+	*RetProfile = p->Profile;
+	RetProfile->ChipUpdate = 0;
+	RetProfile->Resample = 0;
+	for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+	{
+		CAA = (const CAUD_ATTR*)&p->ChipAudio[CurCSet];
+		for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++, CAA ++)
+		{
+			RetProfile->ChipUpdate += CAA->ProfUpdate;
+			RetProfile->Resample += CAA->ProfResample;
+		}
+		CAA = p->CA_Paired[CurCSet];
+		for (CurChip = 0x00; CurChip < 0x03; CurChip ++, CAA ++)
+		{
+			RetProfile->ChipUpdate += CAA->ProfUpdate;
+			RetProfile->Resample += CAA->ProfResample;
+		}
+	}
+
+	return;
+}
+
+UINT32 GetChipStats(void* vgmp, CHIP_STATS* RetStats, UINT32 MaxChips)
+{
+	// returns the number of chips (0 if the counters aren't compiled in)
+#ifdef ENABLE_CHIP_STATS
+	VGM_PLAYER* p = (VGM_PLAYER *)vgmp;
+	const CA_LIST* CurCLst;
+	const CAUD_ATTR* CAA;
+	CHIP_STATS* Stats;
+	UINT32 ChipCnt;
+
+	ChipCnt = 0;
+	for (CurCLst = p->ChipListAll; CurCLst != NULL; CurCLst = CurCLst->next)
+	{
+		for (CAA = CurCLst->CAud; CAA != NULL; CAA = CAA->Paired)
+		{
+			if (ChipCnt < MaxChips)
+			{
+				Stats = &RetStats[ChipCnt];
+				Stats->ChipType = CAA->ChipType;
+				Stats->ChipID = CAA->ChipID;
+				Stats->Writes = CAA->StatWrites;
+				Stats->Samples = CAA->StatSamples;
+				Stats->Frames = CAA->StatFrames;
+				Stats->UpdateTime = CAA->ProfUpdate;
+				Stats->ResampleTime = CAA->ProfResample;
+			}
+			ChipCnt ++;
+		}
+	}
+
+	return (ChipCnt < MaxChips) ? ChipCnt : MaxChips;
+#else
+	return 0;
+#endif
+}
+
+bool LoadCoreProfile(void* vgmp, const char* FileName)
+{
+	// loads the render cost of the cores, as written by vgmbench --profile
+	VGM_PLAYER* p = (VGM_PLAYER *)vgmp;
+	FILE* hFile;
+	char Line[0x80];
+	char* CoreStr;
+	char* LoadStr;
+	CORE_COST* Cost;
+	UINT8 CurChip;
+
+	hFile = fopen(FileName, "rt");
+	if (hFile == NULL)
+		return false;
+
+	free(p->CoreProfile);	p->CoreProfile = NULL;
+	p->CoreProfCount = 0;
+	while(fgets(Line, sizeof(Line), hFile) != NULL)
+	{
+		// Format: chip name<TAB>core<TAB>load
+		if (Line[0x00] == '#')
+			continue;
+		CoreStr = strchr(Line, '\t');
+		if (CoreStr == NULL)
+			continue;
+		*CoreStr = '\0';
+		CoreStr ++;
+		LoadStr = strchr(CoreStr, '\t');
+		if (LoadStr == NULL)
+			continue;
+		LoadStr ++;
+
+		for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++)
+		{
+			if (! strcmp(Line, GetChipName(CurChip)))
+				break;
+		}
+		if (CurChip >= CHIP_COUNT)
+			continue;
+
+		Cost = (CORE_COST*)realloc(p->CoreProfile, (p->CoreProfCount + 1) * sizeof(CORE_COST));
+		if (Cost == NULL)
+			break;
+		p->CoreProfile = Cost;
+		Cost = &p->CoreProfile[p->CoreProfCount];
+		Cost->ChipType = CurChip;
+		Cost->EmuCore = (UINT8)strtoul(CoreStr, NULL, 0);
+		Cost->Load = (float)strtod(LoadStr, NULL);
+		p->CoreProfCount ++;
+	}
+	fclose(hFile);
+
+	return true;
+}
+
+static float GetCoreLoad(const VGM_PLAYER* p, UINT8 ChipType, UINT8 EmuCore)
+{
+	// returns -1 if the core isn't in the profile
+	UINT32 CurCost;
+
+	for (CurCost = 0; CurCost < p->CoreProfCount; CurCost ++)
+	{
+		if (p->CoreProfile[CurCost].ChipType == ChipType &&
+			p->CoreProfile[CurCost].EmuCore == EmuCore)
+			return p->CoreProfile[CurCost].Load;
+	}
+
+	return -1.0f;
+}
+
+// chip type and its cores, the most accurate one first (0xFF - no further cores)
+#define GOV_CHIP_COUNT	0x04
+static const UINT8 GOV_CORES[GOV_CHIP_COUNT][0x04] =
+{	{0x02, 0x02, 0x00, 0x01},	// YM2612: Nuked, MAME, Gens
+	{0x01, 0x02, 0x00, 0x01},	// YM2413: Nuked, EMU2413, MAME
+	{0x09, 0x00, 0x01, 0xFF},	// YM3812: DOSBox, MAME
+	{0x0C, 0x00, 0x01, 0xFF}};	// YMF262: DOSBox, MAME
+
+static void SelectChipCores(VGM_PLAYER* p)
+{
+	// Picks the most accurate cores whose total render cost from the core profile
+	// fits into RenderBudget. While it doesn't fit, the chip with the biggest
+	// saving goes to its next cheaper core.
+	// Chips and cores the profile doesn't have are counted as free.
+	UINT8 Choice[GOV_CHIP_COUNT];	// index into GOV_CORES, 0 - chip not present
+	UINT8 ChipCnt[GOV_CHIP_COUNT];
+	UINT8 CurGov;
+	UINT8 CurChip;
+	UINT8 CurCore;
+	UINT8 BestGov;
+	UINT8 BestCore;
+	UINT32 Clock;
+	float Load;
+	float CurLoad;
+	float Saving;
+	float BestSaving;
+	float TotalLoad;
+	CHIP_OPTS* COpt;
+
+	if (! p->CoreProfCount)
+		return;
+
+	TotalLoad = 0.0f;
+	memset(Choice, 0x00, sizeof(Choice));
+	for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++)
+	{
+		Clock = GetChipClock(p, CurChip, NULL);
+		if (! Clock)
+			continue;
+
+		for (CurGov = 0x00; CurGov < GOV_CHIP_COUNT; CurGov ++)
+		{
+			if (GOV_CORES[CurGov][0x00] == CurChip)
+				break;
+		}
+		if (CurGov < GOV_CHIP_COUNT)
+		{
+			ChipCnt[CurGov] = (Clock & 0x40000000) ? 0x02 : 0x01;
+			for (CurCore = 0x01; CurCore < 0x04 && GOV_CORES[CurGov][CurCore] != 0xFF; CurCore ++)
+			{
+				Load = GetCoreLoad(p, CurChip, GOV_CORES[CurGov][CurCore]);
+				if (Load >= 0.0f)
+				{
+					Choice[CurGov] = CurCore;
+					TotalLoad += Load * ChipCnt[CurGov];
+					break;
+				}
+			}
+			if (Choice[CurGov])
+				continue;
+		}
+
+		// a chip without choice costs what its configured core costs
+		COpt = (CHIP_OPTS*)&p->ChipOpts[0x00] + CurChip;
+		Load = GetCoreLoad(p, CurChip, COpt->EmuCore);
+		if (Load > 0.0f)
+			TotalLoad += Load * ((Clock & 0x40000000) ? 0x02 : 0x01);
+	}
+
+	while(TotalLoad > p->RenderBudget)
+	{
+		BestGov = 0xFF;
+		BestCore = 0x00;
+		BestSaving = 0.0f;
+		for (CurGov = 0x00; CurGov < GOV_CHIP_COUNT; CurGov ++)
+		{
+			if (! Choice[CurGov])
+				continue;
+			CurLoad = GetCoreLoad(p, GOV_CORES[CurGov][0x00], GOV_CORES[CurGov][Choice[CurGov]]);
+			for (CurCore = Choice[CurGov] + 1; CurCore < 0x04 && GOV_CORES[CurGov][CurCore] != 0xFF;
+				CurCore ++)
+			{
+				Load = GetCoreLoad(p, GOV_CORES[CurGov][0x00], GOV_CORES[CurGov][CurCore]);
+				if (Load < 0.0f || Load >= CurLoad)
+					continue;
+				Saving = (CurLoad - Load) * ChipCnt[CurGov];
+				if (Saving > BestSaving)
+				{
+					BestGov = CurGov;
+					BestCore = CurCore;
+					BestSaving = Saving;
+				}
+				break;
+			}
+		}
+		if (BestGov == 0xFF)
+			break;	// everything is as fast as it gets
+		Choice[BestGov] = BestCore;
+		TotalLoad -= BestSaving;
+	}
+
+	for (CurGov = 0x00; CurGov < GOV_CHIP_COUNT; CurGov ++)
+	{
+		if (! Choice[CurGov])
+			continue;
+		CurChip = GOV_CORES[CurGov][0x00];
+		COpt = (CHIP_OPTS*)&p->ChipOpts[0x00] + CurChip;
+		if (p->GovUserCores[CurChip] == 0xFF)
+			p->GovUserCores[CurChip] = COpt->EmuCore;
+		COpt->EmuCore = GOV_CORES[CurGov][Choice[CurGov]];
+	}
+
+	return;
+}
+
+#define GOV_WINDOW		2	// measurements per second
+#define GOV_OVERLOADS	4	// measurements in a row over the budget before the quality goes down
+
+static void UpdateRenderBudget(VGM_PLAYER* p, UINT64 RenderTime, UINT32 Samples)
+{
+	// Compares the render time with the real time of the rendered samples.
+	// When it stays over the budget, ResampleMode is raised by one step. The cores
+	// can't be changed during a song, the resampler is all that's left.
+	// (RenderChipStream hands the buffered samples of the sinc resampler over.)
+	double Load;
+
+	p->GovTime += RenderTime;
+	p->GovSamples += Samples;
+	if (p->GovSamples < p->SampleRate / GOV_WINDOW)
+		return;
+
+	Load = p->GovTime / (p->GovSamples * 1000000000.0 / p->SampleRate);
+	p->GovTime = 0;
+	p->GovSamples = 0;
+	if (Load <= p->RenderBudget)
+	{
+		p->GovOverloads = 0;
+		return;
+	}
+	p->GovOverloads ++;
+	if (p->GovOverloads < GOV_OVERLOADS || p->ResampleMode >= 0x02)
+		return;
+
+	if (p->GovResampleMode == 0xFF)
+		p->GovResampleMode = p->ResampleMode;
+	p->ResampleMode ++;
+	p->GovOverloads = 0;
+
+	return;
+}
+
+#define RSMP_SINC	0x00	// sinc resampler (resampler.c)
+#define RSMP_LQ		0x01	// RenderChipStreamLQ
+#define RSMP_DIRECT	0x02	// no resampling, the chip runs at the output rate
+#define RSMP_RAMP	0x200	// output samples that bring a hand-over from the sinc filter's level to 1.0
+
+struct resample_carry
+{
+	// What the sinc resampler had buffered when the chip changed to another resampling.
+	// Its computed output is played first, then its input from the center of the next
+	// output's filter on is resampled again, before the chip renders anything new.
+	UINT32 OutLen;	// output samples per pair
+	UINT32 OutPos;
+	UINT32 InLen;	// chip samples per channel
+	UINT32 InPos;
+	UINT32 Gain;	// level of the new resampling (16.16 fixed point, ramps up to 1.0)
+	UINT32 GainStep;
+	INT32* OutBufs[OUT_PAIRS_MAX];	// interleaved stereo
+	INT32* InBufs[OUT_PAIRS_MAX * 2];
+};
+
+static UINT8 GetResamplePath(VGM_PLAYER* p, const CAUD_ATTR* CAA)
+{
+	bool VoiceStems;
+
+	// (the voice resamplers of the stems have no hand-over and have to stay in sync)
+	VoiceStems = (CAA->Stems != NULL && CAA->Stems->VoiceCnt);
+	if (VoiceStems && CAA->RsmpPath == RSMP_SINC)
+		return RSMP_SINC;
+
+	if ((p->ResampleMode != 0x00 || CAA->StepSynth) && CAA->SmpRate == CAA->TargetSmpRate)
+	{
+		// The chip already runs at the output rate, so its samples are mixed
+		// directly and the resampler is skipped.
+		// (The sinc filter isn't transparent at 1:1, so HQ mode still uses it,
+		// except for the band-limited steps, which need no more filtering.)
+		return RSMP_DIRECT;
+	}
+	// (stems always use the sinc filter, their resamplers have to stay in sync)
+	if (! VoiceStems && (p->ResampleMode == 0x02 ||
+		(p->ResampleMode == 0x01 && CAA->SmpRate > CAA->TargetSmpRate)))
+		return RSMP_LQ;
+	return RSMP_SINC;
+}
+
+static void HandOverResampler(VGM_PLAYER* p, CAUD_ATTR* CAA, UINT8 NewPath)
+{
+	// The governor lowered the resampling during a song (or a new sample rate moved the
+	// chip away from the sinc filter). Dropping what the sinc resampler buffered would
+	// make the chip jump ahead by its group delay, so it is handed over instead.
+	RSMP_CARRY* Carry;
+	double Gain;
+	int OutPairs;
+	int InPairs;
+	UINT8 CurPair;
+	UINT8 CurChn;
+
+	FreeResampleCarry(CAA);
+	Gain = resampler_get_gain(CAA->Resampler);	// (the hand-over resets the rate)
+	OutPairs = resampler_get_handover(CAA->Resampler, &InPairs);
+
+	Carry = (RSMP_CARRY*)malloc(sizeof(RSMP_CARRY));
+	Carry->OutBufs[0x00] = (INT32*)malloc(((OutPairs + InPairs) * 2 * CAA->OutPairs + 1) *
+											sizeof(INT32));
+	for (CurPair = 0x01; CurPair < CAA->OutPairs; CurPair ++)
+		Carry->OutBufs[CurPair] = Carry->OutBufs[CurPair - 1] + OutPairs * 2;
+	for (CurChn = 0x00; CurChn < CAA->OutPairs * 2; CurChn ++)
+		Carry->InBufs[CurChn] = Carry->OutBufs[0x00] + OutPairs * 2 * CAA->OutPairs +
+								InPairs * CurChn;
+	resampler_handover(CAA->Resampler, Carry->OutBufs[0x00], Carry->InBufs[0x00],
+						Carry->InBufs[0x01]);
+	// the resamplers of the other pairs got the same amount of samples
+	for (CurPair = 0x01; CurPair < CAA->OutPairs; CurPair ++)
+		resampler_handover(CAA->PairResamplers[CurPair - 1], Carry->OutBufs[CurPair],
+							Carry->InBufs[CurPair * 2 + 0], Carry->InBufs[CurPair * 2 + 1]);
+	CAA->LastSmpRate = 0;	// the cleared resamplers need their rate again
+
+	Carry->OutLen = OutPairs;
+	Carry->OutPos = 0;
+	Carry->InLen = InPairs;
+	Carry->InPos = 0;
+	// The sinc filter doesn't play at full level, so the new resampling starts at its
+	// level and ramps up from there.
+	if (Gain <= 0.0 || Gain >= 1.0)
+		Carry->Gain = 0x10000;
+	else
+		Carry->Gain = (UINT32)(Gain * 0x10000 + 0.5);
+	Carry->GainStep = (0x10000 - Carry->Gain + RSMP_RAMP - 1) / RSMP_RAMP;
+
+	// the LQ resampler continues from the first handed over sample instead of 0
+	CAA->LQPos = 0;
+	for (CurChn = 0x00; CurChn < CAA->OutPairs * 2; CurChn ++)
+	{
+		CAA->LQPrev[CurChn] = InPairs ? Carry->InBufs[CurChn][0] : 0;
+		CAA->LQLast[CurChn] = CAA->LQPrev[CurChn];
+	}
+	if (NewPath == RSMP_LQ && CAA->SmpRate < CAA->TargetSmpRate && InPairs)
+		Carry->InPos = 1;	// the interpolation starts at LQLast, which already is that sample
+
+	CAA->Carry = Carry;
+
+	return;
+}
+
+static void FreeResampleCarry(CAUD_ATTR* CAA)
+{
+	if (CAA->Carry == NULL)
+		return;
+
+	free(CAA->Carry->OutBufs[0x00]);
+	free(CAA->Carry);
+	CAA->Carry = NULL;
+
+	return;
+}
+
+static bool IsStreamSilent(CAUD_ATTR* CAA)
+{
+	if (CAA->IsSilent == NULL)
+		return false;
+	if (CAA->Carry != NULL && CAA->Carry->InPos < CAA->Carry->InLen)
+		return false;	// the handed over samples still have to be played
+	return CAA->IsSilent(CAA->StreamUpdateParam);
+}
+
+static void UpdateChipStream(CAUD_ATTR* CAA, INT32** StreamBufs, UINT32 Samples)
+{
+	// updates the chip, the samples the sinc resampler handed over come first
+	RSMP_CARRY* Carry;
+	INT32* ChnBufs[OUT_PAIRS_MAX * 2];
+	UINT32 CarryCnt;
+	UINT8 CurChn;
+
+	Carry = CAA->Carry;
+	if (Carry == NULL || Carry->InPos >= Carry->InLen)
+	{
+		CAA->StreamUpdate(CAA->StreamUpdateParam, StreamBufs, Samples);
+		return;
+	}
+
+	CarryCnt = Carry->InLen - Carry->InPos;
+	if (CarryCnt > Samples)
+		CarryCnt = Samples;
+	for (CurChn = 0x00; CurChn < CAA->OutPairs * 2; CurChn ++)
+	{
+		memcpy(StreamBufs[CurChn], &Carry->InBufs[CurChn][Carry->InPos], CarryCnt * sizeof(INT32));
+		ChnBufs[CurChn] = StreamBufs[CurChn] + CarryCnt;
+	}
+	Carry->InPos += CarryCnt;
+	if (CarryCnt < Samples)
+		CAA->StreamUpdate(CAA->StreamUpdateParam, ChnBufs, Samples - CarryCnt);
+
+	return;
+}
+
+static void RenderChipStream(VGM_PLAYER* p, CAUD_ATTR* CAA, INT32** StreamBufs, INT32* OutBuf,
+							UINT32 Length)
+{
+	// renders and resamples the output of a single chip into OutBuf (interleaved stereo,
+	// SMPL_BUFSIZE samples per output pair)
+	RSMP_CARRY* Carry;
+	INT32* PairBuf;
+	UINT32 CarryCnt;
+	UINT32 CurSmpl;
+	UINT8 NewPath;
+	UINT8 CurPair;
+
+	NewPath = GetResamplePath(p, CAA);
+	if (CAA->RsmpPath == RSMP_SINC && NewPath != RSMP_SINC)
+		HandOverResampler(p, CAA, NewPath);
+	CAA->RsmpPath = NewPath;
+
+	Carry = CAA->Carry;
+	if (Carry == NULL)
+	{
+		RenderChipStreamPath(p, CAA, StreamBufs, OutBuf, Length);
+		return;
+	}
+
+	// the output the sinc resampler already computed comes first
+	CarryCnt = Carry->OutLen - Carry->OutPos;
+	if (CarryCnt > Length)
+		CarryCnt = Length;
+	for (CurPair = 0x00; CurPair < CAA->OutPairs; CurPair ++)
+		memcpy(&OutBuf[CurPair * SMPL_BUFSIZE * 2], &Carry->OutBufs[CurPair][Carry->OutPos * 2],
+				CarryCnt * 2 * sizeof(INT32));
+	Carry->OutPos += CarryCnt;
+	if (CarryCnt < Length)
+		RenderChipStreamPath(p, CAA, StreamBufs, &OutBuf[CarryCnt * 2], Length - CarryCnt);
+
+	if (NewPath == RSMP_SINC)
+		Carry->Gain = 0x10000;	// back at the sinc filter's level
+	for (CurSmpl = CarryCnt; CurSmpl < Length && Carry->Gain < 0x10000; CurSmpl ++)
+	{
+		for (CurPair = 0x00; CurPair < CAA->OutPairs; CurPair ++)
+		{
+			PairBuf = &OutBuf[(CurPair * SMPL_BUFSIZE + CurSmpl) * 2];
+			PairBuf[0] = (INT32)(((INT64)PairBuf[0] * Carry->Gain) >> 16);
+			PairBuf[1] = (INT32)(((INT64)PairBuf[1] * Carry->Gain) >> 16);
+		}
+		Carry->Gain += Carry->GainStep;
+	}
+	if (Carry->OutPos >= Carry->OutLen && Carry->InPos >= Carry->InLen && Carry->Gain >= 0x10000)
+		FreeResampleCarry(CAA);
+
+	return;
+}
+
+static void RenderChipStreamPath(VGM_PLAYER* p, CAUD_ATTR* CAA, INT32** StreamBufs, INT32* OutBuf,
+							UINT32 Length)
+{
+	// renders and resamples the output of a single chip into OutBuf (interleaved stereo,
+	// SMPL_BUFSIZE samples per output pair) the way CAA->RsmpPath says
+	INT32* ChnBufs[OUT_PAIRS_MAX * 2];
+	INT32* PairBuf;
+	INT32 SmpCnt;	// must be signed, else I'm getting calculation errors
+	INT32 CurSmpl;
+	INT32 BufPos;
+	INT32 OutCnt;
+	UINT32 OutPos;
+	INT32 CurOut;
+	int FillList[SMPL_BUFSIZE];
+	CHIP_STEMS* Stems;
+	UINT8 CurVoice;
+	UINT8 CurPair;
+	UINT8 CurChn;
+	bool Silent;
+	UINT64 ProfTime;
+	UINT64 CurTime;
+
+	// The time of each chip is kept in its CAUD_ATTR, a chip always renders
+	// on one thread at a time.
+	ProfTime = p->RenderProfile ? GetProfileTime() : 0;
+	Stems = CAA->Stems;
+	if (Stems != NULL && ! Stems->VoiceCnt)
+		Stems = NULL;	// the whole chip is a single stem
+	if (Stems != NULL)
+	{
+		for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt * 2; CurVoice ++)
+			Stems->VoicePtrs[CurVoice] = Stems->VoiceBufs[CurVoice];
+	}
+	// A silent core isn't updated at all. It can only start to play again with
+	// a register write, and there are none within a block.
+	Silent = IsStreamSilent(CAA);
+
+	if (CAA->RsmpPath == RSMP_DIRECT)
+	{
+		if (Silent)
+		{
+			for (CurPair = 0x00; CurPair < CAA->OutPairs; CurPair ++)
+				memset(&OutBuf[CurPair * SMPL_BUFSIZE * 2], 0x00, Length * 2 * sizeof(INT32));
+			for (CurVoice = 0x00; Stems != NULL && CurVoice < Stems->VoiceCnt; CurVoice ++)
+				memset(Stems->VoiceOut[CurVoice], 0x00, Length * 2 * sizeof(INT32));
+			if (p->RenderProfile)
+				CAA->ProfUpdate += GetProfileTime() - ProfTime;
+			return;
+		}
+		for (OutPos = 0; OutPos < Length; OutPos += SmpCnt)
+		{
+			SmpCnt = CAA->BlockUpdate ? (Length - OutPos) : 1;
+			if (SmpCnt > SMPL_BUFSIZE)
+				SmpCnt = SMPL_BUFSIZE;
+			UpdateChipStream(CAA, StreamBufs, SmpCnt);
+			CHIP_STAT_ADD(CAA->StatSamples, SmpCnt);
+
+			for (CurPair = 0x00; CurPair < CAA->OutPairs; CurPair ++)
+			{
+				PairBuf = &OutBuf[CurPair * SMPL_BUFSIZE * 2];
+				for (CurSmpl = 0; CurSmpl < SmpCnt; CurSmpl ++)
+				{
+					PairBuf[(OutPos + CurSmpl) * 2 + 0] = StreamBufs[CurPair * 2 + 0][CurSmpl];
+					PairBuf[(OutPos + CurSmpl) * 2 + 1] = StreamBufs[CurPair * 2 + 1][CurSmpl];
+				}
+			}
+			if (Stems != NULL)
+			{
+				for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt; CurVoice ++)
+				{
+					for (CurSmpl = 0; CurSmpl < SmpCnt; CurSmpl ++)
+					{
+						Stems->VoiceOut[CurVoice][(OutPos + CurSmpl) * 2 + 0] =
+							Stems->VoiceBufs[CurVoice * 2 + 0][CurSmpl];
+						Stems->VoiceOut[CurVoice][(OutPos + CurSmpl) * 2 + 1] =
+							Stems->VoiceBufs[CurVoice * 2 + 1][CurSmpl];
+					}
+				}
+			}
+		}
+		if (p->RenderProfile)
+			CAA->ProfUpdate += GetProfileTime() - ProfTime;
+		return;
+	}
+
+	if (CAA->RsmpPath == RSMP_LQ)
+	{
+		RenderChipStreamLQ(p, CAA, StreamBufs, OutBuf, Length);
+		return;
+	}
+
+	// The sample rate can only change with a register write, so checking it
+	// once per block is enough.
+	if (CAA->LastSmpRate != CAA->SmpRate)
+	{
+		resampler_set_rate(CAA->Resampler, (double)CAA->SmpRate / (double)CAA->TargetSmpRate);
+		CAA->LastSmpRate = CAA->SmpRate;
+		for (CurPair = 0x01; CurPair < CAA->OutPairs; CurPair ++)
+			resampler_set_rate(CAA->PairResamplers[CurPair - 1],
+								(double)CAA->SmpRate / (double)CAA->TargetSmpRate);
+		if (Stems != NULL)
+		{
+			for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt; CurVoice ++)
+				resampler_set_rate(Stems->Resamplers[CurVoice],
+									(double)CAA->SmpRate / (double)CAA->TargetSmpRate);
+		}
+	}
+
+	for (OutPos = 0; OutPos < Length; OutPos += OutCnt)
+	{
+		// Render all chip samples the next output samples need, then run them
+		// through the resampler in one go. The result is the same as feeding it
+		// sample by sample.
+		OutCnt = resampler_get_block_fill(CAA->Resampler, Length - OutPos, SMPL_BUFSIZE,
+											&SmpCnt, CAA->BlockUpdate ? NULL : FillList);
+		if (Silent)
+		{
+			// the resamplers get silence (NULL) instead
+		}
+		else if (CAA->BlockUpdate)
+		{
+			if (SmpCnt)
+				UpdateChipStream(CAA, StreamBufs, SmpCnt);
+			CHIP_STAT_ADD(CAA->StatSamples, SmpCnt);
+		}
+		else
+		{
+			// The core's output depends on how the updates are split, so update it
+			// exactly when a sample-by-sample run would.
+			BufPos = 0;
+			for (CurOut = 0; CurOut < OutCnt; CurOut ++)
+			{
+				if (! FillList[CurOut])
+					continue;
+				for (CurChn = 0x00; CurChn < CAA->OutPairs * 2; CurChn ++)
+					ChnBufs[CurChn] = StreamBufs[CurChn] + BufPos;
+				if (Stems != NULL)
+				{
+					for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt * 2; CurVoice ++)
+						Stems->VoicePtrs[CurVoice] = Stems->VoiceBufs[CurVoice] + BufPos;
+				}
+				UpdateChipStream(CAA, ChnBufs, FillList[CurOut]);
+				BufPos += FillList[CurOut];
+			}
+			CHIP_STAT_ADD(CAA->StatSamples, BufPos);
+		}
+		if (p->RenderProfile)
+		{
+			CurTime = GetProfileTime();
+			CAA->ProfUpdate += CurTime - ProfTime;
+			ProfTime = CurTime;
+		}
+		for (CurChn = 0x00; CurChn < CAA->OutPairs * 2; CurChn ++)
+			ChnBufs[CurChn] = Silent ? NULL : StreamBufs[CurChn];
+		resampler_write_block(CAA->Resampler, ChnBufs[0x00], ChnBufs[0x01], SmpCnt);
+		resampler_read_block(CAA->Resampler, &OutBuf[OutPos * 2], OutCnt);
+		CHIP_STAT_ADD(CAA->StatFrames, OutCnt);
+		// the resamplers of the other pairs get the same amount of samples, so they stay in sync
+		for (CurPair = 0x01; CurPair < CAA->OutPairs; CurPair ++)
+		{
+			resampler_write_block(CAA->PairResamplers[CurPair - 1], ChnBufs[CurPair * 2 + 0],
+									ChnBufs[CurPair * 2 + 1], SmpCnt);
+			resampler_read_block(CAA->PairResamplers[CurPair - 1],
+									&OutBuf[(CurPair * SMPL_BUFSIZE + OutPos) * 2], OutCnt);
+		}
+		if (Stems != NULL)
+		{
+			// the voice resamplers get the same amount of samples, so they stay in sync
+			for (CurVoice = 0x00; CurVoice < Stems->VoiceCnt; CurVoice ++)
+			{
+				resampler_write_block(Stems->Resamplers[CurVoice],
+										Silent ? NULL : Stems->VoiceBufs[CurVoice * 2 + 0],
+										Silent ? NULL : Stems->VoiceBufs[CurVoice * 2 + 1], SmpCnt);
+				resampler_read_block(Stems->Resamplers[CurVoice],
+										&Stems->VoiceOut[CurVoice][OutPos * 2], OutCnt);
+			}
+		}
+		if (p->RenderProfile)
+		{
+			CurTime = GetProfileTime();
+			CAA->ProfResample += CurTime - ProfTime;
+			ProfTime = CurTime;
+		}
+	}
+
+	return;
+}
+
+static void RenderChipStreamLQ(VGM_PLAYER* p, CAUD_ATTR* CAA, INT32** StreamBufs, INT32* OutBuf,
+							UINT32 Length)
+{
+	// the LQ resampler of ResampleMode 1 and 2:
+	// linear interpolation for upsampling, the average of the chip samples for downsampling
+	INT64 SmplSum[OUT_PAIRS_MAX * 2];
+	UINT32 Step;	// chip samples per output sample (16.16 fixed point)
+	UINT32 SmpLeft;	// chip samples that still have to be rendered
+	UINT32 SmpCnt;
+	UINT32 BufPos;
+	UINT32 BufLen;
+	UINT32 CurOut;
+	UINT32 CurSmpl;
+	INT32 OutSmpl;
+	UINT8 ChnCnt;
+	UINT8 CurChn;
+	bool Silent;
+	UINT64 ProfTime;
+	UINT64 CurTime;
+
+	ProfTime = p->RenderProfile ? GetProfileTime() : 0;
+	Silent = IsStreamSilent(CAA);
+	ChnCnt = CAA->OutPairs * 2;
+	Step = (UINT32)(((UINT64)CAA->SmpRate << 16) / CAA->TargetSmpRate);
+	SmpLeft = (UINT32)((CAA->LQPos + (UINT64)Step * Length) >> 16);
+	BufPos = 0;
+	BufLen = 0;
+	for (CurOut = 0; CurOut < Length; CurOut ++)
+	{
+		CAA->LQPos += Step;
+		SmpCnt = CAA->LQPos >> 16;
+		CAA->LQPos &= 0xFFFF;
+		for (CurChn = 0x00; CurChn < ChnCnt; CurChn ++)
+			SmplSum[CurChn] = 0;
+		for (CurSmpl = 0; CurSmpl < SmpCnt; CurSmpl ++)
+		{
+			if (BufPos >= BufLen)
+			{
+				BufLen = (SmpLeft < SMPL_BUFSIZE) ? SmpLeft : SMPL_BUFSIZE;
+				SmpLeft -= BufLen;
+				BufPos = 0;
+				if (Silent)
+				{
+					for (CurChn = 0x00; CurChn < ChnCnt; CurChn ++)
+						memset(StreamBufs[CurChn], 0x00, BufLen * sizeof(INT32));
+				}
+				else
+				{
+					if (p->RenderProfile)
+					{
+						CurTime = GetProfileTime();
+						CAA->ProfResample += CurTime - ProfTime;
+						ProfTime = CurTime;
+					}
+					UpdateChipStream(CAA, StreamBufs, BufLen);
+					CHIP_STAT_ADD(CAA->StatSamples, BufLen);
+					if (p->RenderProfile)
+					{
+						CurTime = GetProfileTime();
+						CAA->ProfUpdate += CurTime - ProfTime;
+						ProfTime = CurTime;
+					}
+				}
 			}
+			for (CurChn = 0x00; CurChn < ChnCnt; CurChn ++)
+			{
+				CAA->LQPrev[CurChn] = CAA->LQLast[CurChn];
+				CAA->LQLast[CurChn] = StreamBufs[CurChn][BufPos];
+				SmplSum[CurChn] += CAA->LQLast[CurChn];
+			}
+			BufPos ++;
 		}
-	}
-	if (CLstOld != NULL)
-		CLstOld->next = NULL;
 
-	/*// Go through the chip list and copy all chips to a new list, except for a few
-	// selected ones.
-	CLstOld = NULL;
-	CurLst = ChipListAll;
-	while(CurLst != NULL)
-	{
-		// don't emulate the RF5Cxx chips when paused+emulated
-		if (CurLst->CAud->ChipType != 0x05 && CurLst->CAud->ChipType != 0x10)
+		for (CurChn = 0x00; CurChn < ChnCnt; CurChn ++)
 		{
-			CLst = &p->ChipListBuffer[CurBufIdx];
-			CurBufIdx ++;
-			if (CLstOld == NULL)
-				p->ChipListPause = CLst;
+			if (Step > 0x10000)
+				OutSmpl = (INT32)(SmplSum[CurChn] / (INT32)SmpCnt);
 			else
-				CLstOld->next = CLst;
-
-			*CLst = *CurLst;
-			CLstOld = CLst;
+				OutSmpl = CAA->LQPrev[CurChn] + (INT32)(((INT64)(CAA->LQLast[CurChn] -
+							CAA->LQPrev[CurChn]) * CAA->LQPos) >> 16);
+			OutBuf[((CurChn >> 1) * SMPL_BUFSIZE + CurOut) * 2 + (CurChn & 0x01)] = OutSmpl;
 		}
-		CurLst = CurLst->next;
 	}
-	if (CLstOld != NULL)
-		CLstOld->next = NULL;*/
+	CHIP_STAT_ADD(CAA->StatFrames, Length);
+	if (p->RenderProfile)
+		CAA->ProfResample += GetProfileTime() - ProfTime;
 
 	return;
 }
 
-static void SetupResampler(VGM_PLAYER* p, CAUD_ATTR* CAA)
+static void MixChipStream(VGM_PLAYER* p, const CAUD_ATTR* CAA, const INT32* ChipBuf,
+							WAVE_32BS* RetSample, UINT32 Length)
 {
-	if (! CAA->SmpRate)
+	// speaker pair of the chip's front, rear and center/LFE output
+	static const UINT8 PAIR_MAP[OUT_PAIRS_MAX][OUT_PAIRS_MAX] =
+	{	{0, 0, 0},	// stereo
+		{0, 1, 0},	// quad: FL FR BL BR
+		{0, 2, 1}};	// 5.1: FL FR FC LFE BL BR
+	const UINT8* PairMap = PAIR_MAP[p->MixPairs - 1];
+	WAVE_32BS* MixBuf;
+	UINT32 CurSmpl;
+	UINT8 CurPair;
+
+	for (CurPair = 0x00; CurPair < CAA->OutPairs; CurPair ++, ChipBuf += SMPL_BUFSIZE * 2)
 	{
-		CAA->Resampler = 0x00;
-		return;
+		MixBuf = &RetSample[PairMap[CurPair] * SMPL_BUFSIZE];
+		for (CurSmpl = 0; CurSmpl < Length; CurSmpl ++)
+		{
+			MixBuf[CurSmpl].Left = LimitScaleAdd(MixBuf[CurSmpl].Left,
+												ChipBuf[CurSmpl * 2 + 0], CAA->Volume);
+			MixBuf[CurSmpl].Right = LimitScaleAdd(MixBuf[CurSmpl].Right,
+												ChipBuf[CurSmpl * 2 + 1], CAA->Volume);
+		}
 	}
 
-    CAA->TargetSmpRate = p->SampleRate;
-
-		CAA->Resampler = resampler_create();
-
 	return;
 }
 
-static void ChangeChipSampleRate(void* DataPtr, UINT32 NewSmplRate)
+static void ResampleChipStream(VGM_PLAYER* p, CA_LIST* CLst, WAVE_32BS* RetSample, UINT32 Length)
 {
-	CAUD_ATTR* CAA = (CAUD_ATTR*)DataPtr;
+	CAUD_ATTR* CAA;
+	UINT64 ProfTime;
 
-	if (CAA->SmpRate == NewSmplRate)
+	CAA = CLst->CAud;
+	if (!CAA->Resampler)
 		return;
 
-	CAA->SmpRate = NewSmplRate;
+	// This Do-While-Loop gets and resamples the chip output of one or more chips.
+	// It's a loop to support the AY8910 paired with the YM2203/YM2608/YM2610.
+	do
+	{
+		RenderChipStream(p, CAA, p->StreamBufs, p->ChipBuf, Length);
+		ProfTime = p->RenderProfile ? GetProfileTime() : 0;
+		MixChipStream(p, CAA, p->ChipBuf, RetSample, Length);
+		if (CAA->Stems != NULL)
+			MixChipStems(p, CAA, p->ChipBuf, Length);
+		if (p->RenderProfile)
+			p->Profile.Mix += GetProfileTime() - ProfTime;
+
+		CAA = CAA->Paired;
+	} while(CAA != NULL);
 
 	return;
 }
 
+// Render Threads
+// The chips don't influence each other between two register writes, so the chips
+// of a block can be rendered on several threads. Each chip renders into its own
+// buffer and the buffers are mixed in the order of the chip list afterwards, so the
+// output is exactly the same as with a single thread.
+#define RENDER_MIN_BLOCK	0x80	// shorter blocks aren't worth waking the threads up
+
+#ifdef WIN32
+typedef HANDLE				RT_THREAD;
+typedef CRITICAL_SECTION	RT_MUTEX;
+typedef CONDITION_VARIABLE	RT_COND;
+#define RT_MutexInit(m)		InitializeCriticalSection(m)
+#define RT_MutexDeinit(m)	DeleteCriticalSection(m)
+#define RT_Lock(m)			EnterCriticalSection(m)
+#define RT_Unlock(m)		LeaveCriticalSection(m)
+#define RT_CondInit(c)		InitializeConditionVariable(c)
+#define RT_CondDeinit(c)
+#define RT_CondWait(c, m)	SleepConditionVariableCS(c, m, INFINITE)
+#define RT_CondSignal(c)	WakeConditionVariable(c)
+#define RT_CondBroadcast(c)	WakeAllConditionVariable(c)
+#else
+typedef pthread_t			RT_THREAD;
+typedef pthread_mutex_t		RT_MUTEX;
+typedef pthread_cond_t		RT_COND;
+#define RT_MutexInit(m)		pthread_mutex_init(m, NULL)
+#define RT_MutexDeinit(m)	pthread_mutex_destroy(m)
+#define RT_Lock(m)			pthread_mutex_lock(m)
+#define RT_Unlock(m)		pthread_mutex_unlock(m)
+#define RT_CondInit(c)		pthread_cond_init(c, NULL)
+#define RT_CondDeinit(c)	pthread_cond_destroy(c)
+#define RT_CondWait(c, m)	pthread_cond_wait(c, m)
+#define RT_CondSignal(c)	pthread_cond_signal(c)
+#define RT_CondBroadcast(c)	pthread_cond_broadcast(c)
+#endif
 
-INLINE INT16 Limit2Short(INT32 Value)
+typedef struct render_job
 {
-	INT32 NewValue;
+	CA_LIST* CLst;
+	bool Threaded;		// false - rendered by the calling thread
+	INT32* OutBuf[0x02];	// resampled output of the chip and its paired chip
+} RENDER_JOB;
 
-	NewValue = Value;
-	if (NewValue < -0x8000)
-		NewValue = -0x8000;
-	else if (NewValue > 0x7FFF)
-		NewValue = 0x7FFF;
+typedef struct render_pool RENDER_POOL;
+typedef struct render_thread
+{
+	RENDER_POOL* Pool;
+	RT_THREAD hThread;
+	INT32* StreamBufs[OUT_PAIRS_MAX * 2];
+} RENDER_THREAD;
 
-	return (INT16)NewValue;
-}
+struct render_pool
+{
+	VGM_PLAYER* Player;
+	UINT32 ThreadCnt;
+	RENDER_THREAD* Threads;
+	RENDER_JOB Jobs[CHIP_COUNT * 0x02];
+	UINT32 JobCnt;
+	UINT32 Length;
+
+	// protected by Lock
+	RT_MUTEX Lock;
+	RT_COND StartCond;	// a new block was started
+	RT_COND DoneCond;	// all threads are done with the block
+	UINT32 BlockID;
+	UINT32 NextJob;
+	UINT32 Running;
+	bool Quit;
+};
 
-INLINE INT32 LimitScaleAdd(INT32 Target, INT32 Value, UINT16 Scale)
+static void RenderJobs(RENDER_POOL* Pool, INT32** StreamBufs)
 {
-	INT64 NewValue;
+	RENDER_JOB* Job;
+	CAUD_ATTR* CAA;
+	UINT32 CurJob;
+	UINT8 CurBuf;
 
-	NewValue = (INT64)Value;
-	NewValue *= (INT64)Scale;
-	NewValue += (INT64)Target;
+	while(true)
+	{
+		RT_Lock(&Pool->Lock);
+		CurJob = Pool->NextJob;
+		Pool->NextJob ++;
+		RT_Unlock(&Pool->Lock);
+		if (CurJob >= Pool->JobCnt)
+			break;
 
-	if (NewValue < -0x80000000LL)
-		NewValue = -0x80000000LL;
-	else if (NewValue > 0x7FFFFFFFLL)
-		NewValue = 0x7FFFFFFFLL;
+		Job = &Pool->Jobs[CurJob];
+		if (! Job->Threaded)
+			continue;
+		CAA = Job->CLst->CAud;
+		for (CurBuf = 0x00; CAA != NULL; CurBuf ++, CAA = CAA->Paired)
+			RenderChipStream(Pool->Player, CAA, StreamBufs, Job->OutBuf[CurBuf], Pool->Length);
+	}
 
-	return (INT32)NewValue;
+	return;
 }
 
-static void null_update(void *param, stream_sample_t **outputs, int samples)
+#ifdef WIN32
+static DWORD WINAPI RenderThread(void* Param)
+#else
+static void* RenderThread(void* Param)
+#endif
 {
-	memset(outputs[0x00], 0x00, sizeof(stream_sample_t) * samples);
-	memset(outputs[0x01], 0x00, sizeof(stream_sample_t) * samples);
+	RENDER_THREAD* Thread = (RENDER_THREAD*)Param;
+	RENDER_POOL* Pool = Thread->Pool;
+	UINT32 LastBlock;
 
-	return;
+	LastBlock = 0;
+	RT_Lock(&Pool->Lock);
+	while(true)
+	{
+		while(! Pool->Quit && Pool->BlockID == LastBlock)
+			RT_CondWait(&Pool->StartCond, &Pool->Lock);
+		if (Pool->Quit)
+			break;
+		LastBlock = Pool->BlockID;
+		RT_Unlock(&Pool->Lock);
+
+		RenderJobs(Pool, Thread->StreamBufs);
+
+		RT_Lock(&Pool->Lock);
+		Pool->Running --;
+		if (! Pool->Running)
+			RT_CondSignal(&Pool->DoneCond);
+	}
+	RT_Unlock(&Pool->Lock);
+
+	return 0;
 }
 
-static void dual_opl2_stereo(void *param, stream_sample_t **outputs, int samples)
+static void StartRenderThreads(VGM_PLAYER* p)
 {
-    struct dual_opl2_info * info = (struct dual_opl2_info *) param;
+	RENDER_POOL* Pool;
+	RENDER_THREAD* Thread;
+	UINT32 CurThr;
+	UINT8 CurBuf;
+	bool RetVal;
 
-	ym3812_stream_update(info->chip, outputs, samples);
+	Pool = (RENDER_POOL*)calloc(1, sizeof(RENDER_POOL));
+	if (Pool == NULL)
+		return;
+	Pool->Player = p;
+	// the calling thread renders as well
+	Pool->Threads = (RENDER_THREAD*)calloc(p->RenderThreads - 1, sizeof(RENDER_THREAD));
+	if (Pool->Threads == NULL)
+	{
+		free(Pool);
+		return;
+	}
+	RT_MutexInit(&Pool->Lock);
+	RT_CondInit(&Pool->StartCond);
+	RT_CondInit(&Pool->DoneCond);
+	p->RenderPool = Pool;
 
-	// Dual-OPL with Stereo
-	if (info->ChipID & 0x01)
-		memset(outputs[0x00], 0x00, sizeof(stream_sample_t) * samples);	// Mute Left Chanel
-	else
-		memset(outputs[0x01], 0x00, sizeof(stream_sample_t) * samples);	// Mute Right Chanel
+	for (CurThr = 0; CurThr < p->RenderThreads - 1U; CurThr ++)
+	{
+		Thread = &Pool->Threads[CurThr];
+		Thread->Pool = Pool;
+		for (CurBuf = 0x00; CurBuf < OUT_PAIRS_MAX * 2; CurBuf ++)
+			Thread->StreamBufs[CurBuf] = (INT32*)malloc(SMPL_BUFSIZE * sizeof(INT32));
+#ifdef WIN32
+		Thread->hThread = CreateThread(NULL, 0, &RenderThread, Thread, 0, NULL);
+		RetVal = (Thread->hThread != NULL);
+#else
+		RetVal = ! pthread_create(&Thread->hThread, NULL, &RenderThread, Thread);
+#endif
+		if (! RetVal)
+		{
+			for (CurBuf = 0x00; CurBuf < OUT_PAIRS_MAX * 2; CurBuf ++)
+				free(Thread->StreamBufs[CurBuf]);
+			break;
+		}
+		Pool->ThreadCnt ++;
+	}
 
 	return;
 }
 
-static void ResampleChipStream(VGM_PLAYER* p, CA_LIST* CLst, WAVE_32BS* RetSample, UINT32 Length)
+static void StopRenderThreads(VGM_PLAYER* p)
 {
-	CAUD_ATTR* CAA;
-	INT32* CurBufL;
-	INT32* CurBufR;
-	INT32 SmpCnt;	// must be signed, else I'm getting calculation errors
-	INT32 CurSmpl;
-  UINT32 SampleRate;
-	UINT32 OutPos;
-	sample_t ls, rs;
+	RENDER_POOL* Pool = (RENDER_POOL*)p->RenderPool;
+	RENDER_THREAD* Thread;
+	UINT32 CurThr;
+	UINT8 CurBuf;
 
-	CAA = CLst->CAud;
-	if (!CAA->Resampler)
+	if (Pool == NULL)
 		return;
-    
-	CurBufL = p->StreamBufs[0x00];
-	CurBufR = p->StreamBufs[0x01];
 
-  SampleRate = p->SampleRate;
+	RT_Lock(&Pool->Lock);
+	Pool->Quit = true;
+	RT_CondBroadcast(&Pool->StartCond);
+	RT_Unlock(&Pool->Lock);
+
+	for (CurThr = 0; CurThr < Pool->ThreadCnt; CurThr ++)
+	{
+		Thread = &Pool->Threads[CurThr];
+#ifdef WIN32
+		WaitForSingleObject(Thread->hThread, INFINITE);
+		CloseHandle(Thread->hThread);
+#else
+		pthread_join(Thread->hThread, NULL);
+#endif
+		for (CurBuf = 0x00; CurBuf < OUT_PAIRS_MAX * 2; CurBuf ++)
+			free(Thread->StreamBufs[CurBuf]);
+	}
+	for (CurThr = 0; CurThr < CHIP_COUNT * 0x02; CurThr ++)
+	{
+		free(Pool->Jobs[CurThr].OutBuf[0x00]);
+		free(Pool->Jobs[CurThr].OutBuf[0x01]);
+	}
+
+	RT_CondDeinit(&Pool->DoneCond);
+	RT_CondDeinit(&Pool->StartCond);
+	RT_MutexDeinit(&Pool->Lock);
+	free(Pool->Threads);
+	free(Pool);
+	p->RenderPool = NULL;
 
-	OutPos = 0;
+	return;
+}
 
-	// This Do-While-Loop gets and resamples the chip output of one or more chips.
-	// It's a loop to support the AY8910 paired with the YM2203/YM2608/YM2610.
-	do
+static bool IsChipAudible(const CHIP_OPTS* COpts)
+{
+	// The ChnMute masks go to the cores (a set bit mutes a channel), so a chip with
+	// no muted channels must be rendered, too. Only a disabled chip is skipped.
+	return ! COpts->Disabled;
+}
+
+static void RenderChips(VGM_PLAYER* p, WAVE_32BS* RetSample, UINT32 Length)
+{
+	RENDER_POOL* Pool = (RENDER_POOL*)p->RenderPool;
+	RENDER_JOB* Job;
+	CA_LIST* CurCLst;
+	CAUD_ATTR* CAA;
+	UINT32 CurJob;
+	UINT32 ThrJobs;
+	UINT8 CurBuf;
+	UINT64 ProfTime;
+
+	ThrJobs = 0;
+	if (Pool != NULL && Pool->ThreadCnt && Length >= RENDER_MIN_BLOCK)
 	{
-		for (OutPos = 0; OutPos < Length; OutPos++)
+		Pool->JobCnt = 0;
+		for (CurCLst = p->ChipListAll; CurCLst != NULL; CurCLst = CurCLst->next)
 		{
-			if (CAA->LastSmpRate != CAA->SmpRate)
-			{
-				resampler_set_rate(CAA->Resampler, (double)CAA->SmpRate / (double)CAA->TargetSmpRate);
-				CAA->LastSmpRate = CAA->SmpRate;
-			}
-
-			SmpCnt = resampler_get_min_fill(CAA->Resampler) / 2;
+			if (! IsChipAudible(CurCLst->COpts))
+				continue;
+			CAA = CurCLst->CAud;
+			if (! CAA->Resampler)
+				continue;
 
-			if (SmpCnt)
+			Job = &Pool->Jobs[Pool->JobCnt];
+			Pool->JobCnt ++;
+			Job->CLst = CurCLst;
+			Job->Threaded = CAA->ThreadSafe && (CAA->Paired == NULL || CAA->Paired->ThreadSafe);
+			if (Job->Threaded)
+				ThrJobs ++;
+			for (CurBuf = 0x00; CAA != NULL; CurBuf ++, CAA = CAA->Paired)
 			{
-				CAA->StreamUpdate(CAA->StreamUpdateParam, p->StreamBufs, SmpCnt);
-				for (CurSmpl = 0; CurSmpl < SmpCnt; CurSmpl++)
-					resampler_write_pair(CAA->Resampler, CurBufL[CurSmpl], CurBufR[CurSmpl]);
+				if (Job->OutBuf[CurBuf] == NULL)
+					Job->OutBuf[CurBuf] = (INT32*)malloc(OUT_PAIRS_MAX * SMPL_BUFSIZE * 0x02 * sizeof(INT32));
 			}
+		}
+	}
+	if (ThrJobs < 0x02)
+	{
+		// nothing to gain from the threads
+		for (CurCLst = p->ChipListAll; CurCLst != NULL; CurCLst = CurCLst->next)
+		{
+			if (IsChipAudible(CurCLst->COpts))
+				ResampleChipStream(p, CurCLst, RetSample, Length);
+		}
+		return;
+	}
 
-			resampler_read_pair(CAA->Resampler, &ls, &rs);
+	RT_Lock(&Pool->Lock);
+	Pool->Length = Length;
+	Pool->NextJob = 0;
+	Pool->Running = Pool->ThreadCnt;
+	Pool->BlockID ++;
+	RT_CondBroadcast(&Pool->StartCond);
+	RT_Unlock(&Pool->Lock);
+
+	// The chips that have to stay on this thread are rendered in the list order,
+	// then this thread helps out with the rest.
+	for (CurJob = 0; CurJob < Pool->JobCnt; CurJob ++)
+	{
+		Job = &Pool->Jobs[CurJob];
+		if (Job->Threaded)
+			continue;
+		CAA = Job->CLst->CAud;
+		for (CurBuf = 0x00; CAA != NULL; CurBuf ++, CAA = CAA->Paired)
+			RenderChipStream(p, CAA, p->StreamBufs, Job->OutBuf[CurBuf], Length);
+	}
+	RenderJobs(Pool, p->StreamBufs);
 
-			RetSample[OutPos].Left = LimitScaleAdd(RetSample[OutPos].Left, ls, CAA->Volume);
-			RetSample[OutPos].Right = LimitScaleAdd(RetSample[OutPos].Right, rs, CAA->Volume);
-		}
+	RT_Lock(&Pool->Lock);
+	while(Pool->Running)
+		RT_CondWait(&Pool->DoneCond, &Pool->Lock);
+	RT_Unlock(&Pool->Lock);
 
-		CAA = CAA->Paired;
-	} while(CAA != NULL);
+	ProfTime = p->RenderProfile ? GetProfileTime() : 0;
+	for (CurJob = 0; CurJob < Pool->JobCnt; CurJob ++)
+	{
+		Job = &Pool->Jobs[CurJob];
+		CAA = Job->CLst->CAud;
+		for (CurBuf = 0x00; CAA != NULL; CurBuf ++, CAA = CAA->Paired)
+		{
+			MixChipStream(p, CAA, Job->OutBuf[CurBuf], RetSample, Length);
+			if (CAA->Stems != NULL)
+				MixChipStems(p, CAA, Job->OutBuf[CurBuf], Length);
+		}
+	}
+	if (p->RenderProfile)
+		p->Profile.Mix += GetProfileTime() - ProfTime;
 
 	return;
 }
@@ -5061,15 +7832,172 @@ static INT32 RecalcFadeVolume(VGM_PLAYER* p)
 	return (INT32)(0x100 * p->FinalVol + 0.5f);
 }
 
-UINT32 FillBuffer(void *_p, WAVE_16BS* Buffer, UINT32 BufferSize)
+// Applies the master volume/fade to the mix and writes it in the requested format.
+//	16-bit: ChipData << 9 [ChipVol] >> 5 << 8 [MstVol] >> 11  ->  9-5+8-11 = <<1
+//	32-bit and float use the full product Mix * BlkVol at the scale of 16-bit output << 16
+//	(resp. / 0x8000) and are neither truncated nor clipped at 16 bits.
+//	The 16-bit path drops the low 5 mix bits before the multiply, so S32 >> 16 only
+//	equals it when BlkVol is a power of 2 (e.g. 0x100, full volume). During a fade or
+//	with other volumes the two can differ by 1 LSB (for BlkVol up to 0x800).
+// InvRight inverts the right channel (SurroundSound).
+static void ConvertBlock(VGM_PLAYER* p, const WAVE_32BS* MixBuf, const INT32* BlkVol, void* Buffer,
+						UINT8 Format, bool InvRight, UINT32 Length)
 {
 	UINT32 CurSmpl;
 	WAVE_32BS TempBuf;
+	INT64 TempSmpl;
+	INT32* Buf32;
+	float* BufFlt;
+	float VolFlt;
+	float RightSign;
+
+	switch(Format)
+	{
+	case SMPFMT_S16:
+		for (CurSmpl = 0x00; CurSmpl < Length; CurSmpl ++)
+		{
+			TempBuf.Left = ((MixBuf[CurSmpl].Left >> 5) * BlkVol[CurSmpl]) >> 11;
+			TempBuf.Right = ((MixBuf[CurSmpl].Right >> 5) * BlkVol[CurSmpl]) >> 11;
+			if (InvRight)
+				TempBuf.Right *= -1;
+			((WAVE_16BS*)Buffer)[CurSmpl].Left = Limit2Short(TempBuf.Left);
+			((WAVE_16BS*)Buffer)[CurSmpl].Right = Limit2Short(TempBuf.Right);
+		}
+		break;
+	case SMPFMT_S32:
+		// the 64-bit products don't fit into the vector units without SSE4.1, but
+		// the compiler vectorizes this loop well enough
+		Buf32 = (INT32*)Buffer;
+		for (CurSmpl = 0x00; CurSmpl < Length; CurSmpl ++)
+		{
+			TempSmpl = (INT64)MixBuf[CurSmpl].Left * BlkVol[CurSmpl];
+			if (TempSmpl < -0x80000000LL)
+				TempSmpl = -0x80000000LL;
+			else if (TempSmpl > 0x7FFFFFFFLL)
+				TempSmpl = 0x7FFFFFFFLL;
+			Buf32[CurSmpl * 2 + 0] = (INT32)TempSmpl;
+
+			TempSmpl = (INT64)MixBuf[CurSmpl].Right * BlkVol[CurSmpl];
+			if (InvRight)
+				TempSmpl = -TempSmpl;
+			if (TempSmpl < -0x80000000LL)
+				TempSmpl = -0x80000000LL;
+			else if (TempSmpl > 0x7FFFFFFFLL)
+				TempSmpl = 0x7FFFFFFFLL;
+			Buf32[CurSmpl * 2 + 1] = (INT32)TempSmpl;
+		}
+		break;
+	case SMPFMT_F32:
+		// The vector and scalar loops do the same float operations in the same
+		// order, so the result doesn't depend on where the vector part ends.
+		BufFlt = (float*)Buffer;
+		RightSign = InvRight ? -1.0f : 1.0f;
+		CurSmpl = 0x00;
+#if defined(MIX_SSE2)
+		{
+			const __m128 Scale = _mm_set1_ps(1.0f / 2147483648.0f);
+			const __m128 Sign = _mm_set_ps(RightSign, 1.0f, RightSign, 1.0f);
+			__m128i Vol;
+			__m128 VolLo;
+			__m128 VolHi;
+			__m128 SmpLo;
+			__m128 SmpHi;
+
+			for (; CurSmpl + 4 <= Length; CurSmpl += 4)
+			{
+				Vol = _mm_loadu_si128((const __m128i*)&BlkVol[CurSmpl]);
+				VolLo = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi32(Vol, Vol)), Scale), Sign);
+				VolHi = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi32(Vol, Vol)), Scale), Sign);
+				SmpLo = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)&MixBuf[CurSmpl + 0]));
+				SmpHi = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)&MixBuf[CurSmpl + 2]));
+				_mm_storeu_ps(&BufFlt[CurSmpl * 2 + 0], _mm_mul_ps(SmpLo, VolLo));
+				_mm_storeu_ps(&BufFlt[CurSmpl * 2 + 4], _mm_mul_ps(SmpHi, VolHi));
+			}
+		}
+#elif defined(MIX_NEON)
+		{
+			const float SignArr[4] = {1.0f, RightSign, 1.0f, RightSign};
+			const float32x4_t Sign = vld1q_f32(SignArr);
+			int32x4x2_t Vol;
+			float32x4_t VolLo;
+			float32x4_t VolHi;
+
+			for (; CurSmpl + 4 <= Length; CurSmpl += 4)
+			{
+				Vol.val[0] = Vol.val[1] = vld1q_s32(&BlkVol[CurSmpl]);
+				Vol = vzipq_s32(Vol.val[0], Vol.val[1]);
+				VolLo = vmulq_f32(vmulq_n_f32(vcvtq_f32_s32(Vol.val[0]), 1.0f / 2147483648.0f), Sign);
+				VolHi = vmulq_f32(vmulq_n_f32(vcvtq_f32_s32(Vol.val[1]), 1.0f / 2147483648.0f), Sign);
+				vst1q_f32(&BufFlt[CurSmpl * 2 + 0],
+						vmulq_f32(vcvtq_f32_s32(vld1q_s32(&MixBuf[CurSmpl + 0].Left)), VolLo));
+				vst1q_f32(&BufFlt[CurSmpl * 2 + 4],
+						vmulq_f32(vcvtq_f32_s32(vld1q_s32(&MixBuf[CurSmpl + 2].Left)), VolHi));
+			}
+		}
+#endif
+		for (; CurSmpl < Length; CurSmpl ++)
+		{
+			VolFlt = (float)BlkVol[CurSmpl] * (1.0f / 2147483648.0f);
+			BufFlt[CurSmpl * 2 + 0] = (float)MixBuf[CurSmpl].Left * (VolFlt * 1.0f);
+			BufFlt[CurSmpl * 2 + 1] = (float)MixBuf[CurSmpl].Right * (VolFlt * RightSign);
+		}
+		break;
+	}
+
+	return;
+}
+
+UINT32 FillBuffer(void *_p, WAVE_16BS* Buffer, UINT32 BufferSize)
+{
+	return RenderBuffer((VGM_PLAYER*)_p, Buffer, SMPFMT_S16, NULL, 0x01, BufferSize);
+}
+
+// StemBufs receives one buffer per stem (see GetStemCount), it's ignored when
+// stem rendering is off.
+UINT32 FillBufferStems(void *_p, WAVE_16BS* Buffer, WAVE_16BS** StemBufs, UINT32 BufferSize)
+{
+	return RenderBuffer((VGM_PLAYER*)_p, Buffer, SMPFMT_S16, StemBufs, 0x01, BufferSize);
+}
+
+// Format is one of the SMPFMT_ constants, Buffer receives interleaved stereo samples.
+UINT32 FillBufferEx(void *_p, void* Buffer, UINT8 Format, UINT32 BufferSize)
+{
+	return RenderBuffer((VGM_PLAYER*)_p, Buffer, Format, NULL, 0x01, BufferSize);
+}
+
+// Like FillBufferEx, but Buffer receives GetOutputChannels() interleaved channels
+// in WAVE_FORMAT_EXTENSIBLE order (FL FR [FC LFE] BL BR). SurroundSound is ignored.
+UINT32 FillBufferMulti(void *_p, void* Buffer, UINT8 Format, UINT32 BufferSize)
+{
+	VGM_PLAYER* p = (VGM_PLAYER*)_p;
+
+	return RenderBuffer(p, Buffer, Format, NULL, GetSpeakerPairs(p), BufferSize);
+}
+
+UINT8 GetOutputChannels(void *_p)
+{
+	return GetSpeakerPairs((VGM_PLAYER*)_p) * 2;
+}
+
+static UINT32 RenderBuffer(VGM_PLAYER* p, void* Buffer, UINT8 Format, WAVE_16BS** StemBufs,
+						UINT8 SpkPairs, UINT32 BufferSize)
+{
+	UINT32 CurSmpl;
 	INT32 CurMstVol;
 	UINT32 RecalcStep;
-	CA_LIST* CurCLst;
-
-    VGM_PLAYER* p = (VGM_PLAYER *)_p;
+	UINT32 BlkLen;
+	UINT32 BlkMax;
+	INT32 BlkVol[SMPL_BUFSIZE];
+	bool StopPlay;
+	STEM_LIST* SList;
+	UINT32 CurStem;
+	UINT32 SmplSize;	// size of one stereo sample
+	INT32 PairBuf[SMPL_BUFSIZE * 0x02];
+	UINT8* OutPtr;
+	UINT32 CurPos;
+	UINT8 CurPair;
+	UINT64 StartTime;
+	UINT64 ProfTime;
 
 	//memset(Buffer, 0x00, sizeof(WAVE_16BS) * BufferSize);
 
@@ -5080,7 +8008,7 @@ UINT32 FillBuffer(void *_p, WAVE_16BS* Buffer, UINT32 BufferSize)
 	{
 		//for (CurSmpl = 0x00; CurSmpl < BufferSize; CurSmpl ++)
 		//	InterpretFile(1);
-		InterpretFile(p, BufferSize);
+		InterpretSeek(p, BufferSize);
 
 		if (p->FadePlay && ! p->FadeStart)
 		{
@@ -5099,9 +8027,45 @@ UINT32 FillBuffer(void *_p, WAVE_16BS* Buffer, UINT32 BufferSize)
 		return BufferSize;
 	}
 
-	for (CurSmpl = 0x00; CurSmpl < BufferSize; CurSmpl ++)
+	SList = (StemBufs != NULL) ? (STEM_LIST*)p->StemList : NULL;
+	SmplSize = (Format == SMPFMT_S16) ? sizeof(WAVE_16BS) : sizeof(INT32) * 0x02;
+	p->MixPairs = SpkPairs;
+	StartTime = (p->RenderProfile || p->RenderBudget > 0.0f) ? GetProfileTime() : 0;
+	CurSmpl = 0x00;
+	while (CurSmpl < BufferSize)
 	{
-		InterpretFile(p, 1);
+		// Process the VGM until the next sample that writes to a chip, so that the
+		// chips can render the whole block at once. The fading is applied
+		// afterwards, so the volume of each sample is remembered.
+		BlkMax = BufferSize - CurSmpl;
+		if (BlkMax > SMPL_BUFSIZE)
+			BlkMax = SMPL_BUFSIZE;
+		BlkLen = 0x00;
+		StopPlay = false;
+		ProfTime = p->RenderProfile ? GetProfileTime() : 0;
+		CheckSeekIndex(p);	// the chips are rendered up to here
+		do
+		{
+			InterpretFile(p, 1);
+			BlkVol[BlkLen] = CurMstVol;
+
+			if (p->FadePlay && ! p->FadeStart)
+			{
+				p->FadeStart = p->PlayingTime;
+				RecalcStep = p->FadePlay ? p->SampleRate / 100 : 0;
+			}
+			if (RecalcStep && ! ((CurSmpl + BlkLen) % RecalcStep))
+				CurMstVol = RecalcFadeVolume(p);
+			BlkLen ++;
+
+			if (p->VGMEnd && ! p->EndPlay)
+			{
+				StopPlay = true;
+				break;
+			}
+		} while(BlkLen < BlkMax && p->BlockRender && IsNextSampleIdle(p));
+		if (p->RenderProfile)
+			p->Profile.Interpret += GetProfileTime() - ProfTime;
 
 		// Sample Structures
 		//	00 - SN76496
@@ -5145,42 +8109,58 @@ UINT32 FillBuffer(void *_p, WAVE_16BS* Buffer, UINT32 BufferSize)
 		//	26 - X1-010
 		//	27 - C352
 		//	28 - GA20
-		TempBuf.Left = 0x00;
-		TempBuf.Right = 0x00;
-		CurCLst = p->ChipListAll;
-		while(CurCLst != NULL)
+		for (CurPair = 0x00; CurPair < SpkPairs; CurPair ++)
+			memset(&p->MixBuf[CurPair * SMPL_BUFSIZE], 0x00, sizeof(WAVE_32BS) * BlkLen);
+		for (CurStem = 0; SList != NULL && CurStem < SList->Count; CurStem ++)
+			memset(&SList->MixBufs[CurStem * SMPL_BUFSIZE], 0x00, sizeof(WAVE_32BS) * BlkLen);
+		if (p->RenderThreads > 1 && p->RenderPool == NULL)
+			StartRenderThreads(p);
+		RenderChips(p, p->MixBuf, BlkLen);
+
+		ProfTime = p->RenderProfile ? GetProfileTime() : 0;
+		// the stems get the same volume and surround treatment as the mix
+		for (CurStem = 0; SList != NULL && CurStem < SList->Count; CurStem ++)
+			ConvertBlock(p, &SList->MixBufs[CurStem * SMPL_BUFSIZE], BlkVol,
+						&StemBufs[CurStem][CurSmpl], SMPFMT_S16, p->SurroundSound, BlkLen);
+		if (SpkPairs == 0x01)
+		{
+			ConvertBlock(p, p->MixBuf, BlkVol, (UINT8*)Buffer + CurSmpl * SmplSize, Format,
+						p->SurroundSound, BlkLen);
+		}
+		else
 		{
-			if (! CurCLst->COpts->Disabled && (CurCLst->COpts->ChnMute1 | CurCLst->COpts->ChnMute2 | CurCLst->COpts->ChnMute3 != 0))
+			// convert every speaker pair on its own and interleave them
+			for (CurPair = 0x00; CurPair < SpkPairs; CurPair ++)
 			{
-				ResampleChipStream(p, CurCLst, &TempBuf, 1);
+				ConvertBlock(p, &p->MixBuf[CurPair * SMPL_BUFSIZE], BlkVol, PairBuf, Format,
+							false, BlkLen);
+				OutPtr = (UINT8*)Buffer + (CurSmpl * SpkPairs + CurPair) * SmplSize;
+				for (CurPos = 0x00; CurPos < BlkLen; CurPos ++, OutPtr += SpkPairs * SmplSize)
+					memcpy(OutPtr, (UINT8*)PairBuf + CurPos * SmplSize, SmplSize);
 			}
-			CurCLst = CurCLst->next;
 		}
+		if (p->RenderProfile)
+			p->Profile.Mix += GetProfileTime() - ProfTime;
+		CurSmpl += BlkLen;
 
-		// ChipData << 9 [ChipVol] >> 5 << 8 [MstVol] >> 11  ->  9-5+8-11 = <<1
-		TempBuf.Left = ((TempBuf.Left >> 5) * CurMstVol) >> 11;
-		TempBuf.Right = ((TempBuf.Right >> 5) * CurMstVol) >> 11;
-		if (p->SurroundSound)
-			TempBuf.Right *= -1;
-		Buffer[CurSmpl].Left = Limit2Short(TempBuf.Left);
-		Buffer[CurSmpl].Right = Limit2Short(TempBuf.Right);
-
-		if (p->FadePlay && ! p->FadeStart)
+		if (StopPlay)
 		{
-			p->FadeStart = p->PlayingTime;
-			RecalcStep = p->FadePlay ? p->SampleRate / 100 : 0;
+			// the last sample is rendered, but not counted
+			p->EndPlay = true;
+			CurSmpl --;
+			break;
 		}
-		if (RecalcStep && ! (CurSmpl % RecalcStep))
-			CurMstVol = RecalcFadeVolume(p);
-
-		if (p->VGMEnd)
+	}
+	if (p->RenderProfile || p->RenderBudget > 0.0f)
+	{
+		ProfTime = GetProfileTime() - StartTime;
+		if (p->RenderProfile)
 		{
-            if (! p->EndPlay)
-            {
-                p->EndPlay = true;
-                break;
-            }
-        }
+			p->Profile.Total += ProfTime;
+			p->Profile.Samples += CurSmpl;
+		}
+		if (p->RenderBudget > 0.0f)
+			UpdateRenderBudget(p, ProfTime, CurSmpl);
 	}
 
 	return CurSmpl;
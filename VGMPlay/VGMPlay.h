@@ -79,7 +79,16 @@ typedef struct chips_options
 } CHIPS_OPTION;
 
 typedef void (*strm_func)(void *, stream_sample_t **outputs, int samples);
+// returns non-zero while the core outputs silence and its state doesn't change until
+// the next register write, so that its updates can be skipped
+typedef UINT8 (*silent_func)(void *);
 
+// Speaker pairs of the mix bus. The chips output their pairs in the order front,
+// rear, center/LFE. FillBufferMulti writes them in WAVE_FORMAT_EXTENSIBLE order.
+#define OUT_PAIRS_MAX	0x03
+
+typedef struct chip_stems CHIP_STEMS;
+typedef struct resample_carry RSMP_CARRY;
 typedef struct chip_audio_attributes CAUD_ATTR;
 struct chip_audio_attributes
 {
@@ -92,7 +101,26 @@ struct chip_audio_attributes
 		void* Resampler;
     strm_func StreamUpdate;
     void* StreamUpdateParam;
+    silent_func IsSilent;	// NULL - the core has to be updated all the time
     CAUD_ATTR* Paired;
+    bool BlockUpdate;	// the core's output doesn't depend on how the updates are split
+    bool StepSynth;	// the core outputs band-limited steps at the output rate (see blip.h)
+    bool ThreadSafe;	// the core keeps no state in globals and can render on any thread
+    CHIP_STEMS* Stems;	// single channel output for stem rendering (NULL - off)
+    REGW_CALLBACK RegWrite;	// register write of the chip's core (set by chip_reg_setup)
+    void* RegWriteParam;
+    UINT8 OutPairs;	// stereo pairs the core outputs (more than 1 only if OutChannels > 2)
+    void* PairResamplers[OUT_PAIRS_MAX - 1];	// resamplers of the 2nd and 3rd pair
+    UINT32 LQPos;	// LQ resampling: position after LQLast (16.16 fixed point)
+    INT32 LQPrev[OUT_PAIRS_MAX * 2];	// LQ resampling: the last two samples of every channel
+    INT32 LQLast[OUT_PAIRS_MAX * 2];
+    UINT8 RsmpPath;	// resampling of the last block (RSMP_SINC/LQ/DIRECT, 0xFF - none yet)
+    RSMP_CARRY* Carry;	// what the sinc resampler handed over to another resampling (NULL - none)
+    UINT64 ProfUpdate;	// render time of the core in ns (RenderProfile)
+    UINT64 ProfResample;	// resampling time in ns (RenderProfile)
+    UINT32 StatWrites;	// see CHIP_STATS (always there, so the layout doesn't depend on ENABLE_CHIP_STATS)
+    UINT64 StatSamples;
+    UINT64 StatFrames;
 };
 
 typedef struct chip_audio_struct
@@ -149,6 +177,13 @@ struct chip_aud_list
     CA_LIST* next;
 };
 
+typedef struct core_cost
+{
+    UINT8 ChipType;
+    UINT8 EmuCore;
+    float Load;	// share of real time a single chip needs
+} CORE_COST;
+
 typedef struct daccontrol_data
 {
     bool Enable;
@@ -186,6 +221,15 @@ typedef struct vgm_player
     bool DoubleSSGVol;
 
     UINT8 ResampleMode;	// 00 - HQ both, 01 - LQ downsampling, 02 - LQ both
+    bool BlockRender;	// render chips in blocks between events (false - one sample at a time)
+    UINT8 RenderThreads;	// threads that render the chips (0/1 - all on the calling thread)
+    UINT32 SeekIndexTime;	// distance between seek index checkpoints in msec (0 - no seek index)
+    bool StemRender;	// render every channel into a stem of its own as well (see FillBufferStems)
+    bool PreDecode;	// decode the commands into an event list in PlayVGM (whole file in memory only)
+    bool StepSynth;	// SN76496 (MAME core), AY8910 (EMU2149 core), K051649 and Pokey render band-limited steps at the output rate
+    bool RenderProfile;	// measure the time of the render stages (see GetRenderProfile)
+    float RenderBudget;	// share of real time the rendering may use, picks the cores and raises ResampleMode (0 - off)
+    UINT8 OutChannels;	// FillBufferMulti channels: 2, 4 (quad) or 6 (5.1), ES5506/C352 pairs stay separate if > 2
     UINT8 CHIP_SAMPLING_MODE;
     INT32 CHIP_SAMPLE_RATE;
 
@@ -201,6 +245,12 @@ typedef struct vgm_player
     VGM_EXTRA VGMH_Extra;
     UINT32 VGMDataLen;
     UINT8* VGMData;
+    UINT32 VGMMapLen;	// size of the file mapping VGMData points to (0 - VGMData is allocated)
+    void* VGMStream;	// gzFile that VGMData is streamed from (NULL - VGMData has the whole file)
+    UINT32 VGMDataOfs;	// file offset of VGMData[0]
+    UINT32 VGMDataFill;	// streamed data in VGMData
+    UINT32 VGMDataAlloc;
+    UINT8* VGMStreamBlk;	// data block that didn't fit into the stream window
     GD3_TAG VGMTag;
 
 #define PCM_BANK_COUNT	0x40
@@ -219,7 +269,22 @@ typedef struct vgm_player
     //CA_LIST* ChipListOpt;	// ChipListAll minus muted chips
 
 #define SMPL_BUFSIZE	0x100
-    INT32* StreamBufs[0x02];
+    INT32* StreamBufs[OUT_PAIRS_MAX * 2];
+    WAVE_32BS* MixBuf;	// SMPL_BUFSIZE samples per speaker pair, chip mix of the current block
+    INT32* ChipBuf;	// SMPL_BUFSIZE stereo samples per output pair, resampled output of a single chip
+    UINT8 MixPairs;	// speaker pairs of the current mix (1 - stereo)
+    void* RenderPool;	// render threads, started by FillBuffer if RenderThreads > 1
+    void* SeekIndex;	// checkpoints for SeekVGM, set up by PlayVGM if SeekIndexTime > 0
+    void* StemList;	// stems of the current song, set up by PlayVGM if StemRender is on
+    void* EventList;	// pre-decoded commands, set up by PlayVGM if PreDecode is on
+    RENDER_PROFILE Profile;	// stage times of the current song (the chips keep their own)
+    CORE_COST* CoreProfile;	// render cost of the cores, loaded by LoadCoreProfile
+    UINT32 CoreProfCount;
+    UINT64 GovTime;	// RenderBudget: render time (ns) and samples of the current measurement
+    UINT32 GovSamples;
+    UINT8 GovOverloads;	// measurements in a row that were over the budget
+    UINT8 GovResampleMode;	// ResampleMode before RenderBudget raised it (0xFF - unchanged)
+    UINT8 GovUserCores[CHIP_COUNT];	// EmuCore before RenderBudget picked one (0xFF - unchanged)
 
     UINT32 VGMPos;
     INT32 VGMSmplPos;
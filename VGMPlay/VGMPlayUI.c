@@ -112,6 +112,7 @@ INLINE INT8 sign(double Value);
 INLINE long int Round(double Value);
 INLINE double RoundSpecial(double Value, double RoundTo);
 static void PrintMinSec(UINT32 SamplePos, UINT32 SmplRate);
+static void PrintChipLoad(void);
 
 
 // Options Variables
@@ -142,6 +143,10 @@ static UINT16 ForceAudioBuf;
 extern UINT8 ResampleMode;	// 00 - HQ both, 01 - LQ downsampling, 02 - LQ both
 extern UINT8 CHIP_SAMPLING_MODE;
 extern INT32 CHIP_SAMPLE_RATE;
+extern bool StepSynth;
+extern bool RenderProfile;
+extern float RenderBudget;
+extern UINT32 SeekIndexTime;
 
 extern UINT16 FMPort;
 extern bool UseFM;
@@ -229,6 +234,14 @@ extern UINT32 Last95Freq;	// for optvgm debugging
 
 static bool PrintMSHours;
 
+// live view of the chips' render time (key C)
+#define CHIP_LOAD_MAX	0x40
+static bool ShowChipLoad;
+static CHIP_STATS ChipLoadStats[CHIP_LOAD_MAX];	// counters at the start of the measurement
+static UINT32 ChipLoadCount;
+static UINT32 ChipLoadStart;	// PlayingTime at the start of the measurement
+static char ChipLoadStr[0x80];
+
 int main(int argc, char* argv[])
 {
 	int argbase;
@@ -1145,6 +1158,25 @@ static void ReadOptions(const char* AppName)
 				{
 					CHIP_SAMPLE_RATE = strtol(RStr, NULL, 0);
 				}
+				else if (! stricmp_u(LStr, "StepSynth"))
+				{
+					StepSynth = GetBoolFromStr(RStr);
+				}
+				else if (! stricmp_u(LStr, "RenderBudget"))
+				{
+					RenderBudget = (float)strtod(RStr, NULL);
+				}
+				else if (! stricmp_u(LStr, "SeekIndexTime"))
+				{
+					SeekIndexTime = strtoul(RStr, NULL, 0);
+				}
+				else if (! stricmp_u(LStr, "CoreProfile"))
+				{
+					TempPnt = FindFile(RStr);
+					if (TempPnt == NULL || ! LoadCoreProfile(TempPnt))
+						printerr("Failed to load the core profile.\n");
+					free(TempPnt);
+				}
 				else if (! stricmp_u(LStr, "AudioBuffers"))
 				{
 					ForceAudioBuf = (UINT16)strtol(RStr, NULL, 0);
@@ -2297,6 +2329,8 @@ static void PlayVGM_UI(void)
 							Last95Freq / 1000.0);
 			}
 			//printf("  %u / %u", multipcm_get_channels(0, NULL), 28);
+			if (ShowChipLoad)
+				PrintChipLoad();
 			printf("\r");
 #ifndef WIN32
 			fflush(stdout);
@@ -2514,6 +2548,14 @@ static void PlayVGM_UI(void)
 				RestartVGM();
 				PosPrint = true;
 				break;
+			case 'C':	// Chip load
+				ShowChipLoad = ! ShowChipLoad;
+				RenderProfile = ShowChipLoad;
+				ChipLoadCount = 0;
+				ChipLoadStr[0] = '\0';
+				printf("\n");	// the status line gets shorter
+				PosPrint = true;
+				break;
 			case 'B':	// Previous file (Back)
 				if (PLFileCount && /*! NextPLCmd &&*/ CurPLFile)
 				{
@@ -2677,3 +2719,75 @@ static void PrintMinSec(UINT32 SamplePos, UINT32 SmplRate)
 	
 	return;
 }
+
+static void PrintChipLoad(void)
+{
+	// shows the chips that need the most time to render, in percent of the playback time
+	CHIP_STATS CurStats[CHIP_LOAD_MAX];
+	UINT32 ChipCnt;
+	UINT32 CurChip;
+	UINT32 TopChip[3];
+	double TopLoad[3];
+	double ChipLoad;
+	double MeasureTime;
+	UINT64 ChipTime;
+	UINT64 LastTime;
+	UINT8 CurTop;
+	UINT8 TopPos;
+	char* StrPos;
+	
+	if (ChipLoadCount && PlayingTime >= ChipLoadStart && PlayingTime - ChipLoadStart < SampleRate)
+	{
+		// measure for at least a second, so that the numbers can be read
+		printf("%s", ChipLoadStr);
+		return;
+	}
+	
+	ChipCnt = GetChipStats(CurStats, CHIP_LOAD_MAX);
+	if (! ChipCnt)
+	{
+		printf("  (no chip statistics in this build)");
+		return;
+	}
+	// a restart or seek resets the counters, so the measurement starts again
+	if (ChipCnt == ChipLoadCount && PlayingTime > ChipLoadStart)
+	{
+		MeasureTime = (PlayingTime - ChipLoadStart) * 1000000000.0 / SampleRate;
+		for (CurTop = 0; CurTop < 3; CurTop ++)
+			TopLoad[CurTop] = -1.0;
+		for (CurChip = 0; CurChip < ChipCnt; CurChip ++)
+		{
+			ChipTime = CurStats[CurChip].UpdateTime + CurStats[CurChip].ResampleTime;
+			LastTime = ChipLoadStats[CurChip].UpdateTime + ChipLoadStats[CurChip].ResampleTime;
+			if (ChipTime < LastTime)
+				continue;
+			ChipLoad = (ChipTime - LastTime) * 100.0 / MeasureTime;
+			for (TopPos = 0; TopPos < 3 && ChipLoad <= TopLoad[TopPos]; TopPos ++)
+				;
+			if (TopPos >= 3)
+				continue;
+			for (CurTop = 2; CurTop > TopPos; CurTop --)
+			{
+				TopLoad[CurTop] = TopLoad[CurTop - 1];
+				TopChip[CurTop] = TopChip[CurTop - 1];
+			}
+			TopLoad[TopPos] = ChipLoad;
+			TopChip[TopPos] = CurChip;
+		}
+		
+		StrPos = ChipLoadStr;
+		for (CurTop = 0; CurTop < 3 && TopLoad[CurTop] >= 0.0; CurTop ++)
+		{
+			CurChip = TopChip[CurTop];
+			StrPos += sprintf(StrPos, "  %.10s%s %.1f%%", GetChipName(CurStats[CurChip].ChipType),
+							CurStats[CurChip].ChipID ? " #2" : "", TopLoad[CurTop]);
+		}
+	}
+	memcpy(ChipLoadStats, CurStats, ChipCnt * sizeof(CHIP_STATS));
+	ChipLoadCount = ChipCnt;
+	ChipLoadStart = PlayingTime;
+	
+	printf("%s", ChipLoadStr);
+	
+	return;
+}
@@ -19,6 +19,35 @@ typedef struct waveform_32bit_stereo
 	INT32 Right;
 } WAVE_32BS;
 
+// sample formats for FillBufferEx
+#define SMPFMT_S16	0x00	// WAVE_16BS
+#define SMPFMT_S32	0x01	// interleaved INT32, full scale is 16-bit << 16
+#define SMPFMT_F32	0x02	// interleaved float, full scale is 1.0 (not clipped)
+
+// time spent in the stages of FillBuffer in nanoseconds, collected if RenderProfile is on
+// ChipUpdate and Resample add up the time of all render threads.
+typedef struct render_profile
+{
+	UINT64 Interpret;	// processing the VGM commands
+	UINT64 ChipUpdate;	// rendering the chips
+	UINT64 Resample;	// resampling the chip output to the output rate
+	UINT64 Mix;	// mixing the chips and converting the mix to the output format
+	UINT64 Total;	// whole FillBuffer calls
+	UINT64 Samples;	// samples rendered
+} RENDER_PROFILE;
+
+// counters of a single chip since the song started (see GetChipStats)
+typedef struct chip_stats
+{
+	UINT8 ChipType;
+	UINT8 ChipID;
+	UINT32 Writes;	// register and memory writes
+	UINT64 Samples;	// samples rendered by the core at its own rate
+	UINT64 Frames;	// output samples of the resampler (0 if the chip runs at the output rate)
+	UINT64 UpdateTime;	// ns, only with RenderProfile
+	UINT64 ResampleTime;	// ns, only with RenderProfile
+} CHIP_STATS;
+
 typedef struct vgm_file VGM_FILE;
 struct vgm_file
 {
@@ -40,6 +69,8 @@ UINT32 GetGZFileLength(const char* FileName);
 
 bool OpenVGMFile(void* vgmp, const char* FileName);
 bool OpenVGMFile_Handle(void* vgmp, VGM_FILE*);
+bool OpenVGMFile_Mapped(void* vgmp, const char* FileName);
+bool OpenVGMFile_Stream(void* vgmp, const char* FileName);
 void CloseVGMFile(void* vgmp);
 
 void FreeGD3Tag(GD3_TAG* TagData);
@@ -68,11 +99,22 @@ void PlayVGM(void* vgmp);
 void StopVGM(void* vgmp);
 void RestartVGM(void* vgmp);
 void SeekVGM(void* vgmp, bool Relative, INT32 PlayBkSamples);
+void BuildSeekIndex(void* vgmp);
 void RefreshMuting(void* vgmp);
 void RefreshPanning(void* vgmp);
 void RefreshPlaybackOptions(void* vgmp);
+bool CanPlayConcurrently(void* vgmp);
 
 UINT32 FillBuffer(void* vgmp, WAVE_16BS* Buffer, UINT32 BufferSize);
+UINT32 FillBufferStems(void* vgmp, WAVE_16BS* Buffer, WAVE_16BS** StemBufs, UINT32 BufferSize);
+UINT32 FillBufferEx(void* vgmp, void* Buffer, UINT8 Format, UINT32 BufferSize);
+UINT32 FillBufferMulti(void* vgmp, void* Buffer, UINT8 Format, UINT32 BufferSize);
+UINT8 GetOutputChannels(void* vgmp);
+UINT32 GetStemCount(void* vgmp);
+bool GetStemInfo(void* vgmp, UINT32 Stem, UINT8* ChipType, UINT8* ChipID, UINT8* Channel);
+void GetRenderProfile(void* vgmp, RENDER_PROFILE* RetProfile);
+UINT32 GetChipStats(void* vgmp, CHIP_STATS* RetStats, UINT32 MaxChips);
+bool LoadCoreProfile(void* vgmp, const char* FileName);
     
 #ifdef __cplusplus
 }
@@ -236,6 +236,46 @@ void ym2413_w(void *_info, offs_t offset, UINT8 data)
 	}
 }
 
+#ifdef ENABLE_ALL_CORES
+static void ym2413_reg_w_mame(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2413_write(chip, 0x00, Offset);
+	ym2413_write(chip, 0x01, Data);
+}
+
+static void ym2413_reg_w_nuked(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	NukedOPLLWrapper_write(chip, 0x00, Offset);
+	NukedOPLLWrapper_write(chip, 0x01, Data);
+}
+#endif
+
+static void ym2413_reg_w_emu2413(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	OPLL_writeIO(chip, 0x00, Offset);
+	OPLL_writeIO(chip, 0x01, Data);
+}
+
+REGW_CALLBACK ym2413_get_reg_write(void *_info, void **RetChip)
+{
+	// returns a function that writes a register straight to the core (for chip_reg_write)
+	ym2413_state *info = (ym2413_state *)_info;
+	*RetChip = info->chip;
+	switch(info->EMU_CORE)
+	{
+#ifdef ENABLE_ALL_CORES
+	case EC_MAME:
+		return &ym2413_reg_w_mame;
+	case EC_NUKED:
+		return &ym2413_reg_w_nuked;
+#endif
+	case EC_EMU2413:
+		return &ym2413_reg_w_emu2413;
+	}
+
+	return NULL;
+}
+
 //WRITE8_DEVICE_HANDLER( ym2413_register_port_w )
 void ym2413_register_port_w(void *_info, offs_t offset, UINT8 data)
 {
@@ -15,6 +15,7 @@ void device_stop_ym2413(void *chip);
 void device_reset_ym2413(void *chip);
 
 void ym2413_w(void *chip, offs_t offset, UINT8 data);
+REGW_CALLBACK ym2413_get_reg_write(void *chip, void **RetChip);
 void ym2413_register_port_w(void *chip, offs_t offset, UINT8 data);
 void ym2413_data_port_w(void *chip, offs_t offset, UINT8 data);
 
@@ -29,6 +29,8 @@
 #define EC_NUKED	0x02	// Nuked OPN2 via wrapepr
 #endif
 
+#define GENS_BUF_SIZE	0x80	// samples per channel of the Gens render buffer
+
 typedef struct _ym2612_state ym2612_state;
 struct _ym2612_state
 {
@@ -58,13 +60,20 @@ void ym2612_stream_update(void *_info, stream_sample_t **outputs, int samples)
 		break;
 #ifdef ENABLE_ALL_CORES
 	case EC_GENS:
-		YM2612_ClearBuffer(info->GensBuf, samples);
-		YM2612_Update(info->chip, info->GensBuf, samples);
-		YM2612_DacAndTimers_Update(info->chip, info->GensBuf, samples);
-		for (int i = 0x00; i < samples; i ++)
+		// render in pieces that fit into the buffer
+		for (int pos = 0x00; pos < samples; pos += GENS_BUF_SIZE)
 		{
-			outputs[0x00][i] = info->GensBuf[0x00][i];
-			outputs[0x01][i] = info->GensBuf[0x01][i];
+			int len = samples - pos;
+			if (len > GENS_BUF_SIZE)
+				len = GENS_BUF_SIZE;
+			YM2612_ClearBuffer(info->GensBuf, len);
+			YM2612_Update(info->chip, info->GensBuf, len);
+			YM2612_DacAndTimers_Update(info->chip, info->GensBuf, len);
+			for (int i = 0x00; i < len; i ++)
+			{
+				outputs[0x00][pos + i] = info->GensBuf[0x00][i];
+				outputs[0x01][pos + i] = info->GensBuf[0x01][i];
+			}
 		}
 		break;
 	case EC_NUKED:
@@ -104,8 +113,8 @@ int device_start_ym2612(void **_info, int EMU_CORE, int ChipFlags, int clock, in
 	case EC_GENS:
 		if (info->GensBuf[0x00] == NULL)
 		{
-			info->GensBuf[0x00] = malloc(sizeof(int) * 0x100);
-			info->GensBuf[0x01] = info->GensBuf[0x00] + 0x80;
+			info->GensBuf[0x00] = malloc(sizeof(int) * GENS_BUF_SIZE * 2);
+			info->GensBuf[0x01] = info->GensBuf[0x00] + GENS_BUF_SIZE;
 		}
 		info->chip = YM2612_Init(clock, rate, 0x00);
 		YM2612_SetMute(info->chip, 0x80);	// Disable SSG-EG
@@ -172,6 +181,44 @@ void device_reset_ym2612(void *_info)
 	}
 }
 
+UINT32 device_save_state_ym2612(void *_info, void *Buffer)
+{
+	// returns 0 if the core can't save its state (Nuked: not at this moment)
+	ym2612_state *info = (ym2612_state *)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return ym2612_save_state(info->chip, Buffer);
+#ifdef ENABLE_ALL_CORES
+	case EC_GENS:
+		return YM2612_SaveState(info->chip, Buffer);
+	case EC_NUKED:
+		return NukedOPN2Wrapper_save_state(info->chip, Buffer);
+#endif
+	}
+
+	return 0;
+}
+
+void device_load_state_ym2612(void *_info, const void *Buffer)
+{
+	ym2612_state *info = (ym2612_state *)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		ym2612_load_state(info->chip, Buffer);
+		break;
+#ifdef ENABLE_ALL_CORES
+	case EC_GENS:
+		YM2612_LoadState(info->chip, Buffer);
+		break;
+	case EC_NUKED:
+		NukedOPN2Wrapper_load_state(info->chip, Buffer);
+		break;
+#endif
+	}
+}
+
 void ym2612_w(void *_info, offs_t offset, UINT8 data)
 {
 	//ym2612_state *info = get_safe_token(device);
@@ -192,6 +239,59 @@ void ym2612_w(void *_info, offs_t offset, UINT8 data)
 	}
 }
 
+static void ym2612_reg_w_mame(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym2612_write(chip, (Port & 0x01) << 1 | 0x00, Offset);
+	ym2612_write(chip, (Port & 0x01) << 1 | 0x01, Data);
+}
+
+#ifdef ENABLE_ALL_CORES
+static void ym2612_reg_w_gens(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	YM2612_Write(chip, (Port & 0x01) << 1 | 0x00, Offset);
+	YM2612_Write(chip, (Port & 0x01) << 1 | 0x01, Data);
+}
+
+static void ym2612_reg_w_nuked(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	NukedOPN2Wrapper_write(chip, (Port & 0x01) << 1 | 0x00, Offset);
+	NukedOPN2Wrapper_write(chip, (Port & 0x01) << 1 | 0x01, Data);
+}
+#endif
+
+REGW_CALLBACK ym2612_get_reg_write(void *_info, void **RetChip)
+{
+	// returns a function that writes a register straight to the core (for chip_reg_write)
+	ym2612_state *info = (ym2612_state *)_info;
+	*RetChip = info->chip;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return &ym2612_reg_w_mame;
+#ifdef ENABLE_ALL_CORES
+	case EC_GENS:
+		return &ym2612_reg_w_gens;
+	case EC_NUKED:
+		return &ym2612_reg_w_nuked;
+#endif
+	}
+
+	return NULL;
+}
+
+UINT8 ym2612_set_voice_output(void *_info, stream_sample_t **VoiceOut)
+{
+	// returns the number of channels written to VoiceOut (0 - not supported)
+	ym2612_state *info = (ym2612_state *)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return ym2612_set_voiceout(info->chip, VoiceOut);
+	}
+
+	return 0;
+}
+
 void ym2612_set_mute_mask(void *_info, UINT32 MuteMask)
 {
 	ym2612_state *info = (ym2612_state *)_info;
@@ -6,11 +6,15 @@ void ym2612_stream_update(void *chip, stream_sample_t **outputs, int samples);
 int device_start_ym2612(void **chip, int core, int options, int clock, int CHIP_SAMPLING_MODE, int CHIP_SAMPLE_RATE, UINT8 * IsVGMInit);
 void device_stop_ym2612(void *chip);
 void device_reset_ym2612(void *chip);
+UINT32 device_save_state_ym2612(void *chip, void *Buffer);
+void device_load_state_ym2612(void *chip, const void *Buffer);
 
 void ym2612_w(void *chip, offs_t offset, UINT8 data);
+REGW_CALLBACK ym2612_get_reg_write(void *chip, void **RetChip);
 
 
 void ym2612_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT8 ym2612_set_voice_output(void *chip, stream_sample_t **VoiceOut);
 
 
 /*typedef struct _ym3438_interface ym3438_interface;
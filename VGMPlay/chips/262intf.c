@@ -252,6 +252,38 @@ void ymf262_w(void *_info, offs_t offset, UINT8 data)
 	}
 }
 
+#ifdef ENABLE_ALL_CORES
+static void ymf262_reg_w_mame(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ymf262_write(chip, (Port & 0x01) << 1 | 0x00, Offset);
+	ymf262_write(chip, (Port & 0x01) << 1 | 0x01, Data);
+}
+#endif
+
+static void ymf262_reg_w_dbopl(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	adlib_OPL3_writeIO(chip, (Port & 0x01) << 1 | 0x00, Offset);
+	adlib_OPL3_writeIO(chip, (Port & 0x01) << 1 | 0x01, Data);
+}
+
+REGW_CALLBACK ymf262_get_reg_write(void *_info, void **RetChip)
+{
+	// returns a function that writes a register straight to the core (for chip_reg_write)
+	ymf262_state *info = (ymf262_state *)_info;
+	*RetChip = info->chip;
+	switch(info->EMU_CORE)
+	{
+#ifdef ENABLE_ALL_CORES
+	case EC_MAME:
+		return &ymf262_reg_w_mame;
+#endif
+	case EC_DBOPL:
+		return &ymf262_reg_w_dbopl;
+	}
+
+	return NULL;
+}
+
 //READ8_DEVICE_HANDLER ( ymf262_status_r )
 UINT8 ymf262_status_r(void *info, offs_t offset)
 {
@@ -30,6 +30,7 @@ void device_reset_ymf262(void *chip);
 
 UINT8 ymf262_r(void *chip, offs_t offset);
 void ymf262_w(void *chip, offs_t offset, UINT8 data);
+REGW_CALLBACK ymf262_get_reg_write(void *chip, void **RetChip);
 
 UINT8 ymf262_status_r(void *chip, offs_t offset);
 void ymf262_register_a_w(void *chip, offs_t offset, UINT8 data);
@@ -269,6 +269,38 @@ void ym3812_w(void *_info, offs_t offset, UINT8 data)
 	}
 }
 
+#ifdef ENABLE_ALL_CORES
+static void ym3812_reg_w_mame(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	ym3812_write(chip, 0x00, Offset);
+	ym3812_write(chip, 0x01, Data);
+}
+#endif
+
+static void ym3812_reg_w_dbopl(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	adlib_OPL2_writeIO(chip, 0x00, Offset);
+	adlib_OPL2_writeIO(chip, 0x01, Data);
+}
+
+REGW_CALLBACK ym3812_get_reg_write(void *_info, void **RetChip)
+{
+	// returns a function that writes a register straight to the core (for chip_reg_write)
+	ym3812_state *info = (ym3812_state *)_info;
+	*RetChip = info->chip;
+	switch(info->EMU_CORE)
+	{
+#ifdef ENABLE_ALL_CORES
+	case EC_MAME:
+		return &ym3812_reg_w_mame;
+#endif
+	case EC_DBOPL:
+		return &ym3812_reg_w_dbopl;
+	}
+
+	return NULL;
+}
+
 //READ8_DEVICE_HANDLER( ym3812_status_port_r )
 UINT8 ym3812_status_port_r(void *info, offs_t offset)
 {
@@ -25,6 +25,7 @@ void device_reset_ym3812(void *chip);
 
 UINT8 ym3812_r(void *chip, offs_t offset);
 void ym3812_w(void *chip, offs_t offset, UINT8 data);
+REGW_CALLBACK ym3812_get_reg_write(void *chip, void **RetChip);
 
 UINT8 ym3812_status_port_r(void *chip, offs_t offset);
 UINT8 ym3812_read_port_r(void *chip, offs_t offset);
@@ -5,9 +5,20 @@ extern "C"
 }
 
 #include <queue>
+#include <cstring>
 
 class NukedOPN2Wrapper
 {
+	// A saved state holds the chip and the register writes that are still waiting for it.
+	static const uint32_t kMaxSavedWrites = 0x100;
+	struct saved_state
+	{
+		ym3438_t chip;
+		uint32_t write_count;
+		uint32_t write_address[kMaxSavedWrites];
+		uint8_t write_data[kMaxSavedWrites];
+	};
+
 	ym3438_t chip_;
 	uint32_t mute_mask_{0};
 	std::queue<std::pair<uint32_t, uint8_t>> buffered_writes_;
@@ -84,6 +95,36 @@ public:
 	{
 		mute_mask_ = mute_mask;
 	}
+
+	// Returns the size of a saved state, or 0 if too many writes are pending to save one now.
+	uint32_t save_state(void* buffer) const
+	{
+		if (buffer == nullptr)
+			return sizeof(saved_state);
+		if (buffered_writes_.size() > kMaxSavedWrites)
+			return 0;
+
+		saved_state* state = static_cast<saved_state*>(buffer);
+		std::queue<std::pair<uint32_t, uint8_t>> writes = buffered_writes_;
+		memcpy(&state->chip, &chip_, sizeof(ym3438_t));
+		state->write_count = 0;
+		for (; !writes.empty(); writes.pop(), ++state->write_count)
+		{
+			state->write_address[state->write_count] = writes.front().first;
+			state->write_data[state->write_count] = writes.front().second;
+		}
+		return sizeof(saved_state);
+	}
+
+	// Restores a state that was saved from the same chip (the mute mask is kept).
+	void load_state(const void* buffer)
+	{
+		const saved_state* state = static_cast<const saved_state*>(buffer);
+		memcpy(&chip_, &state->chip, sizeof(ym3438_t));
+		buffered_writes_ = std::queue<std::pair<uint32_t, uint8_t>>();
+		for (uint32_t i = 0; i < state->write_count; ++i)
+			buffered_writes_.emplace(state->write_address[i], state->write_data[i]);
+	}
 };
 
 extern "C"
@@ -117,4 +158,14 @@ extern "C"
 	{
 		static_cast<NukedOPN2Wrapper*>(chip)->stream_update(outputs, samples);
 	}
+
+	uint32_t NukedOPN2Wrapper_save_state(void* chip, void* buffer)
+	{
+		return static_cast<NukedOPN2Wrapper*>(chip)->save_state(buffer);
+	}
+
+	void NukedOPN2Wrapper_load_state(void* chip, const void* buffer)
+	{
+		static_cast<NukedOPN2Wrapper*>(chip)->load_state(buffer);
+	}
 }
@@ -10,4 +10,6 @@ void NukedOPN2Wrapper_reset(void* chip);
 void NukedOPN2Wrapper_set_mute_mask(void* chip, uint32_t mask);
 void NukedOPN2Wrapper_write(void* chip, uint32_t offset, uint8_t data);
 void NukedOPN2Wrapper_stream_update(void* chip, stream_sample_t **outputs, int samples);
+uint32_t NukedOPN2Wrapper_save_state(void* chip, void* buffer);
+void NukedOPN2Wrapper_load_state(void* chip, const void* buffer);
 
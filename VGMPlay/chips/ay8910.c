@@ -242,7 +242,6 @@ struct _ay8910_context
 //static ay8910_context AY8910Data[MAX_CHIPS];
 
 #define MAX_UPDATE_LEN	0x10	// in samples
-static stream_sample_t AYBuf[NUM_CHANNELS][MAX_UPDATE_LEN];
 
 
 /*INLINE ay8910_context *get_safe_token(const device_config *device)
@@ -644,24 +643,16 @@ static void ay8910_write_reg(ay8910_context *psg, int r, int v)
 	return;
 }*/
 
-void ay8910_update_one(void *param, stream_sample_t **outputs, int samples)
+// renders up to MAX_UPDATE_LEN samples
+static void ay8910_update_block(ay8910_context *psg, stream_sample_t *bufL, stream_sample_t *bufR, int samples)
 {
-	ay8910_context *psg = (ay8910_context *)param;
+	stream_sample_t AYBuf[NUM_CHANNELS][MAX_UPDATE_LEN];
 	stream_sample_t *buf[NUM_CHANNELS];
 	int chan;
 	int cursmpl;
 	int buf_smpls;
-	stream_sample_t *bufL = outputs[0];
-	stream_sample_t *bufR = outputs[1];
 	//stream_sample_t bufSmpl;
 	
-	memset(outputs[0], 0x00, samples * sizeof(stream_sample_t));
-	memset(outputs[1], 0x00, samples * sizeof(stream_sample_t));
-	
-	// Speed hack for OPN chips (YM2203, YM26xx), that have an often unused AY8910
-	if (psg->IsDisabled)
-		return;
-	
 	buf_smpls = samples;
 	//buf[0] = outputs[0];
 	buf[0] = AYBuf[0];
@@ -824,6 +815,28 @@ void ay8910_update_one(void *param, stream_sample_t **outputs, int samples)
 	}
 }
 
+void ay8910_update_one(void *param, stream_sample_t **outputs, int samples)
+{
+	ay8910_context *psg = (ay8910_context *)param;
+	int cursmpl;
+	int blk_smpls;
+	
+	memset(outputs[0], 0x00, samples * sizeof(stream_sample_t));
+	memset(outputs[1], 0x00, samples * sizeof(stream_sample_t));
+	
+	// Speed hack for OPN chips (YM2203, YM26xx), that have an often unused AY8910
+	if (psg->IsDisabled)
+		return;
+	
+	for (cursmpl = 0; cursmpl < samples; cursmpl += blk_smpls)
+	{
+		blk_smpls = samples - cursmpl;
+		if (blk_smpls > MAX_UPDATE_LEN)
+			blk_smpls = MAX_UPDATE_LEN;
+		ay8910_update_block(psg, &outputs[0][cursmpl], &outputs[1][cursmpl], blk_smpls);
+	}
+}
+
 static void build_mixer_table(ay8910_context *psg)
 {
 	int	normalize = 0;
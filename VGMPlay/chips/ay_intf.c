@@ -13,6 +13,7 @@
 #include "ay8910.h"		// must be always included (for YM2149_PIN26_LOW)
 #include "emu2149.h"
 #include "ay_intf.h"
+#include "blip.h"
 
 
 #ifdef ENABLE_ALL_CORES
@@ -27,11 +28,75 @@ struct _ayxx_state
 {
 	void *chip;
 	int EMU_CORE;
+	
+	UINT8 StepSynth;	// render band-limited steps at the output rate (see blip.h)
+	INT32 StepLevel[2];
+	BLIP_BUF Blip[2];
 };
 
+static void ayxx_add_steps(ayxx_state *info, UINT32 Time, const e_int32 *Out, UINT8 Write)
+{
+	UINT8 CurChn;
+	
+	for (CurChn = 0; CurChn < 2; CurChn ++)
+	{
+		if (Out[CurChn] != info->StepLevel[CurChn])
+		{
+			if (Write)
+				blip_add_write_delta(&info->Blip[CurChn], Out[CurChn] - info->StepLevel[CurChn]);
+			else
+				blip_add_delta(&info->Blip[CurChn], Time, Out[CurChn] - info->StepLevel[CurChn]);
+			info->StepLevel[CurChn] = Out[CurChn];
+		}
+	}
+	
+	return;
+}
+
+static void ayxx_update_steps(ayxx_state *info, stream_sample_t **outputs, int samples)
+{
+	// The EMU2149 jumps from one tick that can change the output to the next one
+	// and the changes become band-limited steps at the output rate.
+	PSG *psg = (PSG*)info->chip;
+	stream_sample_t *bufL = outputs[0];
+	stream_sample_t *bufR = outputs[1];
+	e_int32 Out[2];
+	UINT32 Clocks;
+	UINT32 Time;
+	UINT32 Ticks;
+	int Frame;
+	
+	while (samples > 0)
+	{
+		Frame = (samples > BLIP_MAX_FRAME) ? BLIP_MAX_FRAME : samples;
+		Clocks = blip_clocks_needed(&info->Blip[0], Frame);
+		PSG_advance(psg, 0, Out);
+		ayxx_add_steps(info, 0, Out, 0x01);	// register writes since the last update
+		for (Time = 0; Time < Clocks; Time += Ticks)
+		{
+			Ticks = PSG_advance(psg, Clocks - Time, Out);
+			ayxx_add_steps(info, Time + Ticks - 1, Out, 0x00);
+		}
+		blip_end_frame(&info->Blip[0], Clocks);
+		blip_end_frame(&info->Blip[1], Clocks);
+		blip_read_samples(&info->Blip[0], bufL, Frame);
+		blip_read_samples(&info->Blip[1], bufR, Frame);
+		bufL += Frame;
+		bufR += Frame;
+		samples -= Frame;
+	}
+	
+	return;
+}
+
 void ayxx_stream_update(void *_info, stream_sample_t **outputs, int samples)
 {
 	ayxx_state *info = (ayxx_state *)_info;
+	if (info->StepSynth)
+	{
+		ayxx_update_steps(info, outputs, samples);
+		return;
+	}
 	switch(info->EMU_CORE)
 	{
 #ifdef ENABLE_ALL_CORES
@@ -122,6 +187,9 @@ void device_reset_ayxx(void *_info)
 		PSG_reset((PSG*)info->chip);
 		break;
 	}
+	info->StepLevel[0] = info->StepLevel[1] = 0;
+	blip_clear(&info->Blip[0]);
+	blip_clear(&info->Blip[1]);
 }
 
 
@@ -158,3 +226,23 @@ void ayxx_set_mute_mask(void *_info, UINT32 MuteMask)
 	
 	return;
 }
+
+UINT32 ayxx_set_step_synth(void *_info, UINT32 SampleRate)
+{
+	// returns the new sample rate of the chip (0 - not supported)
+	ayxx_state *info = (ayxx_state *)_info;
+	PSG *psg;
+	
+	if (info->EMU_CORE != EC_EMU2149)
+		return 0;
+	psg = (PSG*)info->chip;
+	if (psg->clk < 8)
+		return 0;
+	info->StepSynth = 0x01;
+	info->StepLevel[0] = info->StepLevel[1] = 0;
+	// EMU2149 ticks at clock / 8, PSG_new already got the halved clock for PIN26_LOW
+	blip_init(&info->Blip[0], psg->clk / 8, SampleRate);
+	blip_init(&info->Blip[1], psg->clk / 8, SampleRate);
+	
+	return SampleRate;
+}
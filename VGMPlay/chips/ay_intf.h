@@ -9,3 +9,4 @@ void device_reset_ayxx(void *chip);
 void ayxx_w(void *chip, offs_t offset, UINT8 data);
 
 void ayxx_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 ayxx_set_step_synth(void *chip, UINT32 SampleRate);
@@ -0,0 +1,184 @@
+// blip.c: band-limited step synthesis
+//
+// A delta is spread over BLIP_WIDTH output samples with a windowed sinc impulse
+// and the output is the running sum of the buffer. Every phase of the kernel sums
+// up to exactly 1 << BLIP_KERNEL_BITS, so the sum always settles on the exact
+// level and there is no drift.
+
+#include <math.h>
+#include <string.h>
+#include "mamedef.h"
+#include "run_once.h"
+#include "blip.h"
+
+#define BLIP_PHASE_BITS		6
+#define BLIP_PHASES			(1 << BLIP_PHASE_BITS)
+#define BLIP_KERNEL_BITS	12	// leaves room for deltas of the full 16-bit range
+#define BLIP_CUTOFF			0.90	// of the Nyquist frequency
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+static INT16 BlipKernel[BLIP_PHASES][BLIP_WIDTH];
+static run_once_t BlipKernelOnce = RUN_ONCE_INIT;
+
+static void blip_make_kernel(void)
+{
+	double Taps[BLIP_WIDTH];
+	double Sum;
+	double Pos;
+	INT32 IntSum;
+	int Phase;
+	int CurTap;
+	int MaxTap;
+
+	for (Phase = 0; Phase < BLIP_PHASES; Phase ++)
+	{
+		// The step happens Phase / BLIP_PHASES after the first sample, the impulse
+		// is centered BLIP_WIDTH / 2 samples later.
+		Sum = 0.0;
+		for (CurTap = 0; CurTap < BLIP_WIDTH; CurTap ++)
+		{
+			Pos = CurTap - BLIP_WIDTH / 2 - (double)Phase / BLIP_PHASES;
+			Taps[CurTap] = (Pos == 0.0) ? 1.0 : sin(PI * BLIP_CUTOFF * Pos) / (PI * BLIP_CUTOFF * Pos);
+			// Blackman window over the whole kernel
+			Pos = (Pos + BLIP_WIDTH / 2) / BLIP_WIDTH;
+			Taps[CurTap] *= 0.42 - 0.5 * cos(2 * PI * Pos) + 0.08 * cos(4 * PI * Pos);
+			Sum += Taps[CurTap];
+		}
+
+		IntSum = 0;
+		MaxTap = 0;
+		for (CurTap = 0; CurTap < BLIP_WIDTH; CurTap ++)
+		{
+			BlipKernel[Phase][CurTap] = (INT16)floor(Taps[CurTap] / Sum * (1 << BLIP_KERNEL_BITS) + 0.5);
+			IntSum += BlipKernel[Phase][CurTap];
+			if (BlipKernel[Phase][CurTap] > BlipKernel[Phase][MaxTap])
+				MaxTap = CurTap;
+		}
+		// the rounding error goes to the largest tap
+		BlipKernel[Phase][MaxTap] += (1 << BLIP_KERNEL_BITS) - IntSum;
+	}
+
+	return;
+}
+
+void blip_init(BLIP_BUF* bb, UINT32 ClockRate, UINT32 SampleRate)
+{
+	run_once(&BlipKernelOnce, &blip_make_kernel);
+
+	bb->Factor = ((UINT64)SampleRate << 32) / ClockRate;
+	blip_clear(bb);
+
+	return;
+}
+
+void blip_clear(BLIP_BUF* bb)
+{
+	// A step reaches half of its height between the taps BLIP_WIDTH / 2 - 1 and
+	// BLIP_WIDTH / 2. The first read drops BLIP_DELAY samples, so the clocks run
+	// that far ahead of the output and the steps line up with the resampled output
+	// of the cores' native rate.
+	bb->Offset = 0;
+	bb->Integrator = 0;
+	bb->Skip = BLIP_DELAY;
+	memset(bb->Buf, 0x00, sizeof(bb->Buf));
+
+	return;
+}
+
+UINT32 blip_clocks_needed(const BLIP_BUF* bb, UINT32 Samples)
+{
+	// the smallest number of clocks that completes the samples
+	UINT64 Needed;
+
+	Needed = (UINT64)(Samples + bb->Skip) << 32;
+	if (bb->Offset >= Needed)
+		return 0;
+	return (UINT32)((Needed - bb->Offset + bb->Factor - 1) / bb->Factor);
+}
+
+void blip_add_delta(BLIP_BUF* bb, UINT32 Time, INT32 Delta)
+{
+	UINT64 Pos;
+	const INT16* Kernel;
+	INT32* Out;
+	int CurTap;
+
+	Pos = bb->Offset + Time * bb->Factor;
+	Kernel = BlipKernel[(Pos >> (32 - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1)];
+	Out = &bb->Buf[Pos >> 32];
+	for (CurTap = 0; CurTap < BLIP_WIDTH; CurTap ++)
+		Out[CurTap] += Delta * Kernel[CurTap];
+
+	return;
+}
+
+void blip_add_write_delta(BLIP_BUF* bb, INT32 Delta)
+{
+	// The clocks run BLIP_DELAY samples ahead of the output, so a delta at Time 0
+	// would play that much after the write. Instead the step goes between the next
+	// sample that will be read and the one after it. The taps before that can't be
+	// played any more and are added to the next sample.
+	const INT16* Kernel;
+	INT32 Early;
+	int Start;
+	int CurTap;
+
+	Kernel = BlipKernel[0];
+	Start = (int)bb->Skip - BLIP_DELAY;
+	Early = 0;
+	for (CurTap = 0; CurTap < BLIP_WIDTH && Start + CurTap <= 0; CurTap ++)
+		Early += Kernel[CurTap];
+	bb->Buf[0] += Delta * Early;
+	for (; CurTap < BLIP_WIDTH; CurTap ++)
+		bb->Buf[Start + CurTap] += Delta * Kernel[CurTap];
+
+	return;
+}
+
+void blip_end_frame(BLIP_BUF* bb, UINT32 Clocks)
+{
+	bb->Offset += Clocks * bb->Factor;
+
+	return;
+}
+
+static void blip_remove_samples(BLIP_BUF* bb, UINT32 Samples)
+{
+	// move the rest of the kernels to the start
+	UINT32 Remain;
+
+	Remain = (UINT32)(bb->Offset >> 32) - Samples + BLIP_WIDTH;
+	memmove(&bb->Buf[0], &bb->Buf[Samples], Remain * sizeof(INT32));
+	memset(&bb->Buf[Remain], 0x00, Samples * sizeof(INT32));
+	bb->Offset -= (UINT64)Samples << 32;
+
+	return;
+}
+
+void blip_read_samples(BLIP_BUF* bb, stream_sample_t* Buffer, UINT32 Samples)
+{
+	// Samples must not be more than the frame completed.
+	INT32 Sum;
+	UINT32 CurSmpl;
+
+	Sum = bb->Integrator;
+	if (bb->Skip)
+	{
+		for (CurSmpl = 0; CurSmpl < bb->Skip; CurSmpl ++)
+			Sum += bb->Buf[CurSmpl];
+		blip_remove_samples(bb, bb->Skip);
+		bb->Skip = 0;
+	}
+	for (CurSmpl = 0; CurSmpl < Samples; CurSmpl ++)
+	{
+		Sum += bb->Buf[CurSmpl];
+		Buffer[CurSmpl] = Sum >> BLIP_KERNEL_BITS;
+	}
+	bb->Integrator = Sum;
+	blip_remove_samples(bb, Samples);
+
+	return;
+}
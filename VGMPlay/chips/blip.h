@@ -0,0 +1,48 @@
+#ifndef __BLIP_H__
+#define __BLIP_H__
+
+// blip.h: band-limited step synthesis
+//
+// Square, noise and wavetable chips only change their output at a few points in
+// time. Instead of rendering every tick of the chip and resampling the result,
+// a core can add the amplitude changes (deltas) at their exact clock time to a
+// BLIP_BUF, which turns them into band-limited steps at the output sample rate.
+// The buffer is part of the chip state, so saving the state saves it as well.
+// (include mamedef.h first)
+//
+// Usage for each frame of at most BLIP_MAX_FRAME samples:
+//	Clocks = blip_clocks_needed(bb, Samples);
+//	blip_add_delta(bb, Time, Delta);	// for every change, Time < Clocks
+//	blip_end_frame(bb, Clocks);
+//	blip_read_samples(bb, Buffer, Samples);
+// Level changes of register writes since the last read go in with
+// blip_add_write_delta before the frame, so they don't get the delay of the kernel.
+//
+// Used by the SN76496 (MAME core), AY8910 (EMU2149 core), K051649 and Pokey.
+// Still to do: the NES APU, which runs at clock / 4 (447 kHz) in both cores.
+// Not needed: the HuC6280 Ootake core and the SAA1099 (clock / 256) already run
+// at or below the output rate. Only the MAME HuC6280 core (ENABLE_ALL_CORES) runs
+// at clock / 16.
+
+#define BLIP_MAX_FRAME	0x100	// output samples per frame
+#define BLIP_WIDTH		16		// taps of the step kernel, centered on BLIP_WIDTH / 2
+#define BLIP_DELAY		(BLIP_WIDTH / 2 - 1)	// delay of the kernel in output samples, blip_clear removes it
+
+typedef struct _blip_buffer
+{
+	UINT64 Factor;		// output samples per clock, 32.32 fixed point
+	UINT64 Offset;		// time of the frame start in output samples, 32.32 fixed point
+	INT32 Integrator;	// current output level, scaled like the kernel
+	UINT32 Skip;		// samples to drop before the next read (see blip_clear)
+	INT32 Buf[BLIP_MAX_FRAME + 1 + BLIP_DELAY + BLIP_WIDTH];	// deltas of the output samples
+} BLIP_BUF;
+
+void blip_init(BLIP_BUF* bb, UINT32 ClockRate, UINT32 SampleRate);
+void blip_clear(BLIP_BUF* bb);
+UINT32 blip_clocks_needed(const BLIP_BUF* bb, UINT32 Samples);
+void blip_add_delta(BLIP_BUF* bb, UINT32 Time, INT32 Delta);
+void blip_add_write_delta(BLIP_BUF* bb, INT32 Delta);
+void blip_end_frame(BLIP_BUF* bb, UINT32 Clocks);
+void blip_read_samples(BLIP_BUF* bb, stream_sample_t* Buffer, UINT32 Samples);
+
+#endif	// __BLIP_H__
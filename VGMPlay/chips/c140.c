@@ -607,6 +607,34 @@ void c140_set_mute_mask(void *_info, UINT32 MuteMask)
 	return;
 }
 
+UINT32 c140_save_state(void *_info, void *Buffer)
+{
+	// copies the chip state to Buffer (or only returns its size, if Buffer is NULL)
+	if (Buffer != NULL)
+		memcpy(Buffer, _info, sizeof(c140_state));
+	
+	return sizeof(c140_state);
+}
+
+void c140_load_state(void *_info, const void *Buffer)
+{
+	// restores a state that was saved from the same chip (ROM, buffers and mute mask are kept)
+	c140_state *info = (c140_state *)_info;
+	c140_state OldState;
+	UINT8 CurChn;
+	
+	OldState = *info;
+	memcpy(info, Buffer, sizeof(c140_state));
+	info->mixer_buffer_left = OldState.mixer_buffer_left;
+	info->mixer_buffer_right = OldState.mixer_buffer_right;
+	info->pRomSize = OldState.pRomSize;
+	info->pRom = OldState.pRom;
+	for (CurChn = 0; CurChn < MAX_VOICE; CurChn ++)
+		info->voi[CurChn].Muted = OldState.voi[CurChn].Muted;
+	
+	return;
+}
+
 
 
 
@@ -32,5 +32,7 @@ void c140_write_rom(void *chip, offs_t ROMSize, offs_t DataStart, offs_t DataLen
 					const UINT8* ROMData);
 
 void c140_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 c140_save_state(void *chip, void *Buffer);
+void c140_load_state(void *chip, const void *Buffer);
 
 //DECLARE_LEGACY_SOUND_DEVICE(C140, c140);
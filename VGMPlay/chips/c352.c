@@ -22,6 +22,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>    // for NULL
+
+// vector versions of the voice mixing (SSE2 is part of x86-64, NEON of ARM64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+
 #include "mamedef.h"
 #include "c352.h"
 
@@ -29,6 +39,7 @@
 #define LOG(x) do { if (VERBOSE) logerror x; } while (0)
 
 #define C352_VOICES 32
+#define C352_BLOCK  256     // samples per voice that are rendered in one go
 enum {
     C352_FLG_BUSY       = 0x8000,   // channel is busy
     C352_FLG_KEYON      = 0x4000,   // Keyon
@@ -75,6 +86,7 @@ typedef struct {
 
     UINT32 rate;
     UINT8 muteRear;
+    UINT8 rearOut;  // rear speakers go to outputs 2/3 instead of being added to the front
 
     C352_Voice v[C352_VOICES];
 
@@ -84,6 +96,7 @@ typedef struct {
     UINT8* wave;
     UINT32 wavesize;
     UINT32 wave_mask;
+    UINT8 wave_ref; // wave ROM is owned by the caller (c352_set_rom)
 
     UINT16 random;
     
@@ -127,7 +140,11 @@ void C352_fetch_sample(C352 *c, int i)
         INT8 s;
         UINT16 pos;
 
-        s = (INT8)c->wave[v->pos&0xffffff];
+        // reads past the end of the ROM return 0
+        if((v->pos&0xffffff) < c->wavesize)
+            s = (INT8)c->wave[v->pos&0xffffff];
+        else
+            s = 0;
 
         if(v->flags & C352_FLG_MULAW)
             v->sample = c->mulaw[(UINT8)s];
@@ -174,7 +191,7 @@ void C352_fetch_sample(C352 *c, int i)
     }
 }
 
-UINT16 C352_update_voice(C352 *c, int i)
+INLINE UINT16 C352_update_voice(C352 *c, int i)
 {
     C352_Voice *v = &c->v[i];
     INT32 temp;
@@ -198,36 +215,152 @@ UINT16 C352_update_voice(C352 *c, int i)
     return temp;
 }
 
+static void C352_render_voice(C352 *c, int i, INT16 *buffer, int samples)
+{
+    int j;
+
+    for(j=0;j<samples;j++)
+    {
+        if((c->v[i].flags & C352_FLG_BUSY) == 0)
+        {
+            // the voice stopped, it stays silent until the next keyon
+            memset(&buffer[j], 0x00, (samples - j) * sizeof(INT16));
+            return;
+        }
+        buffer[j] = (INT16)C352_update_voice(c,i);
+    }
+}
+
+// output += (sample * vol) >> 8, vol is -255..255 (the sign is the phase inversion)
+static void C352_mix_voice(stream_sample_t *output, const INT16 *buffer, INT16 vol, int samples)
+{
+    int j;
+
+    j = 0;
+#if defined(MIX_SSE2)
+    {
+        const __m128i Vol = _mm_set1_epi16(vol);
+        __m128i Smpl;
+        __m128i MulLo;
+        __m128i MulHi;
+
+        for(;j+8<=samples;j+=8)
+        {
+            Smpl = _mm_loadu_si128((const __m128i*)&buffer[j]);
+            MulLo = _mm_mullo_epi16(Smpl, Vol);
+            MulHi = _mm_mulhi_epi16(Smpl, Vol);
+            _mm_storeu_si128((__m128i*)&output[j+0], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&output[j+0]),
+                            _mm_srai_epi32(_mm_unpacklo_epi16(MulLo, MulHi), 8)));
+            _mm_storeu_si128((__m128i*)&output[j+4], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&output[j+4]),
+                            _mm_srai_epi32(_mm_unpackhi_epi16(MulLo, MulHi), 8)));
+        }
+    }
+#elif defined(MIX_NEON)
+    {
+        const int16x4_t Vol = vdup_n_s16(vol);
+        int16x8_t Smpl;
+
+        for(;j+8<=samples;j+=8)
+        {
+            Smpl = vld1q_s16(&buffer[j]);
+            vst1q_s32(&output[j+0], vsraq_n_s32(vld1q_s32(&output[j+0]), vmull_s16(vget_low_s16(Smpl), Vol), 8));
+            vst1q_s32(&output[j+4], vsraq_n_s32(vld1q_s32(&output[j+4]), vmull_s16(vget_high_s16(Smpl), Vol), 8));
+        }
+    }
+#endif
+    for(;j<samples;j++)
+        output[j] += (buffer[j] * vol)>>8;
+}
+
 void c352_update(void *_info, stream_sample_t **outputs, int samples)
 {
     C352 *c = (C352 *) _info;
+    C352_Voice *v;
+    INT16 buffer[C352_BLOCK];
+    INT16 vols[C352_VOICES][4];
+    UINT32 noise_mask;
     int i, j;
+    int done, len;
     INT16 s;
+    stream_sample_t *rear[2];
     memset(outputs[0], 0x00, samples * sizeof(stream_sample_t));
     memset(outputs[1], 0x00, samples * sizeof(stream_sample_t));
+    if (c->rearOut)
+    {
+        rear[0] = outputs[2];
+        rear[1] = outputs[3];
+        memset(rear[0], 0x00, samples * sizeof(stream_sample_t));
+        memset(rear[1], 0x00, samples * sizeof(stream_sample_t));
+    }
+    else
+    {
+        rear[0] = outputs[0];
+        rear[1] = outputs[1];
+    }
+    
+    // Volume per speaker, negative for inverted phase. (-s * vol)>>8 and (s * -vol)>>8
+    // are the same, so this gives the same result as applying the phase to the sample.
+    noise_mask = 0;
+    for(j=0;j<C352_VOICES;j++)
+    {
+        v = &c->v[j];
+        vols[j][0] = (v->flags & C352_FLG_PHASEFL) ? -(v->vol_f>>8) : (v->vol_f>>8);
+        vols[j][1] = (v->flags & C352_FLG_PHASERL) ? -(v->vol_r>>8) : (v->vol_r>>8);
+        vols[j][2] = (v->flags & C352_FLG_PHASEFR) ? -(v->vol_f&0xff) : (v->vol_f&0xff);
+        vols[j][3] = (v->vol_r&0xff);
+        if (c->muteRear)
+            vols[j][1] = vols[j][3] = 0;
+        if((v->flags & C352_FLG_BUSY) && (v->flags & C352_FLG_NOISE))
+            noise_mask |= (1U << j);
+    }
     
-    for(i=0;i<samples;i++)
+    // Voices that play samples are rendered one after another. Noise voices share the
+    // random generator, so they have to advance sample by sample in voice order.
+    for(done=0;done<samples;done+=len)
     {
-        for(j=0;j<32;j++)
+        len = samples - done;
+        if (len > C352_BLOCK)
+            len = C352_BLOCK;
+        
+        for(j=0;j<C352_VOICES;j++)
+        {
+            v = &c->v[j];
+            if((v->flags & C352_FLG_BUSY) == 0 || (noise_mask & (1U << j)))
+                continue;   // idle voices output 0 and don't change
+            
+            C352_render_voice(c,j,buffer,len);
+            if(v->mute)
+                continue;
+            // Left
+            if (vols[j][0])
+                C352_mix_voice(&outputs[0][done], buffer, vols[j][0], len);
+            if (vols[j][1])
+                C352_mix_voice(&rear[0][done], buffer, vols[j][1], len);
+            // Right
+            if (vols[j][2])
+                C352_mix_voice(&outputs[1][done], buffer, vols[j][2], len);
+            if (vols[j][3])
+                C352_mix_voice(&rear[1][done], buffer, vols[j][3], len);
+        }
+        
+        if (! noise_mask)
+            continue;
+        for(i=done;i<done+len;i++)
         {
-            s = C352_update_voice(c,j);
-            if(!c->v[j].mute)
+            for(j=0;j<C352_VOICES;j++)
             {
-                // Left
-                outputs[0][i] += (c->v[j].flags & C352_FLG_PHASEFL) ? (-s * (c->v[j].vol_f>>8)  )>>8
-                                                                  : ( s * (c->v[j].vol_f>>8)  )>>8;
-                if (!c->muteRear)
-                    outputs[0][i] += (c->v[j].flags & C352_FLG_PHASERL) ? (-s * (c->v[j].vol_r>>8)  )>>8
-                                                                      : ( s * (c->v[j].vol_r>>8)  )>>8;
-                 
-                // Right
-                outputs[1][i] += (c->v[j].flags & C352_FLG_PHASEFR) ? (-s * (c->v[j].vol_f&0xff))>>8
-                                                                  : ( s * (c->v[j].vol_f&0xff))>>8;
-                if (!c->muteRear)
-                    outputs[1][i] += ( s * (c->v[j].vol_r&0xff))>>8;
+                if(! (noise_mask & (1U << j)))
+                    continue;
+                s = C352_update_voice(c,j);
+                if(!c->v[j].mute)
+                {
+                    outputs[0][i] += (s * vols[j][0])>>8;
+                    rear[0][i] += (s * vols[j][1])>>8;
+                    outputs[1][i] += (s * vols[j][2])>>8;
+                    rear[1][i] += (s * vols[j][3])>>8;
+                }
             }
         }
-        
     }
 }
 
@@ -238,12 +371,14 @@ int device_start_c352(void **_info, int clock, int clkdiv)
 
     c->wave = NULL;
     c->wavesize = 0x00;
+    c->wave_ref = 0x00;
 
     if(!clkdiv)
         clkdiv = 288;
 
     c->rate = (clock&0x7FFFFFFF)/clkdiv;
     c->muteRear = (clock&0x80000000)>>31;
+    c->rearOut = 0;
 
     memset(c->v,0,sizeof(C352_Voice)*C352_VOICES);
 
@@ -260,7 +395,8 @@ void device_stop_c352(void *_info)
 {
     C352 *c = (C352 *)_info;
     
-    free(c->wave);
+    if (! c->wave_ref)
+        free(c->wave);
     c->wave = NULL;
 
     free(c);
@@ -341,6 +477,14 @@ void c352_write_rom(void *_info, offs_t ROMSize, offs_t DataStart, offs_t DataLe
 {
     C352 *c = (C352 *) _info;
     
+    if (c->wave_ref)
+    {
+        // make a copy of the caller's ROM before modifying it
+        UINT8* ROMCopy = (UINT8*)malloc(c->wavesize);
+        memcpy(ROMCopy, c->wave, c->wavesize);
+        c->wave = ROMCopy;
+        c->wave_ref = 0x00;
+    }
     if (c->wavesize != ROMSize)
     {
         c->wave = (UINT8*)realloc(c->wave, ROMSize);
@@ -357,6 +501,30 @@ void c352_write_rom(void *_info, offs_t ROMSize, offs_t DataStart, offs_t DataLe
     return;
 }
 
+void c352_set_rom(void *_info, offs_t ROMSize, const UINT8* ROMData)
+{
+    // use a complete ROM image in place, it must stay valid until the chip is stopped
+    C352 *c = (C352 *) _info;
+    
+    if (! c->wave_ref)
+        free(c->wave);
+    c->wave = (UINT8*)ROMData;
+    c->wavesize = ROMSize;
+    c->wave_ref = 0x01;
+    
+    return;
+}
+
+// Separate != 0: c352_update writes the rear speakers to outputs[2] and [3]
+void c352_set_rear_output(void *_info, UINT8 Separate)
+{
+    C352 *c = (C352 *) _info;
+    
+    c->rearOut = Separate ? 1 : 0;
+    
+    return;
+}
+
 void c352_set_mute_mask(void *_info, UINT32 MuteMask)
 {
     C352 *c = (C352 *) _info;
@@ -368,3 +536,19 @@ void c352_set_mute_mask(void *_info, UINT32 MuteMask)
     return;
 }
 
+UINT8 c352_is_silent(void *_info)
+{
+    // Voices that aren't busy output nothing and keep their state, the noise
+    // generator only advances while a noise voice is busy.
+    C352 *c = (C352 *) _info;
+    int i;
+    
+    for (i = 0; i < C352_VOICES; i++)
+    {
+        if (c->v[i].flags & C352_FLG_BUSY)
+            return 0x00;
+    }
+    
+    return 0x01;
+}
+
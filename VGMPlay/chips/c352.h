@@ -17,8 +17,11 @@ void c352_w(void *chip, offs_t offset, UINT16 data);
 
 void c352_write_rom(void *chip, offs_t ROMSize, offs_t DataStart, offs_t DataLength,
 					const UINT8* ROMData);
+void c352_set_rom(void *chip, offs_t ROMSize, const UINT8* ROMData);
 
+void c352_set_rear_output(void *chip, UINT8 Separate);
 void c352_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT8 c352_is_silent(void *chip);
 
 //DECLARE_LEGACY_SOUND_DEVICE(C352, c352);
 
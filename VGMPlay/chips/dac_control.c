@@ -17,6 +17,7 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "mamedef.h"
 #include "dac_control.h"
@@ -53,6 +54,8 @@ typedef struct _dac_control
 	UINT32 RealPos;		// true Position in Data (== Pos, if Reverse is off)
 	UINT8 DataStep;		// always StepSize * CmdSize
 
+	REGW_CALLBACK RegWrite;	// write function of the dest-chip (resolved by setup_chip)
+	void* RegWriteParam;
 	void* param;
 	UINT32 SampleRate;
 } dac_control;
@@ -84,13 +87,13 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 		Port = (chip->DstCommand & 0xFF00) >> 8;
 		Command = (chip->DstCommand & 0x00FF) >> 0;
 		Data = ChipData[0x00];
-		chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, Port, Command, Data);
+		chip->RegWrite(chip->RegWriteParam, Port, Command, Data);
 		break;
 	case 0x11:	// PWM (4-bit Register, 12-bit Data)
 		Port = (chip->DstCommand & 0x000F) >> 0;
 		Command = ChipData[0x01] & 0x0F;
 		Data = ChipData[0x00];
-		chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, Port, Command, Data);
+		chip->RegWrite(chip->RegWriteParam, Port, Command, Data);
 		break;
 	// Support for other chips (mainly for completeness)
 	case 0x00:	// SN76496 (4-bit Register, 4-bit/10-bit Data)
@@ -99,14 +102,14 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 		if (Command & 0x10)
 		{
 			// Volume Change (4-Bit value)
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, 0x00, Command | Data);
+			chip->RegWrite(chip->RegWriteParam, 0x00, 0x00, Command | Data);
 		}
 		else
 		{
 			// Frequency Write (10-Bit value)
 			Port = ((ChipData[0x01] & 0x03) << 4) | ((ChipData[0x00] & 0xF0) >> 4);
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, 0x00, Command | Data);
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, 0x00, Port);
+			chip->RegWrite(chip->RegWriteParam, 0x00, 0x00, Command | Data);
+			chip->RegWrite(chip->RegWriteParam, 0x00, 0x00, Port);
 		}
 		break;
 	case 0x18:	// OKIM6295 - TODO: verify
@@ -120,19 +123,19 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 			{
 				// Sample Start
 				// write sample ID
-				chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command, Data);
+				chip->RegWrite(chip->RegWriteParam, 0x00, Command, Data);
 				// write channel(s) that should play the sample
-				chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command, Port << 4);
+				chip->RegWrite(chip->RegWriteParam, 0x00, Command, Port << 4);
 			}
 			else
 			{
 				// Sample Stop
-				chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command, Port << 3);
+				chip->RegWrite(chip->RegWriteParam, 0x00, Command, Port << 3);
 			}
 		}
 		else
 		{
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command, Data);
+			chip->RegWrite(chip->RegWriteParam, 0x00, Command, Data);
 		}
 		break;
 		// Generic support: 8-bit Register, 8-bit Data
@@ -153,7 +156,7 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 	case 0x1E:	// Pokey - TODO: Verify
 		Command = (chip->DstCommand & 0x00FF) >> 0;
 		Data = ChipData[0x00];
-		chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command, Data);
+		chip->RegWrite(chip->RegWriteParam, 0x00, Command, Data);
 		break;
 		// Generic support: 16-bit Register, 8-bit Data
 	case 0x07:	// YM2608
@@ -167,7 +170,7 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 		Port = (chip->DstCommand & 0xFF00) >> 8;
 		Command = (chip->DstCommand & 0x00FF) >> 0;
 		Data = ChipData[0x00];
-		chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, Port, Command, Data);
+		chip->RegWrite(chip->RegWriteParam, Port, Command, Data);
 		break;
 		// Generic support: 8-bit Register with Channel Select, 8-bit Data
 	case 0x05:	// RF5C68
@@ -179,7 +182,7 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 		
 		if (Port == 0xFF)
 		{
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command & 0x0F, Data);
+			chip->RegWrite(chip->RegWriteParam, 0x00, Command & 0x0F, Data);
 		}
 		else
 		{
@@ -195,18 +198,18 @@ INLINE void daccontrol_SendCommand(dac_control *chip)
 				prevChn = chip_reg_read(chip->param, 0x1B, chip->DstChipID, 0x00, 0x00);
 			
 			// Send Channel Select
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command >> 4, Port);
+			chip->RegWrite(chip->RegWriteParam, 0x00, Command >> 4, Port);
 			// Send Data
-			chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command & 0x0F, Data);
+			chip->RegWrite(chip->RegWriteParam, 0x00, Command & 0x0F, Data);
 			// restore old channel
 			if (prevChn != Port)
-				chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, 0x00, Command >> 4, prevChn);
+				chip->RegWrite(chip->RegWriteParam, 0x00, Command >> 4, prevChn);
 		}
 		break;
 		// Generic support: 8-bit Register, 16-bit Data
 	case 0x1F:	// QSound
 		Command = (chip->DstCommand & 0x00FF) >> 0;
-		chip_reg_write(chip->param, chip->DstChipType, chip->DstChipID, ChipData[0x00], ChipData[0x01], Command);
+		chip->RegWrite(chip->RegWriteParam, ChipData[0x00], ChipData[0x01], Command);
 		break;
 	}
 	chip->Running |= 0x10;
@@ -220,6 +223,27 @@ INLINE UINT32 muldiv64round(UINT32 Multiplicand, UINT32 Multiplier, UINT32 Divis
 	return (UINT32)(((UINT64)Multiplicand * Multiplier + Divisor / 2) / Divisor);
 }
 
+UINT8 daccontrol_send_pending(void *_info)
+{
+	// returns 1 if the next daccontrol_update(chip, 1) is going to send a command
+	dac_control *chip = (dac_control *)_info;
+	UINT32 NewPos;
+	
+	if (chip->Running & 0x80)	// disabled
+		return 0x00;
+	if (! (chip->Running & 0x01))	// stopped
+		return 0x00;
+	if (! (chip->Running & 0x10))
+		return 0x01;
+	
+	// The first loop iteration only advances, the second one sends.
+	NewPos = muldiv64round((chip->Step + 1) * chip->DataStep, chip->Frequency, DAC_SMPL_RATE);
+	if (chip->RemainCmds >= 2 && chip->Pos + chip->DataStep < NewPos)
+		return 0x01;
+	
+	return 0x00;
+}
+
 void daccontrol_update(void *_info, UINT32 samples)
 {
 	dac_control *chip = (dac_control *)_info;
@@ -294,6 +318,7 @@ UINT8 device_start_daccontrol(void **_info, void *param, int SampleRate)
 	chip->DstChipType = 0xFF;
 	chip->DstChipID = 0x00;
 	chip->DstCommand = 0x0000;
+	chip->RegWrite = chip_reg_get_write(param, chip->DstChipType, chip->DstChipID, &chip->RegWriteParam);
 	
 	chip->Running = 0xFF;	// disable all actions (except setup_chip)
 	
@@ -319,6 +344,7 @@ void device_reset_daccontrol(void *_info)
 	chip->DstChipID = 0x00;
 	chip->DstCommand = 0x00;
 	chip->CmdSize = 0x00;
+	chip->RegWrite = chip_reg_get_write(chip->param, chip->DstChipType, chip->DstChipID, &chip->RegWriteParam);
 	
 	chip->Frequency = 0;
 	chip->DataLen = 0x00;
@@ -338,6 +364,32 @@ void device_reset_daccontrol(void *_info)
 	return;
 }
 
+UINT32 device_save_state_daccontrol(void *_info, void *Buffer)
+{
+	dac_control *chip = (dac_control *)_info;
+	
+	if (Buffer != NULL)
+		memcpy(Buffer, chip, sizeof(dac_control));
+	
+	return sizeof(dac_control);
+}
+
+void device_load_state_daccontrol(void *_info, const void *Buffer)
+{
+	// The data pointer is kept, call daccontrol_refresh_data afterwards.
+	dac_control *chip = (dac_control *)_info;
+	const UINT8* Data;
+	UINT32 DataLen;
+	
+	Data = chip->Data;
+	DataLen = chip->DataLen;
+	memcpy(chip, Buffer, sizeof(dac_control));
+	chip->Data = Data;
+	chip->DataLen = DataLen;
+	
+	return;
+}
+
 void daccontrol_setup_chip(void *_info, UINT8 ChType, UINT8 ChNum, UINT16 Command)
 {
 	dac_control *chip = (dac_control *)_info;
@@ -345,6 +397,7 @@ void daccontrol_setup_chip(void *_info, UINT8 ChType, UINT8 ChNum, UINT16 Comman
 	chip->DstChipType = ChType;	// TypeID (e.g. 0x02 for YM2612)
 	chip->DstChipID = ChNum;	// chip number (to send commands to 1st or 2nd chip)
 	chip->DstCommand = Command;	// Port and Command (would be 0x02A for YM2612)
+	chip->RegWrite = chip_reg_get_write(chip->param, ChType, ChNum, &chip->RegWriteParam);
 	
 	switch(chip->DstChipType)
 	{
@@ -1,7 +1,10 @@
 void daccontrol_update(void *chip, UINT32 samples);
+UINT8 daccontrol_send_pending(void *chip);
 UINT8 device_start_daccontrol(void **chip, void *param, int samplerate);
 void device_stop_daccontrol(void *chip);
 void device_reset_daccontrol(void *chip);
+UINT32 device_save_state_daccontrol(void *chip, void *Buffer);
+void device_load_state_daccontrol(void *chip, const void *Buffer);
 void daccontrol_setup_chip(void *chip, UINT8 ChType, UINT8 ChNum, UINT16 Command);
 void daccontrol_set_data(void *chip, UINT8* Data, UINT32 DataLen, UINT8 StepSize, UINT8 StepBase);
 void daccontrol_refresh_data(void *chip, UINT8* Data, UINT32 DataLen);
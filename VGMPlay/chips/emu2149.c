@@ -329,15 +329,9 @@ PSG_calc (PSG * psg)
 }
 
 INLINE static void
-calc_stereo (PSG * psg, e_int32 out[2])
+update_state (PSG * psg, e_uint32 incr)
 {
-  int i, noise;
-  e_uint32 incr;
-  e_int32 l = 0, r = 0;
-
-  psg->base_count += psg->base_incr;
-  incr = (psg->base_count >> GETA_BITS);
-  psg->base_count &= (1 << GETA_BITS) - 1;
+  int i;
 
   /* Envelope */
   psg->env_count += incr;
@@ -378,7 +372,6 @@ calc_stereo (PSG * psg, e_int32 out[2])
     psg->noise_seed >>= 1;
     psg->noise_count -= psg->noise_freq;
   }
-  noise = psg->noise_seed & 1;
 
   /* Tone */
   for (i = 0; i < 3; i++)
@@ -396,7 +389,19 @@ calc_stereo (PSG * psg, e_int32 out[2])
         psg->edge[i] = 1;
       }
     }
+  }
+}
 
+INLINE static void
+mix_stereo (PSG * psg, e_int32 out[2])
+{
+  int i, noise;
+  e_int32 l = 0, r = 0;
+
+  noise = psg->noise_seed & 1;
+
+  for (i = 0; i < 3; i++)
+  {
     psg->cout[i] = 0; // BS maintaining cout for stereo mix
 
     if (psg->mask&PSG_MASK_CH(i))
@@ -422,6 +427,21 @@ calc_stereo (PSG * psg, e_int32 out[2])
   return;
 }
 
+INLINE static void
+calc_stereo (PSG * psg, e_int32 out[2])
+{
+  e_uint32 incr;
+
+  psg->base_count += psg->base_incr;
+  incr = (psg->base_count >> GETA_BITS);
+  psg->base_count &= (1 << GETA_BITS) - 1;
+
+  update_state (psg, incr);
+  mix_stereo (psg, out);
+
+  return;
+}
+
 EMU2149_API void
 PSG_calc_stereo (PSG * psg, e_int32 **out, e_int32 samples)
 {
@@ -458,6 +478,61 @@ PSG_calc_stereo (PSG * psg, e_int32 **out, e_int32 samples)
   }
 }
 
+static e_uint32
+ticks_to_bit (e_uint32 count, e_uint32 bit)
+{
+  /* ticks until the counter has the bit set */
+  e_uint32 next = count + 1;
+
+  if (next & bit)
+    return 1;
+  return ((next & ~(bit * 2 - 1)) | bit) - count;
+}
+
+/* Runs up to ticks chip ticks (clock / 8), but stops after the first tick that
+   can change the output. Returns the ticks it ran and the output after them,
+   0 ticks only return the current output. */
+EMU2149_API e_uint32
+PSG_advance (PSG * psg, e_uint32 ticks, e_int32 out[2])
+{
+  e_uint32 n = ticks;
+  e_uint32 t;
+  int i;
+
+  if (n)
+  {
+    /* a paused envelope doesn't change, the key-on sets a new counter */
+    if (!psg->env_pause && psg->env_freq != 0)
+    {
+      t = (psg->env_count >= 0x10000) ? 1 : 0x10000 - psg->env_count;
+      if (t < n)
+        n = t;
+    }
+    t = ticks_to_bit (psg->noise_count, 0x40);
+    if (t < n)
+      n = t;
+    for (i = 0; i < 3; i++)
+    {
+      if (psg->freq[i] > 1 || !psg->edge[i])
+      {
+        t = ticks_to_bit (psg->count[i], 0x1000);
+        if (t < n)
+          n = t;
+      }
+    }
+
+    /* nothing happens before the last tick */
+    psg->env_count += n - 1;
+    psg->noise_count += n - 1;
+    for (i = 0; i < 3; i++)
+      psg->count[i] += n - 1;
+    update_state (psg, 1);
+  }
+  mix_stereo (psg, out);
+
+  return n;
+}
+
 EMU2149_API void
 PSG_writeReg (PSG * psg, e_uint32 reg, e_uint32 val)
 {
@@ -90,6 +90,7 @@ extern "C"
   EMU2149_API e_uint8 PSG_readIO (PSG * psg);
   EMU2149_API e_int16 PSG_calc (PSG *);
   EMU2149_API void PSG_calc_stereo (PSG * psg, e_int32 **out, e_int32 samples);
+  EMU2149_API e_uint32 PSG_advance (PSG * psg, e_uint32 ticks, e_int32 out[2]);
   EMU2149_API void PSG_setFlags (PSG * psg, e_uint8 flags);
   EMU2149_API void PSG_setVolumeMode (PSG * psg, int type);
   EMU2149_API e_uint32 PSG_setMask (PSG *, e_uint32 mask);
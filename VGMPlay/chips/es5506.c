@@ -1040,8 +1040,8 @@ int device_start_es5506(void **_info, int clock, int channels)
 	*_info = (void *) chip;
 	
 	//es5506_start_common(device, device->static_config(), ES5506);
-	//chip->channels = channels;
-	chip->channels = 1;	// fixed to L+R for now
+	// the player passes 1 (everything mixed to L+R) unless it mixes surround pairs
+	chip->channels = channels;
 	es5506_start_common(chip, clock & 0x7FFFFFFF, clock >> 31);
 	return chip->master_clock / (16*32);
 }
@@ -119,6 +119,7 @@
 #include <stdlib.h>
 
 #include "mamedef.h"
+#include "run_once.h"
 //#ifndef __RAINE__
 //#include "sndintrf.h"		/* use M.A.M.E. */
 //#else
@@ -1549,8 +1550,9 @@ static void reset_channels( FM_ST *ST , FM_CH *CH , int num )
 	}
 }
 
-/* initialize generic tables */
-static int init_tables(void)
+/* initialize generic tables (shared by all chips, built once) */
+static run_once_t tables_once = RUN_ONCE_INIT;
+static void init_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1661,7 +1663,7 @@ static int init_tables(void)
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
 
-	return 1;
+	return;
 
 }
 
@@ -2297,11 +2299,7 @@ void * ym2203_init(void *param, int clock, int rate,
 	/* clear */
 	memset(F2203,0,sizeof(YM2203));
 
-	if( !init_tables() )
-	{
-		free( F2203 );
-		return NULL;
-	}
+	run_once(&tables_once, init_tables);
 
 	F2203->OPN.ST.param = param;
 	F2203->OPN.type = TYPE_YM2203;
@@ -2497,6 +2495,7 @@ static const int step_inc[8] = { -1*16, -1*16, -1*16, -1*16, 2*16, 5*16, 7*16, 9
 
 /* speedup purposes only */
 static int jedi_table[ 49*16 ];
+static run_once_t jedi_table_once = RUN_ONCE_INIT;
 
 
 static void Init_ADPCMATable(void)
@@ -3569,11 +3568,7 @@ void * ym2608_init(void *param, int clock, int rate,
 	/* clear */
 	memset(F2608,0,sizeof(YM2608));
 	/* allocate total level table (128kb space) */
-	if( !init_tables() )
-	{
-		free( F2608 );
-		return NULL;
-	}
+	run_once(&tables_once, init_tables);
 
 	F2608->OPN.ST.param = param;
 	F2608->OPN.type = TYPE_YM2608;
@@ -3608,7 +3603,7 @@ void * ym2608_init(void *param, int clock, int rate,
 	F2608->pcmbuf   = (UINT8*)YM2608_ADPCM_ROM;
 	F2608->pcm_size = 0x2000;
 
-	Init_ADPCMATable();
+	run_once(&jedi_table_once, Init_ADPCMATable);
 
 #ifdef __STATE_H__
 	YM2608_save_state(F2608, device);
@@ -4352,11 +4347,7 @@ void *ym2610_init(void *param, int clock, int rate,
 	/* clear */
 	memset(F2610,0,sizeof(YM2610));
 	/* allocate total level table (128kb space) */
-	if( !init_tables() )
-	{
-		free( F2610 );
-		return NULL;
-	}
+	run_once(&tables_once, init_tables);
 
 	/* FM */
 	F2610->OPN.ST.param = param;
@@ -4386,7 +4377,7 @@ void *ym2610_init(void *param, int clock, int rate,
 	F2610->deltaT.status_change_which_chip = F2610;
 	F2610->deltaT.status_change_EOS_bit = 0x80;	/* status flag: set bit7 on End Of Sample */
 
-	Init_ADPCMATable();
+	run_once(&jedi_table_once, Init_ADPCMATable);
 #ifdef __STATE_H__
 	YM2610_save_state(F2610, device);
 #endif
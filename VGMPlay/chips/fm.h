@@ -234,5 +234,8 @@ int ym2612_timer_over(void *chip, int c );
 void ym2612_postload(void *chip);
 
 void ym2612_set_mutemask(void *chip, UINT32 MuteMask);
+UINT32 ym2612_save_state(void *chip, void *Buffer);
+void ym2612_load_state(void *chip, const void *Buffer);
+UINT8 ym2612_set_voiceout(void *chip, FMSAMPLE **VoiceOut);
 #endif /* (BUILD_YM2612||BUILD_YM3438) */
 
@@ -130,9 +130,11 @@
 
 //#include "emu.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
 #include "mamedef.h"
+#include "run_once.h"
 #include "fm.h"
 
 #ifndef NULL
@@ -708,6 +710,7 @@ typedef struct
 	INT32		WaveR;
 
 	UINT8		PseudoSt;
+	FMSAMPLE	**VoiceOut;		/* L/R output of every single channel (optional) */
 } YM2612;
 
 /* log output level */
@@ -2119,7 +2122,8 @@ static void reset_channels( FM_ST *ST , FM_CH *CH , int num )
 	}
 }
 
-/* initialize generic tables */
+/* initialize generic tables (shared by all chips, built once) */
+static run_once_t tables_once = RUN_ONCE_INIT;
 static void init_tables(void)
 {
 	signed int i,x;
@@ -2384,6 +2388,23 @@ void ym2612_update_one(void *chip, FMSAMPLE **buffer, int length)
 		lt += ((out_fm[5]>>0) & OPN->pan[10]);
 		rt += ((out_fm[5]>>0) & OPN->pan[11]);
 
+		if (F2612->VoiceOut != NULL)
+		{
+			FMSAMPLE **VoiceOut = F2612->VoiceOut;
+			int ch;
+
+			for (ch = 0; ch < 6; ch ++)
+			{
+				VoiceOut[ch * 2 + 0][i] = out_fm[ch] & OPN->pan[ch * 2 + 0];
+				VoiceOut[ch * 2 + 1][i] = out_fm[ch] & OPN->pan[ch * 2 + 1];
+			}
+			if (F2612->dac_test)
+			{
+				VoiceOut[4 * 2 + 0][i] = dacout * 2;
+				VoiceOut[4 * 2 + 1][i] = 0;
+			}
+		}
+
 //      Limit( lt, MAXOUT, MINOUT );
 //      Limit( rt, MAXOUT, MINOUT );
 
@@ -2497,7 +2518,7 @@ void * ym2612_init(void *param, int clock, int rate,
 		return NULL;
 	memset(F2612, 0x00, sizeof(YM2612));
 	/* allocate total level table (128kb space) */
-	init_tables();
+	run_once(&tables_once, init_tables);
 
 	F2612->OPN.ST.param = param;
 	F2612->OPN.type = TYPE_YM2612;
@@ -2715,6 +2736,57 @@ int ym2612_timer_over(void *chip,int c)
 }
 
 
+/* the fnumber table only depends on the clock, so it's left out of saved states */
+#define FN_TABLE_START	offsetof(YM2612, OPN.fn_table)
+#define FN_TABLE_END	(FN_TABLE_START + sizeof(((FM_OPN *)NULL)->fn_table))
+
+/* copy the chip state to Buffer (or only return its size, if Buffer is NULL) */
+UINT32 ym2612_save_state(void *chip, void *Buffer)
+{
+	if (Buffer != NULL)
+	{
+		memcpy(Buffer, chip, FN_TABLE_START);
+		memcpy((UINT8 *)Buffer + FN_TABLE_START, (UINT8 *)chip + FN_TABLE_END,
+				sizeof(YM2612) - FN_TABLE_END);
+	}
+	return sizeof(YM2612) - (FN_TABLE_END - FN_TABLE_START);
+}
+
+/* restore a state that was saved from the same chip
+   (all pointers in the state point into the chip itself, the mute mask is kept) */
+void ym2612_load_state(void *chip, const void *Buffer)
+{
+	YM2612 *F2612 = (YM2612 *)chip;
+	UINT8 Muted[6];
+	UINT8 MuteDAC;
+	FMSAMPLE **VoiceOut;
+	UINT8 CurChn;
+
+	for (CurChn = 0; CurChn < 6; CurChn ++)
+		Muted[CurChn] = F2612->CH[CurChn].Muted;
+	MuteDAC = F2612->MuteDAC;
+	VoiceOut = F2612->VoiceOut;
+
+	memcpy(F2612, Buffer, FN_TABLE_START);
+	memcpy((UINT8 *)F2612 + FN_TABLE_END, (const UINT8 *)Buffer + FN_TABLE_START,
+			sizeof(YM2612) - FN_TABLE_END);
+
+	for (CurChn = 0; CurChn < 6; CurChn ++)
+		F2612->CH[CurChn].Muted = Muted[CurChn];
+	F2612->MuteDAC = MuteDAC;
+	F2612->VoiceOut = VoiceOut;
+}
+
+/* VoiceOut receives the L/R output of channel 1, L/R of channel 2, etc.
+   (the DAC is part of channel 6), returns the number of channels */
+UINT8 ym2612_set_voiceout(void *chip, FMSAMPLE **VoiceOut)
+{
+	YM2612 *F2612 = (YM2612 *)chip;
+
+	F2612->VoiceOut = VoiceOut;
+	return 6;
+}
+
 void ym2612_set_mutemask(void *chip, UINT32 MuteMask)
 {
 	YM2612 *F2612 = (YM2612 *)chip;
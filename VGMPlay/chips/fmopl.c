@@ -69,6 +69,7 @@ Revision History:
 
 #include <math.h>
 #include "mamedef.h"
+#include "run_once.h"
 #ifdef _DEBUG
 #include <stdio.h>
 #endif
@@ -653,8 +654,8 @@ static const INT8 lfo_pm_table[8*8*2] = {
 };
 
 
-/* lock level of common table */
-static int num_lock = 0;
+/* the common tables are built once, by the first chip */
+static run_once_t tables_once = RUN_ONCE_INIT;
 
 
 #define SLOT7_1 (&OPL->P_CH[7].SLOT[SLOT1])
@@ -1232,7 +1233,7 @@ INLINE void OPL_CALC_RH( FM_OPL *OPL, OPL_CH *CH, unsigned int noise )
 
 
 /* generic table initialize */
-static int init_tables(void)
+static void init_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1335,14 +1336,6 @@ static int init_tables(void)
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
 
-	return 1;
-}
-
-static void OPLCloseTable( void )
-{
-#ifdef SAVE_SAMPLE
-	fclose(sample[0]);
-#endif
 }
 
 
@@ -1825,20 +1818,10 @@ static void OPLWriteReg(FM_OPL *OPL, int r, int v)
 	}
 }*/
 
-/* lock/unlock for common table */
+/* build the common tables */
 static int OPL_LockTable(void)
 {
-	num_lock++;
-	if(num_lock>1) return 0;
-
-	/* first time */
-
-	/* allocate total level table (128kb space) */
-	if( !init_tables() )
-	{
-		num_lock--;
-		return -1;
-	}
+	run_once(&tables_once, init_tables);
 
 	/*if (LOG_CYM_FILE)
 	{
@@ -1852,20 +1835,6 @@ static int OPL_LockTable(void)
 	return 0;
 }
 
-static void OPL_UnLockTable(void)
-{
-	if(num_lock) num_lock--;
-	if(num_lock) return;
-
-	/* last time */
-
-	OPLCloseTable();
-
-	/*if (cymfile)
-		fclose (cymfile);
-	cymfile = NULL;*/
-}
-
 static void OPLResetChip(FM_OPL *OPL)
 {
 	int c,s;
@@ -2116,7 +2085,6 @@ static FM_OPL *OPLCreate(UINT32 clock, UINT32 rate, int type)
 /* Destroy one of virtual YM3812 */
 static void OPLDestroy(FM_OPL *OPL)
 {
-	OPL_UnLockTable();
 	free(OPL);
 }
 
@@ -28,6 +28,7 @@
 //#include "emu.h"
 //#include "streams.h"
 #include "k051649.h"
+#include "blip.h"
 
 #define FREQ_BITS	16
 #define DEF_GAIN	8
@@ -59,6 +60,10 @@ struct _k051649_state
 
 	int cur_reg;
 	UINT8 test;
+
+	UINT8 StepSynth;	// render band-limited steps at the output rate (see blip.h)
+	INT32 StepLevel;
+	BLIP_BUF Blip;
 };
 
 /*INLINE k051649_state *get_safe_token(running_device *device)
@@ -93,6 +98,85 @@ static void make_mixer_table(/*running_machine *machine,*/ k051649_state *info,
 }
 
 
+INLINE int k051649_step(k051649_state *info, int frequency)
+{
+	/* Amuse source:  Cab suggests this method gives greater resolution */
+	/* Sean Young 20010417: the formula is really: f = clock/(16*(f+1))*/
+	return (int)(((INT64)info->mclock * (1 << FREQ_BITS)) / (float)((frequency + 1) * 16 * (info->rate / 32)) + 0.5);
+}
+
+static void k051649_update_steps(k051649_state *info, stream_sample_t **outputs, int samples)
+{
+	// The counters jump from one waveram position to the next one and the
+	// level changes become band-limited steps at the output rate.
+	k051649_sound_channel *voice=info->channel_list;
+	stream_sample_t *buffer = outputs[0];
+	stream_sample_t *buffer2 = outputs[1];
+	UINT32 step[5];
+	int v[5];
+	UINT8 active[5];
+	UINT32 Clocks;
+	UINT32 Time;
+	UINT32 Ticks;
+	UINT32 Next;
+	INT32 level;
+	int Frame;
+	int j;
+
+	for (j=0; j<5; j++) {
+		// channel is halted for freq < 9
+		active[j] = (voice[j].frequency > 8 && ! voice[j].Muted);
+		step[j] = active[j] ? k051649_step(info, voice[j].frequency) : 0;
+		v[j] = voice[j].volume * voice[j].key;
+	}
+
+	while (samples > 0)
+	{
+		Frame = (samples > BLIP_MAX_FRAME) ? BLIP_MAX_FRAME : samples;
+		Clocks = blip_clocks_needed(&info->Blip, Frame);
+		for (Time = 0; ; Time += Ticks)
+		{
+			level = 0;
+			for (j=0; j<5; j++) {
+				if (active[j])
+					level += (voice[j].waveram[(voice[j].counter >> FREQ_BITS) & 0x1f] * v[j])>>3;
+			}
+			level = info->mixer_lookup[level];
+			if (level != info->StepLevel)
+			{
+				if (Time)
+					blip_add_delta(&info->Blip, Time - 1, level - info->StepLevel);
+				else	// register writes since the last update
+					blip_add_write_delta(&info->Blip, level - info->StepLevel);
+				info->StepLevel = level;
+			}
+			if (Time >= Clocks)
+				break;
+
+			// ticks until the next audible position change
+			Ticks = Clocks - Time;
+			for (j=0; j<5; j++) {
+				if (active[j] && v[j])
+				{
+					Next = ((1 << FREQ_BITS) - (voice[j].counter & ((1 << FREQ_BITS) - 1)) + step[j] - 1) / step[j];
+					if (Next < Ticks)
+						Ticks = Next;
+				}
+			}
+			for (j=0; j<5; j++) {
+				if (active[j])
+					voice[j].counter = (UINT32)(voice[j].counter + step[j] * Ticks);
+			}
+		}
+		blip_end_frame(&info->Blip, Clocks);
+		blip_read_samples(&info->Blip, buffer, Frame);
+		memcpy(buffer2, buffer, Frame * sizeof(stream_sample_t));
+		buffer += Frame;
+		buffer2 += Frame;
+		samples -= Frame;
+	}
+}
+
 /* generate sound to the mix buffer */
 //static STREAM_UPDATE( k051649_update )
 void k051649_update(void *param, stream_sample_t **outputs, int samples)
@@ -104,6 +188,12 @@ void k051649_update(void *param, stream_sample_t **outputs, int samples)
 	short *mix;
 	int i,j;
 
+	if (info->StepSynth)
+	{
+		k051649_update_steps(info, outputs, samples);
+		return;
+	}
+
 	// zap the contents of the mixer buffer
 	memset(info->mixer_buffer, 0, samples * sizeof(short));
 
@@ -114,9 +204,7 @@ void k051649_update(void *param, stream_sample_t **outputs, int samples)
 			const signed char *w = voice[j].waveram;			/* 19991207.CAB */
 			int v=voice[j].volume * voice[j].key;
 			int c=voice[j].counter;
-			/* Amuse source:  Cab suggests this method gives greater resolution */
-			/* Sean Young 20010417: the formula is really: f = clock/(16*(f+1))*/
-			int step = (int)(((INT64)info->mclock * (1 << FREQ_BITS)) / (float)((voice[j].frequency + 1) * 16 * (info->rate / 32)) + 0.5);
+			int step = k051649_step(info, voice[j].frequency);
 
 			mix = info->mixer_buffer;
 
@@ -205,9 +293,26 @@ void device_reset_k051649(void *_info)
 	info->test = 0x00;
 	info->cur_reg = 0x00;
 	
+	info->StepLevel = 0;
+	blip_clear(&info->Blip);
+	
 	return;
 }
 
+UINT32 k051649_set_step_synth(void *_info, UINT32 SampleRate)
+{
+	// returns the new sample rate of the chip (0 - not possible)
+	k051649_state *info = (k051649_state *)_info;
+	
+	if (! info->rate)
+		return 0;
+	info->StepSynth = 0x01;
+	info->StepLevel = 0;
+	blip_init(&info->Blip, info->rate, SampleRate);
+	
+	return SampleRate;
+}
+
 /********************************************************************************/
 
 //WRITE8_DEVICE_HANDLER( k051649_waveform_w )
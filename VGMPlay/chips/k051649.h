@@ -35,5 +35,6 @@ UINT8 k051649_test_r(void *chip, offs_t offset);
 void k051649_w(void *chip, offs_t offset, UINT8 data);
 
 void k051649_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 k051649_set_step_synth(void *chip, UINT32 SampleRate);
 
 //#endif /* __K051649_H__ */
@@ -58,5 +58,6 @@ typedef INT32 stream_sample_t;
 #endif
 
 typedef void (*SRATE_CALLBACK)(void*, UINT32);
+typedef void (*REGW_CALLBACK)(void*, UINT8 Port, UINT8 Offset, UINT8 Data);
 
 #endif	// __MAMEDEF_H__
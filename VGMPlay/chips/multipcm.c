@@ -33,7 +33,18 @@
 
 //#include "emu.h"
 //#include "streams.h"
+
+// vector versions of the slot mixing (SSE2 is part of x86-64, NEON of ARM64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+
 #include "mamedef.h"
+#include "run_once.h"
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
@@ -45,6 +56,7 @@
 
 //????
 #define MULTIPCM_CLOCKDIV   	(180.0)
+#define MULTIPCM_BLOCK	256		// samples per slot that are rendered in one go
 
 struct _Sample
 {
@@ -106,6 +118,7 @@ struct _MultiPCM
 	//sound_stream * stream;
 	struct _Sample Samples[0x200];		//Max 512 samples
 	struct _SLOT Slots[28];
+	UINT32 ActiveSlots;	// bit mask of the slots that may be playing (set on KeyOn, cleared by the update)
 	unsigned int CurSlot;
 	unsigned int Address;
 	unsigned int BankR,BankL;
@@ -119,7 +132,7 @@ struct _MultiPCM
 };
 
 
-static UINT8 IsInit = 0x00;
+static run_once_t PanTableOnce = RUN_ONCE_INIT;
 static signed int LPANTABLE[0x800],RPANTABLE[0x800];
 
 #define FIX(v)	((UINT32) ((float) (1<<SHIFT)*(v)))
@@ -370,6 +383,7 @@ static void WriteSlot(MultiPCM *ptChip,struct _SLOT *slot,int reg,unsigned char
 				{
 					slot->Sample=ptChip->Samples+slot->Regs[1];
 					slot->Playing=1;
+					ptChip->ActiveSlots|=1<<(slot-ptChip->Slots);
 					slot->Base=slot->Sample->Start;
 					slot->offset=0;
 					slot->Prev=0;
@@ -435,12 +449,106 @@ static void WriteSlot(MultiPCM *ptChip,struct _SLOT *slot,int reg,unsigned char
 	}
 }
 
+// Renders up to "samples" samples of a slot and their volume/pan factors.
+// Returns the number of samples before the slot stopped playing.
+INLINE int MultiPCM_render_slot(MultiPCM *ptChip, struct _SLOT *slot, signed int *smpbuf,
+								signed int *lvolbuf, signed int *rvolbuf, int samples)
+{
+	const unsigned int ROMMask=ptChip->ROMMask;
+	const unsigned int Base=slot->Base;
+	const unsigned int End=slot->Sample->End<<SHIFT;
+	const unsigned int Loop=slot->Sample->Loop<<SHIFT;
+	const int Vibrato=slot->Regs[6]&7;
+	const int Tremolo=slot->Regs[7]&7;
+	const unsigned int Pan=slot->Pan<<7;
+	const unsigned int DstTL=slot->DstTL;
+	unsigned int offset=slot->offset;
+	unsigned int TL=slot->TL;
+	signed int Prev=slot->Prev;
+	int i;
+
+	for(i=0;i<samples && slot->Playing;++i)
+	{
+		unsigned int vol=(TL>>SHIFT)|Pan;
+		unsigned int adr=offset>>SHIFT;
+		signed int sample;
+		unsigned int step=slot->step;
+		signed int csample=(signed short) (ptChip->ROM[(Base+adr) & ROMMask]<<8);
+		signed int fpart=offset&((1<<SHIFT)-1);
+		sample=(csample*fpart+Prev*((1<<SHIFT)-fpart))>>SHIFT;
+
+		if(Vibrato)
+		{
+			step=step*PLFO_Step(&(slot->PLFO));
+			step>>=SHIFT;
+		}
+
+		offset+=step;
+		if(offset>=End)
+		{
+			offset=Loop;
+		}
+		if(adr^(offset>>SHIFT))
+		{
+			Prev=csample;
+		}
+
+		if((TL>>SHIFT)!=DstTL)
+			TL+=slot->TLStep;
+
+		if(Tremolo)
+		{
+			sample=sample*ALFO_Step(&(slot->ALFO));
+			sample>>=SHIFT;
+		}
+
+		smpbuf[i]=(sample*EG_Update(slot))>>10;
+		lvolbuf[i]=LPANTABLE[vol];
+		rvolbuf[i]=RPANTABLE[vol];
+	}
+	slot->offset=offset;
+	slot->TL=TL;
+	slot->Prev=Prev;
+	return i;
+}
+
+// output += (vol * sample) >> SHIFT
+INLINE void MultiPCM_mix_slot(stream_sample_t *output, const signed int *smpbuf, const signed int *volbuf, int samples)
+{
+	int i;
+
+	i=0;
+#if defined(MIX_SSE2)
+	for(;i+4<=samples;i+=4)
+	{
+		// SSE2 has no 32-bit multiplication, but the low 32 bits of the unsigned
+		// 32x32 bit product are the same as the ones of the signed product.
+		__m128i Smpl=_mm_loadu_si128((const __m128i*)&smpbuf[i]);
+		__m128i Vol=_mm_loadu_si128((const __m128i*)&volbuf[i]);
+		__m128i Mul02=_mm_mul_epu32(Smpl,Vol);
+		__m128i Mul13=_mm_mul_epu32(_mm_srli_epi64(Smpl,32),_mm_srli_epi64(Vol,32));
+		__m128i Mul=_mm_unpacklo_epi32(_mm_shuffle_epi32(Mul02,0x08),_mm_shuffle_epi32(Mul13,0x08));
+		_mm_storeu_si128((__m128i*)&output[i],_mm_add_epi32(_mm_loadu_si128((const __m128i*)&output[i]),
+						_mm_srai_epi32(Mul,SHIFT)));
+	}
+#elif defined(MIX_NEON)
+	for(;i+4<=samples;i+=4)
+		vst1q_s32(&output[i],vsraq_n_s32(vld1q_s32(&output[i]),vmulq_s32(vld1q_s32(&smpbuf[i]),vld1q_s32(&volbuf[i])),SHIFT));
+#endif
+	for(;i<samples;++i)
+		output[i]+=(volbuf[i]*smpbuf[i])>>SHIFT;
+}
+
 //static STREAM_UPDATE( MultiPCM_update )
 void MultiPCM_update(void *param, stream_sample_t **outputs, int samples)
 {
 	MultiPCM *ptChip = (MultiPCM *)param;
 	stream_sample_t  *datap[2];
-	int i,sl;
+	signed int smpbuf[MULTIPCM_BLOCK];
+	signed int lvolbuf[MULTIPCM_BLOCK];
+	signed int rvolbuf[MULTIPCM_BLOCK];
+	int sl;
+	int done,len,count;
 
 	datap[0] = outputs[0];
 	datap[1] = outputs[1];
@@ -448,61 +556,37 @@ void MultiPCM_update(void *param, stream_sample_t **outputs, int samples)
 	memset(datap[0], 0, sizeof(*datap[0])*samples);
 	memset(datap[1], 0, sizeof(*datap[1])*samples);
 
-
-	for(i=0;i<samples;++i)
+	// The slots don't share any state, so they are rendered one after another.
+	for(sl=0;sl<28;++sl)
 	{
-		signed int smpl=0;
-		signed int smpr=0;
-		for(sl=0;sl<28;++sl)
+		struct _SLOT *slot=ptChip->Slots+sl;
+		if(! (ptChip->ActiveSlots & (1<<sl)))
+			continue;
+		if(! slot->Playing)
 		{
-			struct _SLOT *slot=ptChip->Slots+sl;
-			if(slot->Playing && ! slot->Muted)
-			{
-				unsigned int vol=(slot->TL>>SHIFT)|(slot->Pan<<7);
-				unsigned int adr=slot->offset>>SHIFT;
-				signed int sample;
-				unsigned int step=slot->step;
-				signed int csample=(signed short) (ptChip->ROM[(slot->Base+adr) & ptChip->ROMMask]<<8);
-				signed int fpart=slot->offset&((1<<SHIFT)-1);
-				sample=(csample*fpart+slot->Prev*((1<<SHIFT)-fpart))>>SHIFT;
-
-				if(slot->Regs[6]&7)	//Vibrato enabled
-				{
-					step=step*PLFO_Step(&(slot->PLFO));
-					step>>=SHIFT;
-				}
-
-				slot->offset+=step;
-				if(slot->offset>=(slot->Sample->End<<SHIFT))
-				{
-					slot->offset=slot->Sample->Loop<<SHIFT;
-				}
-				if(adr^(slot->offset>>SHIFT))
-				{
-					slot->Prev=csample;
-				}
-
-				if((slot->TL>>SHIFT)!=slot->DstTL)
-					slot->TL+=slot->TLStep;
-
-				if(slot->Regs[7]&7)	//Tremolo enabled
-				{
-					sample=sample*ALFO_Step(&(slot->ALFO));
-					sample>>=SHIFT;
-				}
-
-				sample=(sample*EG_Update(slot))>>10;
+			ptChip->ActiveSlots&=~(1<<sl);
+			continue;
+		}
+		if(slot->Muted)
+			continue;
 
-				smpl+=(LPANTABLE[vol]*sample)>>SHIFT;
-				smpr+=(RPANTABLE[vol]*sample)>>SHIFT;
-			}
+		for(done=0;done<samples;done+=len)
+		{
+			len=samples-done;
+			if(len>MULTIPCM_BLOCK)
+				len=MULTIPCM_BLOCK;
+			count=MultiPCM_render_slot(ptChip,slot,smpbuf,lvolbuf,rvolbuf,len);
+			MultiPCM_mix_slot(&datap[0][done],smpbuf,lvolbuf,count);
+			MultiPCM_mix_slot(&datap[1][done],smpbuf,rvolbuf,count);
+			if(count<len)
+				break;	// the slot stopped
 		}
+		if(! slot->Playing)
+			ptChip->ActiveSlots&=~(1<<sl);
+	}
 /*#define ICLIP16(x) (x<-32768)?-32768:((x>32767)?32767:x)
 		datap[0][i]=ICLIP16(smpl);
 		datap[1][i]=ICLIP16(smpr);*/
-		datap[0][i] = smpl;
-		datap[1][i] = smpr;
-	}
 }
 
 //READ8_DEVICE_HANDLER( multipcm_r )
@@ -513,6 +597,64 @@ UINT8 multipcm_r(void *_info, offs_t offset)
 	return 0;
 }
 
+static void init_pan_tables(void)
+{
+	int i;
+
+	//Volume+pan table
+	for(i=0;i<0x800;++i)
+	{
+		float SegaDB=0;
+		float TL;
+		float LPAN,RPAN;
+
+		unsigned char iTL=i&0x7f;
+		unsigned char iPAN=(i>>7)&0xf;
+
+		SegaDB=(float) iTL*(-24.0)/(float) 0x40;
+
+		TL=pow(10.0,SegaDB/20.0);
+
+
+		if(iPAN==0x8)
+		{
+			LPAN=RPAN=0.0;
+		}
+		else if(iPAN==0x0)
+		{
+			LPAN=RPAN=1.0;
+		}
+		else if(iPAN&0x8)
+		{
+			LPAN=1.0;
+
+			iPAN=0x10-iPAN;
+
+			SegaDB=(float) iPAN*(-12.0)/(float) 0x4;
+
+			RPAN=pow(10.0,SegaDB/20.0);
+
+			if((iPAN&0x7)==7)
+				RPAN=0.0;
+		}
+		else
+		{
+			RPAN=1.0;
+
+			SegaDB=(float) iPAN*(-12.0)/(float) 0x4;
+
+			LPAN=pow(10.0,SegaDB/20.0);
+			if((iPAN&0x7)==7)
+				LPAN=0.0;
+		}
+
+		TL/=4.0;
+
+		LPANTABLE[i]=FIX((LPAN*TL));
+		RPANTABLE[i]=FIX((RPAN*TL));
+	}
+}
+
 //static DEVICE_START( multipcm )
 int device_start_multipcm(void **_info, int clock)
 {
@@ -532,62 +674,7 @@ int device_start_multipcm(void **_info, int clock)
 
 	//ptChip->stream = stream_create(device, 0, 2, ptChip->Rate, ptChip, MultiPCM_update);
 
-	if (! IsInit)
-	{
-		//Volume+pan table
-		for(i=0;i<0x800;++i)
-		{
-			float SegaDB=0;
-			float TL;
-			float LPAN,RPAN;
-
-			unsigned char iTL=i&0x7f;
-			unsigned char iPAN=(i>>7)&0xf;
-
-			SegaDB=(float) iTL*(-24.0)/(float) 0x40;
-
-			TL=pow(10.0,SegaDB/20.0);
-
-
-			if(iPAN==0x8)
-			{
-				LPAN=RPAN=0.0;
-			}
-			else if(iPAN==0x0)
-			{
-				LPAN=RPAN=1.0;
-			}
-			else if(iPAN&0x8)
-			{
-				LPAN=1.0;
-
-				iPAN=0x10-iPAN;
-
-				SegaDB=(float) iPAN*(-12.0)/(float) 0x4;
-
-				RPAN=pow(10.0,SegaDB/20.0);
-
-				if((iPAN&0x7)==7)
-					RPAN=0.0;
-			}
-			else
-			{
-				RPAN=1.0;
-
-				SegaDB=(float) iPAN*(-12.0)/(float) 0x4;
-
-				LPAN=pow(10.0,SegaDB/20.0);
-				if((iPAN&0x7)==7)
-					LPAN=0.0;
-			}
-
-			TL/=4.0;
-
-			LPANTABLE[i]=FIX((LPAN*TL));
-			RPANTABLE[i]=FIX((RPAN*TL));
-		}
-		IsInit = 0x01;
-	}
+	run_once(&PanTableOnce, init_pan_tables);
 
 	//Pitch steps
 	for(i=0;i<0x400;++i)
@@ -702,6 +789,7 @@ void device_reset_multipcm(void *_info)
 		ptChip->Slots[i].Num=i;
 		ptChip->Slots[i].Playing=0;
 	}
+	ptChip->ActiveSlots=0;
 	
 	return;
 }
@@ -814,6 +902,22 @@ void multipcm_set_mute_mask(void *_info, UINT32 MuteMask)
 	return;
 }
 
+UINT8 multipcm_is_silent(void *_info)
+{
+	// muted slots are skipped by the update and don't advance either
+	MultiPCM* ptChip = (MultiPCM *)_info;
+	UINT8 CurChn;
+	
+	for (CurChn = 0; CurChn < 28; CurChn ++)
+	{
+		if ((ptChip->ActiveSlots & (1 << CurChn)) && ptChip->Slots[CurChn].Playing &&
+			! ptChip->Slots[CurChn].Muted)
+			return 0x00;
+	}
+	
+	return 0x01;
+}
+
 #if 0	// for debugging only
 UINT8 multipcm_get_channels(UINT8 ChipID, UINT32* ChannelMask)
 {
@@ -19,4 +19,5 @@ void multipcm_set_bank(void *chip, UINT32 leftoffs, UINT32 rightoffs);
 void multipcm_bank_write(void *chip, UINT8 offset, UINT16 data);
 
 void multipcm_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT8 multipcm_is_silent(void *chip);
 //DECLARE_LEGACY_SOUND_DEVICE(MULTIPCM, multipcm);
@@ -11,6 +11,7 @@
 
 //#include "emu.h"
 #include "mamedef.h"
+#include "run_once.h"
 #ifdef _DEBUG
 #include <stdio.h>
 #endif
@@ -84,8 +85,7 @@ static const int index_shift[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
 /* lookup table for the precomputed difference */
 static int diff_lookup[49*16];
 
-/* tables computed? */
-static int tables_computed = 0;
+static run_once_t tables_once = RUN_ONCE_INIT;	/* lookup-table is computed */
 
 
 /*INLINE okim6258_state *get_safe_token(running_device *device)
@@ -114,9 +114,6 @@ static void compute_tables(void)
 
 	int step, nib;
 
-	if (tables_computed)
-		return;
-	
 	/* loop over all possible steps */
 	for (step = 0; step <= 48; step++)
 	{
@@ -133,8 +130,6 @@ static void compute_tables(void)
 				 stepval/8);
 		}
 	}
-
-	tables_computed = 1;
 }
 
 
@@ -318,7 +313,7 @@ int device_start_okim6258(void **_info, int clock, int Options, int divider, int
 	info->Iternal10Bit = (Options >> 0) & 0x01;
 	info->DCRemoval = (Options >> 1) & 0x01;
 	
-	compute_tables();
+	run_once(&tables_once, compute_tables);
 
 	//info->master_clock = device->clock();
 	info->initial_clock = clock;
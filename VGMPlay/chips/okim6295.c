@@ -22,6 +22,7 @@
 
 
 #include "mamedef.h"
+#include "run_once.h"
 //#include "emu.h"
 //#include "streams.h"
 #include <stdio.h>
@@ -103,8 +104,7 @@ static const int volume_table[16] =
 	0x00,
 };
 
-/* tables computed? */
-static int tables_computed = 0;
+static run_once_t tables_once = RUN_ONCE_INIT;	/* lookup-table is computed */
 
 /* useful interfaces */
 //const okim6295_interface okim6295_interface_pin7high = { 1 };
@@ -161,8 +161,6 @@ static void compute_tables(void)
 				 stepval/8);
 		}
 	}
-
-	tables_computed = 1;
 }
 
 
@@ -176,8 +174,7 @@ static void compute_tables(void)
 void reset_adpcm(struct adpcm_state *state)
 {
 	/* make sure we have our tables */
-	if (!tables_computed)
-		compute_tables();
+	run_once(&tables_once, compute_tables);
 
 	/* reset the signal/step */
 	state->signal = -2;
@@ -424,7 +421,7 @@ int device_start_okim6295(void **_info, int clock)
 	info = (okim6295_state *) calloc(1, sizeof(okim6295_state));
 	*_info = (void *) info;
 	
-	compute_tables();
+	run_once(&tables_once, compute_tables);
 
 	info->command = -1;
 	//info->bank_installed = FALSE;
@@ -783,6 +780,21 @@ void okim6295_set_mute_mask(void *_info, UINT32 MuteMask)
 	return;
 }
 
+UINT8 okim6295_is_silent(void *_info)
+{
+	// muted voices are skipped by the update and don't advance either
+	okim6295_state *chip = (okim6295_state *)_info;
+	UINT8 CurChn;
+	
+	for (CurChn = 0; CurChn < OKIM6295_VOICES; CurChn ++)
+	{
+		if (chip->voice[CurChn].playing && ! chip->voice[CurChn].Muted)
+			return 0x00;
+	}
+	
+	return 0x01;
+}
+
 void okim6295_set_srchg_cb(void *_info, SRATE_CALLBACK CallbackFunc, void* DataPtr)
 {
 	okim6295_state *info = (okim6295_state *)_info;
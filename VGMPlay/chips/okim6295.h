@@ -32,6 +32,7 @@ void okim6295_w(void *chip, offs_t offset, UINT8 data);
 void okim6295_write_rom(void *chip, offs_t ROMSize, offs_t DataStart, offs_t DataLength,
 						const UINT8* ROMData);
 void okim6295_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT8 okim6295_is_silent(void *chip);
 void okim6295_set_srchg_cb(void *chip, SRATE_CALLBACK CallbackFunc, void* DataPtr);
 
 
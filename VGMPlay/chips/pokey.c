@@ -52,10 +52,12 @@
 #include "mamedef.h"
 //#include "emu.h"
 #include <stdlib.h>
+#include <string.h>
 #ifdef _DEBUG
 #include <stdio.h>
 #endif
 #include "pokey.h"
+#include "blip.h"
 
 /*
  * Defining this produces much more (about twice as much)
@@ -207,6 +209,11 @@ struct _pokey_state
 	//pokey_interface intf;
 	//attotime clock_period;
 	double clock_period;
+	UINT32 clock;			/* input clock, the chip renders one sample per clock */
+	UINT8 StepSynth;		/* render band-limited steps at the output rate (see blip.h) */
+	INT32 StepLevel;
+	UINT32 StepGain;		/* level scale of the steps, 1.0 = 0x1000 */
+	BLIP_BUF Blip;
 	//attotime ad_time_fast;
 	//attotime ad_time_slow;
 
@@ -537,6 +544,77 @@ struct _pokey_state
 }*/
 
 
+static void pokey_update_steps(pokey_state *chip, stream_sample_t **outputs, int samples)
+{
+	// The events already jump from one channel toggle to the next one, so only
+	// the changes of the sum go into the buffer instead of a sample per clock.
+	stream_sample_t *bufL = outputs[0];
+	stream_sample_t *bufR = outputs[1];
+	UINT32 sum = 0;
+	INT32 Level;
+	UINT32 Clocks;
+	UINT32 Time;
+	int Frame;
+	int ch;
+
+	for (ch = 0; ch < 4; ch ++)
+	{
+		if( chip->output[ch] && ! chip->Muted[ch] )
+			sum += chip->volume[ch];
+	}
+	// register writes since the last update
+	Level = (INT32)((sum * chip->StepGain) >> 12);
+	if (Level != chip->StepLevel)
+	{
+		blip_add_write_delta(&chip->Blip, Level - chip->StepLevel);
+		chip->StepLevel = Level;
+	}
+
+	while (samples > 0)
+	{
+		Frame = (samples > BLIP_MAX_FRAME) ? BLIP_MAX_FRAME : samples;
+		Clocks = blip_clocks_needed(&chip->Blip, Frame);
+		Time = 0;
+		for (;;)
+		{
+			UINT32 event = Clocks - Time;
+			UINT32 channel = SAMPLE;
+
+			Level = (INT32)((sum * chip->StepGain) >> 12);
+			if (Level != chip->StepLevel)
+			{
+				blip_add_delta(&chip->Blip, Time, Level - chip->StepLevel);
+				chip->StepLevel = Level;
+			}
+
+			for (ch = 0; ch < 4; ch ++)
+			{
+				if( chip->counter[ch] < event )
+				{
+					event = chip->counter[ch];
+					channel = ch;
+				}
+			}
+			if( channel == SAMPLE )
+			{
+				// no more events in this frame
+				ADJUST_EVENT(chip);
+				break;
+			}
+			{
+				PROCESS_CHANNEL(chip,channel);
+			}
+			Time += event;
+		}
+		blip_end_frame(&chip->Blip, Clocks);
+		blip_read_samples(&chip->Blip, bufL, Frame);
+		memcpy(bufR, bufL, Frame * sizeof(stream_sample_t));
+		bufL += Frame;
+		bufR += Frame;
+		samples -= Frame;
+	}
+}
+
 //static STREAM_UPDATE( pokey_update )
 void pokey_update(void *param, stream_sample_t **outputs, int samples)
 {
@@ -544,7 +622,14 @@ void pokey_update(void *param, stream_sample_t **outputs, int samples)
 	//stream_sample_t *buffer = outputs[0];
 	stream_sample_t *bufL = outputs[0];
 	stream_sample_t *bufR = outputs[1];
-	PROCESS_POKEY(chip);
+	if (chip->StepSynth)
+	{
+		pokey_update_steps(chip, outputs, samples);
+		return;
+	}
+	{
+		PROCESS_POKEY(chip);
+	}
 }
 
 
@@ -645,6 +730,7 @@ int device_start_pokey(void **_info, int clock)
 	//chip->device = device;
 	//chip->clock_period = attotime::from_hz(device->clock());
 	chip->clock_period = 1.0 / clock;
+	chip->clock = clock;
 
 	/* calculate the A/D times
      * In normal, slow mode (SKCTL bit SK_PADDLE is clear) the conversion
@@ -729,9 +815,28 @@ void device_reset_pokey(void *_info)
 	chip->r17 = 0;
 	chip->clockmult = DIV_64;
 	
+	chip->StepLevel = 0;
+	blip_clear(&chip->Blip);
+	
 	return;
 }
 
+UINT32 pokey_set_step_synth(void *_info, UINT32 SampleRate, double Gain)
+{
+	// returns the new sample rate of the chip (0 - not possible)
+	// Gain scales the steps to the level the chip would have after resampling.
+	pokey_state *chip = (pokey_state *)_info;
+	
+	if (! chip->clock)
+		return 0;
+	chip->StepSynth = 0x01;
+	chip->StepLevel = 0;
+	chip->StepGain = (UINT32)(Gain * 0x1000 + 0.5);
+	blip_init(&chip->Blip, chip->clock, SampleRate);
+	
+	return SampleRate;
+}
+
 /*static TIMER_CALLBACK( pokey_timer_expire )
 {
 	pokey_state *p = (pokey_state *)ptr;
@@ -95,5 +95,6 @@ void pokey_break_w (device_t *device, int shift);
 void pokey_kbcode_w (device_t *device, int kbcode, int make);*/
 
 void pokey_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 pokey_set_step_synth(void *chip, UINT32 SampleRate, double Gain);
 
 //DECLARE_LEGACY_SOUND_DEVICE(POKEY, pokey);
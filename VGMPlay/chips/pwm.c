@@ -354,6 +354,28 @@ void pwm_mute(void *_info, UINT8 Mute)
     chip->Mute = Mute;
 }
 
+UINT32 pwm_save_state(void *_info, void *Buffer)
+{
+	// copies the chip state to Buffer (or only returns its size, if Buffer is NULL)
+	if (Buffer != NULL)
+		memcpy(Buffer, _info, sizeof(pwm_chip));
+	
+	return sizeof(pwm_chip);
+}
+
+void pwm_load_state(void *_info, const void *Buffer)
+{
+	// restores a state that was saved from the same chip (the mute flag is kept)
+	pwm_chip *chip = (pwm_chip *)_info;
+	UINT8 Mute;
+	
+	Mute = chip->Mute;
+	memcpy(chip, Buffer, sizeof(pwm_chip));
+	chip->Mute = Mute;
+	
+	return;
+}
+
 int device_start_pwm(void **_info, int clock, int CHIP_SAMPLING_MODE, int CHIP_SAMPLE_RATE)
 {
 	/* allocate memory for the chip */
@@ -59,5 +59,7 @@ void device_stop_pwm(void *chip);
 void device_reset_pwm(void *chip);
 
 void pwm_mute(void *chip, UINT8 Mute);
+UINT32 pwm_save_state(void *chip, void *Buffer);
+void pwm_load_state(void *chip, const void *Buffer);
 
 void pwm_chn_w(void *chip, UINT8 Channel, UINT16 data);
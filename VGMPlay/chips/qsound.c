@@ -32,6 +32,16 @@
 ***************************************************************************/
 
 //#include "emu.h"
+
+// vector versions of the channel mixing (SSE2 is part of x86-64, NEON of ARM64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+
 #include "mamedef.h"
 #ifdef _DEBUG
 #include <stdio.h>
@@ -58,6 +68,7 @@ typedef INT8 QSOUND_SRC_SAMPLE;
 
 #define QSOUND_CLOCKDIV 166			 /* Clock divider */
 #define QSOUND_CHANNELS 16
+#define QSOUND_BLOCK	256			 /* samples per channel that are rendered in one go */
 typedef stream_sample_t QSOUND_SAMPLE;
 
 struct QSOUND_CHANNEL
@@ -74,6 +85,7 @@ struct QSOUND_CHANNEL
 	int lvol;           // left volume
 	int rvol;           // right volume
 	UINT32 step_ptr;    // current offset counter
+	const INT8* rom_bank;	// ROM data of the bank, NULL if the bank isn't completely inside the ROM
 	
 	UINT8 Muted;
 };
@@ -88,6 +100,7 @@ struct _qsound_state
 	UINT16 data;			/* register latch data */
 	QSOUND_SRC_SAMPLE *sample_rom;	/* Q sound sample ROM */
 	UINT32 sample_rom_length;
+	UINT8 sample_rom_ref;	/* sample ROM is owned by the caller (qsound_set_rom) */
 
 	int pan_table[33];		/* Pan volume table */
 
@@ -106,6 +119,7 @@ struct _qsound_state
 /* Function prototypes */
 //static STREAM_UPDATE( qsound_update );
 static void qsound_set_command(qsound_state *chip, UINT8 address, UINT16 data);
+static void qsound_set_bank(qsound_state *chip, struct QSOUND_CHANNEL *pC);
 
 //static DEVICE_START( qsound )
 int device_start_qsound(void **_info, int clock)
@@ -121,6 +135,7 @@ int device_start_qsound(void **_info, int clock)
 	//chip->sample_rom_length = device->region()->bytes();
 	chip->sample_rom = NULL;
 	chip->sample_rom_length = 0x00;
+	chip->sample_rom_ref = 0x00;
 
 	/* Create pan table */
 	for (i=0; i<33; i++)
@@ -184,7 +199,9 @@ void device_stop_qsound(void *_info)
 		fclose(chip->fpRawDataL);
 	}
 	chip->fpRawDataL = NULL;*/
-	free(chip->sample_rom);	chip->sample_rom = NULL;
+	if (! chip->sample_rom_ref)
+		free(chip->sample_rom);
+	chip->sample_rom = NULL;
 	free(chip);
 }
 
@@ -273,6 +290,7 @@ static void qsound_set_command(qsound_state *chip, UINT8 address, UINT16 data)
 			// bank, high bits unknown
 			ch = (ch + 1) & 0x0f;	/* strange ... */
 			chip->channel[ch].bank = (data & 0x7f) << 16;	// Note: The most recent MAME doesn't do "& 0x7F"
+			qsound_set_bank(chip, &chip->channel[ch]);
 #ifdef _DEBUG
 			if (data && !(data & 0x8000))
 				printf("QSound Ch %u: Bank = %04x\n",ch,data);
@@ -355,66 +373,184 @@ static void qsound_set_command(qsound_state *chip, UINT8 address, UINT16 data)
 }
 
 
+static void qsound_set_bank(qsound_state *chip, struct QSOUND_CHANNEL *pC)
+{
+	UINT32 bank_ofs;
+	
+	// Addresses stay within 0000..FFFF while the channel is playing (freq != 0), so
+	// "(bank | address) % rom_length" is "bank % rom_length + address" if the whole
+	// 64 KB bank fits into the ROM. This saves the division per sample.
+	pC->rom_bank = NULL;
+	if (! chip->sample_rom_length)
+		return;
+	bank_ofs = pC->bank % chip->sample_rom_length;
+	if (bank_ofs + 0x10000 <= chip->sample_rom_length)
+		pC->rom_bank = &chip->sample_rom[bank_ofs];
+	
+	return;
+}
+
+// Advances the channel by one sample, returns 0 when it reached the end of a non-looped sample.
+INLINE UINT8 qsound_advance(struct QSOUND_CHANNEL *pC)
+{
+	UINT32 advance;
+	
+	advance = (pC->step_ptr >> 12);
+	pC->step_ptr &= 0xfff;
+	pC->step_ptr += pC->freq;
+	
+	if (advance)
+	{
+		pC->address += advance;
+		if (pC->freq && pC->address >= pC->end)
+		{
+			if (pC->loop)
+			{
+				// Reached the end, restart the loop
+				pC->address -= pC->loop;
+				
+				// Make sure we don't overflow (what does the real chip do in this case?)
+				if (pC->address >= pC->end)
+					pC->address = pC->end - pC->loop;
+				
+				pC->address &= 0xffff;
+			}
+			else
+			{
+				// Reached the end of a non-looped sample
+				//pC->enabled = 0;
+				pC->address --;	// ensure that old ripped VGMs still work
+				pC->step_ptr += 0x1000;
+				return 0;
+			}
+		}
+	}
+	
+	return 1;
+}
+
+// see qsound_set_bank, else it falls back to the division per sample
+#define QSOUND_READ(chip, pC, rom_bank)	\
+	((rom_bank != NULL) ? rom_bank[pC->address] :	\
+		chip->sample_rom[(pC->bank | pC->address) % chip->sample_rom_length])
+
+INLINE const QSOUND_SRC_SAMPLE* qsound_get_bank(struct QSOUND_CHANNEL *pC)
+{
+	if (pC->freq && pC->address <= 0xffff)
+		return pC->rom_bank;
+	else
+		return NULL;
+}
+
+// Renders up to "samples" ROM samples of a channel, returns the number of samples
+// before the channel reached the end of a non-looped sample.
+INLINE int qsound_render_channel(qsound_state *chip, struct QSOUND_CHANNEL *pC, INT16 *buffer, int samples)
+{
+	const QSOUND_SRC_SAMPLE *rom_bank = qsound_get_bank(pC);
+	int j;
+	
+	for (j=0; j<samples; j++)
+	{
+		if (! qsound_advance(pC))
+			break;
+		buffer[j] = QSOUND_READ(chip, pC, rom_bank);
+	}
+	
+	return j;
+}
+
+// output += (sample * pan * vol) >> 14
+INLINE void qsound_mix_channel(QSOUND_SAMPLE *output, const INT16 *buffer, int pan, UINT16 vol, int samples)
+{
+	int j;
+	
+	j = 0;
+#if defined(MIX_SSE2)
+	{
+		// sample * pan fits into 16 bits (-128 * 256 = -32768), the product with the
+		// unsigned volume is put together from the signed 16x16 bit multiplications
+		const __m128i Pan = _mm_set1_epi16(pan);
+		const __m128i Vol = _mm_set1_epi16((INT16)vol);
+		const __m128i VolSign = _mm_set1_epi16((vol & 0x8000) ? -1 : 0);
+		__m128i Smpl;
+		__m128i MulLo;
+		__m128i MulHi;
+		
+		for (; j+8<=samples; j+=8)
+		{
+			Smpl = _mm_mullo_epi16(_mm_loadu_si128((const __m128i*)&buffer[j]), Pan);
+			MulLo = _mm_mullo_epi16(Smpl, Vol);
+			MulHi = _mm_add_epi16(_mm_mulhi_epi16(Smpl, Vol), _mm_and_si128(Smpl, VolSign));
+			_mm_storeu_si128((__m128i*)&output[j+0], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&output[j+0]),
+							_mm_srai_epi32(_mm_unpacklo_epi16(MulLo, MulHi), 14)));
+			_mm_storeu_si128((__m128i*)&output[j+4], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&output[j+4]),
+							_mm_srai_epi32(_mm_unpackhi_epi16(MulLo, MulHi), 14)));
+		}
+	}
+#elif defined(MIX_NEON)
+	{
+		const int32x4_t Vol = vdupq_n_s32(pan * vol);
+		int16x8_t Smpl;
+		
+		for (; j+8<=samples; j+=8)
+		{
+			Smpl = vld1q_s16(&buffer[j]);
+			vst1q_s32(&output[j+0], vsraq_n_s32(vld1q_s32(&output[j+0]), vmulq_s32(vmovl_s16(vget_low_s16(Smpl)), Vol), 14));
+			vst1q_s32(&output[j+4], vsraq_n_s32(vld1q_s32(&output[j+4]), vmulq_s32(vmovl_s16(vget_high_s16(Smpl)), Vol), 14));
+		}
+	}
+#endif
+	for (; j<samples; j++)
+		output[j] += ((buffer[j] * pan * vol) >> 14);
+}
+
 //static STREAM_UPDATE( qsound_update )
 void qsound_update(void *param, stream_sample_t **outputs, int samples)
 {
 	qsound_state *chip = (qsound_state *)param;
-	int i,j;
-	UINT32 offset;
-	UINT32 advance;
-	INT8 sample;
-	struct QSOUND_CHANNEL *pC=&chip->channel[0];
+	int i;
+	int done, len, count;
+	INT16 buffer[QSOUND_BLOCK];
+	struct QSOUND_CHANNEL *pC;
 
 	memset( outputs[0], 0x00, samples * sizeof(*outputs[0]) );
 	memset( outputs[1], 0x00, samples * sizeof(*outputs[1]) );
 	if (! chip->sample_rom_length)
 		return;
 
-	for (i=0; i<QSOUND_CHANNELS; i++, pC++)
+	for (i=0, pC=&chip->channel[0]; i<QSOUND_CHANNELS; i++, pC++)
 	{
-		if (pC->enabled && ! pC->Muted)
+		if (! pC->enabled || pC->Muted)
+			continue;
+		
+		if (samples < 8)
 		{
-			QSOUND_SAMPLE *pOutL=outputs[0];
-			QSOUND_SAMPLE *pOutR=outputs[1];
+			// too short for the block mixing (the resampler often asks for single samples)
+			const QSOUND_SRC_SAMPLE *rom_bank = qsound_get_bank(pC);
+			INT8 sample;
 			
-			for (j=samples-1; j>=0; j--)
+			for (done=0; done<samples; done++)
 			{
-				advance = (pC->step_ptr >> 12);
-				pC->step_ptr &= 0xfff;
-				pC->step_ptr += pC->freq;
-				
-				if (advance)
-				{
-					pC->address += advance;
-					if (pC->freq && pC->address >= pC->end)
-					{
-						if (pC->loop)
-						{
-							// Reached the end, restart the loop
-							pC->address -= pC->loop;
-							
-							// Make sure we don't overflow (what does the real chip do in this case?)
-							if (pC->address >= pC->end)
-								pC->address = pC->end - pC->loop;
-							
-							pC->address &= 0xffff;
-						}
-						else
-						{
-							// Reached the end of a non-looped sample
-							//pC->enabled = 0;
-							pC->address --;	// ensure that old ripped VGMs still work
-							pC->step_ptr += 0x1000;
-							break;
-						}
-					}
-				}
-				
-				offset = (pC->bank | pC->address) % chip->sample_rom_length;
-				sample = chip->sample_rom[offset];
-				*pOutL++ += ((sample * pC->lvol * pC->vol) >> 14);
-				*pOutR++ += ((sample * pC->rvol * pC->vol) >> 14);
+				if (! qsound_advance(pC))
+					break;
+				sample = QSOUND_READ(chip, pC, rom_bank);
+				outputs[0][done] += ((sample * pC->lvol * pC->vol) >> 14);
+				outputs[1][done] += ((sample * pC->rvol * pC->vol) >> 14);
 			}
+			continue;
+		}
+		for (done=0; done<samples; done+=len)
+		{
+			len = samples - done;
+			if (len > QSOUND_BLOCK)
+				len = QSOUND_BLOCK;
+			count = qsound_render_channel(chip, pC, buffer, len);
+			if (pC->lvol && pC->vol)
+				qsound_mix_channel(&outputs[0][done], buffer, pC->lvol, pC->vol, count);
+			if (pC->rvol && pC->vol)
+				qsound_mix_channel(&outputs[1][done], buffer, pC->rvol, pC->vol, count);
+			if (count < len)
+				break;	// the rest of the update stays silent
 		}
 	}
 
@@ -428,13 +564,24 @@ void qsound_write_rom(void *_info, offs_t ROMSize, offs_t DataStart, offs_t Data
 					  const UINT8* ROMData)
 {
 	qsound_state* info = (qsound_state *)_info;
+	UINT8 CurChn;
 	
+	if (info->sample_rom_ref)
+	{
+		// make a copy of the caller's ROM before modifying it
+		QSOUND_SRC_SAMPLE* ROMCopy = (QSOUND_SRC_SAMPLE*)malloc(info->sample_rom_length);
+		memcpy(ROMCopy, info->sample_rom, info->sample_rom_length);
+		info->sample_rom = ROMCopy;
+		info->sample_rom_ref = 0x00;
+	}
 	if (info->sample_rom_length != ROMSize)
 	{
 		info->sample_rom = (QSOUND_SRC_SAMPLE*)realloc(info->sample_rom, ROMSize);
 		info->sample_rom_length = ROMSize;
 		memset(info->sample_rom, 0xFF, ROMSize);
 	}
+	for (CurChn = 0; CurChn < QSOUND_CHANNELS; CurChn ++)
+		qsound_set_bank(info, &info->channel[CurChn]);	// the ROM may have moved
 	if (DataStart > ROMSize)
 		return;
 	if (DataStart + DataLength > ROMSize)
@@ -445,6 +592,23 @@ void qsound_write_rom(void *_info, offs_t ROMSize, offs_t DataStart, offs_t Data
 	return;
 }
 
+void qsound_set_rom(void *_info, offs_t ROMSize, const UINT8* ROMData)
+{
+	// use a complete ROM image in place, it must stay valid until the chip is stopped
+	qsound_state* info = (qsound_state *)_info;
+	UINT8 CurChn;
+	
+	if (! info->sample_rom_ref)
+		free(info->sample_rom);
+	info->sample_rom = (QSOUND_SRC_SAMPLE*)ROMData;
+	info->sample_rom_length = ROMSize;
+	info->sample_rom_ref = 0x01;
+	for (CurChn = 0; CurChn < QSOUND_CHANNELS; CurChn ++)
+		qsound_set_bank(info, &info->channel[CurChn]);
+	
+	return;
+}
+
 
 void qsound_set_mute_mask(void *_info, UINT32 MuteMask)
 {
@@ -457,6 +621,53 @@ void qsound_set_mute_mask(void *_info, UINT32 MuteMask)
 	return;
 }
 
+UINT32 qsound_save_state(void *_info, void *Buffer)
+{
+	// copies the chip state to Buffer (or only returns its size, if Buffer is NULL)
+	if (Buffer != NULL)
+		memcpy(Buffer, _info, sizeof(qsound_state));
+	
+	return sizeof(qsound_state);
+}
+
+void qsound_load_state(void *_info, const void *Buffer)
+{
+	// restores a state that was saved from the same chip (ROM and mute mask are kept)
+	qsound_state* info = (qsound_state *)_info;
+	qsound_state OldState;
+	UINT8 CurChn;
+	
+	OldState = *info;
+	memcpy(info, Buffer, sizeof(qsound_state));
+	info->sample_rom = OldState.sample_rom;
+	info->sample_rom_length = OldState.sample_rom_length;
+	info->sample_rom_ref = OldState.sample_rom_ref;
+	for (CurChn = 0; CurChn < QSOUND_CHANNELS; CurChn ++)
+	{
+		info->channel[CurChn].Muted = OldState.channel[CurChn].Muted;
+		qsound_set_bank(info, &info->channel[CurChn]);	// the bank pointers depend on the ROM
+	}
+	
+	return;
+}
+
+UINT8 qsound_is_silent(void *_info)
+{
+	// muted channels are skipped by the update and don't advance either
+	qsound_state* info = (qsound_state *)_info;
+	UINT8 CurChn;
+	
+	if (! info->sample_rom_length)
+		return 0x01;
+	for (CurChn = 0; CurChn < QSOUND_CHANNELS; CurChn ++)
+	{
+		if (info->channel[CurChn].enabled && ! info->channel[CurChn].Muted)
+			return 0x00;
+	}
+	
+	return 0x01;
+}
+
 
 
 /**************************************************************************
@@ -24,6 +24,10 @@ UINT8 qsound_r(void *chip, offs_t offset);
 
 void qsound_write_rom(void *chip, offs_t ROMSize, offs_t DataStart, offs_t DataLength,
 					   const UINT8* ROMData);
+void qsound_set_rom(void *chip, offs_t ROMSize, const UINT8* ROMData);
 void qsound_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 qsound_save_state(void *chip, void *Buffer);
+void qsound_load_state(void *chip, const void *Buffer);
+UINT8 qsound_is_silent(void *chip);
 
 //DECLARE_LEGACY_SOUND_DEVICE(QSOUND, qsound);
@@ -446,6 +446,40 @@ void rf5c68_set_mute_mask(void *_info, UINT32 MuteMask)
 	return;
 }
 
+UINT32 rf5c68_save_state(void *_info, void *Buffer)
+{
+	// copies the chip state and the wave RAM to Buffer (or only returns their size, if Buffer is NULL)
+	rf5c68_state *chip = (rf5c68_state *)_info;
+	
+	if (Buffer != NULL)
+	{
+		memcpy(Buffer, chip, sizeof(rf5c68_state));
+		memcpy((UINT8*)Buffer + sizeof(rf5c68_state), chip->data, chip->datasize);
+	}
+	
+	return sizeof(rf5c68_state) + chip->datasize;
+}
+
+void rf5c68_load_state(void *_info, const void *Buffer)
+{
+	// restores a state that was saved from the same chip (the mute mask is kept)
+	rf5c68_state *chip = (rf5c68_state *)_info;
+	UINT8 Muted[NUM_CHANNELS];
+	UINT8* Data;
+	unsigned char CurChn;
+	
+	for (CurChn = 0; CurChn < NUM_CHANNELS; CurChn ++)
+		Muted[CurChn] = chip->chan[CurChn].Muted;
+	Data = chip->data;
+	memcpy(chip, Buffer, sizeof(rf5c68_state));
+	for (CurChn = 0; CurChn < NUM_CHANNELS; CurChn ++)
+		chip->chan[CurChn].Muted = Muted[CurChn];
+	chip->data = Data;
+	memcpy(chip->data, (const UINT8*)Buffer + sizeof(rf5c68_state), chip->datasize);
+	
+	return;
+}
+
 
 
 /**************************************************************************
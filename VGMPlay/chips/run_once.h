@@ -0,0 +1,38 @@
+#ifndef __RUN_ONCE_H__
+#define __RUN_ONCE_H__
+
+// run_once() calls a function exactly once, even when several threads (i.e. players)
+// get there at the same time. The sound cores use it to build their shared lookup tables.
+// (include mamedef.h first)
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef volatile LONG	run_once_t;
+#define RUN_ONCE_INIT	0
+
+INLINE void run_once(run_once_t* flag, void (*func)(void))
+{
+	// 0 - not called yet, 1 - running, 2 - done
+	if (InterlockedCompareExchange(flag, 2, 2) == 2)
+		return;
+	if (InterlockedCompareExchange(flag, 1, 0) == 0)
+	{
+		func();
+		InterlockedExchange(flag, 2);
+		return;
+	}
+	while(InterlockedCompareExchange(flag, 2, 2) != 2)
+		Sleep(0);
+	return;
+}
+#else
+#include <pthread.h>
+
+typedef pthread_once_t	run_once_t;
+#define RUN_ONCE_INIT	PTHREAD_ONCE_INIT
+#define run_once(flag, func)	pthread_once(flag, func)
+#endif
+
+#endif	// __RUN_ONCE_H__
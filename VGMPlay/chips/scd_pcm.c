@@ -508,3 +508,37 @@ void rf5c164_set_mute_mask(void *_info, UINT32 MuteMask)
 	
 	return;
 }
+
+UINT32 rf5c164_save_state(void *_info, void *Buffer)
+{
+	// copies the chip state and the wave RAM to Buffer (or only returns their size, if Buffer is NULL)
+	struct pcm_chip_ *chip = (struct pcm_chip_ *)_info;
+	
+	if (Buffer != NULL)
+	{
+		memcpy(Buffer, chip, sizeof(struct pcm_chip_));
+		memcpy((UINT8*)Buffer + sizeof(struct pcm_chip_), chip->RAM, chip->RAMSize);
+	}
+	
+	return sizeof(struct pcm_chip_) + chip->RAMSize;
+}
+
+void rf5c164_load_state(void *_info, const void *Buffer)
+{
+	// restores a state that was saved from the same chip (the mute mask is kept)
+	struct pcm_chip_ *chip = (struct pcm_chip_ *)_info;
+	unsigned int Muted[8];
+	unsigned char* RAM;
+	unsigned char CurChn;
+	
+	for (CurChn = 0; CurChn < 8; CurChn ++)
+		Muted[CurChn] = chip->Channel[CurChn].Muted;
+	RAM = chip->RAM;
+	memcpy(chip, Buffer, sizeof(struct pcm_chip_));
+	for (CurChn = 0; CurChn < 8; CurChn ++)
+		chip->Channel[CurChn].Muted = Muted[CurChn];
+	chip->RAM = RAM;
+	memcpy(chip->RAM, (const UINT8*)Buffer + sizeof(struct pcm_chip_), chip->RAMSize);
+	
+	return;
+}
@@ -45,3 +45,5 @@ void rf5c164_mem_w(void *chip, offs_t offset, UINT8 data);
 void rf5c164_write_ram(void *chip, offs_t DataStart, offs_t DataLength, const UINT8* RAMData);
 
 void rf5c164_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 rf5c164_save_state(void *chip, void *Buffer);
+void rf5c164_load_state(void *chip, const void *Buffer);
@@ -382,6 +382,48 @@ void segapcm_set_mute_mask(void *_info, UINT32 MuteMask)
 	return;
 }
 
+UINT32 segapcm_save_state(void *_info, void *Buffer)
+{
+	// copies the chip state to Buffer (or only returns its size, if Buffer is NULL)
+	// Only the register RAM and the sample position fractions change during playback,
+	// the ROM settings are left out.
+	segapcm_state *spcm = (segapcm_state *)_info;
+	
+	if (Buffer != NULL)
+	{
+		memcpy(Buffer, spcm->low, sizeof(spcm->low));
+		memcpy((UINT8*)Buffer + sizeof(spcm->low), spcm->ram, 0x800);
+	}
+	
+	return sizeof(spcm->low) + 0x800;
+}
+
+void segapcm_load_state(void *_info, const void *Buffer)
+{
+	// restores a state that was saved from the same chip
+	segapcm_state *spcm = (segapcm_state *)_info;
+	
+	memcpy(spcm->low, Buffer, sizeof(spcm->low));
+	memcpy(spcm->ram, (const UINT8*)Buffer + sizeof(spcm->low), 0x800);
+	
+	return;
+}
+
+UINT8 segapcm_is_silent(void *_info)
+{
+	// muted channels are skipped by the update and don't advance either
+	segapcm_state *spcm = (segapcm_state *)_info;
+	unsigned char CurChn;
+	
+	for (CurChn = 0; CurChn < 16; CurChn ++)
+	{
+		if (! (spcm->ram[0x86 + 8 * CurChn] & 1) && ! spcm->Muted[CurChn])
+			return 0x00;
+	}
+	
+	return 0x01;
+}
+
 
 /**************************************************************************
  * Generic get_info
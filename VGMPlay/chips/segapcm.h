@@ -35,4 +35,7 @@ void sega_pcm_write_rom(void *chip, offs_t ROMSize, offs_t DataStart, offs_t Dat
 						const UINT8* ROMData);
 
 void segapcm_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT32 segapcm_save_state(void *chip, void *Buffer);
+void segapcm_load_state(void *chip, const void *Buffer);
+UINT8 segapcm_is_silent(void *chip);
 
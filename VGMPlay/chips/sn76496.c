@@ -127,6 +127,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "sn76496.h"
+#include "blip.h"
 
 #ifndef NULL
 #define NULL	((void *)0)
@@ -163,6 +164,11 @@ struct _sn76496_state
 	UINT32 MuteMsk[4];
 	UINT8 NgpFlags;		/* bit 7 - NGP Mode on/off, bit 0 - is 2nd NGP chip */
 	sn76496_state* NgpChip2;	/* Pointer to other Chip */
+	stream_sample_t** VoiceOut;	/* L/R output of every single channel (optional) */
+	INT32 TickRate;		/* rate of the divided clock, the native sample rate */
+	UINT8 StepSynth;	/* render band-limited steps at the output rate instead (see blip.h) */
+	INT32 StepLevel[2];	/* L/R output of the last step */
+	BLIP_BUF Blip[2];
 };
 
 
@@ -279,6 +285,26 @@ void sn76496_write_reg(void *chip, offs_t offset, UINT8 data)
 	}
 }
 
+INLINE void SN76496_clock_noise(sn76496_state *R)
+{
+	// if noisemode is 1, both taps are enabled
+	// if noisemode is 0, the lower tap, whitenoisetap2, is held at 0
+	if (((R->RNG & R->WhitenoiseTap1)?1:0) ^ ((((R->RNG & R->WhitenoiseTap2)?1:0))*(NOISEMODE)))
+	{
+		R->RNG >>= 1;
+		R->RNG |= R->FeedbackMask;
+	}
+	else
+	{
+		R->RNG >>= 1;
+	}
+	R->Output[3] = R->RNG & 1;
+
+	R->Count[3] = R->Period[3];
+}
+
+static void SN76496_update_steps(sn76496_state *R, stream_sample_t **outputs, int samples);
+
 //static STREAM_UPDATE( SN76496Update )
 void SN76496Update(void *chip, stream_sample_t **outputs, int samples)
 {
@@ -294,6 +320,15 @@ void SN76496Update(void *chip, stream_sample_t **outputs, int samples)
 	INT32 vol[4];
 	UINT8 NGPMode;
 	INT32 ggst[2];
+	stream_sample_t** VoiceOut = R->VoiceOut;
+	INT32 chl, chr;
+	int smpl;
+
+	if (R->StepSynth)
+	{
+		SN76496_update_steps(R, outputs, samples);
+		return;
+	}
 
 	NGPMode = (R->NgpFlags >> 7) & 0x01;
 	if (NGPMode)
@@ -317,12 +352,18 @@ void SN76496Update(void *chip, stream_sample_t **outputs, int samples)
 		{
 			memset(lbuffer, 0x00, sizeof(stream_sample_t) * samples);
 			memset(rbuffer, 0x00, sizeof(stream_sample_t) * samples);
+			if (VoiceOut != NULL)
+			{
+				for (i = 0; i < 4 * 2; i ++)
+					memset(VoiceOut[i], 0x00, sizeof(stream_sample_t) * samples);
+			}
 			return;
 		}
 	}
 	
 	ggst[0] = 0x01;
 	ggst[1] = 0x01;
+	smpl = 0;
 	while (samples > 0)
 	{
 		/* Speed Patch */
@@ -351,22 +392,7 @@ void SN76496Update(void *chip, stream_sample_t **outputs, int samples)
 			// handle channel 3
 			R->Count[3]--;
 			if (R->Count[3] <= 0)
-			{
-			// if noisemode is 1, both taps are enabled
-			// if noisemode is 0, the lower tap, whitenoisetap2, is held at 0
-				if (((R->RNG & R->WhitenoiseTap1)?1:0) ^ ((((R->RNG & R->WhitenoiseTap2)?1:0))*(NOISEMODE)))
-				{
-					R->RNG >>= 1;
-					R->RNG |= R->FeedbackMask;
-				}
-				else
-				{
-					R->RNG >>= 1;
-				}
-				R->Output[3] = R->RNG & 1;
-
-				R->Count[3] = R->Period[3];
-			}
+				SN76496_clock_noise(R);
 		//}
 
 
@@ -417,16 +443,28 @@ void SN76496Update(void *chip, stream_sample_t **outputs, int samples)
 				}
 				if (R->Period[i] > 1 || i == 3)
 				{
-					out += vol[i] * R->Volume[i] * ggst[0];
-					out2 += vol[i] * R->Volume[i] * ggst[1];
+					chl = vol[i] * R->Volume[i] * ggst[0];
+					chr = vol[i] * R->Volume[i] * ggst[1];
 				}
 				else if (R->MuteMsk[i])
 				{
 					// Make Bipolar Output with PCM possible
 					//out += (2 * R->Volume[i] - R->VolTable[5]) * ggst[0];
 					//out2 += (2 * R->Volume[i] - R->VolTable[5]) * ggst[1];
-					out += R->Volume[i] * ggst[0];
-					out2 += R->Volume[i] * ggst[1];
+					chl = R->Volume[i] * ggst[0];
+					chr = R->Volume[i] * ggst[1];
+				}
+				else
+				{
+					chl = chr = 0;
+				}
+				out += chl;
+				out2 += chr;
+				if (VoiceOut != NULL)
+				{
+					if(R->Negate) { chl = -chl; chr = -chr; }
+					VoiceOut[i * 2 + 0][smpl] = chl >> 1;
+					VoiceOut[i * 2 + 1][smpl] = chr >> 1;
 				}
 			}
 		}
@@ -502,10 +540,140 @@ void SN76496Update(void *chip, stream_sample_t **outputs, int samples)
 		*(lbuffer++) = out >> 1;	// Output is Bipolar
 		//if (R->Stereo) *(rbuffer++) = out2;
 		*(rbuffer++) = out2 >> 1;
+		smpl++;
 		samples--;
 	}
 }
 
+static void SN76496_add_steps(sn76496_state *R, UINT32 Time, UINT8 Write)
+{
+	// the same mix as SN76496Update does without the NGP mode
+	INT32 out[2];
+	INT32 vol;
+	INT32 ggst[2];
+	int i;
+
+	out[0] = out[1] = 0;
+	ggst[0] = ggst[1] = 0x01;
+	for (i = 0; i < 4; i ++)
+	{
+		vol = R->Output[i] ? +1 : -1;
+		if (i != 3 && R->Period[i] <= FNumLimit && R->Period[i] > 1)
+			vol = 0;
+		vol &= R->MuteMsk[i];
+
+		if (R->Stereo)
+		{
+			ggst[0] = (R->StereoMask & (0x10 << i)) ? 0x01 : 0x00;
+			ggst[1] = (R->StereoMask & (0x01 << i)) ? 0x01 : 0x00;
+		}
+		if (R->Period[i] > 1 || i == 3)
+		{
+			out[0] += vol * R->Volume[i] * ggst[0];
+			out[1] += vol * R->Volume[i] * ggst[1];
+		}
+		else if (R->MuteMsk[i])
+		{
+			out[0] += R->Volume[i] * ggst[0];
+			out[1] += R->Volume[i] * ggst[1];
+		}
+	}
+	if (R->Negate) { out[0] = -out[0]; out[1] = -out[1]; }
+
+	for (i = 0; i < 2; i ++)
+	{
+		if ((out[i] >> 1) != R->StepLevel[i])
+		{
+			if (Write)
+				blip_add_write_delta(&R->Blip[i], (out[i] >> 1) - R->StepLevel[i]);
+			else
+				blip_add_delta(&R->Blip[i], Time, (out[i] >> 1) - R->StepLevel[i]);
+			R->StepLevel[i] = out[i] >> 1;
+		}
+	}
+}
+
+INLINE void SN76496_advance_tone(sn76496_state *R, int i, INT32 Ticks)
+{
+	// gives the same state as counting down Ticks times
+	INT32 first = (R->Count[i] > 1) ? R->Count[i] : 1;	// tick of the next toggle
+	INT32 period = (R->Period[i] > 1) ? R->Period[i] : 1;
+	INT32 toggles;
+
+	if (Ticks < first)
+	{
+		R->Count[i] -= Ticks;
+		return;
+	}
+	toggles = 1 + (Ticks - first) / period;
+	R->Output[i] ^= toggles & 1;
+	R->Count[i] = R->Period[i] - (Ticks - first - (toggles - 1) * period);
+}
+
+static void SN76496_update_steps(sn76496_state *R, stream_sample_t **outputs, int samples)
+{
+	// The counters jump from one audible output change to the next one and the
+	// changes become band-limited steps at the output rate. Tones above the
+	// Nyquist frequency are silent anyway, so they don't need to stop there.
+	stream_sample_t *lbuffer = outputs[0];
+	stream_sample_t *rbuffer = outputs[1];
+	UINT32 Clocks;
+	UINT32 Time;
+	INT32 Ticks;
+	INT32 Next;
+	UINT8 Idle;
+	int Frame;
+	int i;
+
+	// the speed hack of SN76496Update: nothing runs while all channels are off
+	Idle = ! R->Volume[3];
+	for (i = 0; i < 3; i ++)
+	{
+		if (R->Period[i] || R->Volume[i])
+			Idle = 0;
+	}
+
+	while (samples > 0)
+	{
+		Frame = (samples > BLIP_MAX_FRAME) ? BLIP_MAX_FRAME : samples;
+		Clocks = blip_clocks_needed(&R->Blip[0], Frame);
+		SN76496_add_steps(R, 0, 0x01);	// register writes since the last update
+		for (Time = 0; ! Idle && Time < Clocks; Time += Ticks)
+		{
+			Ticks = Clocks - Time;
+			for (i = 0; i < 3; i ++)
+			{
+				if (R->Period[i] > 1 && R->Period[i] > FNumLimit)
+				{
+					Next = (R->Count[i] > 1) ? R->Count[i] : 1;
+					if (Next < Ticks)
+						Ticks = Next;
+				}
+			}
+			Next = (R->Count[3] > 1) ? R->Count[3] : 1;
+			if (Next < Ticks)
+				Ticks = Next;
+
+			if (R->CyclestoREADY > 0)
+				R->CyclestoREADY = (R->CyclestoREADY > Ticks) ? (R->CyclestoREADY - Ticks) : 0;
+			for (i = 0; i < 3; i ++)
+				SN76496_advance_tone(R, i, Ticks);
+			if (R->Count[3] <= Ticks)
+				SN76496_clock_noise(R);
+			else
+				R->Count[3] -= Ticks;
+			SN76496_add_steps(R, Time + Ticks - 1, 0x00);
+		}
+		blip_end_frame(&R->Blip[0], Clocks);
+		blip_end_frame(&R->Blip[1], Clocks);
+		blip_read_samples(&R->Blip[0], lbuffer, Frame);
+		blip_read_samples(&R->Blip[1], rbuffer, Frame);
+		lbuffer += Frame;
+		rbuffer += Frame;
+		samples -= Frame;
+	}
+}
+
 
 
 static void SN76496_set_gain(sn76496_state *R,int gain)
@@ -621,6 +789,7 @@ static int generic_start(sn76496_state *chip, int clock, int feedbackmask, int n
 	
 	/* Speed Patch*/
 	sample_rate /= chip->ClockDivider;
+	chip->TickRate = sample_rate;
 	
 	/*state_save_register_device_item_array(device, 0, chip->VolTable);
 	state_save_register_device_item_array(device, 0, chip->Register);
@@ -713,10 +882,29 @@ void sn76496_reset(void *chip)
 
 	R->RNG = R->FeedbackMask;
 	R->Output[3] = R->RNG & 1;
+
+	R->StepLevel[0] = R->StepLevel[1] = 0;
+	blip_clear(&R->Blip[0]);
+	blip_clear(&R->Blip[1]);
 	
 	return;
 }
 
+UINT32 sn76496_set_step_synth(void *chip, UINT32 SampleRate)
+{
+	// returns the new sample rate of the chip (0 - not possible)
+	sn76496_state *R = (sn76496_state*)chip;
+	
+	if (R->NgpFlags || R->VoiceOut != NULL || ! R->TickRate)
+		return 0;
+	R->StepSynth = 0x01;
+	R->StepLevel[0] = R->StepLevel[1] = 0;
+	blip_init(&R->Blip[0], R->TickRate, SampleRate);
+	blip_init(&R->Blip[1], R->TickRate, SampleRate);
+	
+	return SampleRate;
+}
+
 void sn76496_freq_limiter(int clock, int clockdiv, int sample_rate)
 {
 	FNumLimit = (unsigned short int)((clock / (clockdiv ? 2.0 : 16.0)) / sample_rate);
@@ -724,6 +912,44 @@ void sn76496_freq_limiter(int clock, int clockdiv, int sample_rate)
 	return;
 }
 
+UINT32 sn76496_save_state(void *chip, void *Buffer)
+{
+	// copies the chip state to Buffer (or only returns its size, if Buffer is NULL)
+	if (Buffer != NULL)
+		memcpy(Buffer, chip, sizeof(sn76496_state));
+	
+	return sizeof(sn76496_state);
+}
+
+void sn76496_load_state(void *chip, const void *Buffer)
+{
+	// restores a state that was saved from the same chip (the mute mask is kept)
+	sn76496_state *R = (sn76496_state*)chip;
+	UINT32 MuteMsk[4];
+	stream_sample_t** VoiceOut;
+	
+	memcpy(MuteMsk, R->MuteMsk, sizeof(MuteMsk));
+	VoiceOut = R->VoiceOut;
+	memcpy(R, Buffer, sizeof(sn76496_state));
+	memcpy(R->MuteMsk, MuteMsk, sizeof(MuteMsk));
+	R->VoiceOut = VoiceOut;
+	
+	return;
+}
+
+UINT8 sn76496_set_voiceout(void *chip, stream_sample_t **VoiceOut)
+{
+	// VoiceOut receives the L/R output of channel 0, L/R of channel 1, etc.
+	// Returns the number of channels (0 - not supported by this chip).
+	sn76496_state *R = (sn76496_state*)chip;
+	
+	if (R->NgpFlags)
+		return 0;	// the T6W28 channels are split between two chips
+	R->VoiceOut = VoiceOut;
+	
+	return 4;
+}
+
 void sn76496_set_mutemask(void *chip, UINT32 MuteMask)
 {
 	sn76496_state *R = (sn76496_state*)chip;
@@ -32,4 +32,8 @@ unsigned long int sn76496_start(void **chip, int clock, int shiftregwidth, int n
 void sn76496_shutdown(void *chip);
 void sn76496_reset(void *chip);
 void sn76496_freq_limiter(int clock, int clockdiv, int sample_rate);
+UINT32 sn76496_set_step_synth(void *chip, UINT32 SampleRate);
 void sn76496_set_mutemask(void *chip, UINT32 MuteMask);
+UINT32 sn76496_save_state(void *chip, void *Buffer);
+void sn76496_load_state(void *chip, const void *Buffer);
+UINT8 sn76496_set_voiceout(void *chip, stream_sample_t **VoiceOut);
@@ -117,6 +117,31 @@ void device_reset_sn764xx(void *_info)
 }
 
 
+UINT32 device_save_state_sn764xx(void *_info, void *Buffer)
+{
+	// returns 0 if the core can't save its state
+	sn764xx_state *info = (sn764xx_state*)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return sn76496_save_state(info->chip, Buffer);
+	}
+	
+	return 0;
+}
+
+void device_load_state_sn764xx(void *_info, const void *Buffer)
+{
+	sn764xx_state *info = (sn764xx_state*)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		sn76496_load_state(info->chip, Buffer);
+		break;
+	}
+}
+
+
 void sn764xx_w(void *_info, offs_t offset, UINT8 data)
 {
 	sn764xx_state *info = (sn764xx_state*)_info;
@@ -149,6 +174,68 @@ void sn764xx_w(void *_info, offs_t offset, UINT8 data)
 	}
 }
 
+static void sn764xx_reg_w_mame(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	if (Port == 0x00)
+		sn76496_write_reg(chip, 0x00, Data);
+	else if (Port == 0x01)
+		sn76496_stereo_w(chip, 0x01, Data);
+}
+
+#ifdef ENABLE_ALL_CORES
+static void sn764xx_reg_w_maxim(void *chip, UINT8 Port, UINT8 Offset, UINT8 Data)
+{
+	if (Port == 0x00)
+		SN76489_Write((SN76489_Context*)chip, Data);
+	else if (Port == 0x01)
+		SN76489_GGStereoWrite((SN76489_Context*)chip, Data);
+}
+#endif
+
+REGW_CALLBACK sn764xx_get_reg_write(void *_info, void **RetChip)
+{
+	// returns a function that writes a register straight to the core (for chip_reg_write)
+	sn764xx_state *info = (sn764xx_state*)_info;
+	*RetChip = info->chip;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return &sn764xx_reg_w_mame;
+#ifdef ENABLE_ALL_CORES
+	case EC_MAXIM:
+		return &sn764xx_reg_w_maxim;
+#endif
+	}
+
+	return NULL;
+}
+
+UINT8 sn764xx_set_voice_output(void *_info, stream_sample_t **VoiceOut)
+{
+	// returns the number of channels written to VoiceOut (0 - not supported)
+	sn764xx_state *info = (sn764xx_state*)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return sn76496_set_voiceout(info->chip, VoiceOut);
+	}
+	
+	return 0;
+}
+
+UINT32 sn764xx_set_step_synth(void *_info, UINT32 SampleRate)
+{
+	// returns the new sample rate of the chip (0 - not supported)
+	sn764xx_state *info = (sn764xx_state*)_info;
+	switch(info->EMU_CORE)
+	{
+	case EC_MAME:
+		return sn76496_set_step_synth(info->chip, SampleRate);
+	}
+	
+	return 0;
+}
+
 void sn764xx_set_mute_mask(void *_info, UINT32 MuteMask)
 {
 	sn764xx_state *info = (sn764xx_state*)_info;
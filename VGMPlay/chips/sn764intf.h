@@ -14,8 +14,13 @@ int device_start_sn764xx(void **chip, int core, int clock, int samplerate, int s
 						 int negate, int stereo, int clockdivider, int freq0);
 void device_stop_sn764xx(void *chip);
 void device_reset_sn764xx(void *chip);
+UINT32 device_save_state_sn764xx(void *chip, void *Buffer);
+void device_load_state_sn764xx(void *chip, const void *Buffer);
 
 void sn764xx_w(void *chip, offs_t offset, UINT8 data);
+REGW_CALLBACK sn764xx_get_reg_write(void *chip, void **RetChip);
 
 void sn764xx_set_mute_mask(void *chip, UINT32 MuteMask);
+UINT8 sn764xx_set_voice_output(void *chip, stream_sample_t **VoiceOut);
+UINT32 sn764xx_set_step_synth(void *chip, UINT32 SampleRate);
 void sn764xx_set_panning(void *chip, INT16* PanVals);
@@ -8,6 +8,7 @@
 #include <math.h>
 
 #include "mamedef.h"
+#include "run_once.h"
 #include <stdlib.h>
 #include <string.h>
 //#include "sndintrf.h"
@@ -505,6 +506,8 @@ static FILE *sample[9];
 
 
 
+/* shared by all chips, built once */
+static run_once_t tables_once = RUN_ONCE_INIT;
 static void init_tables(void)
 {
 	signed int i,x,n;
@@ -1533,7 +1536,7 @@ void * ym2151_init(int clock, int rate)
 
 	//ym2151_state_save_register( PSG, device );
 
-	init_tables();
+	run_once(&tables_once, init_tables);
 
 	//PSG->device = device;
 	PSG->clock = clock;
@@ -40,6 +40,7 @@ to do:
 #include <stdio.h>
 #include <math.h>
 #include "mamedef.h"
+#include "run_once.h"
 #include <stdlib.h>
 #include <string.h>
 //#include "sndintrf.h"
@@ -625,8 +626,8 @@ static const unsigned char table[19][8] = {
   {0x05, 0x01, 0x00, 0x00, 0xf8, 0xba, 0x49, 0x55 },/* TOM(multi,env verified), TOP CYM(multi verified, env verified) */
 };
 
-/* lock level of common table */
-static int num_lock = 0;
+/* the common tables are built once, by the first chip */
+static run_once_t tables_once = RUN_ONCE_INIT;
 
 /* work table */
 #define SLOT7_1 (&chip->P_CH[7].SLOT[SLOT1])
@@ -1169,7 +1170,7 @@ INLINE void rhythm_calc( YM2413 *chip, OPLL_CH *CH, unsigned int noise )
 
 
 /* generic table initialize */
-static int init_tables(void)
+static void init_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1256,14 +1257,6 @@ static int init_tables(void)
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
 
-	return 1;
-}
-
-static void OPLCloseTable( void )
-{
-#ifdef SAVE_SAMPLE
-	fclose(sample[0]);
-#endif
 }
 
 
@@ -1941,21 +1934,11 @@ static void OPLLWriteReg(YM2413 *chip, int r, int v)
 	}
 }*/
 
-/* lock/unlock for common table */
+/* build the common tables */
 //static int OPLL_LockTable(const device_config *device)
 static int OPLL_LockTable(void)
 {
-	num_lock++;
-	if(num_lock>1) return 0;
-
-	/* first time */
-
-	/* allocate total level table (128kb space) */
-	if( !init_tables() )
-	{
-		num_lock--;
-		return -1;
-	}
+	run_once(&tables_once, init_tables);
 
 	/*if (LOG_CYM_FILE)
 	{
@@ -1969,20 +1952,6 @@ static int OPLL_LockTable(void)
 	return 0;
 }
 
-static void OPLL_UnLockTable(void)
-{
-	if(num_lock) num_lock--;
-	if(num_lock) return;
-
-	/* last time */
-
-	OPLCloseTable();
-
-	/*if (cymfile)
-		fclose (cymfile);
-	cymfile = NULL;*/
-}
-
 static void OPLLResetChip(YM2413 *chip)
 {
 	int c,s;
@@ -2062,7 +2031,6 @@ static YM2413 *OPLLCreate(int clock, int rate)
 /* Destroy one of virtual YM3812 */
 static void OPLLDestroy(YM2413 *chip)
 {
-	OPLL_UnLockTable();
 	free(chip);
 }
 
@@ -2338,6 +2338,25 @@ void YM2612_SetOptions(int Flags)
 	YM2612_Enable_SSGEG = (Flags >> 1) & 0x01;
 }
 
+unsigned int YM2612_SaveState(ym2612_ *YM2612, void *Buffer)
+{
+  // copies the chip state to Buffer (or only returns its size, if Buffer is NULL)
+  // The slot's rate and detune pointers point into the global tables, so they stay valid.
+  if (Buffer != NULL)
+    memcpy(Buffer, YM2612, sizeof(ym2612_));
+  return sizeof(ym2612_);
+}
+
+void YM2612_LoadState(ym2612_ *YM2612, const void *Buffer)
+{
+  // restores a state that was saved from the same chip (the mute flags are kept)
+  int Mute;
+
+  Mute = YM2612_GetMute(YM2612);
+  memcpy(YM2612, Buffer, sizeof(ym2612_));
+  YM2612_SetMute(YM2612, Mute);
+}
+
 void YM2612_ClearBuffer(int **buffer, int length)
 {
 	// the MAME core does this before updating,
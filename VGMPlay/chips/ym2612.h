@@ -136,6 +136,10 @@ int YM2612_GetMute(ym2612_ *YM2612);
 void YM2612_SetMute(ym2612_ *YM2612, int val);
 void YM2612_SetOptions(int Flags);
 
+/* chip states for the seek index */
+unsigned int YM2612_SaveState(ym2612_ *YM2612, void *Buffer);
+void YM2612_LoadState(ym2612_ *YM2612, const void *Buffer);
+
 /* Gens */
 
 void YM2612_DacAndTimers_Update(ym2612_ *YM2612, int **buffer, int length);
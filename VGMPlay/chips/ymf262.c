@@ -55,6 +55,7 @@ differences between OPL2 and OPL3 shown in datasheets:
 
 #include <math.h>
 #include "mamedef.h"
+#include "run_once.h"
 #include <stdlib.h>
 #include <string.h>
 //#include "sndintrf.h"
@@ -600,8 +601,8 @@ static const INT8 lfo_pm_table[8*8*2] = {
 };
 
 
-/* lock level of common table */
-static int num_lock = 0;
+/* the common tables are built once, by the first chip */
+static run_once_t tables_once = RUN_ONCE_INIT;
 
 /* work table */
 #define SLOT7_1 (&chip->P_CH[7].SLOT[SLOT1])
@@ -1148,7 +1149,7 @@ INLINE void chan_calc_rhythm( OPL3 *chip, OPL3_CH *CH, unsigned int noise )
 
 
 /* generic table initialize */
-static int init_tables(void)
+static void init_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1303,14 +1304,6 @@ static int init_tables(void)
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
 
-	return 1;
-}
-
-static void OPLCloseTable( void )
-{
-#ifdef SAVE_SAMPLE
-	fclose(sample[0]);
-#endif
 }
 
 
@@ -2264,19 +2257,10 @@ static void OPL3WriteReg(OPL3 *chip, int r, int v)
 	}
 }*/
 
-/* lock/unlock for common table */
+/* build the common tables */
 static int OPL3_LockTable()
 {
-	num_lock++;
-	if(num_lock>1) return 0;
-
-	/* first time */
-
-	if( !init_tables() )
-	{
-		num_lock--;
-		return -1;
-	}
+	run_once(&tables_once, init_tables);
 
 	/*if (LOG_CYM_FILE)
 	{
@@ -2290,20 +2274,6 @@ static int OPL3_LockTable()
 	return 0;
 }
 
-static void OPL3_UnLockTable(void)
-{
-	if(num_lock) num_lock--;
-	if(num_lock) return;
-
-	/* last time */
-
-	OPLCloseTable();
-
-	/*if (LOG_CYM_FILE)
-		fclose (cymfile);
-	cymfile = NULL;*/
-}
-
 static void OPL3ResetChip(OPL3 *chip)
 {
 	int c,s;
@@ -2379,7 +2349,6 @@ static OPL3 *OPL3Create(int clock, int rate, int type)
 /* Destroy one of virtual YMF262 */
 static void OPL3Destroy(OPL3 *chip)
 {
-	OPL3_UnLockTable();
 	free(chip);
 }
 
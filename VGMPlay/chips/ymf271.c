@@ -28,6 +28,7 @@
 
 #include <math.h>
 #include "mamedef.h"
+#include "run_once.h"
 //#include "sndintrf.h"
 //#include "streams.h"
 #ifdef _DEBUG
@@ -290,9 +291,6 @@ typedef struct
 typedef struct
 {
 	// lookup tables
-	INT16 *lut_waves[8];
-	double *lut_plfo[4][8];
-	int *lut_alfo[4];
 	double lut_ar[64];
 	double lut_dc[64];
 	double lut_lfo[256];
@@ -330,6 +328,12 @@ typedef struct
 	//void (*irq_callback)(int);
 } YMF271Chip;
 
+/* waveform and LFO tables, shared by all chips and built once */
+static INT16 lut_waves[8][SIN_LEN];
+static double lut_plfo[4][8][LFO_LENGTH];
+static int lut_alfo[4][LFO_LENGTH];
+static run_once_t lut_once = RUN_ONCE_INIT;
+
 
 /*INLINE YMF271Chip *get_safe_token(const device_config *device)
 {
@@ -539,8 +543,8 @@ INLINE void update_lfo(YMF271Chip *chip, YMF271Slot *slot)
 {
 	slot->lfo_phase += slot->lfo_step;
 
-	slot->lfo_amplitude = chip->lut_alfo[slot->lfowave][(slot->lfo_phase >> LFO_SHIFT) & (LFO_LENGTH-1)];
-	slot->lfo_phasemod = chip->lut_plfo[slot->lfowave][slot->pms][(slot->lfo_phase >> LFO_SHIFT) & (LFO_LENGTH-1)];
+	slot->lfo_amplitude = lut_alfo[slot->lfowave][(slot->lfo_phase >> LFO_SHIFT) & (LFO_LENGTH-1)];
+	slot->lfo_phasemod = lut_plfo[slot->lfowave][slot->pms][(slot->lfo_phase >> LFO_SHIFT) & (LFO_LENGTH-1)];
 
 	calculate_step(slot);
 }
@@ -666,7 +670,7 @@ static INT64 calculate_op(YMF271Chip *chip, int slotnum, INT64 inp)
 		slot_input = ((inp << (SIN_BITS-2)) * modulation_level[slot->feedback]);
 	}
 
-	slot_output = chip->lut_waves[slot->waveform][((slot->stepptr + slot_input) >> 16) & SIN_MASK];
+	slot_output = lut_waves[slot->waveform][((slot->stepptr + slot_input) >> 16) & SIN_MASK];
 	slot_output = (slot_output * env) >> 16;
 	slot->stepptr += slot->step;
 
@@ -1642,47 +1646,37 @@ UINT8 ymf271_r(void *_info, offs_t offset)
 	return 0xff;
 }
 
-static void init_tables(YMF271Chip *chip)
+static void init_shared_tables(void)
 {
 	int i,j;
-	double clock_correction;
 
-	for (i = 0; i < 8; i++)
-		chip->lut_waves[i] = (INT16*)malloc(sizeof(INT16) * SIN_LEN);
-
-	for (i = 0; i < 4*8; i++)
-		chip->lut_plfo[i>>3][i&7] = (double*)malloc(sizeof(double) * LFO_LENGTH);
-
-	for (i = 0; i < 4; i++)
-		chip->lut_alfo[i] = (int*)malloc(sizeof(int) * LFO_LENGTH);
-	
 	for (i=0; i < SIN_LEN; i++)
 	{
 		double m = sin( ((i*2)+1) * M_PI / SIN_LEN );
 		double m2 = sin( ((i*4)+1) * M_PI / SIN_LEN );
 
 		// Waveform 0: sin(wt)    (0 <= wt <= 2PI)
-		chip->lut_waves[0][i] = (INT16)(m * MAXOUT);
+		lut_waves[0][i] = (INT16)(m * MAXOUT);
 
 		// Waveform 1: sin?(wt)   (0 <= wt <= PI)     -sin?(wt)  (PI <= wt <= 2PI)
-		chip->lut_waves[1][i] = (i < (SIN_LEN/2)) ? (INT16)((m * m) * MAXOUT) : (INT16)((m * m) * MINOUT);
+		lut_waves[1][i] = (i < (SIN_LEN/2)) ? (INT16)((m * m) * MAXOUT) : (INT16)((m * m) * MINOUT);
 
 		// Waveform 2: sin(wt)    (0 <= wt <= PI)     -sin(wt)   (PI <= wt <= 2PI)
-		chip->lut_waves[2][i] = (i < (SIN_LEN/2)) ? (INT16)(m * MAXOUT) : (INT16)(-m * MAXOUT);
+		lut_waves[2][i] = (i < (SIN_LEN/2)) ? (INT16)(m * MAXOUT) : (INT16)(-m * MAXOUT);
 
 		// Waveform 3: sin(wt)    (0 <= wt <= PI)     0
-		chip->lut_waves[3][i] = (i < (SIN_LEN/2)) ? (INT16)(m * MAXOUT) : 0;
+		lut_waves[3][i] = (i < (SIN_LEN/2)) ? (INT16)(m * MAXOUT) : 0;
 
 		// Waveform 4: sin(2wt)   (0 <= wt <= PI)     0
-		chip->lut_waves[4][i] = (i < (SIN_LEN/2)) ? (INT16)(m2 * MAXOUT) : 0;
+		lut_waves[4][i] = (i < (SIN_LEN/2)) ? (INT16)(m2 * MAXOUT) : 0;
 
 		// Waveform 5: |sin(2wt)| (0 <= wt <= PI)     0
-		chip->lut_waves[5][i] = (i < (SIN_LEN/2)) ? (INT16)(fabs(m2) * MAXOUT) : 0;
+		lut_waves[5][i] = (i < (SIN_LEN/2)) ? (INT16)(fabs(m2) * MAXOUT) : 0;
 
 		// Waveform 6:     1      (0 <= wt <= 2PI)
-		chip->lut_waves[6][i] = (INT16)(1 * MAXOUT);
+		lut_waves[6][i] = (INT16)(1 * MAXOUT);
 
-		chip->lut_waves[7][i] = 0;
+		lut_waves[7][i] = 0;
 	}
 
 	for (i = 0; i < LFO_LENGTH; i++)
@@ -1711,27 +1705,35 @@ static void init_tables(YMF271Chip *chip)
 
 		for (j = 0; j < 4; j++)
 		{
-			chip->lut_plfo[j][0][i] = pow(2.0, 0.0);
-			chip->lut_plfo[j][1][i] = pow(2.0, (3.378 * plfo[j]) / 1200.0);
-			chip->lut_plfo[j][2][i] = pow(2.0, (5.0646 * plfo[j]) / 1200.0);
-			chip->lut_plfo[j][3][i] = pow(2.0, (6.7495 * plfo[j]) / 1200.0);
-			chip->lut_plfo[j][4][i] = pow(2.0, (10.1143 * plfo[j]) / 1200.0);
-			chip->lut_plfo[j][5][i] = pow(2.0, (20.1699 * plfo[j]) / 1200.0);
-			chip->lut_plfo[j][6][i] = pow(2.0, (40.1076 * plfo[j]) / 1200.0);
-			chip->lut_plfo[j][7][i] = pow(2.0, (79.307 * plfo[j]) / 1200.0);
+			lut_plfo[j][0][i] = pow(2.0, 0.0);
+			lut_plfo[j][1][i] = pow(2.0, (3.378 * plfo[j]) / 1200.0);
+			lut_plfo[j][2][i] = pow(2.0, (5.0646 * plfo[j]) / 1200.0);
+			lut_plfo[j][3][i] = pow(2.0, (6.7495 * plfo[j]) / 1200.0);
+			lut_plfo[j][4][i] = pow(2.0, (10.1143 * plfo[j]) / 1200.0);
+			lut_plfo[j][5][i] = pow(2.0, (20.1699 * plfo[j]) / 1200.0);
+			lut_plfo[j][6][i] = pow(2.0, (40.1076 * plfo[j]) / 1200.0);
+			lut_plfo[j][7][i] = pow(2.0, (79.307 * plfo[j]) / 1200.0);
 		}
 
 		// LFO amplitude modulation
-		chip->lut_alfo[0][i] = 0;
+		lut_alfo[0][i] = 0;
 
-		chip->lut_alfo[1][i] = ALFO_MAX - ((i * ALFO_MAX) / LFO_LENGTH);
+		lut_alfo[1][i] = ALFO_MAX - ((i * ALFO_MAX) / LFO_LENGTH);
 
-		chip->lut_alfo[2][i] = (i < (LFO_LENGTH/2)) ? ALFO_MAX : ALFO_MIN;
+		lut_alfo[2][i] = (i < (LFO_LENGTH/2)) ? ALFO_MAX : ALFO_MIN;
 
 		tri_wave = ((i % (LFO_LENGTH/2)) * ALFO_MAX) / (LFO_LENGTH/2);
-		chip->lut_alfo[3][i] = (i < (LFO_LENGTH/2)) ? ALFO_MAX-tri_wave : tri_wave;
+		lut_alfo[3][i] = (i < (LFO_LENGTH/2)) ? ALFO_MAX-tri_wave : tri_wave;
 	}
-	
+}
+
+static void init_tables(YMF271Chip *chip)
+{
+	int i;
+	double clock_correction;
+
+	run_once(&lut_once, init_shared_tables);
+
 	for (i = 0; i < 256; i++)
 	{
 		chip->lut_env_volume[i] = (int)(65536.0 / pow(10.0, ((double)i / (256.0 / 96.0)) / 20.0));
@@ -1877,28 +1879,10 @@ int device_start_ymf271(void **_info, int clock)
 //static DEVICE_STOP( ymf271 )
 void device_stop_ymf271(void *_info)
 {
-	int i;
 	YMF271Chip *chip = (YMF271Chip *)_info;
 	
 	free(chip->mem_base);	chip->mem_base = NULL;
 	
-	for (i=0; i < 8; i++)
-	{
-		free(chip->lut_waves[i]);
-		chip->lut_waves[i] = NULL;
-	}
-	for (i = 0; i < 4*8; i++)
-	{
-		free(chip->lut_plfo[i>>3][i&7]);
-		chip->lut_plfo[i>>3][i&7] = NULL;
-	}
-
-	for (i = 0; i < 4; i++)
-	{
-		free(chip->lut_alfo[i]);
-		chip->lut_alfo[i] = NULL;
-	}
-	
 	free(chip->mix_buffer);
 	chip->mix_buffer = NULL;
 
@@ -31,6 +31,7 @@
 #include <math.h>
 
 #include "mamedef.h"
+#include "run_once.h"
 //#include "sndintrf.h"
 //#include "streams.h"
 #ifdef _DEBUG
@@ -147,7 +148,7 @@ static const int index_scale[8] = { 0x0e6, 0x0e6, 0x0e6, 0x0e6, 0x133, 0x199, 0x
 
 /* lookup table for the precomputed difference */
 static int diff_lookup[16];
-static unsigned char lookup_init = 0x00;	/* lookup-table is initialized */
+static run_once_t lookup_once = RUN_ONCE_INIT;	/* lookup-table is initialized */
 
 /* timer callback */
 /*static TIMER_CALLBACK( update_irq_state_timer_0 );
@@ -308,17 +309,12 @@ static void compute_tables(void)
 {
 	int nib;
 
-	if (lookup_init)
-		return;
-
 	/* loop over all nibbles and compute the difference */
 	for (nib = 0; nib < 16; nib++)
 	{
 		int value = (nib & 0x07) * 2 + 1;
 		diff_lookup[nib] = (nib & 0x08) ? -value : value;
 	}
-	
-	lookup_init = 0x01;
 }
 
 
@@ -818,7 +814,7 @@ int device_start_ymz280b(void **_info, int clock)
 	//devcb_resolve_write8(&chip->ext_ram_write, &intf->ext_write, device);
 
 	/* compute ADPCM tables */
-	compute_tables();
+	run_once(&lookup_once, compute_tables);
 
 	/* initialize the rest of the structure */
 	chip->master_clock = (double)clock / 384.0;
@@ -19,6 +19,34 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 #undef PI
 #define PI 3.1415926535897932384626433832795029
 
+/* Vector versions of the inner loop, picked at runtime. They need 64-bit sums,
+   so they are only available with 32-bit samples.
+   Define RESAMPLER_NO_SIMD to always use the plain C loop. */
+#if RESAMPLER_BITS == 32 && ! defined(RESAMPLER_NO_SIMD)
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define RESAMPLER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define RESAMPLER_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(RESAMPLER_X86) && defined(__GNUC__)
+#define RESAMPLER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define RESAMPLER_TARGET(isa)
+#endif
+
+#ifdef _MSC_VER
+#define RESAMPLER_INLINE __forceinline
+#else
+#define RESAMPLER_INLINE __inline__ __attribute__((always_inline))
+#endif
+
 enum { imp_scale = 0x7FFF };
 typedef int16_t imp_t;
 typedef int32_t imp_off_t; /* for max_res of 512 and impulse width of 32, end offsets must be 32 bits */
@@ -67,28 +95,68 @@ enum { adj_width = min_width / 4 * 4 + 2 };
 enum { write_offset = adj_width * stereo };
 
 enum { buffer_size = 128 };
+enum { in_buffer_size = 512 }; /* large enough for a whole block written with write_block */
+
+/* Impulse tables only depend on the rate, so resamplers running at the same rate
+   share one. They are reference-counted and freed when the last user is gone. */
+typedef struct _resampler_table
+{
+	struct _resampler_table* next;
+	int refs;
+	int width;
+	int res;
+	int nearest; /* ratio is nearest / res */
+	imp_t* impulses;
+} resampler_table;
+
+#ifdef _WIN32
+#include <windows.h>
+/* the lock is only taken when a rate changes, so a simple spin lock will do */
+static volatile LONG table_lock = 0;
+#define lock_tables() while (InterlockedExchange(&table_lock, 1)) Sleep(0)
+#define unlock_tables() InterlockedExchange(&table_lock, 0)
+#else
+#include <pthread.h>
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+#define lock_tables() pthread_mutex_lock(&table_lock)
+#define unlock_tables() pthread_mutex_unlock(&table_lock)
+#endif
+static resampler_table* tables = NULL;
+
+struct _resampler;
+typedef const sample_t * (*resampler_loop_t)( struct _resampler *r, sample_t** out_,
+		sample_t const* out_end, sample_t const in [], int in_size );
 
 typedef struct _resampler
 {
+	resampler_loop_t inner_loop;
 	int width_;
 	int rate_;
 	int inptr;
 	int infilled;
+	int inpending; /* written by write_block, but not yet handed to the filter by read_block */
 	int outptr;
 	int outfilled;
 
 	int latency;
 
 	imp_t const* imp;
-	imp_t impulses [max_res * (adj_width + 2 * (sizeof(imp_off_t) / sizeof(imp_t)))];
-	sample_t buffer_in[buffer_size * stereo * 2];
+	resampler_table* table;
+	sample_t buffer_in[in_buffer_size * stereo * 2];
 	sample_t buffer_out[buffer_size * stereo];
 } resampler;
 
+static resampler_loop_t resampler_select_loop( void );
+
 void * resampler_create()
 {
 	resampler *r = (resampler *) malloc(sizeof(resampler));
-	if (r) resampler_clear(r);
+	if (r)
+	{
+		r->inner_loop = resampler_select_loop();
+		r->table = NULL;
+		resampler_clear(r);
+	}
 	return r;
 }
 
@@ -99,17 +167,42 @@ void * resampler_dup(void *_r)
 	if (r && t)
 	{
 		memcpy(t, r, sizeof(resampler));
-		t->imp = t->impulses + (r->imp - r->impulses);
+		lock_tables();
+		t->table->refs++;
+		unlock_tables();
 	}
 	else if (t)
 	{
+		t->inner_loop = resampler_select_loop();
+		t->table = NULL;
 		resampler_clear(t);
 	}
 	return t;
 }
 
-void resampler_destroy(void *r)
+static void resampler_release_table( resampler_table* table )
 {
+	resampler_table** link;
+
+	if (table == NULL)
+		return;
+
+	lock_tables();
+	if (! --table->refs)
+	{
+		for (link = &tables; *link != table; link = &(*link)->next)
+			;
+		*link = table->next;
+		free(table);
+	}
+	unlock_tables();
+}
+
+void resampler_destroy(void *_r)
+{
+	resampler *r = (resampler *)_r;
+	if (r)
+		resampler_release_table(r->table);
 	free(r);
 }
 
@@ -119,18 +212,16 @@ void resampler_clear(void *_r)
 	r->width_ = adj_width;
 	r->inptr = 0;
 	r->infilled = 0;
+	r->inpending = 0;
 	r->outptr = 0;
 	r->outfilled = 0;
 	r->latency = 0;
-	r->imp = r->impulses;
 
 	resampler_set_rate(r, 1.0);
 }
 
-void resampler_set_rate( void *_r, double new_factor )
+static void resampler_gen_impulses( imp_t* impulses, int width_, int res, double ratio_ )
 {
-	resampler *rs = (resampler *)_r;
-
 	double const rolloff = 0.999;
 	double const gain = 1.0;
 
@@ -144,6 +235,44 @@ void resampler_set_rate( void *_r, double new_factor )
 
 	int n;
 
+	/* how much of input is used for each output sample */
+	step = stereo * (int) floor( ratio_ );
+	fraction = fmod( ratio_, 1.0 );
+
+	filter = (ratio_ < 1.0) ? 1.0 : 1.0 / ratio_;
+	/*int input_per_cycle = 0;*/
+	out = impulses;
+	for ( n = res; --n >= 0; )
+	{
+		int cur_step;
+
+		gen_sinc( rolloff, (int) (width_ * filter + 1) & ~1, pos, filter,
+				(double)(imp_scale * gain * filter), (int) width_, out );
+		out += width_;
+
+		cur_step = step;
+		pos += fraction;
+		if ( pos >= 0.9999999 )
+		{
+			pos -= 1.0;
+			cur_step += stereo;
+		}
+
+		((imp_off_t*)out)[0] = (cur_step - width_ * 2 + 4) * sizeof (sample_t);
+		((imp_off_t*)out)[1] = 2 * sizeof (imp_t) + 2 * sizeof (imp_off_t);
+		out += 2 * (sizeof(imp_off_t) / sizeof(imp_t));
+		/*input_per_cycle += cur_step;*/
+	}
+	/* last offset moves back to beginning of impulses*/
+	((imp_off_t*)out) [-1] -= (char*) out - (char*) impulses;
+}
+
+void resampler_set_rate( void *_r, double new_factor )
+{
+	resampler *rs = (resampler *)_r;
+	resampler_table* table;
+	double nearest_ = 0.0;
+
 	/* determine number of sub-phases that yield lowest error */
 	double ratio_ = 0.0;
 	int res = -1;
@@ -161,50 +290,74 @@ void resampler_set_rate( void *_r, double new_factor )
 			{
 				res = r;
 				ratio_ = nearest / res;
+				nearest_ = nearest;
 				least_error = error;
 			}
 		}
 	}
 	rs->rate_ = ratio_;
 
-	/* how much of input is used for each output sample */
-	step = stereo * (int) floor( ratio_ );
-	fraction = fmod( ratio_, 1.0 );
-
-	filter = (ratio_ < 1.0) ? 1.0 : 1.0 / ratio_;
-	/*int input_per_cycle = 0;*/
-	out = rs->impulses;
-	for ( n = res; --n >= 0; )
+	table = rs->table;
+	if ( table == NULL || table->width != rs->width_ || table->res != res || table->nearest != (int) nearest_ )
 	{
-		int cur_step;
-
-		gen_sinc( rolloff, (int) (rs->width_ * filter + 1) & ~1, pos, filter,
-				(double)(imp_scale * gain * filter), (int) rs->width_, out );
-		out += rs->width_;
-
-		cur_step = step;
-		pos += fraction;
-		if ( pos >= 0.9999999 )
+		lock_tables();
+		for ( table = tables; table != NULL; table = table->next )
 		{
-			pos -= 1.0;
-			cur_step += stereo;
+			if ( table->width == rs->width_ && table->res == res && table->nearest == (int) nearest_ )
+				break;
+		}
+		if ( table == NULL )
+		{
+			size_t size = res * (rs->width_ + 2 * (sizeof(imp_off_t) / sizeof(imp_t)));
+			table = (resampler_table*) malloc( sizeof(resampler_table) + size * sizeof(imp_t) );
+			if ( table == NULL )
+			{
+				unlock_tables();
+				return;
+			}
+			table->refs = 0;
+			table->width = rs->width_;
+			table->res = res;
+			table->nearest = (int) nearest_;
+			table->impulses = (imp_t*) (table + 1);
+			resampler_gen_impulses( table->impulses, rs->width_, res, ratio_ );
+			table->next = tables;
+			tables = table;
 		}
+		table->refs++;
+		unlock_tables();
 
-		((imp_off_t*)out)[0] = (cur_step - rs->width_ * 2 + 4) * sizeof (sample_t);
-		((imp_off_t*)out)[1] = 2 * sizeof (imp_t) + 2 * sizeof (imp_off_t);
-		out += 2 * (sizeof(imp_off_t) / sizeof(imp_t));
-		/*input_per_cycle += cur_step;*/
+		resampler_release_table( rs->table );
+		rs->table = table;
 	}
-	/* last offset moves back to beginning of impulses*/
-	((imp_off_t*)out) [-1] -= (char*) out - (char*) rs->impulses;
 
-	rs->imp = rs->impulses;
+	rs->imp = table->impulses;
+}
+double resampler_get_gain(void *_r)
+{
+	resampler *r = (resampler *)_r;
+	resampler_table const* table = r->table;
+	imp_t const* imp;
+	int32_t sum = 0;
+	int n, i;
+
+	if ( table == NULL )
+		return 0.0;
+	/* every phase is used equally often, so the DC gain is the average tap sum */
+	imp = table->impulses;
+	for ( n = table->res; --n >= 0; )
+	{
+		for ( i = 0; i < table->width; i++ )
+			sum += imp [i];
+		imp += table->width + 2 * (sizeof(imp_off_t) / sizeof(imp_t));
+	}
+	return (double) sum / table->res / (1 << 15);
 }
 
 int resampler_get_free(void *_r)
 {
 	resampler *r = (resampler *)_r;
-	return buffer_size * stereo - r->infilled;
+	return in_buffer_size * stereo - r->infilled - r->inpending;
 }
 
 int resampler_get_min_fill(void *_r)
@@ -216,6 +369,122 @@ int resampler_get_min_fill(void *_r)
 	return min_free < 0 ? 0 : min_free;
 }
 
+typedef struct _resampler_plan
+{
+	int out_pairs;   /* read_pair calls that can be done */
+	int fill_pairs;  /* pairs written before them */
+	int produced;    /* values the filter produces meanwhile */
+	int consumed;    /* input values the filter reads meanwhile */
+	int infilled;    /* infilled afterwards */
+	int outptr;      /* outptr afterwards */
+	int outfilled;   /* outfilled afterwards */
+	imp_t const* imp; /* filter phase afterwards */
+} resampler_plan;
+
+/* dry run of get_min_fill/write_pair/read_pair, only tracking the fill levels */
+static void resampler_make_plan( resampler const* r, int out_pairs, int max_fill, int *fill_list, resampler_plan *plan )
+{
+	const int min_needed = write_offset + stereo;
+	int infilled = r->infilled;
+	int outptr = r->outptr;
+	int outfilled = r->outfilled;
+	int latency = r->latency;
+	imp_t const* imp = r->imp;
+	int total = 0;
+	int produced = 0;
+	int consumed = 0;
+	int done;
+
+	for (done = 0; done < out_pairs; done++)
+	{
+		int fill = min_needed - infilled - (latency ? 0 : adj_width);
+		if (fill > 0)
+		{
+			fill /= stereo;
+			if (total + fill > max_fill)
+				break;
+			total += fill;
+			if (!latency)
+			{
+				infilled += adj_width / 2 * stereo;
+				latency = 1;
+			}
+			if (infilled < in_buffer_size * stereo)
+			{
+				infilled += fill * stereo;
+				if (infilled > in_buffer_size * stereo)
+					infilled = in_buffer_size * stereo;
+			}
+		}
+		else
+		{
+			fill = 0;
+		}
+		if (fill_list)
+			fill_list[done] = fill;
+
+		while (outfilled < stereo && infilled)
+		{
+			int writepos = ( outptr + outfilled ) % (buffer_size * stereo);
+			int writesize = (buffer_size * stereo) - writepos;
+			int in_size = infilled - write_offset;
+			int inread = 0;
+			int written = 0;
+			if ( writesize > ( buffer_size * stereo - outfilled ) )
+				writesize = buffer_size * stereo - outfilled;
+			if ( in_size > 0 )
+			{
+				do
+				{
+					imp_off_t const* off;
+					if ( written >= writesize )
+						break;
+					imp += adj_width - 2;
+					off = (imp_off_t const*)(&imp [2]);
+					inread += off[0] / (int)sizeof(sample_t) + (adj_width - 2) * stereo;
+					imp = (imp_t const*) ((char const*) imp + off[1]);
+					written += stereo;
+				}
+				while ( inread < in_size );
+			}
+			infilled -= inread;
+			consumed += inread;
+			outfilled += written;
+			produced += written;
+			if (!inread)
+				break;
+		}
+		if (outfilled >= stereo)
+		{
+			outptr = (outptr + 2) % (buffer_size * stereo);
+			outfilled -= stereo;
+		}
+	}
+
+	plan->out_pairs = done;
+	plan->fill_pairs = total;
+	plan->produced = produced;
+	plan->consumed = consumed;
+	plan->infilled = infilled;
+	plan->outptr = outptr;
+	plan->outfilled = outfilled;
+	plan->imp = imp;
+}
+
+int resampler_get_block_fill(void *_r, int out_pairs, int max_fill, int *fill_pairs, int *fill_list)
+{
+	resampler *r = (resampler *)_r;
+	resampler_plan plan;
+	int max_free = resampler_get_free(r) - (r->latency ? 0 : adj_width);
+
+	if (max_fill > max_free / stereo)
+		max_fill = max_free / stereo;
+	resampler_make_plan(r, out_pairs, max_fill, fill_list, &plan);
+
+	*fill_pairs = plan.fill_pairs;
+	return plan.out_pairs;
+}
+
 void resampler_write_pair(void *_r, sample_t ls, sample_t rs)
 {
 	resampler *r = (resampler *)_r;
@@ -227,25 +496,74 @@ void resampler_write_pair(void *_r, sample_t ls, sample_t rs)
 		{
 			r->buffer_in[r->inptr + 0] = 0;
 			r->buffer_in[r->inptr + 1] = 0;
-			r->buffer_in[buffer_size * stereo + r->inptr + 0] = 0;
-			r->buffer_in[buffer_size * stereo + r->inptr + 1] = 0;
-			r->inptr = (r->inptr + stereo) % (buffer_size * stereo);
+			r->buffer_in[in_buffer_size * stereo + r->inptr + 0] = 0;
+			r->buffer_in[in_buffer_size * stereo + r->inptr + 1] = 0;
+			r->inptr = (r->inptr + stereo) % (in_buffer_size * stereo);
 			r->infilled += stereo;
 		}
 		r->latency = 1;
 	}
 
-	if (r->infilled < buffer_size * stereo)
+	if (r->infilled < in_buffer_size * stereo)
 	{
 		r->buffer_in[r->inptr + 0] = ls;
 		r->buffer_in[r->inptr + 1] = rs;
-		r->buffer_in[buffer_size * stereo + r->inptr + 0] = ls;
-		r->buffer_in[buffer_size * stereo + r->inptr + 1] = rs;
-		r->inptr = (r->inptr + stereo) % (buffer_size * stereo);
+		r->buffer_in[in_buffer_size * stereo + r->inptr + 0] = ls;
+		r->buffer_in[in_buffer_size * stereo + r->inptr + 1] = rs;
+		r->inptr = (r->inptr + stereo) % (in_buffer_size * stereo);
 		r->infilled += stereo;
 	}
 }
 
+void resampler_write_block(void *_r, sample_t const* ls, sample_t const* rs, int pairs)
+{
+	resampler *r = (resampler *)_r;
+	sample_t* in;
+
+	if (!r->latency)
+	{
+		int i;
+		for (i = 0; i < adj_width / 2; ++i)
+		{
+			r->buffer_in[r->inptr + 0] = 0;
+			r->buffer_in[r->inptr + 1] = 0;
+			r->buffer_in[in_buffer_size * stereo + r->inptr + 0] = 0;
+			r->buffer_in[in_buffer_size * stereo + r->inptr + 1] = 0;
+			r->inptr = (r->inptr + stereo) % (in_buffer_size * stereo);
+			r->inpending += stereo;
+		}
+		r->latency = 1;
+	}
+
+	if (pairs > resampler_get_free(r) / stereo)
+		pairs = resampler_get_free(r) / stereo;
+	r->inpending += pairs * stereo;
+	while (pairs)
+	{
+		/* copy up to the end of the ring, the second half mirrors the first one */
+		int count = (in_buffer_size * stereo - r->inptr) / stereo;
+		int i;
+		if (count > pairs)
+			count = pairs;
+		in = &r->buffer_in[r->inptr];
+		if (!ls)
+		{
+			memset(in, 0, count * stereo * sizeof(sample_t));
+			memset(in + in_buffer_size * stereo, 0, count * stereo * sizeof(sample_t));
+		}
+		else
+		{
+			for (i = 0; i < count; i++, in += stereo)
+			{
+				in[0] = in[in_buffer_size * stereo + 0] = *ls++;
+				in[1] = in[in_buffer_size * stereo + 1] = *rs++;
+			}
+		}
+		r->inptr = (r->inptr + count * stereo) % (in_buffer_size * stereo);
+		pairs -= count;
+	}
+}
+
 #ifdef _MSC_VER
 #define restrict __restrict
 #endif
@@ -305,11 +623,187 @@ static const sample_t * resampler_inner_loop( resampler *r, sample_t** out_,
 
 #undef restrict
 
+#if defined(RESAMPLER_X86) || defined(RESAMPLER_NEON)
+typedef void (*resampler_dot_t)( imp_t const* imp, sample_t const* in, intermediate_t* lr );
+
+/* resampler_inner_loop, with the convolution for one output pair done by dot().
+   The sums are exact, so the order the vector kernels add them in doesn't matter
+   and the output is the same as the one of the C loop. */
+static RESAMPLER_INLINE const sample_t * resampler_vector_loop( resampler *r, sample_t** out_,
+		sample_t const* out_end, sample_t const in [], int in_size, resampler_dot_t dot )
+{
+	in_size -= write_offset;
+	if ( in_size > 0 )
+	{
+		sample_t* out = *out_;
+		sample_t const* const in_end = in + in_size;
+		imp_t const* imp = r->imp;
+
+		do
+		{
+			intermediate_t lr [2];
+			if ( out >= out_end )
+				break;
+			dot( imp, in, lr );
+
+			/* same offsets as at the end of the C loop */
+			imp += adj_width - 2;
+			in += (adj_width - 2) * stereo;
+			in  = (sample_t const*) ((char const*) in  + ((imp_off_t*)(&imp [2]))[0]);
+			imp = (imp_t const*) ((char const*) imp + ((imp_off_t*)(&imp [2]))[1]);
+
+			out [0] = (sample_t) (lr [0] >> 15);
+			out [1] = (sample_t) (lr [1] >> 15);
+			out += 2;
+		}
+		while ( in < in_end );
+
+		r->imp = imp;
+		*out_ = out;
+	}
+	return in;
+}
+#endif
+
+#ifdef RESAMPLER_X86
+/* Two taps at a time. _mm_mul_epi32 multiplies the even 32-bit lanes into 64 bits,
+   which are the left samples; shifting the pairs down gives the right ones. */
+static RESAMPLER_INLINE RESAMPLER_TARGET("sse4.1") __m128i resampler_taps2_sse41( imp_t const* imp,
+		sample_t const* in, __m128i* sumr, __m128i suml )
+{
+	__m128i pt = _mm_cvtepi16_epi64( _mm_cvtsi32_si128( *(int32_t const*)imp ) );
+	__m128i smp = _mm_loadu_si128( (__m128i const*)in );
+	*sumr = _mm_add_epi64( *sumr, _mm_mul_epi32( _mm_srli_epi64( smp, 32 ), pt ) );
+	return _mm_add_epi64( suml, _mm_mul_epi32( smp, pt ) );
+}
+
+static RESAMPLER_INLINE RESAMPLER_TARGET("sse4.1") void resampler_store_sums( __m128i suml, __m128i sumr,
+		intermediate_t* lr )
+{
+	suml = _mm_add_epi64( suml, _mm_unpackhi_epi64( suml, suml ) );
+	sumr = _mm_add_epi64( sumr, _mm_unpackhi_epi64( sumr, sumr ) );
+	_mm_storeu_si128( (__m128i*)lr, _mm_unpacklo_epi64( suml, sumr ) );
+}
+
+static RESAMPLER_TARGET("sse4.1") void resampler_dot_sse41( imp_t const* imp, sample_t const* in,
+		intermediate_t* lr )
+{
+	__m128i suml = _mm_setzero_si128();
+	__m128i sumr = _mm_setzero_si128();
+	int n;
+
+	for ( n = 0; n < adj_width; n += 2 )
+		suml = resampler_taps2_sse41( &imp [n], &in [n * stereo], &sumr, suml );
+	resampler_store_sums( suml, sumr, lr );
+}
+
+static RESAMPLER_TARGET("sse4.1") const sample_t * resampler_inner_loop_sse41( resampler *r,
+		sample_t** out_, sample_t const* out_end, sample_t const in [], int in_size )
+{
+	return resampler_vector_loop( r, out_, out_end, in, in_size, resampler_dot_sse41 );
+}
+
+/* Four taps at a time, the last two go through the SSE4.1 code. */
+static RESAMPLER_TARGET("avx2") void resampler_dot_avx2( imp_t const* imp, sample_t const* in,
+		intermediate_t* lr )
+{
+	__m256i suml = _mm256_setzero_si256();
+	__m256i sumr = _mm256_setzero_si256();
+	__m128i suml2, sumr2;
+	int n;
+
+	for ( n = 0; n + 4 <= adj_width; n += 4 )
+	{
+		__m256i pt = _mm256_cvtepi16_epi64( _mm_loadl_epi64( (__m128i const*)&imp [n] ) );
+		__m256i smp = _mm256_loadu_si256( (__m256i const*)&in [n * stereo] );
+		suml = _mm256_add_epi64( suml, _mm256_mul_epi32( smp, pt ) );
+		sumr = _mm256_add_epi64( sumr, _mm256_mul_epi32( _mm256_srli_epi64( smp, 32 ), pt ) );
+	}
+	suml2 = _mm_add_epi64( _mm256_castsi256_si128( suml ), _mm256_extracti128_si256( suml, 1 ) );
+	sumr2 = _mm_add_epi64( _mm256_castsi256_si128( sumr ), _mm256_extracti128_si256( sumr, 1 ) );
+	for ( ; n < adj_width; n += 2 )
+		suml2 = resampler_taps2_sse41( &imp [n], &in [n * stereo], &sumr2, suml2 );
+	resampler_store_sums( suml2, sumr2, lr );
+}
+
+static RESAMPLER_TARGET("avx2") const sample_t * resampler_inner_loop_avx2( resampler *r,
+		sample_t** out_, sample_t const* out_end, sample_t const in [], int in_size )
+{
+	return resampler_vector_loop( r, out_, out_end, in, in_size, resampler_dot_avx2 );
+}
+#endif
+
+#ifdef RESAMPLER_NEON
+/* Four taps at a time, vld2q splits the pairs into left and right samples. */
+static void resampler_dot_neon( imp_t const* imp, sample_t const* in, intermediate_t* lr )
+{
+	int64x2_t suml = vdupq_n_s64( 0 );
+	int64x2_t sumr = vdupq_n_s64( 0 );
+	int n;
+
+	for ( n = 0; n + 4 <= adj_width; n += 4 )
+	{
+		int32x4_t pt = vmovl_s16( vld1_s16( &imp [n] ) );
+		int32x4x2_t smp = vld2q_s32( &in [n * stereo] );
+		suml = vmlal_s32( suml, vget_low_s32( smp.val [0] ), vget_low_s32( pt ) );
+		suml = vmlal_s32( suml, vget_high_s32( smp.val [0] ), vget_high_s32( pt ) );
+		sumr = vmlal_s32( sumr, vget_low_s32( smp.val [1] ), vget_low_s32( pt ) );
+		sumr = vmlal_s32( sumr, vget_high_s32( smp.val [1] ), vget_high_s32( pt ) );
+	}
+	lr [0] = vgetq_lane_s64( suml, 0 ) + vgetq_lane_s64( suml, 1 );
+	lr [1] = vgetq_lane_s64( sumr, 0 ) + vgetq_lane_s64( sumr, 1 );
+	for ( ; n < adj_width; n++ )
+	{
+		lr [0] += (intermediate_t)imp [n] * (intermediate_t)in [n * stereo + 0];
+		lr [1] += (intermediate_t)imp [n] * (intermediate_t)in [n * stereo + 1];
+	}
+}
+
+static const sample_t * resampler_inner_loop_neon( resampler *r,
+		sample_t** out_, sample_t const* out_end, sample_t const in [], int in_size )
+{
+	return resampler_vector_loop( r, out_, out_end, in, in_size, resampler_dot_neon );
+}
+#endif
+
+#ifdef RESAMPLER_X86
+static int resampler_cpu_has( int avx2 )
+{
+#ifdef _MSC_VER
+	int info [4];
+	__cpuid( info, 1 );
+	if ( ! avx2 )
+		return (info [2] >> 19) & 1;	/* SSE4.1 */
+	/* AVX2 also needs the OS to save the YMM registers */
+	if ( ! ((info [2] >> 27) & 1) || (_xgetbv( 0 ) & 0x06) != 0x06 )
+		return 0;
+	__cpuidex( info, 7, 0 );
+	return (info [1] >> 5) & 1;
+#else
+	__builtin_cpu_init();
+	return avx2 ? __builtin_cpu_supports( "avx2" ) : __builtin_cpu_supports( "sse4.1" );
+#endif
+}
+#endif
+
+static resampler_loop_t resampler_select_loop( void )
+{
+#if defined(RESAMPLER_X86)
+	if ( resampler_cpu_has( 1 ) )
+		return resampler_inner_loop_avx2;
+	if ( resampler_cpu_has( 0 ) )
+		return resampler_inner_loop_sse41;
+#elif defined(RESAMPLER_NEON)
+	return resampler_inner_loop_neon;
+#endif
+	return resampler_inner_loop;
+}
+
 static int resampler_wrapper( resampler *r, sample_t out [], int* out_size,
 		sample_t const in [], int in_size )
 {
 	sample_t* out_ = out;
-	int result = resampler_inner_loop( r, &out_, out + *out_size, in, in_size ) - in;
+	int result = r->inner_loop( r, &out_, out + *out_size, in, in_size ) - in;
 
 	*out_size = out_ - out;
 	return result;
@@ -324,7 +818,7 @@ static void resampler_fill( resampler *r )
 		int inread;
 		if ( writesize > ( buffer_size * stereo - r->outfilled ) )
 				writesize = buffer_size * stereo - r->outfilled;
-		inread = resampler_wrapper(r, &r->buffer_out[writepos], &writesize, &r->buffer_in[buffer_size * stereo + r->inptr - r->infilled], r->infilled);
+		inread = resampler_wrapper(r, &r->buffer_out[writepos], &writesize, &r->buffer_in[in_buffer_size * stereo + r->inptr - r->infilled], r->infilled);
 		r->infilled -= inread;
 		r->outfilled += writesize;
 		if (!inread)
@@ -332,6 +826,38 @@ static void resampler_fill( resampler *r )
 	}
 }
 
+int resampler_get_handover(void *_r, int *in_pairs)
+{
+	resampler *r = (resampler *)_r;
+	/* the sinc peak of every phase is at this tap (see gen_sinc) */
+	int const center = (r->width_ / 2 - 1) * stereo;
+	int count = r->infilled + r->inpending;
+
+	/* Right after the start the filter can still be short of its center (the
+	   zeros of the latency are all it has), then there's nothing to hand over. */
+	*in_pairs = (count > center) ? (count - center) / stereo : 0;
+	return r->outfilled / stereo;
+}
+
+void resampler_handover(void *_r, sample_t *out, sample_t *ls, sample_t *rs)
+{
+	resampler *r = (resampler *)_r;
+	int in_pairs;
+	int out_pairs = resampler_get_handover(r, &in_pairs);
+	sample_t const* in = &r->buffer_in[in_buffer_size * stereo + r->inptr - in_pairs * stereo];
+	int i;
+
+	for (i = 0; i < out_pairs * stereo; i++)
+		out[i] = r->buffer_out[(r->outptr + i) % (buffer_size * stereo)];
+	for (i = 0; i < in_pairs; i++, in += stereo)
+	{
+		ls[i] = in[0];
+		rs[i] = in[1];
+	}
+	/* everything is handed over, the resampler starts from scratch if it's used again */
+	resampler_clear(r);
+}
+
 int resampler_get_avail(void *_r)
 {
 	resampler *r = (resampler *)_r;
@@ -370,3 +896,98 @@ void resampler_peek_pair( void *_r, sample_t *ls, sample_t *rs )
 	resampler *r = (resampler *)_r;
 	resampler_read_pair_internal(r, ls, rs, 0);
 }
+
+/* true if everything the filter can still read or hand out is zero */
+static int resampler_is_silent( resampler const* r )
+{
+	int count = r->infilled + r->inpending;
+	sample_t const* in = &r->buffer_in[in_buffer_size * stereo + r->inptr - count];
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (in[i])
+			return 0;
+	}
+	for (i = 0; i < r->outfilled; i++)
+	{
+		if (r->buffer_out[(r->outptr + i) % (buffer_size * stereo)])
+			return 0;
+	}
+	return 1;
+}
+
+void resampler_read_block( void *_r, sample_t *out, int pairs )
+{
+	resampler *r = (resampler *)_r;
+	resampler_plan plan;
+	int to_produce;
+	int to_read;
+
+	/* Work out what sample-by-sample reads would have done with the pending data,
+	   then let the filter run over all of it at once, stopping at the same point. */
+	resampler_make_plan(r, pairs, r->inpending / stereo, NULL, &plan);
+	if (resampler_is_silent(r))
+	{
+		/* The filter would only produce zeros, so just take over the state it
+		   would end up with. (The output buffer gets only zeros as well.) */
+		memset(out, 0, pairs * stereo * sizeof(sample_t));
+		memset(r->buffer_out, 0, sizeof(r->buffer_out));
+		r->inpending = r->infilled + r->inpending - plan.consumed - plan.infilled;
+		r->infilled = plan.infilled;
+		r->outptr = plan.outptr;
+		r->outfilled = plan.outfilled;
+		r->imp = plan.imp;
+		return;
+	}
+	to_produce = plan.produced;
+	to_read = plan.out_pairs * stereo;
+	r->infilled += r->inpending;
+	r->inpending = 0;
+
+	while (to_produce || to_read)
+	{
+		int count = 0;
+
+		if (to_produce && r->outfilled < buffer_size * stereo)
+		{
+			int writepos = ( r->outptr + r->outfilled ) % (buffer_size * stereo);
+			int writesize = (buffer_size * stereo) - writepos;
+			int inread;
+			if ( writesize > ( buffer_size * stereo - r->outfilled ) )
+				writesize = buffer_size * stereo - r->outfilled;
+			if ( writesize > to_produce )
+				writesize = to_produce;
+			inread = resampler_wrapper(r, &r->buffer_out[writepos], &writesize, &r->buffer_in[in_buffer_size * stereo + r->inptr - r->infilled], r->infilled);
+			r->infilled -= inread;
+			r->outfilled += writesize;
+			to_produce -= writesize;
+			count += writesize;
+		}
+
+		if (to_read && r->outfilled)
+		{
+			int readsize = (buffer_size * stereo) - r->outptr;
+			if ( readsize > r->outfilled )
+				readsize = r->outfilled;
+			if ( readsize > to_read )
+				readsize = to_read;
+			memcpy(out, &r->buffer_out[r->outptr], readsize * sizeof(sample_t));
+			out += readsize;
+			r->outptr = (r->outptr + readsize) % (buffer_size * stereo);
+			r->outfilled -= readsize;
+			to_read -= readsize;
+			count += readsize;
+		}
+
+		if (!count)
+			break;
+	}
+
+	/* anything the filter didn't deliver is silence, just like read_pair */
+	memset(out, 0, (to_read + (pairs - plan.out_pairs) * stereo) * sizeof(sample_t));
+
+	/* keep what sample-by-sample reads wouldn't have handed to the filter yet */
+	r->inpending = r->infilled - plan.infilled;
+	r->infilled = plan.infilled;
+}
@@ -26,12 +26,18 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 #define resampler_destroy EVALUATE(RESAMPLER_DECORATE,_resampler_destroy)
 #define resampler_clear EVALUATE(RESAMPLER_DECORATE,_resampler_clear)
 #define resampler_set_rate EVALUATE(RESAMPLER_DECORATE,_resampler_set_rate)
+#define resampler_get_gain EVALUATE(RESAMPLER_DECORATE,_resampler_get_gain)
 #define resampler_get_free EVALUATE(RESAMPLER_DECORATE,_resampler_get_free)
 #define resampler_get_min_fill EVALUATE(RESAMPLER_DECORATE,_resampler_get_min_fill)
+#define resampler_get_block_fill EVALUATE(RESAMPLER_DECORATE,_resampler_get_block_fill)
 #define resampler_write_pair EVALUATE(RESAMPLER_DECORATE,_resampler_write_pair)
+#define resampler_write_block EVALUATE(RESAMPLER_DECORATE,_resampler_write_block)
+#define resampler_get_handover EVALUATE(RESAMPLER_DECORATE,_resampler_get_handover)
+#define resampler_handover EVALUATE(RESAMPLER_DECORATE,_resampler_handover)
 #define resampler_get_avail EVALUATE(RESAMPLER_DECORATE,_resampler_get_avail)
 #define resampler_read_pair EVALUATE(RESAMPLER_DECORATE,_resampler_read_pair)
 #define resampler_peek_pair EVALUATE(RESAMPLER_DECORATE,_resampler_peek_pair)
+#define resampler_read_block EVALUATE(RESAMPLER_DECORATE,_resampler_read_block)
 #endif
 
 #include <stdint.h>
@@ -55,16 +61,38 @@ void resampler_destroy(void *);
 void resampler_clear(void *);
 
 void resampler_set_rate( void *, double new_factor );
+/* DC gain of the filter at the current rate */
+double resampler_get_gain( void * );
 
 int resampler_get_free(void *);
 int resampler_get_min_fill(void *);
+/* Number of read_pair calls (at most out_pairs) that can be done when each one is
+   preceded by writing get_min_fill() values, without writing more than max_fill pairs.
+   The number of pairs that will be written is returned in fill_pairs, fill_list (if not
+   NULL) receives the number of pairs written before each read. */
+int resampler_get_block_fill(void *, int out_pairs, int max_fill, int *fill_pairs, int *fill_list);
 
 void resampler_write_pair(void *, sample_t ls, sample_t rs);
+/* Writes planar data for resampler_read_block. Writing the fill_pairs returned by
+   resampler_get_block_fill and then reading its number of pairs gives exactly the same
+   output and state as doing it with get_min_fill/write_pair/read_pair.
+   ls and rs can be NULL to write silence. */
+void resampler_write_block(void *, sample_t const* ls, sample_t const* rs, int pairs);
+
+/* For switching to another resampler without a gap or a jump: the number of output
+   pairs that are already computed, in_pairs receives the number of input pairs from
+   the center of the next output's filter on. resampler_handover copies them (out
+   interleaved, ls/rs planar) and clears the resampler. */
+int resampler_get_handover(void *, int *in_pairs);
+void resampler_handover(void *, sample_t *out, sample_t *ls, sample_t *rs);
 
 int resampler_get_avail(void *);
 
 void resampler_read_pair( void *, sample_t *ls, sample_t *rs );
 void resampler_peek_pair( void *, sample_t *ls, sample_t *rs );
+/* Reads interleaved stereo pairs, see resampler_write_block. While all the input the
+   filter can still see is silent, it is skipped and only its state is advanced. */
+void resampler_read_block( void *, sample_t *out, int pairs );
 
 #ifdef __cplusplus
 }
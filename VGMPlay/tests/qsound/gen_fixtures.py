@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# Writes the QSound test logs of this directory.
+# The logs are committed, this script only documents how they were made.
+#
+# qs_2mb.vgz     2 MB sample ROM, random registers and banks
+# qs_1a345.vgz   0x1A345 byte ROM (no power of 2, the banks wrap in the ROM)
+# qs_32k.vgz     32 KB ROM, most banks point past the end of the ROM
+# qs_freq0.vgz   channels with frequency 0 next to playing channels
+#
+# golden.txt is rendered with the default options,
+# golden_muted.txt with --mute QSound:0xA5A5.
+import gzip, math, random, struct
+
+CLOCK = 4000000
+
+def rom_data(size):
+	# every 64 KB bank has a wave with its own period, so the banks sound
+	# different and the logs stay small
+	data = bytearray(size)
+	for pos in range(0, size, 0x10000):
+		period = 23 + (pos >> 16) * 7
+		wave = bytes((int(100 * math.sin(2 * math.pi * i / period)) + (pos >> 16)) & 0xFF for i in range(period))
+		end = min(size, pos + 0x10000)
+		bank = (wave * (0x10000 // period + 1))[:end - pos]
+		data[pos:end] = bank
+	return bytes(data)
+
+class Log:
+	def __init__(self, seed):
+		self.rnd = random.Random(seed)
+		self.body = bytearray()
+		self.samples = 0
+		self.loop_ofs = None
+		self.loop_smpl = 0
+
+	def rom_block(self, size):
+		data = rom_data(size)
+		self.body += struct.pack('<BBBIII', 0x67, 0x66, 0x8F, len(data) + 8, size, 0)
+		self.body += data
+
+	def write(self, reg, val):
+		self.body += struct.pack('>BHB', 0xC4, val & 0xFFFF, reg)
+
+	def wait(self, smpls):
+		self.samples += smpls
+		while smpls:
+			cur = min(smpls, 0xFFFF)
+			self.body += struct.pack('<BH', 0x61, cur)
+			smpls -= cur
+
+	def mark_loop(self):
+		self.loop_ofs = len(self.body)
+		self.loop_smpl = self.samples
+
+	def save(self, name):
+		hdr = bytearray(0x100)
+		hdr[0x00:0x04] = b'Vgm '
+		struct.pack_into('<I', hdr, 0x08, 0x171)
+		struct.pack_into('<I', hdr, 0x34, 0x100 - 0x34)
+		struct.pack_into('<I', hdr, 0xB4, CLOCK)
+		data = hdr + self.body + b'\x66'
+		struct.pack_into('<I', data, 0x04, len(data) - 0x04)
+		struct.pack_into('<I', data, 0x18, self.samples)
+		if self.loop_ofs is not None:
+			struct.pack_into('<I', data, 0x1C, 0x100 + self.loop_ofs - 0x1C)
+			struct.pack_into('<I', data, 0x20, self.samples - self.loop_smpl)
+		with open(name, 'wb') as f:
+			f.write(gzip.compress(bytes(data), 9, mtime=0))
+
+def key_on(log, ch, bank, start, freq, loop, end, vol):
+	# the bank register of a channel sets the bank of the next channel
+	log.write(((ch - 1) & 0x0F) * 8 + 0, bank)
+	log.write(ch * 8 + 1, start)
+	log.write(ch * 8 + 2, freq)
+	log.write(ch * 8 + 4, loop)
+	log.write(ch * 8 + 5, end)
+	log.write(ch * 8 + 6, vol)
+	log.write(0x80 + ch, 0x110 + ch * 2)
+	log.write(ch * 8 + 3, 0x8000)
+
+def random_log(name, rom_size, seed):
+	log = Log(seed)
+	rnd = log.rnd
+	log.rom_block(rom_size)
+	log.mark_loop()
+	for i in range(600):
+		ch = rnd.randint(0x00, 0x0F)
+		x = rnd.random()
+		if x < 0.5:
+			start = rnd.randint(0x0000, 0xFFFF)
+			end = rnd.randint(start, 0xFFFF) if rnd.random() < 0.9 else rnd.randint(0x0000, 0xFFFF)
+			key_on(log, ch, rnd.randint(0x00, 0x7F), start,
+				rnd.choice([0x0000, 0x1000, rnd.randint(0x0001, 0xFFFF), rnd.randint(0x0100, 0x3000)]),
+				rnd.choice([0x0000, rnd.randint(0x0000, 0xFFFF), rnd.randint(0x0000, max(1, end - start))]),
+				end, rnd.choice([0x0000, 0x8000, 0xFFFF, rnd.randint(0x0000, 0xFFFF)]))
+		elif x < 0.75:
+			log.write(ch * 8 + rnd.choice([0, 1, 2, 4, 5, 6]), rnd.randint(0x0000, 0xFFFF))
+		elif x < 0.85:
+			log.write(rnd.randint(0x00, 0xFF), rnd.randint(0x0000, 0xFFFF))
+		log.wait(rnd.choice([rnd.randint(1, 30), rnd.randint(30, 800), 735]))
+	log.save(name)
+
+def freq0_log(name, seed):
+	log = Log(seed)
+	rnd = log.rnd
+	log.rom_block(0x40000)
+	for i in range(40):
+		for ch in range(0x10):
+			freq = 0x0000 if (ch & 1) or rnd.random() < 0.25 else rnd.randint(0x0800, 0x2000)
+			key_on(log, ch, rnd.randint(0x00, 0x03), rnd.randint(0x0000, 0x4000), freq,
+				0x4000, 0xF000, 0x4000)
+		log.wait(rnd.randint(2000, 12000))
+		# stop a few channels through frequency 0 while they play
+		for ch in rnd.sample(range(0x10), 4):
+			log.write(ch * 8 + 2, 0x0000)
+		log.wait(rnd.randint(500, 4000))
+	log.save(name)
+
+random_log('qs_2mb.vgz', 0x200000, 1)
+random_log('qs_1a345.vgz', 0x1A345, 2)
+random_log('qs_32k.vgz', 0x8000, 3)
+freq0_log('qs_freq0.vgz', 4)
@@ -6,23 +6,14 @@
 #include "chips/mamedef.h"
 #include "stdbool.h"
 #include "VGMPlay.h"
+#include "SampleWriter.h"
 
 #define SAMPLESIZE sizeof(WAVE_16BS)
 
-INLINE int fputBE16(UINT16 Value, FILE* hFile)
-{
-    int RetVal;
-    int ResVal;
-
-    RetVal = fputc((Value & 0xFF00) >> 8, hFile);
-    RetVal = fputc((Value & 0x00FF) >> 0, hFile);
-    ResVal = (RetVal != EOF) ? 0x02 : 0x00;
-    return ResVal;
-}
-
 int main(int argc, char *argv[]) {
     UINT8 result;
     WAVE_16BS *sampleBuffer;
+    SMPL_WRITER *sampleWriter;
     UINT32 bufferedLength;
     FILE *outputFile;
     void *vgmp;
@@ -51,33 +42,34 @@ int main(int argc, char *argv[]) {
 
     p = (VGM_PLAYER *) vgmp;
     
-    sampleBuffer = (WAVE_16BS*)malloc(SAMPLESIZE * p->SampleRate);
-    if (sampleBuffer == NULL) {
+    sampleWriter = OpenSampleWriter(outputFile, SAMPLESIZE * p->SampleRate, true);
+    if (sampleWriter == NULL) {
         fprintf(stderr, "vgm2pcm: error: failed to allocate %u bytes of memory\n", SAMPLESIZE * p->SampleRate);
         return 1;
     }
 
+    result = 0;
     while (!p->EndPlay) {
         UINT32 bufferSize = p->SampleRate;
+        sampleBuffer = (WAVE_16BS*)GetWriteBuffer(sampleWriter);
         bufferedLength = FillBuffer(vgmp, sampleBuffer, bufferSize);
-        if (bufferedLength) {
-            UINT32 numberOfSamples;
-            UINT32 currentSample;
-            const UINT16* sampleData;
-
-            sampleData = (UINT16*)sampleBuffer;
-            numberOfSamples = SAMPLESIZE * bufferedLength / 0x02;
-            for (currentSample = 0x00; currentSample < numberOfSamples; currentSample++) {
-                fputBE16(sampleData[currentSample], outputFile);
-            }
+        ConvertBE16(sampleBuffer, bufferedLength * 0x02);
+        if (!WriteSamples(sampleWriter, bufferedLength * SAMPLESIZE)) {
+            fprintf(stderr, "vgm2pcm: error: failed to write pcm_file (%s)\n", argv[2]);
+            result = 1;
+            break;
         }
     }
 
+    if (!CloseSampleWriter(sampleWriter))
+        result = 1;
+    fclose(outputFile);
+
     StopVGM(vgmp);
 
     CloseVGMFile(vgmp);
 
     VGMPlay_Deinit(vgmp);
 
-    return 0;
+    return result;
 }
@@ -0,0 +1,322 @@
+/*
+ *  This file is part of VGMPlay <https://github.com/vgmrips/vgmplay>
+ *
+ *  vgm2stems - renders every chip channel of a VGM into a WAV file of its own
+ *  Based on vgm2wav.c.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#ifndef _MSC_VER
+// This turns command line options on (using getopt.h) unless you are using MSVC / Visual Studio, which doesn't have it.
+#define VGM2STEMS_HAS_GETOPT
+#include <getopt.h>
+#endif
+
+#include "chips/mamedef.h"
+#include "stdbool.h"
+#include "VGMPlay.h"
+#include "SampleWriter.h"
+
+#define SAMPLESIZE sizeof(WAVE_16BS)
+
+UINT8 CmdList[0x100]; // used by VGMPlay.c and VGMPlay_AddFmts.c
+bool ErrorHappened;   // used by VGMPlay.c and VGMPlay_AddFmts.c
+
+typedef struct wav_output
+{
+	FILE* hFile;
+	SMPL_WRITER* Writer;
+	UINT32 DataLen;
+} WAV_OUTPUT;
+
+INLINE int fputLE16(UINT16 Value, FILE* hFile)
+{
+	int RetVal;
+	int ResVal;
+
+	RetVal = fputc((Value & 0x00FF) >> 0, hFile);
+	RetVal = fputc((Value & 0xFF00) >> 8, hFile);
+	ResVal = (RetVal != EOF) ? 0x02 : 0x00;
+	return ResVal;
+}
+
+INLINE int fputLE32(UINT32 Value, FILE* hFile)
+{
+	int RetVal;
+	int ResVal;
+
+	RetVal = fputc((Value & 0x000000FF) >> 0, hFile);
+	RetVal = fputc((Value & 0x0000FF00) >> 8, hFile);
+	RetVal = fputc((Value & 0x00FF0000) >> 16, hFile);
+	RetVal = fputc((Value & 0xFF000000) >> 24, hFile);
+	ResVal = (RetVal != EOF) ? 0x02 : 0x00;
+	return ResVal;
+}
+
+static bool OpenWave(WAV_OUTPUT* Wav, const char* FileName, UINT32 SampleRate)
+{
+	Wav->DataLen = 0;
+	Wav->hFile = fopen(FileName, "wb");
+	if (Wav->hFile == NULL)
+		return false;
+	// there can be a lot of stems, so they don't get a thread each
+	Wav->Writer = OpenSampleWriter(Wav->hFile, SAMPLESIZE * SampleRate, false);
+	if (Wav->Writer == NULL)
+	{
+		fclose(Wav->hFile);
+		return false;
+	}
+
+	// the lengths are written by CloseWave
+	fwrite("RIFF", 1, 4, Wav->hFile);
+	fputLE32(-1, Wav->hFile);
+	fwrite("WAVE", 1, 4, Wav->hFile);
+
+	fwrite("fmt ", 1, 4, Wav->hFile);
+	fputLE32(16, Wav->hFile);
+	fputLE16(1, Wav->hFile);
+	fputLE16(2, Wav->hFile);
+	fputLE32(SampleRate, Wav->hFile);
+	fputLE32(SampleRate * 2 * 2, Wav->hFile);
+	fputLE16(2 * 2, Wav->hFile);
+	fputLE16(16, Wav->hFile);
+
+	fwrite("data", 1, 4, Wav->hFile);
+	fputLE32(-1, Wav->hFile);
+
+	return true;
+}
+
+// The samples have to be rendered into GetWriteBuffer(Wav->Writer).
+static bool WriteWave(WAV_OUTPUT* Wav, UINT32 Length)
+{
+	ConvertLE16(GetWriteBuffer(Wav->Writer), Length * 0x02);
+	Wav->DataLen += Length * SAMPLESIZE;
+	return WriteSamples(Wav->Writer, Length * SAMPLESIZE);
+}
+
+static bool CloseWave(WAV_OUTPUT* Wav)
+{
+	bool RetVal;
+
+	RetVal = CloseSampleWriter(Wav->Writer);
+	fseek(Wav->hFile, 0x04, SEEK_SET);
+	fputLE32(Wav->DataLen + 28 + 8, Wav->hFile);
+	fseek(Wav->hFile, 0x28, SEEK_SET);
+	fputLE32(Wav->DataLen, Wav->hFile);
+	if (fclose(Wav->hFile))
+		RetVal = false;
+	Wav->hFile = NULL;
+
+	return RetVal;
+}
+
+// Builds "<prefix>_<stem>_<chip>[#<id>][_ssg][_ch<n>].wav".
+static void GetStemFileName(void* vgmp, char* Buffer, const char* Prefix, UINT32 Stem)
+{
+	UINT8 ChipType;
+	UINT8 ChipID;
+	UINT8 Channel;
+	UINT8 SubType;
+	const char* ChipName;
+	char* NamePtr;
+
+	GetStemInfo(vgmp, Stem, &ChipType, &ChipID, &Channel);
+	GetChipClock(vgmp, (ChipID << 7) | (ChipType & 0x7F), &SubType);
+	ChipName = GetAccurateChipName(ChipType & 0x7F, SubType);
+
+	NamePtr = Buffer + sprintf(Buffer, "%s_%02u_", Prefix, Stem);
+	for (; *ChipName != '\0'; ChipName ++, NamePtr ++)
+	{
+		if (*ChipName == ' ' || *ChipName == '/')
+			*NamePtr = '-';
+		else
+			*NamePtr = *ChipName;
+	}
+	*NamePtr = '\0';
+	if (ChipID)
+		NamePtr += sprintf(NamePtr, "#%u", ChipID + 1);
+	if (ChipType & 0x80)
+		NamePtr += sprintf(NamePtr, "_ssg");	// the AY part of the YM2203/YM2608/YM2610
+	if (Channel != 0xFF)
+		NamePtr += sprintf(NamePtr, "_ch%u", Channel);
+	strcpy(NamePtr, ".wav");
+
+	return;
+}
+
+void usage(const char *name) {
+	fprintf(stderr, "usage: %s [options] vgm_file out_prefix\n"
+		"Writes one WAV file per chip channel (out_prefix_NN_chip_chN.wav)\n"
+		"and the complete mix (out_prefix_mix.wav).\n", name);
+#ifdef VGM2STEMS_HAS_GETOPT
+	fputs("\n"
+		"Options:\n"
+		"--loop-count {number}\n"
+		"--fade-ms {number}\n"
+		"--no-mix\n"
+		"\n", stderr);
+#else
+	fputs("Options not supported in this build (compiled without getopt.)\n", stderr);
+#endif
+}
+
+int main(int argc, char *argv[]) {
+	WAVE_16BS *sampleBuffer;
+	WAVE_16BS **stemBuffers;
+	WAV_OUTPUT mixOutput;
+	WAV_OUTPUT *stemOutputs;
+	UINT32 bufferedLength;
+	UINT32 stemCount;
+	UINT32 curStem;
+	char *fileName;
+	bool writeMix;
+	int result = 0;
+
+	void *vgmp;
+	VGM_PLAYER *p;
+
+	int c;
+
+	// Initialize VGMPlay before parsing arguments, so we can set VGMMaxLoop and FadeTime
+	vgmp = VGMPlay_Init();
+	VGMPlay_Init2(vgmp);
+
+	p = (VGM_PLAYER *) vgmp;
+
+	p->VGMMaxLoop = 2;
+	p->FadeTime = 5000;
+	p->StemRender = true;
+	writeMix = true;
+
+	// Parse command line arguments
+#ifdef VGM2STEMS_HAS_GETOPT
+	static struct option long_options[] = {
+		{ "loop-count", required_argument, NULL, 'l' },
+		{ "fade-ms", required_argument, NULL, 'f' },
+		{ "no-mix", no_argument, NULL, 'M' },
+		{ "help", no_argument, NULL, '?' },
+		{ NULL, 0, NULL, 0 }
+	};
+	while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+		switch (c) {
+		case 'l':
+			c = atoi(optarg);
+			if (c <= 0) {
+				fputs("Error: loop count must be at least 1.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			p->VGMMaxLoop = c;
+			break;
+		case 'f':
+			p->FadeTime = atoi(optarg);
+			break;
+		case 'M':
+			writeMix = false;
+			break;
+		case -1:
+			break;
+		case '?':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Pretend for the rest of the program that those options don't exist
+	argv[optind - 1] = argv[0];
+	argc -= optind - 1;
+	argv += optind - 1;
+#endif
+	if (argc < 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!OpenVGMFile_Mapped(vgmp, argv[1])) {
+		fprintf(stderr, "vgm2stems: error: failed to open vgm_file (%s)\n", argv[1]);
+		return 1;
+	}
+
+	PlayVGM(vgmp);
+
+	stemCount = GetStemCount(vgmp);
+	fileName = (char*)malloc(strlen(argv[2]) + 0x40);
+	stemOutputs = (WAV_OUTPUT*)calloc(stemCount, sizeof(WAV_OUTPUT));
+	stemBuffers = (WAVE_16BS**)calloc(stemCount, sizeof(WAVE_16BS*));
+	sampleBuffer = (WAVE_16BS*)malloc(SAMPLESIZE * p->SampleRate);
+	if (fileName == NULL || stemOutputs == NULL || stemBuffers == NULL || sampleBuffer == NULL) {
+		fputs("vgm2stems: error: failed to allocate memory\n", stderr);
+		return 1;
+	}
+
+	for (curStem = 0; curStem < stemCount; curStem++) {
+		GetStemFileName(vgmp, fileName, argv[2], curStem);
+		if (!OpenWave(&stemOutputs[curStem], fileName, p->SampleRate)) {
+			fprintf(stderr, "vgm2stems: error: failed to open %s\n", fileName);
+			return 1;
+		}
+		fprintf(stderr, "%s\n", fileName);
+	}
+	if (writeMix) {
+		sprintf(fileName, "%s_mix.wav", argv[2]);
+		if (!OpenWave(&mixOutput, fileName, p->SampleRate)) {
+			fprintf(stderr, "vgm2stems: error: failed to open %s\n", fileName);
+			return 1;
+		}
+	}
+
+	// everything is rendered straight into the write buffers
+	while (!p->EndPlay && !result) {
+		for (curStem = 0; curStem < stemCount; curStem++)
+			stemBuffers[curStem] = (WAVE_16BS*)GetWriteBuffer(stemOutputs[curStem].Writer);
+		bufferedLength = FillBufferStems(vgmp, writeMix ? (WAVE_16BS*)GetWriteBuffer(mixOutput.Writer) : sampleBuffer,
+										stemBuffers, p->SampleRate);
+		for (curStem = 0; curStem < stemCount; curStem++) {
+			if (!WriteWave(&stemOutputs[curStem], bufferedLength))
+				result = 1;
+		}
+		if (writeMix && !WriteWave(&mixOutput, bufferedLength))
+			result = 1;
+	}
+
+	StopVGM(vgmp);
+	CloseVGMFile(vgmp);
+	VGMPlay_Deinit(vgmp);
+
+	for (curStem = 0; curStem < stemCount; curStem++) {
+		if (!CloseWave(&stemOutputs[curStem]))
+			result = 1;
+	}
+	if (writeMix && !CloseWave(&mixOutput))
+		result = 1;
+	if (result)
+		fputs("vgm2stems: error: failed to write the output files\n", stderr);
+	free(stemBuffers);
+	free(stemOutputs);
+	free(sampleBuffer);
+	free(fileName);
+
+	return result;
+}
@@ -37,6 +37,7 @@
 #include "chips/mamedef.h"
 #include "stdbool.h"
 #include "VGMPlay.h"
+#include "SampleWriter.h"
 
 #define SAMPLESIZE sizeof(WAVE_16BS)
 
@@ -44,6 +45,10 @@ UINT8 CmdList[0x100]; // used by VGMPlay.c and VGMPlay_AddFmts.c
 bool ErrorHappened;   // used by VGMPlay.c and VGMPlay_AddFmts.c
 
 bool WriteSmplChunk;
+bool VerifyRender;	// compare against sample-by-sample rendering
+bool StreamInput;	// inflate the file during playback (OpenVGMFile_Stream)
+UINT8 SampleFormat;	// SMPFMT_S16/S32/F32
+bool ShowChipStats;	// print the counters of every chip at the end
 
 INLINE int fputLE16(UINT16 Value, FILE* hFile)
 {
@@ -69,6 +74,40 @@ INLINE int fputLE32(UINT32 Value, FILE* hFile)
 	return ResVal;
 }
 
+#define MAX_STATS_CHIPS	0x80
+
+void printChipStats(void *vgmp, UINT32 sampleCount) {
+	VGM_PLAYER *p = (VGM_PLAYER *) vgmp;
+	CHIP_STATS stats[MAX_STATS_CHIPS];
+	UINT32 chipCount;
+	UINT32 curChip;
+	double audioTime;
+	double chipTime;
+	char name[0x20];
+
+	chipCount = GetChipStats(vgmp, stats, MAX_STATS_CHIPS);
+	if (!chipCount) {
+		fputs("vgm2wav: chip statistics aren't available in this build\n", stderr);
+		return;
+	}
+
+	audioTime = (double)sampleCount / p->SampleRate;
+	fprintf(stderr, "%-12s %10s %12s %12s %10s %10s %7s\n",
+		"Chip", "Writes", "Samples", "Out Samples", "Update ms", "Resmpl ms", "Load");
+	for (curChip = 0; curChip < chipCount; curChip++) {
+		if (stats[curChip].ChipID)
+			sprintf(name, "%.9s #%u", GetChipName(stats[curChip].ChipType), stats[curChip].ChipID + 1);
+		else
+			sprintf(name, "%.12s", GetChipName(stats[curChip].ChipType));
+		// the share of the audio time the chip needs to render
+		chipTime = (stats[curChip].UpdateTime + stats[curChip].ResampleTime) / 1000000000.0;
+		fprintf(stderr, "%-12s %10u %12llu %12llu %10.1f %10.1f %6.2f%%\n", name,
+			stats[curChip].Writes, (unsigned long long)stats[curChip].Samples,
+			(unsigned long long)stats[curChip].Frames, stats[curChip].UpdateTime / 1000000.0,
+			stats[curChip].ResampleTime / 1000000.0, (audioTime > 0.0) ? chipTime * 100.0 / audioTime : 0.0);
+	}
+}
+
 void usage(const char *name) {
 	fprintf(stderr, "usage: %s [options] vgm_file wav_file\n"
 		"wav_file can be - for standard output.\n", name);
@@ -78,6 +117,15 @@ void usage(const char *name) {
 		"--loop-count {number}\n"
 		"--fade-ms {number}\n"
 		"--no-smpl-chunk\n"
+		"--no-block-render\n"
+		"--verify-render\n"
+		"--threads {number}\n"
+		"--stream\n"
+		"--pre-decode\n"
+		"--sample-format {s16|s32|f32}\n"
+		"--channels {2|4|6}\n"
+		"--step-synth\n"
+		"--chip-stats\n"
 		"\n", stderr);
 #else
 	fputs("Options not supported in this build (compiled without getopt.)\n", stderr);
@@ -86,16 +134,25 @@ void usage(const char *name) {
 
 int main(int argc, char *argv[]) {
 	WAVE_16BS *sampleBuffer;
+	SMPL_WRITER *sampleWriter;
 	UINT32 bufferedLength;
 	FILE *outputFile;
 
 	long int wavRIFFLengthPos = 0;
 	long int wavDataLengthPos = 0;
 	int sampleBytesWritten = 0;
+	UINT32 sampleSize;
+	UINT32 channels;
+	UINT32 fmtSize;
 
 	void *vgmp;
 	VGM_PLAYER *p;
 
+	FILE *refFile = NULL;
+	WAVE_16BS *refBuffer = NULL;
+	UINT32 renderedLength = 0;
+	int result = 0;
+
 	int c;
 
 	// Initialize VGMPlay before parsing arguments, so we can set VGMMaxLoop and FadeTime
@@ -107,6 +164,10 @@ int main(int argc, char *argv[]) {
 	p->VGMMaxLoop = 2;
 	p->FadeTime = 5000;
 	WriteSmplChunk = true;
+	VerifyRender = false;
+	StreamInput = false;
+	SampleFormat = SMPFMT_S16;
+	ShowChipStats = false;
 
 	// Parse command line arguments
 #ifdef VGM2PCM_HAS_GETOPT
@@ -115,6 +176,15 @@ int main(int argc, char *argv[]) {
 		{ "fade-ms", required_argument, NULL, 'f' },
 		{ "format", required_argument, NULL, 't' },
 		{ "no-smpl-chunk", no_argument, NULL, 'S' },
+		{ "no-block-render", no_argument, NULL, 'B' },
+		{ "verify-render", no_argument, NULL, 'V' },
+		{ "threads", required_argument, NULL, 'T' },
+		{ "stream", no_argument, NULL, 's' },
+		{ "pre-decode", no_argument, NULL, 'P' },
+		{ "sample-format", required_argument, NULL, 'F' },
+		{ "channels", required_argument, NULL, 'C' },
+		{ "step-synth", no_argument, NULL, 'X' },
+		{ "chip-stats", no_argument, NULL, 'I' },
 		{ "help", no_argument, NULL, '?' },
 		{ NULL, 0, NULL, 0 }
 	};
@@ -136,6 +206,57 @@ int main(int argc, char *argv[]) {
 			break;
 		case 'S':
 			WriteSmplChunk = false;
+			break;
+		case 'B':
+			p->BlockRender = false;
+			break;
+		case 'V':
+			VerifyRender = true;
+			break;
+		case 'T':
+			c = atoi(optarg);
+			if (c <= 0 || c > 0xFF) {
+				fputs("Error: thread count must be between 1 and 255.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			p->RenderThreads = c;
+			break;
+		case 's':
+			StreamInput = true;
+			break;
+		case 'P':
+			p->PreDecode = true;
+			break;
+		case 'F':
+			if (!strcmp(optarg, "s16")) {
+				SampleFormat = SMPFMT_S16;
+			} else if (!strcmp(optarg, "s32")) {
+				SampleFormat = SMPFMT_S32;
+			} else if (!strcmp(optarg, "f32")) {
+				SampleFormat = SMPFMT_F32;
+			} else {
+				fputs("Error: sample format must be s16, s32 or f32.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'C':
+			c = atoi(optarg);
+			if (c != 2 && c != 4 && c != 6) {
+				fputs("Error: channel count must be 2, 4 or 6.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			p->OutChannels = c;
+			break;
+		case 'X':
+			p->StepSynth = true;
+			break;
+		case 'I':
+			ShowChipStats = true;
+			p->RenderProfile = true;	// for the render times
+			break;
 		case -1:
 			break;
 		case '?':
@@ -156,8 +277,16 @@ int main(int argc, char *argv[]) {
 		usage(argv[0]);
 		return 1;
 	}
+	if (VerifyRender && (SampleFormat != SMPFMT_S16 || p->OutChannels != 2)) {
+		fputs("Error: --verify-render only works with 16-bit stereo output.\n", stderr);
+		return 1;
+	}
+	sampleSize = (SampleFormat == SMPFMT_S16) ? 2 : 4;
+	channels = GetOutputChannels(vgmp);
+	// WAVE_FORMAT_EXTENSIBLE adds 24 bytes to the fmt chunk
+	fmtSize = (channels > 2) ? 40 : 16;
 
-	if (!OpenVGMFile(vgmp, argv[1])) {
+	if (StreamInput ? !OpenVGMFile_Stream(vgmp, argv[1]) : !OpenVGMFile_Mapped(vgmp, argv[1])) {
 		fprintf(stderr, "vgm2wav: error: failed to open vgm_file (%s)\n", argv[1]);
 		return 1;
 	}
@@ -187,13 +316,28 @@ int main(int argc, char *argv[]) {
 	fwrite("WAVE", 1, 4, outputFile);
 
 	fwrite("fmt ", 1, 4, outputFile);
-	fputLE32(16, outputFile);
-	fputLE16(1, outputFile);
-	fputLE16(2, outputFile);
+	fputLE32(fmtSize, outputFile);
+	if (channels > 2)
+		fputLE16(0xFFFE, outputFile);	// WAVE_FORMAT_EXTENSIBLE
+	else
+		fputLE16((SampleFormat == SMPFMT_F32) ? 3 : 1, outputFile);	// IEEE float / PCM
+	fputLE16(channels, outputFile);
 	fputLE32(p->SampleRate, outputFile);
-	fputLE32(p->SampleRate * 2 * 2, outputFile);
-	fputLE16(2 * 2, outputFile);
-	fputLE16(16, outputFile);
+	fputLE32(p->SampleRate * channels * sampleSize, outputFile);
+	fputLE16(channels * sampleSize, outputFile);
+	fputLE16(8 * sampleSize, outputFile);
+	if (channels > 2) {
+		// the subformat GUID is the format tag + 0000-0010-8000-00AA00389B71
+		static const UINT8 guidTail[14] = {
+			0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+		};
+		fputLE16(22, outputFile);
+		fputLE16(8 * sampleSize, outputFile);
+		// FL FR BL BR or FL FR FC LFE BL BR
+		fputLE32((channels == 6) ? 0x3F : 0x33, outputFile);
+		fputLE16((SampleFormat == SMPFMT_F32) ? 3 : 1, outputFile);
+		fwrite(guidTail, 1, 14, outputFile);
+	}
 
 	if (WriteSmplChunk) {
 		fwrite("smpl", 1, 4, outputFile);
@@ -221,34 +365,108 @@ int main(int argc, char *argv[]) {
 	wavDataLengthPos = ftell(outputFile);
 	fputLE32(-1, outputFile);
 
-	PlayVGM(vgmp);
-
-	sampleBuffer = (WAVE_16BS*)malloc(SAMPLESIZE * p->SampleRate);
-	if (sampleBuffer == NULL) {
-		fprintf(stderr, "vgm2wav: error: failed to allocate %lu bytes of memory\n", SAMPLESIZE * p->SampleRate);
+	sampleWriter = OpenSampleWriter(outputFile, channels * sampleSize * p->SampleRate, true);
+	if (sampleWriter == NULL) {
+		fprintf(stderr, "vgm2wav: error: failed to allocate %lu bytes of memory\n", (unsigned long)channels * sampleSize * p->SampleRate);
 		return 1;
 	}
 
+	if (VerifyRender) {
+		// Render the reference one sample at a time into a temporary file first.
+		// Some cores take their noise from rand(), so both renderings have to
+		// start with the same seed and can't run side by side.
+		void *refVgmp;
+		VGM_PLAYER *refP;
+
+		refBuffer = (WAVE_16BS*)malloc(SAMPLESIZE * p->SampleRate);
+		refFile = tmpfile();
+		if (refBuffer == NULL || refFile == NULL) {
+			fputs("vgm2wav: error: failed to set up the reference rendering\n", stderr);
+			return 1;
+		}
+
+		refVgmp = VGMPlay_Init();
+		VGMPlay_Init2(refVgmp);
+		refP = (VGM_PLAYER *) refVgmp;
+		refP->VGMMaxLoop = p->VGMMaxLoop;
+		refP->FadeTime = p->FadeTime;
+		refP->BlockRender = false;
+		if (StreamInput ? !OpenVGMFile_Stream(refVgmp, argv[1]) : !OpenVGMFile_Mapped(refVgmp, argv[1])) {
+			fprintf(stderr, "vgm2wav: error: failed to open vgm_file (%s)\n", argv[1]);
+			return 1;
+		}
+		srand(1);
+		PlayVGM(refVgmp);
+		while (!refP->EndPlay) {
+			bufferedLength = FillBuffer(refVgmp, refBuffer, p->SampleRate);
+			fwrite(refBuffer, SAMPLESIZE, bufferedLength, refFile);
+		}
+		StopVGM(refVgmp);
+		CloseVGMFile(refVgmp);
+		VGMPlay_Deinit(refVgmp);
+		rewind(refFile);
+		srand(1);
+	}
+
+	PlayVGM(vgmp);
+
 	while (!p->EndPlay) {
 		UINT32 bufferSize = p->SampleRate;
-		bufferedLength = FillBuffer(vgmp, sampleBuffer, bufferSize);
-		if (bufferedLength) {
-			UINT32 numberOfSamples;
-			UINT32 currentSample;
-			const UINT16* sampleData;
-
-			sampleData = (const UINT16*)sampleBuffer;
-			numberOfSamples = SAMPLESIZE * bufferedLength / 0x02;
-			for (currentSample = 0x00; currentSample < numberOfSamples; currentSample++) {
-				fputLE16(sampleData[currentSample], outputFile);
-				sampleBytesWritten += 2;
+		sampleBuffer = (WAVE_16BS*)GetWriteBuffer(sampleWriter);
+		if (channels > 2)
+			bufferedLength = FillBufferMulti(vgmp, sampleBuffer, SampleFormat, bufferSize);
+		else
+			bufferedLength = FillBufferEx(vgmp, sampleBuffer, SampleFormat, bufferSize);
+		if (refFile != NULL) {
+			UINT32 refLength;
+			UINT32 curSmpl;
+
+			refLength = (UINT32)fread(refBuffer, SAMPLESIZE, bufferedLength, refFile);
+			for (curSmpl = 0; curSmpl < refLength; curSmpl++) {
+				if (sampleBuffer[curSmpl].Left != refBuffer[curSmpl].Left ||
+					sampleBuffer[curSmpl].Right != refBuffer[curSmpl].Right)
+					break;
+			}
+			if (curSmpl < bufferedLength) {
+				fprintf(stderr, "vgm2wav: render mismatch at sample %u\n", renderedLength + curSmpl);
+				result = 1;
+				fclose(refFile);
+				refFile = NULL;
 			}
 		}
+		renderedLength += bufferedLength;
+		// float samples have the same size and byte order as 32-bit integers
+		if (SampleFormat == SMPFMT_S16)
+			ConvertLE16(sampleBuffer, bufferedLength * channels);
+		else
+			ConvertLE32(sampleBuffer, bufferedLength * channels);
+		if (!WriteSamples(sampleWriter, bufferedLength * channels * sampleSize)) {
+			fputs("vgm2wav: error: failed to write the output file\n", stderr);
+			result = 1;
+			break;
+		}
+		sampleBytesWritten += bufferedLength * channels * sampleSize;
 	}
 
-	fflush(outputFile);
+	if (!CloseSampleWriter(sampleWriter) && !result) {
+		fputs("vgm2wav: error: failed to write the output file\n", stderr);
+		result = 1;
+	}
+	if (ShowChipStats)
+		printChipStats(vgmp, renderedLength);
 	StopVGM(vgmp);
 
+	if (refFile != NULL) {
+		if (fgetc(refFile) != EOF) {
+			fprintf(stderr, "vgm2wav: render mismatch at sample %u\n", renderedLength);
+			result = 1;
+		} else {
+			fprintf(stderr, "vgm2wav: %u samples match the reference rendering\n", renderedLength);
+		}
+		fclose(refFile);
+	}
+	free(refBuffer);
+
 	CloseVGMFile(vgmp);
 
 	VGMPlay_Deinit(vgmp);
@@ -256,9 +474,9 @@ int main(int argc, char *argv[]) {
 	if (wavRIFFLengthPos >= 0) {
 		fseek(outputFile, wavRIFFLengthPos, SEEK_SET);
 		if (WriteSmplChunk) {
-			fputLE32(sampleBytesWritten + 28 + 68 + 8, outputFile);
+			fputLE32(sampleBytesWritten + 12 + fmtSize + 68 + 8, outputFile);
 		} else {
-			fputLE32(sampleBytesWritten + 28 + 8, outputFile);
+			fputLE32(sampleBytesWritten + 12 + fmtSize + 8, outputFile);
 		}
 	}
 	if (wavDataLengthPos >= 0) {
@@ -266,5 +484,5 @@ int main(int argc, char *argv[]) {
 		fputLE32(sampleBytesWritten, outputFile);
 	}
 
-	return 0;
+	return result;
 }
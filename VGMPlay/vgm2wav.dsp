@@ -1087,6 +1087,18 @@ SOURCE=.\chips\panning.c
 
 SOURCE=.\chips\panning.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\chips\blip.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\chips\blip.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\chips\run_once.h
+# End Source File
 # End Group
 # Begin Source File
 
@@ -0,0 +1,816 @@
+/*
+ *  This file is part of VGMPlay <https://github.com/vgmrips/vgmplay>
+ *
+ *  vgmbatch - renders a whole set of VGMs into WAV/PCM files on all cores
+ *  Based on vgm2wav.c and vgm2pcm.c.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <wchar.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+#ifndef _MSC_VER
+// This turns command line options on (using getopt.h) unless you are using MSVC / Visual Studio, which doesn't have it.
+#define VGMBATCH_HAS_GETOPT
+#include <getopt.h>
+#endif
+
+#ifdef _MSC_VER
+#define strcasecmp	_stricmp
+#endif
+
+#include "chips/mamedef.h"
+#include "stdbool.h"
+#include "VGMPlay.h"
+#include "SampleWriter.h"
+
+#define SAMPLESIZE sizeof(WAVE_16BS)
+
+#define FMT_WAV		0x00
+#define FMT_PCM		0x01	// raw big endian, like vgm2pcm
+
+#ifdef WIN32
+#define DIR_SEP		'\\'
+typedef HANDLE				BT_THREAD;
+typedef CRITICAL_SECTION	BT_MUTEX;
+#define BT_MutexInit(m)		InitializeCriticalSection(m)
+#define BT_MutexDeinit(m)	DeleteCriticalSection(m)
+#define BT_Lock(m)			EnterCriticalSection(m)
+#define BT_Unlock(m)		LeaveCriticalSection(m)
+#else
+#define DIR_SEP		'/'
+typedef pthread_t			BT_THREAD;
+typedef pthread_mutex_t		BT_MUTEX;
+#define BT_MutexInit(m)		pthread_mutex_init(m, NULL)
+#define BT_MutexDeinit(m)	pthread_mutex_destroy(m)
+#define BT_Lock(m)			pthread_mutex_lock(m)
+#define BT_Unlock(m)		pthread_mutex_unlock(m)
+#endif
+
+typedef struct batch_job
+{
+	char* FileName;
+	char* OutName;
+	INT32 MaxLoops;		// -1 - use the global setting
+	INT32 FadeTime;		// -1 - use the global setting
+	UINT32 EstSamples;	// estimated length, longest tracks are rendered first
+	UINT32 ListIdx;
+
+	bool Failed;
+	double AudioTime;
+	double RenderTime;
+} BATCH_JOB;
+
+UINT8 CmdList[0x100]; // used by VGMPlay.c and VGMPlay_AddFmts.c
+bool ErrorHappened;   // used by VGMPlay.c and VGMPlay_AddFmts.c
+
+static BATCH_JOB* Jobs = NULL;
+static UINT32 JobCount = 0;
+static UINT32 JobAlloc = 0;
+
+static const char* OutDir = NULL;
+static UINT8 OutFormat = FMT_WAV;
+static INT32 MaxLoops = 2;
+static INT32 FadeTime = 5000;
+static bool WriteSmplChunk = true;
+static bool Quiet = false;
+static int ProgressWidth;
+
+// protected by JobLock
+static BT_MUTEX JobLock;
+static UINT32 NextJob;
+static UINT32 JobsDone;
+
+// Starting and stopping the chips fills tables that are shared between all players.
+static BT_MUTEX InitLock;
+// Songs that use cores with global state (see CanPlayConcurrently) are played one at a time.
+static BT_MUTEX SerialLock;
+
+static double GetTime(void)
+{
+#ifdef WIN32
+	LARGE_INTEGER Freq;
+	LARGE_INTEGER Count;
+
+	QueryPerformanceFrequency(&Freq);
+	QueryPerformanceCounter(&Count);
+	return (double)Count.QuadPart / (double)Freq.QuadPart;
+#else
+	struct timespec TS;
+
+	clock_gettime(CLOCK_MONOTONIC, &TS);
+	return TS.tv_sec + TS.tv_nsec / 1000000000.0;
+#endif
+}
+
+static UINT32 GetCPUCount(void)
+{
+#ifdef WIN32
+	SYSTEM_INFO SysInfo;
+
+	GetSystemInfo(&SysInfo);
+	return SysInfo.dwNumberOfProcessors;
+#else
+	long CPUs;
+
+	CPUs = sysconf(_SC_NPROCESSORS_ONLN);
+	return (CPUs > 0) ? (UINT32)CPUs : 1;
+#endif
+}
+
+static char* StrDupLen(const char* Str, size_t Len)
+{
+	char* RetStr;
+
+	RetStr = (char*)malloc(Len + 1);
+	memcpy(RetStr, Str, Len);
+	RetStr[Len] = '\0';
+	return RetStr;
+}
+
+static const char* GetFileTitle(const char* FilePath)
+{
+	const char* TempPnt;
+
+	TempPnt = strrchr(FilePath, '/');
+#ifdef WIN32
+	if (TempPnt == NULL || strrchr(FilePath, '\\') > TempPnt)
+		TempPnt = strrchr(FilePath, '\\');
+#endif
+	return (TempPnt == NULL) ? FilePath : TempPnt + 1;
+}
+
+static const char* GetFileExtention(const char* FilePath)
+{
+	const char* TempPnt;
+
+	TempPnt = strrchr(GetFileTitle(FilePath), '.');
+	return (TempPnt == NULL) ? "" : TempPnt + 1;
+}
+
+static bool IsAbsolutePath(const char* FilePath)
+{
+	if (FilePath[0] == '/' || FilePath[0] == '\\')
+		return true;
+	if (FilePath[0] != '\0' && FilePath[1] == ':')	// drive letter
+		return true;
+	return false;
+}
+
+static char* CombinePath(const char* BasePath, size_t BaseLen, const char* FileName)
+{
+	char* RetStr;
+
+	RetStr = (char*)malloc(BaseLen + 1 + strlen(FileName) + 1);
+	memcpy(RetStr, BasePath, BaseLen);
+	if (BaseLen && BasePath[BaseLen - 1] != '/' && BasePath[BaseLen - 1] != DIR_SEP)
+		RetStr[BaseLen ++] = DIR_SEP;
+	strcpy(RetStr + BaseLen, FileName);
+	return RetStr;
+}
+
+static char* MakeOutputName(const char* FileName)
+{
+	const char* Title;
+	const char* Ext;
+	char* BaseName;
+	char* RetStr;
+	size_t BaseLen;
+
+	Title = GetFileTitle(FileName);
+	Ext = GetFileExtention(FileName);
+	BaseLen = (*Ext != '\0') ? (size_t)(Ext - 1 - Title) : strlen(Title);
+	BaseName = (char*)malloc(BaseLen + 5);
+	memcpy(BaseName, Title, BaseLen);
+	strcpy(BaseName + BaseLen, (OutFormat == FMT_PCM) ? ".pcm" : ".wav");
+
+	if (OutDir != NULL)
+		RetStr = CombinePath(OutDir, strlen(OutDir), BaseName);
+	else
+		RetStr = CombinePath(FileName, Title - FileName, BaseName);
+	free(BaseName);
+	return RetStr;
+}
+
+static void AddJob(const char* FileName, INT32 Loops, INT32 Fade)
+{
+	BATCH_JOB* Job;
+
+	if (JobCount >= JobAlloc)
+	{
+		JobAlloc = JobAlloc ? (JobAlloc * 2) : 0x100;
+		Jobs = (BATCH_JOB*)realloc(Jobs, JobAlloc * sizeof(BATCH_JOB));
+	}
+	Job = &Jobs[JobCount];
+	memset(Job, 0x00, sizeof(BATCH_JOB));
+	Job->FileName = StrDupLen(FileName, strlen(FileName));
+	Job->OutName = MakeOutputName(FileName);
+	Job->MaxLoops = Loops;
+	Job->FadeTime = Fade;
+	Job->ListIdx = JobCount;
+	JobCount ++;
+
+	return;
+}
+
+static bool IsVGMFile(const char* FileName)
+{
+	const char* Ext;
+
+	Ext = GetFileExtention(FileName);
+	return ! strcasecmp(Ext, "vgm") || ! strcasecmp(Ext, "vgz");
+}
+
+static bool AddDirectory(const char* DirName)
+{
+	char* FilePath;
+#ifdef WIN32
+	WIN32_FIND_DATAA FindData;
+	HANDLE hFind;
+
+	FilePath = CombinePath(DirName, strlen(DirName), "*");
+	hFind = FindFirstFileA(FilePath, &FindData);
+	free(FilePath);
+	if (hFind == INVALID_HANDLE_VALUE)
+		return false;
+	do
+	{
+		if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			continue;
+		if (! IsVGMFile(FindData.cFileName))
+			continue;
+		FilePath = CombinePath(DirName, strlen(DirName), FindData.cFileName);
+		AddJob(FilePath, -1, -1);
+		free(FilePath);
+	} while(FindNextFileA(hFind, &FindData));
+	FindClose(hFind);
+#else
+	DIR* hDir;
+	struct dirent* Entry;
+	struct stat FileStat;
+
+	hDir = opendir(DirName);
+	if (hDir == NULL)
+		return false;
+	while((Entry = readdir(hDir)) != NULL)
+	{
+		if (! IsVGMFile(Entry->d_name))
+			continue;
+		FilePath = CombinePath(DirName, strlen(DirName), Entry->d_name);
+		if (! stat(FilePath, &FileStat) && S_ISREG(FileStat.st_mode))
+			AddJob(FilePath, -1, -1);
+		free(FilePath);
+	}
+	closedir(hDir);
+#endif
+
+	return true;
+}
+
+static bool AddFileList(const char* ListName, bool HasOptions)
+{
+	// .m3u playlists have a file name per line, file lists can have the loop count
+	// and fade time after it: file_name [TAB loop_count [TAB fade_ms]]
+	// Relative paths are relative to the list's directory.
+	FILE* hFile;
+	char Line[0x400];
+	char* Opt;
+	char* FilePath;
+	size_t BaseLen;
+	size_t LineLen;
+	INT32 Loops;
+	INT32 Fade;
+
+	hFile = fopen(ListName, "rt");
+	if (hFile == NULL)
+		return false;
+	BaseLen = GetFileTitle(ListName) - ListName;
+
+	while(fgets(Line, sizeof(Line), hFile) != NULL)
+	{
+		LineLen = strlen(Line);
+		while(LineLen && (Line[LineLen - 1] == '\n' || Line[LineLen - 1] == '\r'))
+			LineLen --;
+		Line[LineLen] = '\0';
+		if (Line[0] == '\0' || Line[0] == '#')
+			continue;
+		if (! strncmp(Line, "\xEF\xBB\xBF", 3))	// UTF-8 BOM
+			memmove(Line, Line + 3, LineLen - 3 + 1);
+
+		Loops = -1;
+		Fade = -1;
+		if (HasOptions)
+		{
+			Opt = strchr(Line, '\t');
+			if (Opt != NULL)
+			{
+				*Opt = '\0';
+				Opt ++;
+				Loops = (INT32)strtol(Opt, &Opt, 0);
+				if (Loops <= 0)
+					Loops = -1;
+				if (*Opt == '\t')
+					Fade = (INT32)strtol(Opt + 1, NULL, 0);
+			}
+		}
+
+		if (IsAbsolutePath(Line))
+			FilePath = StrDupLen(Line, strlen(Line));
+		else
+			FilePath = CombinePath(ListName, BaseLen, Line);
+		AddJob(FilePath, Loops, Fade);
+		free(FilePath);
+	}
+
+	fclose(hFile);
+	return true;
+}
+
+static bool AddInput(const char* Input)
+{
+	const char* Ext;
+#ifdef WIN32
+	DWORD Attr;
+
+	Attr = GetFileAttributesA(Input);
+	if (Attr != INVALID_FILE_ATTRIBUTES && (Attr & FILE_ATTRIBUTE_DIRECTORY))
+		return AddDirectory(Input);
+#else
+	struct stat FileStat;
+
+	if (! stat(Input, &FileStat) && S_ISDIR(FileStat.st_mode))
+		return AddDirectory(Input);
+#endif
+
+	if (Input[0] == '@')
+		return AddFileList(Input + 1, true);
+	Ext = GetFileExtention(Input);
+	if (! strcasecmp(Ext, "m3u") || ! strcasecmp(Ext, "m3u8"))
+		return AddFileList(Input, false);
+	if (! strcasecmp(Ext, "txt") || ! strcasecmp(Ext, "lst"))
+		return AddFileList(Input, true);
+
+	AddJob(Input, -1, -1);
+	return true;
+}
+
+static int JobCompare(const void* A, const void* B)
+{
+	const BATCH_JOB* JobA = (const BATCH_JOB*)A;
+	const BATCH_JOB* JobB = (const BATCH_JOB*)B;
+
+	if (JobA->EstSamples != JobB->EstSamples)
+		return (JobA->EstSamples < JobB->EstSamples) ? 1 : -1;
+	return (JobA->ListIdx < JobB->ListIdx) ? -1 : 1;
+}
+
+static void EstimateJobLengths(void)
+{
+	// The jobs are handed out longest first, so that one long track doesn't keep
+	// a single thread busy at the end of the batch.
+	VGM_HEADER VGMHead;
+	BATCH_JOB* Job;
+	UINT32 CurJob;
+	INT32 Loops;
+
+	for (CurJob = 0; CurJob < JobCount; CurJob ++)
+	{
+		Job = &Jobs[CurJob];
+		if (! GetVGMFileInfo(Job->FileName, &VGMHead, NULL))
+			continue;
+		Loops = (Job->MaxLoops > 0) ? Job->MaxLoops : MaxLoops;
+		Job->EstSamples = VGMHead.lngTotalSamples;
+		if (VGMHead.lngLoopSamples)
+			Job->EstSamples += VGMHead.lngLoopSamples * (Loops - 1);
+	}
+	qsort(Jobs, JobCount, sizeof(BATCH_JOB), &JobCompare);
+
+	return;
+}
+
+INLINE void WriteLE16(UINT8* Buffer, UINT16 Value)
+{
+	Buffer[0x00] = (Value & 0x00FF) >> 0;
+	Buffer[0x01] = (Value & 0xFF00) >> 8;
+	return;
+}
+
+INLINE void WriteLE32(UINT8* Buffer, UINT32 Value)
+{
+	Buffer[0x00] = (Value & 0x000000FF) >> 0;
+	Buffer[0x01] = (Value & 0x0000FF00) >> 8;
+	Buffer[0x02] = (Value & 0x00FF0000) >> 16;
+	Buffer[0x03] = (Value & 0xFF000000) >> 24;
+	return;
+}
+
+static UINT32 WriteWaveHeader(FILE* hFile, const VGM_PLAYER* p, bool SmplChunk, UINT32 DataBytes)
+{
+	// same layout as vgm2wav
+	UINT8 Header[0x70];
+	UINT32 HdrPos;
+
+	memset(Header, 0x00, sizeof(Header));
+	memcpy(&Header[0x00], "RIFF", 4);
+	memcpy(&Header[0x08], "WAVE", 4);
+	memcpy(&Header[0x0C], "fmt ", 4);
+	WriteLE32(&Header[0x10], 16);
+	WriteLE16(&Header[0x14], 1);
+	WriteLE16(&Header[0x16], 2);
+	WriteLE32(&Header[0x18], p->SampleRate);
+	WriteLE32(&Header[0x1C], p->SampleRate * 2 * 2);
+	WriteLE16(&Header[0x20], 2 * 2);
+	WriteLE16(&Header[0x22], 16);
+	HdrPos = 0x24;
+	if (SmplChunk)
+	{
+		memcpy(&Header[HdrPos + 0x00], "smpl", 4);
+		WriteLE32(&Header[HdrPos + 0x04], 60);
+		WriteLE32(&Header[HdrPos + 0x24], 1);
+		WriteLE32(&Header[HdrPos + 0x34], p->VGMHead.lngTotalSamples - p->VGMHead.lngLoopSamples);
+		WriteLE32(&Header[HdrPos + 0x38], p->VGMHead.lngTotalSamples);
+		HdrPos += 0x44;
+	}
+	memcpy(&Header[HdrPos + 0x00], "data", 4);
+	WriteLE32(&Header[HdrPos + 0x04], DataBytes);
+	HdrPos += 0x08;
+	WriteLE32(&Header[0x04], HdrPos - 0x08 + DataBytes);
+
+	return (UINT32)fwrite(Header, 1, HdrPos, hFile);
+}
+
+static bool RenderJob(void* vgmp, BATCH_JOB* Job)
+{
+	VGM_PLAYER* p = (VGM_PLAYER*)vgmp;
+	FILE* hFile;
+	SMPL_WRITER* SWrt;
+	WAVE_16BS* SmplBuf;
+	bool Concurrent;
+	bool SmplChunk;
+	bool RetVal;
+	UINT32 DataBytes;
+	UINT32 Samples;
+	UINT32 BufLen;
+
+	if (! OpenVGMFile_Mapped(vgmp, Job->FileName))
+	{
+		fprintf(stderr, "vgmbatch: error: failed to open vgm_file (%s)\n", Job->FileName);
+		return false;
+	}
+	hFile = fopen(Job->OutName, "wb");
+	if (hFile == NULL)
+	{
+		fprintf(stderr, "vgmbatch: error: failed to open output file (%s)\n", Job->OutName);
+		CloseVGMFile(vgmp);
+		return false;
+	}
+	// the jobs already keep all cores busy, so the writes stay on this thread
+	SWrt = OpenSampleWriter(hFile, SAMPLESIZE * p->SampleRate, false);
+	if (SWrt == NULL)
+	{
+		fputs("vgmbatch: error: failed to allocate memory\n", stderr);
+		fclose(hFile);
+		CloseVGMFile(vgmp);
+		return false;
+	}
+
+	p->VGMMaxLoop = (Job->MaxLoops > 0) ? Job->MaxLoops : MaxLoops;
+	p->FadeTime = (Job->FadeTime >= 0) ? Job->FadeTime : FadeTime;
+	SmplChunk = (OutFormat == FMT_WAV && WriteSmplChunk && p->VGMHead.lngLoopSamples);
+	if (OutFormat == FMT_WAV)
+		WriteWaveHeader(hFile, p, SmplChunk, 0);
+
+	Concurrent = CanPlayConcurrently(vgmp);
+	if (! Concurrent)
+	{
+		BT_Lock(&SerialLock);
+		srand(1);	// same noise as when playing the song on its own
+	}
+	BT_Lock(&InitLock);
+	PlayVGM(vgmp);
+	BT_Unlock(&InitLock);
+
+	RetVal = true;
+	DataBytes = 0;
+	Samples = 0;
+	while(! p->EndPlay)
+	{
+		SmplBuf = (WAVE_16BS*)GetWriteBuffer(SWrt);
+		BufLen = FillBuffer(vgmp, SmplBuf, p->SampleRate);
+		if (OutFormat == FMT_PCM)
+			ConvertBE16(SmplBuf, BufLen * 0x02);
+		else
+			ConvertLE16(SmplBuf, BufLen * 0x02);
+		if (! WriteSamples(SWrt, BufLen * SAMPLESIZE))
+		{
+			fprintf(stderr, "vgmbatch: error: failed to write %s\n", Job->OutName);
+			RetVal = false;
+			break;
+		}
+		DataBytes += BufLen * 0x04;
+		Samples += BufLen;
+	}
+	Job->AudioTime = (double)Samples / p->SampleRate;
+
+	BT_Lock(&InitLock);
+	StopVGM(vgmp);
+	BT_Unlock(&InitLock);
+	if (! Concurrent)
+		BT_Unlock(&SerialLock);
+	CloseVGMFile(vgmp);
+
+	if (! CloseSampleWriter(SWrt) && RetVal)
+	{
+		fprintf(stderr, "vgmbatch: error: failed to write %s\n", Job->OutName);
+		RetVal = false;
+	}
+	if (OutFormat == FMT_WAV && RetVal)
+	{
+		fseek(hFile, 0, SEEK_SET);
+		WriteWaveHeader(hFile, p, SmplChunk, DataBytes);
+	}
+	if (fclose(hFile))
+		RetVal = false;
+
+	return RetVal;
+}
+
+static void PrintTime(char* Buffer, double Seconds)
+{
+	UINT32 Secs;
+
+	Secs = (UINT32)Seconds;
+	if (Secs >= 3600)
+		sprintf(Buffer, "%u:%02u:%04.1f", Secs / 3600, Secs / 60 % 60, Seconds - Secs / 60 * 60);
+	else
+		sprintf(Buffer, "%u:%04.1f", Secs / 60, Seconds - Secs / 60 * 60);
+	return;
+}
+
+#ifdef WIN32
+static DWORD WINAPI WorkerThread(void* Param)
+#else
+static void* WorkerThread(void* Param)
+#endif
+{
+	void* vgmp;
+	BATCH_JOB* Job;
+	UINT32 CurJob;
+	UINT32 DoneCnt;
+	double StartTime;
+	char TimeStr[0x20];
+
+	// Every thread keeps its player for all of its songs.
+	vgmp = VGMPlay_Init();
+	VGMPlay_Init2(vgmp);
+
+	while(true)
+	{
+		BT_Lock(&JobLock);
+		CurJob = NextJob;
+		NextJob ++;
+		BT_Unlock(&JobLock);
+		if (CurJob >= JobCount)
+			break;
+
+		Job = &Jobs[CurJob];
+		StartTime = GetTime();
+		Job->Failed = ! RenderJob(vgmp, Job);
+		Job->RenderTime = GetTime() - StartTime;
+
+		BT_Lock(&JobLock);
+		JobsDone ++;
+		DoneCnt = JobsDone;
+		BT_Unlock(&JobLock);
+		if (! Quiet)
+		{
+			PrintTime(TimeStr, Job->AudioTime);
+			fprintf(stderr, "[%*u/%u] %s  %s  %.2f s%s\n", ProgressWidth, DoneCnt, JobCount,
+					Job->FileName, TimeStr, Job->RenderTime, Job->Failed ? "  FAILED" : "");
+		}
+	}
+
+	VGMPlay_Deinit(vgmp);
+
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [options] input...\n"
+		"input can be a directory (all .vgm/.vgz files in it), an .m3u playlist,\n"
+		"a .txt/.lst or @file list or a single VGM file.\n"
+		"File lists have one file per line: file_name [TAB loop_count [TAB fade_ms]]\n", name);
+#ifdef VGMBATCH_HAS_GETOPT
+	fputs("\n"
+		"Options:\n"
+		"--jobs {number}      (default: number of CPUs)\n"
+		"--out-dir {dir}      (default: next to the input files)\n"
+		"--format {wav|pcm}\n"
+		"--loop-count {number}\n"
+		"--fade-ms {number}\n"
+		"--no-smpl-chunk\n"
+		"--quiet\n"
+		"\n", stderr);
+#else
+	fputs("Options not supported in this build (compiled without getopt.)\n", stderr);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	BT_THREAD* Threads;
+	UINT32 ThreadCnt;
+	UINT32 CurThr;
+	UINT32 CurJob;
+	UINT32 Failed;
+	double StartTime;
+	double WallTime;
+	double AudioTime;
+	double CPUTime;
+	int ArgIdx;
+	int c;
+	char TimeStr[0x20];
+
+	ThreadCnt = 0;
+
+	// Parse command line arguments
+#ifdef VGMBATCH_HAS_GETOPT
+	static struct option long_options[] = {
+		{ "jobs", required_argument, NULL, 'j' },
+		{ "out-dir", required_argument, NULL, 'o' },
+		{ "format", required_argument, NULL, 't' },
+		{ "loop-count", required_argument, NULL, 'l' },
+		{ "fade-ms", required_argument, NULL, 'f' },
+		{ "no-smpl-chunk", no_argument, NULL, 'S' },
+		{ "quiet", no_argument, NULL, 'q' },
+		{ "help", no_argument, NULL, '?' },
+		{ NULL, 0, NULL, 0 }
+	};
+	while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+		switch (c) {
+		case 'j':
+			c = atoi(optarg);
+			if (c <= 0) {
+				fputs("Error: job count must be at least 1.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			ThreadCnt = c;
+			break;
+		case 'o':
+			OutDir = optarg;
+			break;
+		case 't':
+			if (! strcasecmp(optarg, "wav")) {
+				OutFormat = FMT_WAV;
+			} else if (! strcasecmp(optarg, "pcm")) {
+				OutFormat = FMT_PCM;
+			} else {
+				fprintf(stderr, "Error: unknown format %s.\n", optarg);
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'l':
+			c = atoi(optarg);
+			if (c <= 0) {
+				fputs("Error: loop count must be at least 1.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			MaxLoops = c;
+			break;
+		case 'f':
+			FadeTime = atoi(optarg);
+			break;
+		case 'S':
+			WriteSmplChunk = false;
+			break;
+		case 'q':
+			Quiet = true;
+			break;
+		case '?':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	ArgIdx = optind;
+#else
+	ArgIdx = 1;
+#endif
+	if (ArgIdx >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (; ArgIdx < argc; ArgIdx ++)
+	{
+		if (! AddInput(argv[ArgIdx]))
+			fprintf(stderr, "vgmbatch: error: failed to read %s\n", argv[ArgIdx]);
+	}
+	if (! JobCount)
+	{
+		fputs("vgmbatch: no files to render\n", stderr);
+		return 1;
+	}
+	EstimateJobLengths();
+	ProgressWidth = sprintf(TimeStr, "%u", JobCount);
+
+	if (! ThreadCnt)
+		ThreadCnt = GetCPUCount();
+	if (ThreadCnt > JobCount)
+		ThreadCnt = JobCount;
+
+	BT_MutexInit(&JobLock);
+	BT_MutexInit(&InitLock);
+	BT_MutexInit(&SerialLock);
+	NextJob = 0;
+	JobsDone = 0;
+
+	StartTime = GetTime();
+	Threads = (BT_THREAD*)calloc(ThreadCnt, sizeof(BT_THREAD));
+	for (CurThr = 0; CurThr < ThreadCnt; CurThr ++)
+	{
+#ifdef WIN32
+		Threads[CurThr] = CreateThread(NULL, 0, &WorkerThread, NULL, 0, NULL);
+		if (Threads[CurThr] == NULL)
+			break;
+#else
+		if (pthread_create(&Threads[CurThr], NULL, &WorkerThread, NULL))
+			break;
+#endif
+	}
+	if (! CurThr)
+	{
+		fputs("vgmbatch: error: failed to start the render threads\n", stderr);
+		return 1;
+	}
+	ThreadCnt = CurThr;
+	for (CurThr = 0; CurThr < ThreadCnt; CurThr ++)
+	{
+#ifdef WIN32
+		WaitForSingleObject(Threads[CurThr], INFINITE);
+		CloseHandle(Threads[CurThr]);
+#else
+		pthread_join(Threads[CurThr], NULL);
+#endif
+	}
+	WallTime = GetTime() - StartTime;
+	free(Threads);
+
+	Failed = 0;
+	AudioTime = 0.0;
+	CPUTime = 0.0;
+	for (CurJob = 0; CurJob < JobCount; CurJob ++)
+	{
+		if (Jobs[CurJob].Failed)
+			Failed ++;
+		AudioTime += Jobs[CurJob].AudioTime;
+		CPUTime += Jobs[CurJob].RenderTime;
+		free(Jobs[CurJob].FileName);
+		free(Jobs[CurJob].OutName);
+	}
+	free(Jobs);
+
+	PrintTime(TimeStr, AudioTime);
+	fprintf(stderr, "vgmbatch: %u of %u files rendered with %u threads, %u failed\n",
+			JobCount - Failed, JobCount, ThreadCnt, Failed);
+	fprintf(stderr, "vgmbatch: %s of audio in %.2f s (%.1fx realtime, %.2f s busy per thread)\n",
+			TimeStr, WallTime, (WallTime > 0.0) ? AudioTime / WallTime : 0.0, CPUTime / ThreadCnt);
+
+	BT_MutexDeinit(&SerialLock);
+	BT_MutexDeinit(&InitLock);
+	BT_MutexDeinit(&JobLock);
+
+	return Failed ? 1 : 0;
+}
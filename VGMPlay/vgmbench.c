@@ -0,0 +1,1821 @@
+/*
+ *  This file is part of VGMPlay <https://github.com/vgmrips/vgmplay>
+ *
+ *  vgmbench - measures the speed of the sound chip cores
+ *  Every core is driven directly with synthetic register writes, without a VGM file.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define BENCH_HAS_TSC
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define BENCH_HAS_TSC
+#endif
+
+#ifndef _MSC_VER
+// This turns command line options on (using getopt.h) unless you are using MSVC / Visual Studio, which doesn't have it.
+#define VGMBENCH_HAS_GETOPT
+#include <getopt.h>
+#endif
+
+#ifdef _MSC_VER
+#define strcasecmp	_stricmp
+#endif
+
+#include "chips/mamedef.h"
+#include "chips/ChipIncl.h"
+#include "stdbool.h"
+#include "VGMPlay.h"
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+#define BENCH_SMPLRATE	44100	// for cores that have a selectable sample rate
+#define BENCH_ROM_SIZE	0x100000
+#define MAX_BLOCK		0x1000
+#define MAX_RESULTS		0x100
+
+#define SCN_VOICES		0x00	// all voices play, nothing is written
+#define SCN_KEYON		0x01	// all voices are retriggered at the start of each block
+#define SCN_STREAM		0x02	// one PCM/DAC write per sample, the core is updated sample by sample
+#define SCN_COUNT		0x03
+
+typedef struct bench_chip
+{
+	void* Chip;
+	UINT8 Core;
+	UINT32 Seed;	// register values come from a fixed random sequence
+	UINT32 StrmPos;
+} BENCH_CHIP;
+
+typedef struct bench_def
+{
+	const char* Name;
+	const char* Cores[3];	// NULL - no further cores
+	UINT32 (*Start)(BENCH_CHIP* BC);	// returns the sample rate, 0 on failure
+	void (*Stop)(void* chip);
+	void (*Reset)(void* chip);
+	strm_func Update;
+	void (*Setup)(BENCH_CHIP* BC);	// loads the sample data and keys all voices on
+	void (*KeyOn)(BENCH_CHIP* BC);	// retriggers all voices with new pitches
+	void (*Stream)(BENCH_CHIP* BC);	// writes one PCM sample (NULL - the chip can't stream)
+} BENCH_DEF;
+
+typedef struct bench_result
+{
+	const char* Chip;
+	const char* Core;
+	UINT8 CoreID;
+	UINT8 Scenario;
+	UINT32 SmplRate;
+	UINT32 Samples;
+	double Time;
+	double Cycles;	// < 0 - not available
+} BENCH_RESULT;
+
+UINT8 CmdList[0x100]; // used by VGMPlay.c and VGMPlay_AddFmts.c
+bool ErrorHappened;   // used by VGMPlay.c and VGMPlay_AddFmts.c
+
+static const char* SCN_NAMES[SCN_COUNT] = {"voices", "keyon", "stream"};
+
+static UINT8* BenchROM = NULL;
+static stream_sample_t* StreamBufs[OUT_PAIRS_MAX * 2];
+
+static double BenchSecs = 5.0;
+static UINT32 BenchRuns = 3;
+static UINT32 BlockSize = 0x100;
+
+static BENCH_RESULT Results[MAX_RESULTS];
+static UINT32 ResultCount = 0;
+
+static double GetTime(void)
+{
+#ifdef WIN32
+	LARGE_INTEGER Freq;
+	LARGE_INTEGER Count;
+
+	QueryPerformanceFrequency(&Freq);
+	QueryPerformanceCounter(&Count);
+	return (double)Count.QuadPart / (double)Freq.QuadPart;
+#else
+	struct timespec TS;
+
+	clock_gettime(CLOCK_MONOTONIC, &TS);
+	return TS.tv_sec + TS.tv_nsec / 1000000000.0;
+#endif
+}
+
+static UINT64 GetCycles(void)
+{
+#ifdef BENCH_HAS_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static UINT32 BenchRand(BENCH_CHIP* BC, UINT32 Range)
+{
+	BC->Seed = BC->Seed * 1103515245 + 12345;
+	return ((BC->Seed >> 16) & 0x7FFF) % Range;
+}
+
+static void MakeBenchROM(void)
+{
+	UINT32 CurPos;
+	UINT32 Seed;
+	INT32 Smpl;
+
+	// two sines with a bit of noise, so that ADPCM decoders and the like don't take shortcuts
+	BenchROM = (UINT8*)malloc(BENCH_ROM_SIZE);
+	Seed = 0x2A03;
+	for (CurPos = 0; CurPos < BENCH_ROM_SIZE; CurPos ++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		Smpl = (INT32)(sin(CurPos * 0.05) * 60.0 + sin(CurPos * 0.0031) * 40.0);
+		Smpl += (INT32)((Seed >> 16) & 0x0F) - 0x08;
+		BenchROM[CurPos] = (UINT8)Smpl;
+		// 0xFF is the end marker of RF5C68/RF5C164 samples and 0x80 is silence on some chips
+		if (BenchROM[CurPos] == 0xFF || BenchROM[CurPos] == 0x80)
+			BenchROM[CurPos] ++;
+	}
+
+	return;
+}
+
+static UINT8 StreamSample(BENCH_CHIP* BC)
+{
+	UINT8 Data;
+
+	Data = BenchROM[BC->StrmPos];
+	BC->StrmPos = (BC->StrmPos + 1) & (BENCH_ROM_SIZE - 1);
+	return Data;
+}
+
+
+// --- SN76496 ---
+static UINT32 bench_sn_start(BENCH_CHIP* BC)
+{
+	return device_start_sn764xx(&BC->Chip, BC->Core, 3579545, BENCH_SMPLRATE, 16, 0x09, 0, 0, 0, 0);
+}
+
+static void bench_sn_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Period;
+
+	for (CurChn = 0; CurChn < 3; CurChn ++)
+	{
+		Period = 0x040 + BenchRand(BC, 0x300);
+		sn764xx_w(BC->Chip, 0x00, 0x80 | (CurChn << 5) | (Period & 0x0F));
+		sn764xx_w(BC->Chip, 0x00, Period >> 4);
+		sn764xx_w(BC->Chip, 0x00, 0x90 | (CurChn << 5) | 0x02);
+	}
+	sn764xx_w(BC->Chip, 0x00, 0xE4 | 0x03);	// white noise, clocked by channel 2
+	sn764xx_w(BC->Chip, 0x00, 0xF4);
+
+	return;
+}
+
+static void bench_sn_stream(BENCH_CHIP* BC)
+{
+	sn764xx_w(BC->Chip, 0x00, 0x90 | (~StreamSample(BC) >> 4 & 0x0F));
+	return;
+}
+
+// --- address/data port chips (OPLL, OPN, OPM, OPL, AY, ...) ---
+static void bench_ym2413_reg(BENCH_CHIP* BC, UINT8 Reg, UINT8 Data)
+{
+	ym2413_w(BC->Chip, 0x00, Reg);
+	ym2413_w(BC->Chip, 0x01, Data);
+	return;
+}
+
+static UINT32 bench_ym2413_start(BENCH_CHIP* BC)
+{
+	return device_start_ym2413(&BC->Chip, BC->Core, 3579545, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ym2413_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 FNum;
+	UINT8 Block;
+
+	for (CurChn = 0; CurChn < 9; CurChn ++)
+	{
+		FNum = 0x100 + BenchRand(BC, 0x100);
+		Block = 2 + BenchRand(BC, 4);
+		bench_ym2413_reg(BC, 0x20 + CurChn, 0x00);
+		bench_ym2413_reg(BC, 0x30 + CurChn, ((1 + CurChn) << 4) | 0x02);
+		bench_ym2413_reg(BC, 0x10 + CurChn, FNum & 0xFF);
+		bench_ym2413_reg(BC, 0x20 + CurChn, 0x10 | (Block << 1) | (FNum >> 8));
+	}
+
+	return;
+}
+
+static void bench_port_w(BENCH_CHIP* BC, void (*WriteFunc)(void*, offs_t, UINT8),
+					UINT8 Port, UINT8 Reg, UINT8 Data)
+{
+	WriteFunc(BC->Chip, (Port << 1) | 0x00, Reg);
+	WriteFunc(BC->Chip, (Port << 1) | 0x01, Data);
+	return;
+}
+
+static void bench_opn_setup(BENCH_CHIP* BC, void (*WriteFunc)(void*, offs_t, UINT8), UINT8 Ports)
+{
+	UINT8 CurPort;
+	UINT8 CurChn;
+	UINT8 CurOp;
+	UINT8 Slot;
+
+	bench_port_w(BC, WriteFunc, 0, 0x22, 0x00);	// LFO off
+	bench_port_w(BC, WriteFunc, 0, 0x27, 0x00);	// normal channel 3 mode
+	for (CurPort = 0; CurPort < Ports; CurPort ++)
+	{
+		for (CurChn = 0; CurChn < 3; CurChn ++)
+		{
+			for (CurOp = 0; CurOp < 4; CurOp ++)
+			{
+				Slot = CurChn + CurOp * 4;
+				bench_port_w(BC, WriteFunc, CurPort, 0x30 + Slot, 0x01 + CurOp);	// DT/MUL
+				bench_port_w(BC, WriteFunc, CurPort, 0x40 + Slot, 0x10);	// TL
+				bench_port_w(BC, WriteFunc, CurPort, 0x50 + Slot, 0x1F);	// KS/AR
+				bench_port_w(BC, WriteFunc, CurPort, 0x60 + Slot, 0x05);	// AM/D1R
+				bench_port_w(BC, WriteFunc, CurPort, 0x70 + Slot, 0x02);	// D2R
+				bench_port_w(BC, WriteFunc, CurPort, 0x80 + Slot, 0x27);	// D1L/RR
+			}
+			bench_port_w(BC, WriteFunc, CurPort, 0xB0 + CurChn, 0x07);	// all operators are carriers
+			bench_port_w(BC, WriteFunc, CurPort, 0xB4 + CurChn, 0xC0);
+		}
+	}
+
+	return;
+}
+
+static void bench_opn_keyon(BENCH_CHIP* BC, void (*WriteFunc)(void*, offs_t, UINT8), UINT8 Ports)
+{
+	UINT8 CurPort;
+	UINT8 CurChn;
+	UINT16 FNum;
+	UINT8 Block;
+
+	for (CurPort = 0; CurPort < Ports; CurPort ++)
+	{
+		for (CurChn = 0; CurChn < 3; CurChn ++)
+		{
+			FNum = 0x200 + BenchRand(BC, 0x400);
+			Block = 2 + BenchRand(BC, 4);
+			bench_port_w(BC, WriteFunc, 0, 0x28, (CurPort << 2) | CurChn);
+			bench_port_w(BC, WriteFunc, CurPort, 0xA4 + CurChn, (Block << 3) | (FNum >> 8));
+			bench_port_w(BC, WriteFunc, CurPort, 0xA0 + CurChn, FNum & 0xFF);
+			bench_port_w(BC, WriteFunc, 0, 0x28, 0xF0 | (CurPort << 2) | CurChn);
+		}
+	}
+
+	return;
+}
+
+static UINT32 bench_ym2612_start(BENCH_CHIP* BC)
+{
+	UINT8 IsVGMInit = 0x00;
+
+	return device_start_ym2612(&BC->Chip, BC->Core, 0x00, 7670453, 0, BENCH_SMPLRATE, &IsVGMInit);
+}
+
+static void bench_ym2612_setup(BENCH_CHIP* BC)
+{
+	bench_opn_setup(BC, &ym2612_w, 2);
+	bench_opn_keyon(BC, &ym2612_w, 2);
+	return;
+}
+
+static void bench_ym2612_keyon(BENCH_CHIP* BC)
+{
+	bench_opn_keyon(BC, &ym2612_w, 2);
+	return;
+}
+
+static void bench_ym2612_stream(BENCH_CHIP* BC)
+{
+	if (! BC->StrmPos)
+		bench_port_w(BC, &ym2612_w, 0, 0x2B, 0x80);	// DAC on
+	bench_port_w(BC, &ym2612_w, 0, 0x2A, StreamSample(BC));
+	return;
+}
+
+static UINT32 bench_ym2151_start(BENCH_CHIP* BC)
+{
+	return device_start_ym2151(&BC->Chip, 3579545, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ym2151_reg(BENCH_CHIP* BC, UINT8 Reg, UINT8 Data)
+{
+	ym2151_w(BC->Chip, 0x00, Reg);
+	ym2151_w(BC->Chip, 0x01, Data);
+	return;
+}
+
+static void bench_ym2151_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+
+	for (CurChn = 0; CurChn < 8; CurChn ++)
+	{
+		bench_ym2151_reg(BC, 0x08, CurChn);
+		bench_ym2151_reg(BC, 0x28 + CurChn, BenchRand(BC, 0x80));	// KC
+		bench_ym2151_reg(BC, 0x30 + CurChn, BenchRand(BC, 0x100) & 0xFC);	// KF
+		bench_ym2151_reg(BC, 0x08, 0x78 | CurChn);
+	}
+
+	return;
+}
+
+static void bench_ym2151_setup(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT8 CurOp;
+	UINT8 Slot;
+
+	for (CurChn = 0; CurChn < 8; CurChn ++)
+	{
+		bench_ym2151_reg(BC, 0x20 + CurChn, 0xC7);	// L+R, all operators are carriers
+		for (CurOp = 0; CurOp < 4; CurOp ++)
+		{
+			Slot = CurChn + CurOp * 8;
+			bench_ym2151_reg(BC, 0x40 + Slot, 0x01 + CurOp);	// DT1/MUL
+			bench_ym2151_reg(BC, 0x60 + Slot, 0x10);	// TL
+			bench_ym2151_reg(BC, 0x80 + Slot, 0x1F);	// KS/AR
+			bench_ym2151_reg(BC, 0xA0 + Slot, 0x05);	// AMS/D1R
+			bench_ym2151_reg(BC, 0xC0 + Slot, 0x02);	// DT2/D2R
+			bench_ym2151_reg(BC, 0xE0 + Slot, 0x27);	// D1L/RR
+		}
+	}
+	bench_ym2151_keyon(BC);
+
+	return;
+}
+
+// The OPN chips are started with their SSG part disabled, it is measured by the AY8910 entry.
+static UINT32 bench_ym2203_start(BENCH_CHIP* BC)
+{
+	int AYRate;
+
+	return device_start_ym2203(&BC->Chip, 0, 3993600, 0x01, 0x00, &AYRate, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ym2203_setup(BENCH_CHIP* BC)
+{
+	bench_opn_setup(BC, &ym2203_w, 1);
+	bench_opn_keyon(BC, &ym2203_w, 1);
+	return;
+}
+
+static void bench_ym2203_keyon(BENCH_CHIP* BC)
+{
+	bench_opn_keyon(BC, &ym2203_w, 1);
+	return;
+}
+
+static UINT32 bench_ym2608_start(BENCH_CHIP* BC)
+{
+	int AYRate;
+
+	return device_start_ym2608(&BC->Chip, 0, 7987200, 0x01, 0x00, &AYRate, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ym2608_setup(BENCH_CHIP* BC)
+{
+	bench_opn_setup(BC, &ym2608_w, 2);
+	bench_port_w(BC, &ym2608_w, 0, 0x29, 0x80);	// 6 FM channels
+	bench_opn_keyon(BC, &ym2608_w, 2);
+	return;
+}
+
+static void bench_ym2608_keyon(BENCH_CHIP* BC)
+{
+	bench_opn_keyon(BC, &ym2608_w, 2);
+	return;
+}
+
+static UINT32 bench_ym2610_start(BENCH_CHIP* BC)
+{
+	int AYRate;
+
+	return device_start_ym2610(&BC->Chip, 0, 8000000, 0x01, &AYRate, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ym2610_setup(BENCH_CHIP* BC)
+{
+	bench_opn_setup(BC, &ym2610_w, 2);
+	bench_opn_keyon(BC, &ym2610_w, 2);
+	return;
+}
+
+static void bench_ym2610_keyon(BENCH_CHIP* BC)
+{
+	bench_opn_keyon(BC, &ym2610_w, 2);
+	return;
+}
+
+static const UINT8 OPL_SLOTS[9] = {0x00, 0x01, 0x02, 0x08, 0x09, 0x0A, 0x10, 0x11, 0x12};
+
+static void bench_opl_setup(BENCH_CHIP* BC, void (*WriteFunc)(void*, offs_t, UINT8), UINT8 Ports)
+{
+	UINT8 CurPort;
+	UINT8 CurChn;
+	UINT8 CurOp;
+	UINT8 Slot;
+
+	if (Ports > 1)
+	{
+		bench_port_w(BC, WriteFunc, 1, 0x05, 0x01);	// OPL3 mode
+		bench_port_w(BC, WriteFunc, 1, 0x04, 0x00);	// no 4-op channels
+	}
+	bench_port_w(BC, WriteFunc, 0, 0x01, 0x20);	// waveform select on
+	bench_port_w(BC, WriteFunc, 0, 0x08, 0x00);
+	bench_port_w(BC, WriteFunc, 0, 0xBD, 0xC0);	// deep AM/vibrato, no rhythm mode
+	for (CurPort = 0; CurPort < Ports; CurPort ++)
+	{
+		for (CurChn = 0; CurChn < 9; CurChn ++)
+		{
+			for (CurOp = 0; CurOp < 2; CurOp ++)
+			{
+				Slot = OPL_SLOTS[CurChn] + CurOp * 3;
+				bench_port_w(BC, WriteFunc, CurPort, 0x20 + Slot, 0xE1);	// AM/VIB/EG/MUL
+				bench_port_w(BC, WriteFunc, CurPort, 0x40 + Slot, CurOp ? 0x00 : 0x18);	// KSL/TL
+				bench_port_w(BC, WriteFunc, CurPort, 0x60 + Slot, 0xF4);	// AR/DR
+				bench_port_w(BC, WriteFunc, CurPort, 0x80 + Slot, 0x26);	// SL/RR
+				bench_port_w(BC, WriteFunc, CurPort, 0xE0 + Slot, BenchRand(BC, (Ports > 1) ? 8 : 4));
+			}
+			bench_port_w(BC, WriteFunc, CurPort, 0xC0 + CurChn, 0x30 | 0x06);	// L+R, feedback 3, FM
+		}
+	}
+
+	return;
+}
+
+static void bench_opl_keyon(BENCH_CHIP* BC, void (*WriteFunc)(void*, offs_t, UINT8), UINT8 Ports)
+{
+	UINT8 CurPort;
+	UINT8 CurChn;
+	UINT16 FNum;
+	UINT8 Block;
+
+	for (CurPort = 0; CurPort < Ports; CurPort ++)
+	{
+		for (CurChn = 0; CurChn < 9; CurChn ++)
+		{
+			FNum = 0x150 + BenchRand(BC, 0x200);
+			Block = 2 + BenchRand(BC, 4);
+			bench_port_w(BC, WriteFunc, CurPort, 0xB0 + CurChn, (Block << 2) | (FNum >> 8));
+			bench_port_w(BC, WriteFunc, CurPort, 0xA0 + CurChn, FNum & 0xFF);
+			bench_port_w(BC, WriteFunc, CurPort, 0xB0 + CurChn, 0x20 | (Block << 2) | (FNum >> 8));
+		}
+	}
+
+	return;
+}
+
+static UINT32 bench_ym3812_start(BENCH_CHIP* BC)
+{
+	return device_start_ym3812(&BC->Chip, BC->Core, 3579545, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ym3812_setup(BENCH_CHIP* BC)
+{
+	bench_opl_setup(BC, &ym3812_w, 1);
+	bench_opl_keyon(BC, &ym3812_w, 1);
+	return;
+}
+
+static void bench_ym3812_keyon(BENCH_CHIP* BC)
+{
+	bench_opl_keyon(BC, &ym3812_w, 1);
+	return;
+}
+
+static UINT32 bench_ymf262_start(BENCH_CHIP* BC)
+{
+	return device_start_ymf262(&BC->Chip, BC->Core, 14318180, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ymf262_setup(BENCH_CHIP* BC)
+{
+	bench_opl_setup(BC, &ymf262_w, 2);
+	bench_opl_keyon(BC, &ymf262_w, 2);
+	return;
+}
+
+static void bench_ymf262_keyon(BENCH_CHIP* BC)
+{
+	bench_opl_keyon(BC, &ymf262_w, 2);
+	return;
+}
+
+// --- YMF278B (OPL4): all FM channels and all 24 wavetable slots ---
+static UINT32 bench_ymf278b_start(BENCH_CHIP* BC)
+{
+	return device_start_ymf278b(&BC->Chip, 33868800);
+}
+
+static void bench_ymf278b_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurSlot;
+	UINT16 FNum;
+	UINT8 Octave;
+
+	bench_opl_keyon(BC, &ymf278b_w, 2);
+	for (CurSlot = 0; CurSlot < 24; CurSlot ++)
+	{
+		FNum = BenchRand(BC, 0x400);
+		Octave = BenchRand(BC, 3);
+		bench_port_w(BC, &ymf278b_w, 2, 0x68 + CurSlot, 0x00);	// key off
+		bench_port_w(BC, &ymf278b_w, 2, 0x50 + CurSlot, 0x20);	// TL
+		bench_port_w(BC, &ymf278b_w, 2, 0x38 + CurSlot, (Octave << 4) | (FNum >> 7));
+		bench_port_w(BC, &ymf278b_w, 2, 0x20 + CurSlot, (FNum & 0x7F) << 1);
+		bench_port_w(BC, &ymf278b_w, 2, 0x08 + CurSlot, BenchRand(BC, 0x80));	// wave from the built-in ROM
+		bench_port_w(BC, &ymf278b_w, 2, 0x68 + CurSlot, 0x80);	// key on, center
+	}
+
+	return;
+}
+
+static void bench_ymf278b_setup(BENCH_CHIP* BC)
+{
+	bench_opl_setup(BC, &ymf278b_w, 2);
+	bench_port_w(BC, &ymf278b_w, 1, 0x05, 0x03);	// OPL3 + OPL4 mode
+	bench_ymf278b_keyon(BC);
+	return;
+}
+
+// --- YMZ280B ---
+static UINT32 bench_ymz280b_start(BENCH_CHIP* BC)
+{
+	return device_start_ymz280b(&BC->Chip, 16934400);
+}
+
+static void bench_ymz280b_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurVoc;
+	UINT16 FNum;
+	UINT32 Start;
+	UINT32 End;
+	UINT8 Mode;
+
+	for (CurVoc = 0; CurVoc < 8; CurVoc ++)
+	{
+		FNum = 0x080 + BenchRand(BC, 0x100);
+		Mode = 1 + (CurVoc % 3);	// ADPCM, PCM8, PCM16
+		Start = BenchRand(BC, 0x8000) << 4;
+		End = Start + 0x20000;
+		bench_port_w(BC, &ymz280b_w, 0, CurVoc * 4 + 0x01, (Mode << 5) | 0x10 | (FNum >> 8));	// key off
+		bench_port_w(BC, &ymz280b_w, 0, CurVoc * 4 + 0x00, FNum & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, CurVoc * 4 + 0x02, 0xC0);	// level
+		bench_port_w(BC, &ymz280b_w, 0, CurVoc * 4 + 0x03, 0x08);	// pan
+		bench_port_w(BC, &ymz280b_w, 0, 0x20 + CurVoc * 4 + 0, (Start >> 16) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x40 + CurVoc * 4 + 0, (Start >> 8) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x60 + CurVoc * 4 + 0, (Start >> 0) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x20 + CurVoc * 4 + 1, (Start >> 16) & 0xFF);	// loop start
+		bench_port_w(BC, &ymz280b_w, 0, 0x40 + CurVoc * 4 + 1, (Start >> 8) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x60 + CurVoc * 4 + 1, (Start >> 0) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x20 + CurVoc * 4 + 2, (End >> 16) & 0xFF);	// loop end
+		bench_port_w(BC, &ymz280b_w, 0, 0x40 + CurVoc * 4 + 2, (End >> 8) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x60 + CurVoc * 4 + 2, (End >> 0) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x20 + CurVoc * 4 + 3, (End >> 16) & 0xFF);	// end
+		bench_port_w(BC, &ymz280b_w, 0, 0x40 + CurVoc * 4 + 3, (End >> 8) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, 0x60 + CurVoc * 4 + 3, (End >> 0) & 0xFF);
+		bench_port_w(BC, &ymz280b_w, 0, CurVoc * 4 + 0x01, 0x80 | (Mode << 5) | 0x10 | (FNum >> 8));
+	}
+
+	return;
+}
+
+static void bench_ymz280b_setup(BENCH_CHIP* BC)
+{
+	ymz280b_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, BENCH_ROM_SIZE, BenchROM);
+	bench_port_w(BC, &ymz280b_w, 0, 0xFF, 0x80);	// key on enable
+	bench_ymz280b_keyon(BC);
+	return;
+}
+
+// --- AY8910 ---
+static UINT32 bench_ay8910_start(BENCH_CHIP* BC)
+{
+	return device_start_ayxx(&BC->Chip, BC->Core, 1789772, 0x00, 0x01, 0, BENCH_SMPLRATE);
+}
+
+static void bench_ay8910_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Period;
+
+	for (CurChn = 0; CurChn < 3; CurChn ++)
+	{
+		Period = 0x040 + BenchRand(BC, 0x300);
+		bench_port_w(BC, &ayxx_w, 0, CurChn * 2 + 0, Period & 0xFF);
+		bench_port_w(BC, &ayxx_w, 0, CurChn * 2 + 1, Period >> 8);
+		bench_port_w(BC, &ayxx_w, 0, 0x08 + CurChn, (CurChn == 2) ? 0x10 : 0x0C);	// channel C uses the envelope
+	}
+	bench_port_w(BC, &ayxx_w, 0, 0x06, 0x08);	// noise period
+	bench_port_w(BC, &ayxx_w, 0, 0x07, 0x30);	// tone on A/B/C, noise on A/B
+	bench_port_w(BC, &ayxx_w, 0, 0x0B, 0x40);	// envelope period
+	bench_port_w(BC, &ayxx_w, 0, 0x0C, 0x00);
+	bench_port_w(BC, &ayxx_w, 0, 0x0D, 0x0E);	// triangle envelope
+
+	return;
+}
+
+static void bench_ay8910_stream(BENCH_CHIP* BC)
+{
+	bench_port_w(BC, &ayxx_w, 0, 0x08, StreamSample(BC) >> 4);
+	return;
+}
+
+// --- GameBoy DMG ---
+static UINT32 bench_gb_start(BENCH_CHIP* BC)
+{
+	return device_start_gameboy_sound(&BC->Chip, 4194304, 0x00, BENCH_SMPLRATE);
+}
+
+static void bench_gb_keyon(BENCH_CHIP* BC)
+{
+	UINT16 Freq;
+
+	Freq = 0x400 + BenchRand(BC, 0x300);
+	gb_sound_w(BC->Chip, 0x01, 0x80);	// NR11: duty 50%
+	gb_sound_w(BC->Chip, 0x02, 0xF0);	// NR12: volume 15
+	gb_sound_w(BC->Chip, 0x03, Freq & 0xFF);
+	gb_sound_w(BC->Chip, 0x04, 0x80 | (Freq >> 8));
+	Freq = 0x400 + BenchRand(BC, 0x300);
+	gb_sound_w(BC->Chip, 0x06, 0x40);	// NR21
+	gb_sound_w(BC->Chip, 0x07, 0xF0);
+	gb_sound_w(BC->Chip, 0x08, Freq & 0xFF);
+	gb_sound_w(BC->Chip, 0x09, 0x80 | (Freq >> 8));
+	Freq = 0x400 + BenchRand(BC, 0x300);
+	gb_sound_w(BC->Chip, 0x0A, 0x80);	// NR30: wave channel on
+	gb_sound_w(BC->Chip, 0x0C, 0x20);	// NR32: full volume
+	gb_sound_w(BC->Chip, 0x0D, Freq & 0xFF);
+	gb_sound_w(BC->Chip, 0x0E, 0x80 | (Freq >> 8));
+	gb_sound_w(BC->Chip, 0x11, 0xF0);	// NR42
+	gb_sound_w(BC->Chip, 0x12, 0x22);	// NR43
+	gb_sound_w(BC->Chip, 0x13, 0x80);
+
+	return;
+}
+
+static void bench_gb_setup(BENCH_CHIP* BC)
+{
+	UINT8 CurPos;
+
+	gb_sound_w(BC->Chip, 0x16, 0x80);	// NR52: sound on
+	gb_sound_w(BC->Chip, 0x14, 0x77);	// NR50
+	gb_sound_w(BC->Chip, 0x15, 0xFF);	// NR51
+	for (CurPos = 0x00; CurPos < 0x10; CurPos ++)
+		gb_sound_w(BC->Chip, 0x20 + CurPos, BenchROM[CurPos]);
+	bench_gb_keyon(BC);
+
+	return;
+}
+
+// --- NES APU ---
+static UINT32 bench_nes_start(BENCH_CHIP* BC)
+{
+	return device_start_nes(&BC->Chip, BC->Core, 1789772, 0x00, 0, BENCH_SMPLRATE);
+}
+
+static void bench_nes_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Period;
+
+	nes_w(BC->Chip, 0x15, 0x0F);
+	for (CurChn = 0; CurChn < 2; CurChn ++)
+	{
+		Period = 0x080 + BenchRand(BC, 0x300);
+		nes_w(BC->Chip, CurChn * 4 + 0x00, 0xBF);	// duty 50%, constant volume 15
+		nes_w(BC->Chip, CurChn * 4 + 0x01, 0x08);	// sweep off
+		nes_w(BC->Chip, CurChn * 4 + 0x02, Period & 0xFF);
+		nes_w(BC->Chip, CurChn * 4 + 0x03, 0xF8 | (Period >> 8));
+	}
+	Period = 0x080 + BenchRand(BC, 0x300);
+	nes_w(BC->Chip, 0x08, 0xFF);
+	nes_w(BC->Chip, 0x0A, Period & 0xFF);
+	nes_w(BC->Chip, 0x0B, 0xF8 | (Period >> 8));
+	nes_w(BC->Chip, 0x0C, 0x3F);
+	nes_w(BC->Chip, 0x0E, 0x04);
+	nes_w(BC->Chip, 0x0F, 0xF8);
+
+	return;
+}
+
+static void bench_nes_setup(BENCH_CHIP* BC)
+{
+	bench_nes_keyon(BC);
+	return;
+}
+
+static void bench_nes_stream(BENCH_CHIP* BC)
+{
+	nes_w(BC->Chip, 0x11, StreamSample(BC) >> 1);	// DMC DAC
+	return;
+}
+
+// --- MultiPCM ---
+static UINT32 bench_multipcm_start(BENCH_CHIP* BC)
+{
+	return device_start_multipcm(&BC->Chip, 8053975);
+}
+
+static void bench_multipcm_reg(BENCH_CHIP* BC, UINT8 Slot, UINT8 Reg, UINT8 Data)
+{
+	multipcm_w(BC->Chip, 0x01, Slot);
+	multipcm_w(BC->Chip, 0x02, Reg);
+	multipcm_w(BC->Chip, 0x00, Data);
+	return;
+}
+
+static void bench_multipcm_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurSlot;
+	UINT16 Pitch;
+
+	for (CurSlot = 0; CurSlot < 0x20; CurSlot ++)
+	{
+		if ((CurSlot & 0x07) == 0x07)
+			continue;	// slot numbers 7, 15, 23 and 31 are unused
+		Pitch = BenchRand(BC, 0x400);
+		bench_multipcm_reg(BC, CurSlot, 4, 0x00);	// key off
+		bench_multipcm_reg(BC, CurSlot, 0, 0x00);	// center
+		bench_multipcm_reg(BC, CurSlot, 1, BenchRand(BC, 0x10));	// sample
+		bench_multipcm_reg(BC, CurSlot, 2, (Pitch & 0x3F) << 2);
+		bench_multipcm_reg(BC, CurSlot, 3, (BenchRand(BC, 3) << 4) | (Pitch >> 6));
+		bench_multipcm_reg(BC, CurSlot, 5, 0x20);	// TL
+		bench_multipcm_reg(BC, CurSlot, 4, 0x80);	// key on
+	}
+
+	return;
+}
+
+static void bench_multipcm_setup(BENCH_CHIP* BC)
+{
+	UINT8 Header[0x10 * 12];
+	UINT8* Smpl;
+	UINT32 Start;
+	UINT8 CurSmpl;
+
+	// 16 looping samples, the table overwrites the start of the ROM
+	for (CurSmpl = 0; CurSmpl < 0x10; CurSmpl ++)
+	{
+		Smpl = &Header[CurSmpl * 12];
+		Start = 0x1000 + CurSmpl * 0x10000;
+		Smpl[0] = (Start >> 16) & 0xFF;
+		Smpl[1] = (Start >> 8) & 0xFF;
+		Smpl[2] = (Start >> 0) & 0xFF;
+		Smpl[3] = 0x00;	// loop
+		Smpl[4] = 0x00;
+		Smpl[5] = 0x0F;	// end, stored as 0xFFFF - 0xF000
+		Smpl[6] = 0xFF;
+		Smpl[7] = 0x00;	// LFO/VIB
+		Smpl[8] = 0xF0;	// AR/D1R
+		Smpl[9] = 0x00;	// DL/D2R
+		Smpl[10] = 0x0F;	// KRS/RR
+		Smpl[11] = 0x00;	// AM
+	}
+	multipcm_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, BENCH_ROM_SIZE, BenchROM);
+	multipcm_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, sizeof(Header), Header);
+	bench_multipcm_keyon(BC);
+
+	return;
+}
+
+// --- OKIM6295 ---
+static UINT32 bench_okim6295_start(BENCH_CHIP* BC)
+{
+	return device_start_okim6295(&BC->Chip, 1000000 | 0x80000000);
+}
+
+static void bench_okim6295_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurVoc;
+
+	okim6295_w(BC->Chip, 0x00, 0x78);	// stop all voices
+	for (CurVoc = 0; CurVoc < 4; CurVoc ++)
+	{
+		okim6295_w(BC->Chip, 0x00, 0x80 | (1 + BenchRand(BC, 0x10)));
+		okim6295_w(BC->Chip, 0x00, (0x10 << CurVoc) | 0x00);
+	}
+
+	return;
+}
+
+static void bench_okim6295_setup(BENCH_CHIP* BC)
+{
+	UINT8 Header[0x11 * 8];
+	UINT8* Phrase;
+	UINT32 Start;
+	UINT32 End;
+	UINT8 CurPhr;
+
+	memset(Header, 0x00, sizeof(Header));
+	for (CurPhr = 1; CurPhr <= 0x10; CurPhr ++)
+	{
+		Phrase = &Header[CurPhr * 8];
+		Start = 0x400 + (CurPhr - 1) * 0x3000;
+		End = Start + 0x2FFF;
+		Phrase[0] = (Start >> 16) & 0xFF;
+		Phrase[1] = (Start >> 8) & 0xFF;
+		Phrase[2] = (Start >> 0) & 0xFF;
+		Phrase[3] = (End >> 16) & 0xFF;
+		Phrase[4] = (End >> 8) & 0xFF;
+		Phrase[5] = (End >> 0) & 0xFF;
+	}
+	okim6295_write_rom(BC->Chip, 0x40000, 0x00, 0x40000, BenchROM);
+	okim6295_write_rom(BC->Chip, 0x40000, 0x00, sizeof(Header), Header);
+	bench_okim6295_keyon(BC);
+
+	return;
+}
+
+// --- K051649 (SCC) ---
+static UINT32 bench_k051649_start(BENCH_CHIP* BC)
+{
+	return device_start_k051649(&BC->Chip, 1789772);
+}
+
+static void bench_k051649_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Freq;
+
+	for (CurChn = 0; CurChn < 5; CurChn ++)
+	{
+		Freq = 0x040 + BenchRand(BC, 0x300);
+		bench_port_w(BC, &k051649_w, 1, CurChn * 2 + 0, Freq & 0xFF);
+		bench_port_w(BC, &k051649_w, 1, CurChn * 2 + 1, Freq >> 8);
+		bench_port_w(BC, &k051649_w, 2, CurChn, 0x0F);
+	}
+	bench_port_w(BC, &k051649_w, 3, 0x00, 0x1F);
+
+	return;
+}
+
+static void bench_k051649_setup(BENCH_CHIP* BC)
+{
+	UINT8 CurPos;
+
+	for (CurPos = 0x00; CurPos < 0x80; CurPos ++)
+		bench_port_w(BC, &k051649_w, 0, CurPos, BenchROM[CurPos * 8]);
+	bench_k051649_keyon(BC);
+
+	return;
+}
+
+static void bench_k051649_stream(BENCH_CHIP* BC)
+{
+	bench_port_w(BC, &k051649_w, 2, 0x00, StreamSample(BC) >> 4);
+	return;
+}
+
+// --- K054539 ---
+static UINT32 bench_k054539_start(BENCH_CHIP* BC)
+{
+	UINT32 SmplRate;
+
+	SmplRate = device_start_k054539(&BC->Chip, 18432000);
+	if (SmplRate)
+		k054539_init_flags(BC->Chip, 0x00);
+	return SmplRate;
+}
+
+static void bench_k054539_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT32 Delta;
+	UINT32 Start;
+	UINT16 Base;
+
+	k054539_w(BC->Chip, 0x215, 0xFF);	// key off
+	for (CurChn = 0; CurChn < 8; CurChn ++)
+	{
+		Base = CurChn * 0x20;
+		Delta = 0x4000 + BenchRand(BC, 0x8000);
+		Start = BenchRand(BC, 0x8000) << 4;
+		k054539_w(BC->Chip, Base + 0x00, (Delta >> 0) & 0xFF);
+		k054539_w(BC->Chip, Base + 0x01, (Delta >> 8) & 0xFF);
+		k054539_w(BC->Chip, Base + 0x02, (Delta >> 16) & 0xFF);
+		k054539_w(BC->Chip, Base + 0x03, 0x10);	// volume
+		k054539_w(BC->Chip, Base + 0x04, 0x00);	// reverb volume
+		k054539_w(BC->Chip, Base + 0x05, 0x11 + CurChn);	// pan
+		k054539_w(BC->Chip, Base + 0x08, (Start >> 0) & 0xFF);	// loop
+		k054539_w(BC->Chip, Base + 0x09, (Start >> 8) & 0xFF);
+		k054539_w(BC->Chip, Base + 0x0A, (Start >> 16) & 0xFF);
+		k054539_w(BC->Chip, Base + 0x0C, (Start >> 0) & 0xFF);	// start
+		k054539_w(BC->Chip, Base + 0x0D, (Start >> 8) & 0xFF);
+		k054539_w(BC->Chip, Base + 0x0E, (Start >> 16) & 0xFF);
+		k054539_w(BC->Chip, 0x200 + CurChn * 2, (CurChn & 0x01) << 2);	// 8-bit PCM or 4-bit DPCM
+		k054539_w(BC->Chip, 0x201 + CurChn * 2, 0x01);	// loop
+	}
+	k054539_w(BC->Chip, 0x214, 0xFF);	// key on
+
+	return;
+}
+
+static void bench_k054539_setup(BENCH_CHIP* BC)
+{
+	k054539_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, BENCH_ROM_SIZE, BenchROM);
+	k054539_w(BC->Chip, 0x22F, 0x01);	// sound on
+	bench_k054539_keyon(BC);
+	return;
+}
+
+// --- HuC6280 ---
+static UINT32 bench_c6280_start(BENCH_CHIP* BC)
+{
+	return device_start_c6280(&BC->Chip, BC->Core, 3579545, BENCH_SMPLRATE, 0, BENCH_SMPLRATE);
+}
+
+static void bench_c6280_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Freq;
+
+	for (CurChn = 0; CurChn < 6; CurChn ++)
+	{
+		Freq = 0x080 + BenchRand(BC, 0x300);
+		c6280_w(BC->Chip, 0x00, CurChn);
+		c6280_w(BC->Chip, 0x02, Freq & 0xFF);
+		c6280_w(BC->Chip, 0x03, Freq >> 8);
+		c6280_w(BC->Chip, 0x04, 0x9F);	// channel on, volume 31
+	}
+	// noise on the last two channels
+	c6280_w(BC->Chip, 0x00, 0x04);
+	c6280_w(BC->Chip, 0x07, 0x80 | 0x10);
+	c6280_w(BC->Chip, 0x00, 0x05);
+	c6280_w(BC->Chip, 0x07, 0x80 | 0x18);
+
+	return;
+}
+
+static void bench_c6280_setup(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT8 CurPos;
+
+	c6280_w(BC->Chip, 0x01, 0xFF);	// main volume
+	for (CurChn = 0; CurChn < 6; CurChn ++)
+	{
+		c6280_w(BC->Chip, 0x00, CurChn);
+		c6280_w(BC->Chip, 0x04, 0x40);	// reset the waveform index
+		c6280_w(BC->Chip, 0x04, 0x00);
+		for (CurPos = 0x00; CurPos < 0x20; CurPos ++)
+			c6280_w(BC->Chip, 0x06, BenchROM[CurChn * 0x100 + CurPos * 8] >> 3);
+		c6280_w(BC->Chip, 0x05, 0xFF);	// balance
+	}
+	bench_c6280_keyon(BC);
+
+	return;
+}
+
+static void bench_c6280_stream(BENCH_CHIP* BC)
+{
+	if (! BC->StrmPos)
+	{
+		c6280_w(BC->Chip, 0x00, 0x00);
+		c6280_w(BC->Chip, 0x04, 0xDF);	// DDA mode
+	}
+	c6280_w(BC->Chip, 0x06, StreamSample(BC) >> 3);
+	return;
+}
+
+// --- C140 ---
+static UINT32 bench_c140_start(BENCH_CHIP* BC)
+{
+	return device_start_c140(&BC->Chip, 21390, 0, 0, BENCH_SMPLRATE);
+}
+
+static void bench_c140_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurVoc;
+	UINT16 Base;
+	UINT16 Freq;
+	UINT16 Start;
+
+	for (CurVoc = 0; CurVoc < 24; CurVoc ++)
+	{
+		Base = CurVoc * 0x10;
+		Freq = 0x4000 + BenchRand(BC, 0x8000);
+		Start = BenchRand(BC, 0x8000);
+		c140_w(BC->Chip, Base + 0x05, 0x00);	// key off
+		c140_w(BC->Chip, Base + 0x00, 0x40);	// volume right
+		c140_w(BC->Chip, Base + 0x01, 0x40);	// volume left
+		c140_w(BC->Chip, Base + 0x02, Freq >> 8);
+		c140_w(BC->Chip, Base + 0x03, Freq & 0xFF);
+		c140_w(BC->Chip, Base + 0x04, CurVoc & 0x0F);	// bank
+		c140_w(BC->Chip, Base + 0x06, Start >> 8);
+		c140_w(BC->Chip, Base + 0x07, Start & 0xFF);
+		c140_w(BC->Chip, Base + 0x08, (Start + 0x7000) >> 8);	// end
+		c140_w(BC->Chip, Base + 0x09, (Start + 0x7000) & 0xFF);
+		c140_w(BC->Chip, Base + 0x0A, Start >> 8);	// loop
+		c140_w(BC->Chip, Base + 0x0B, Start & 0xFF);
+		c140_w(BC->Chip, Base + 0x05, 0x80 | 0x10);	// key on, loop
+	}
+
+	return;
+}
+
+static void bench_c140_setup(BENCH_CHIP* BC)
+{
+	c140_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, BENCH_ROM_SIZE, BenchROM);
+	bench_c140_keyon(BC);
+	return;
+}
+
+// --- Pokey ---
+static UINT32 bench_pokey_start(BENCH_CHIP* BC)
+{
+	return device_start_pokey(&BC->Chip, 1789772);
+}
+
+static void bench_pokey_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+
+	for (CurChn = 0; CurChn < 4; CurChn ++)
+	{
+		pokey_w(BC->Chip, CurChn * 2 + 0, 0x20 + BenchRand(BC, 0xC0));	// AUDF
+		pokey_w(BC->Chip, CurChn * 2 + 1, (CurChn & 0x01) ? 0x8A : 0xAA);	// AUDC: noise / pure tone
+	}
+
+	return;
+}
+
+static void bench_pokey_setup(BENCH_CHIP* BC)
+{
+	pokey_w(BC->Chip, 0x0F, 0x03);	// SKCTL
+	pokey_w(BC->Chip, 0x08, 0x00);	// AUDCTL
+	bench_pokey_keyon(BC);
+	return;
+}
+
+static void bench_pokey_stream(BENCH_CHIP* BC)
+{
+	pokey_w(BC->Chip, 0x01, 0x10 | (StreamSample(BC) >> 4));	// volume only
+	return;
+}
+
+// --- QSound ---
+static UINT32 bench_qsound_start(BENCH_CHIP* BC)
+{
+	return device_start_qsound(&BC->Chip, 4000000);
+}
+
+static void bench_qsound_reg(BENCH_CHIP* BC, UINT8 Reg, UINT16 Data)
+{
+	qsound_w(BC->Chip, 0x00, Data >> 8);
+	qsound_w(BC->Chip, 0x01, Data & 0xFF);
+	qsound_w(BC->Chip, 0x02, Reg);
+	return;
+}
+
+static void bench_qsound_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Start;
+
+	for (CurChn = 0; CurChn < 16; CurChn ++)
+	{
+		Start = BenchRand(BC, 0x8000);
+		bench_qsound_reg(BC, CurChn * 8 + 0, CurChn & 0x0F);	// bank
+		bench_qsound_reg(BC, CurChn * 8 + 1, Start);
+		bench_qsound_reg(BC, CurChn * 8 + 2, 0x0800 + BenchRand(BC, 0x1000));	// pitch
+		bench_qsound_reg(BC, CurChn * 8 + 4, 0x4000);	// loop length
+		bench_qsound_reg(BC, CurChn * 8 + 5, Start + 0x6000);	// end
+		bench_qsound_reg(BC, CurChn * 8 + 6, 0x2000);	// volume
+		bench_qsound_reg(BC, 0x80 + CurChn, 0x0110 + CurChn);	// pan
+		bench_qsound_reg(BC, CurChn * 8 + 3, 0x8000);	// key on
+	}
+
+	return;
+}
+
+static void bench_qsound_setup(BENCH_CHIP* BC)
+{
+	qsound_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, BENCH_ROM_SIZE, BenchROM);
+	bench_qsound_keyon(BC);
+	return;
+}
+
+// --- SCSP ---
+static UINT32 bench_scsp_start(BENCH_CHIP* BC)
+{
+	return device_start_scsp(&BC->Chip, 22579200, 0);
+}
+
+static void bench_scsp_reg(BENCH_CHIP* BC, UINT16 Reg, UINT16 Data)
+{
+	// the low byte goes first, key-on is processed with the high byte
+	scsp_w(BC->Chip, Reg | 0x01, Data & 0xFF);
+	scsp_w(BC->Chip, Reg | 0x00, Data >> 8);
+	return;
+}
+
+static void bench_scsp_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurSlot;
+	UINT16 Base;
+	UINT32 Start;
+
+	// KEYONEX only starts slots that were keyed off, so clear all KEYONB bits first
+	for (CurSlot = 0; CurSlot < 32; CurSlot ++)
+		bench_scsp_reg(BC, CurSlot * 0x20 + 0x00, (CurSlot == 31) ? 0x1000 : 0x0000);
+	for (CurSlot = 0; CurSlot < 32; CurSlot ++)
+	{
+		Base = CurSlot * 0x20;
+		Start = BenchRand(BC, 0x8000) << 3;
+		bench_scsp_reg(BC, Base + 0x02, Start & 0xFFFF);	// SA
+		bench_scsp_reg(BC, Base + 0x04, 0x0000);	// LSA
+		bench_scsp_reg(BC, Base + 0x06, 0x8000);	// LEA
+		bench_scsp_reg(BC, Base + 0x08, 0x001F);	// AR
+		bench_scsp_reg(BC, Base + 0x0A, 0x001F);	// RR
+		bench_scsp_reg(BC, Base + 0x0C, 0x0010);	// TL
+		bench_scsp_reg(BC, Base + 0x10, (BenchRand(BC, 4) << 11) | BenchRand(BC, 0x400));	// OCT/FNS
+		bench_scsp_reg(BC, Base + 0x16, 0xE000 | ((CurSlot & 0x1F) << 8));	// DISDL/DIPAN
+		// KEYONB, normal loop, 8/16-bit samples, the last slot sets KEYONEX
+		bench_scsp_reg(BC, Base + 0x00, ((CurSlot == 31) ? 0x1000 : 0x0000) | 0x0800 | 0x0020 |
+				((CurSlot & 0x01) << 4) | (Start >> 16));
+	}
+
+	return;
+}
+
+static void bench_scsp_setup(BENCH_CHIP* BC)
+{
+	scsp_write_ram(BC->Chip, 0x00, 0x80000, BenchROM);
+	bench_scsp_reg(BC, 0x400, 0x000F);	// master volume
+	bench_scsp_keyon(BC);
+	return;
+}
+
+// --- SAA1099 ---
+static UINT32 bench_saa1099_start(BENCH_CHIP* BC)
+{
+	return device_start_saa1099(&BC->Chip, 8000000);
+}
+
+static void bench_saa1099_reg(BENCH_CHIP* BC, UINT8 Reg, UINT8 Data)
+{
+	saa1099_control_w(BC->Chip, 0x00, Reg);
+	saa1099_data_w(BC->Chip, 0x00, Data);
+	return;
+}
+
+static void bench_saa1099_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+
+	for (CurChn = 0; CurChn < 6; CurChn ++)
+	{
+		bench_saa1099_reg(BC, 0x00 + CurChn, 0xFF);	// amplitude
+		bench_saa1099_reg(BC, 0x08 + CurChn, BenchRand(BC, 0x100));	// frequency
+	}
+	for (CurChn = 0; CurChn < 3; CurChn ++)
+		bench_saa1099_reg(BC, 0x10 + CurChn, (BenchRand(BC, 5) << 4) | BenchRand(BC, 5));	// octaves
+	bench_saa1099_reg(BC, 0x14, 0x3F);	// frequency enable
+	bench_saa1099_reg(BC, 0x15, 0x09);	// noise enable
+	bench_saa1099_reg(BC, 0x16, 0x11);	// noise generators
+
+	return;
+}
+
+static void bench_saa1099_setup(BENCH_CHIP* BC)
+{
+	bench_saa1099_reg(BC, 0x1C, 0x01);	// sound on
+	bench_saa1099_keyon(BC);
+	return;
+}
+
+static void bench_saa1099_stream(BENCH_CHIP* BC)
+{
+	UINT8 Data;
+
+	Data = StreamSample(BC) >> 4;
+	bench_saa1099_reg(BC, 0x00, (Data << 4) | Data);
+	return;
+}
+
+// --- C352 ---
+static UINT32 bench_c352_start(BENCH_CHIP* BC)
+{
+	return device_start_c352(&BC->Chip, 24192000, 288);
+}
+
+static void bench_c352_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurVoc;
+	UINT16 Base;
+	UINT16 Start;
+
+	for (CurVoc = 0; CurVoc < 32; CurVoc ++)
+	{
+		Base = CurVoc * 8;
+		Start = BenchRand(BC, 0x8000);
+		c352_w(BC->Chip, Base + 0, 0x8080);	// front volume
+		c352_w(BC->Chip, Base + 1, 0x4040);	// rear volume
+		c352_w(BC->Chip, Base + 2, 0x0800 + BenchRand(BC, 0x1000));	// frequency
+		c352_w(BC->Chip, Base + 4, CurVoc & 0x0F);	// bank
+		c352_w(BC->Chip, Base + 5, Start);
+		c352_w(BC->Chip, Base + 6, Start + 0x6000);	// end
+		c352_w(BC->Chip, Base + 7, Start);	// loop
+		c352_w(BC->Chip, Base + 3, 0x4000 | 0x0002 | ((CurVoc & 0x01) << 3));	// key on, loop, mu-law
+	}
+	c352_w(BC->Chip, 0x202, 0x0020);	// execute key-ons
+
+	return;
+}
+
+static void bench_c352_setup(BENCH_CHIP* BC)
+{
+	c352_write_rom(BC->Chip, BENCH_ROM_SIZE, 0x00, BENCH_ROM_SIZE, BenchROM);
+	bench_c352_keyon(BC);
+	return;
+}
+
+// --- SegaPCM ---
+static UINT32 bench_segapcm_start(BENCH_CHIP* BC)
+{
+	return device_start_segapcm(&BC->Chip, 4000000, 0);
+}
+
+static void bench_segapcm_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Base;
+	UINT8 Start;
+
+	for (CurChn = 0; CurChn < 16; CurChn ++)
+	{
+		Base = CurChn * 8;
+		Start = BenchRand(BC, 0x80);
+		sega_pcm_w(BC->Chip, 0x86 + Base, 0x01);	// channel off
+		sega_pcm_w(BC->Chip, 0x02 + Base, 0x40);	// volume left
+		sega_pcm_w(BC->Chip, 0x03 + Base, 0x40);	// volume right
+		sega_pcm_w(BC->Chip, 0x04 + Base, 0x00);	// start
+		sega_pcm_w(BC->Chip, 0x05 + Base, Start);
+		sega_pcm_w(BC->Chip, 0x84 + Base, 0x00);	// loop
+		sega_pcm_w(BC->Chip, 0x85 + Base, Start);
+		sega_pcm_w(BC->Chip, 0x06 + Base, Start + 0x40);	// end
+		sega_pcm_w(BC->Chip, 0x07 + Base, 0x40 + BenchRand(BC, 0x80));	// delta
+		sega_pcm_w(BC->Chip, 0x86 + Base, 0x00);	// channel on, loop
+	}
+
+	return;
+}
+
+static void bench_segapcm_setup(BENCH_CHIP* BC)
+{
+	sega_pcm_write_rom(BC->Chip, 0x200000, 0x00, BENCH_ROM_SIZE, BenchROM);
+	bench_segapcm_keyon(BC);
+	return;
+}
+
+// --- RF5C68 ---
+static UINT32 bench_rf5c68_start(BENCH_CHIP* BC)
+{
+	return device_start_rf5c68(&BC->Chip, 12500000);
+}
+
+static void bench_rf5c68_keyon(BENCH_CHIP* BC)
+{
+	UINT8 CurChn;
+	UINT16 Step;
+
+	rf5c68_w(BC->Chip, 0x08, 0xFF);	// all channels off
+	for (CurChn = 0; CurChn < 8; CurChn ++)
+	{
+		Step = 0x0400 + BenchRand(BC, 0x0800);
+		rf5c68_w(BC->Chip, 0x07, 0xC0 | CurChn);
+		rf5c68_w(BC->Chip, 0x00, 0xFF);	// envelope
+		rf5c68_w(BC->Chip, 0x01, 0x88);	// pan
+		rf5c68_w(BC->Chip, 0x02, Step & 0xFF);
+		rf5c68_w(BC->Chip, 0x03, Step >> 8);
+		rf5c68_w(BC->Chip, 0x04, 0x00);	// loop start
+		rf5c68_w(BC->Chip, 0x05, CurChn << 5);
+		rf5c68_w(BC->Chip, 0x06, CurChn << 5);	// start
+	}
+	rf5c68_w(BC->Chip, 0x08, 0x00);	// all channels on
+
+	return;
+}
+
+static void bench_rf5c68_setup(BENCH_CHIP* BC)
+{
+	UINT8 CurBank;
+
+	for (CurBank = 0; CurBank < 0x10; CurBank ++)
+	{
+		rf5c68_w(BC->Chip, 0x07, 0x80 | CurBank);	// select the memory bank
+		rf5c68_write_ram(BC->Chip, 0x0000, 0x1000, &BenchROM[CurBank * 0x1000]);
+	}
+	bench_rf5c68_keyon(BC);
+
+	return;
+}
+
+static void bench_rf5c68_stream(BENCH_CHIP* BC)
+{
+	// the sound driver streams into the wave memory of the last bank
+	rf5c68_mem_w(BC->Chip, BC->StrmPos & 0x0FFF, StreamSample(BC));
+	return;
+}
+
+
+static const BENCH_DEF BENCH_CHIPS[] =
+{
+	{"SN76496", {"MAME", "Maxim"}, &bench_sn_start, &device_stop_sn764xx, &device_reset_sn764xx,
+		&sn764xx_stream_update, &bench_sn_keyon, &bench_sn_keyon, &bench_sn_stream},
+	{"YM2413", {"EMU2413", "MAME", "Nuked"}, &bench_ym2413_start, &device_stop_ym2413, &device_reset_ym2413,
+		&ym2413_stream_update, &bench_ym2413_keyon, &bench_ym2413_keyon, NULL},
+	{"YM2612", {"MAME", "Gens", "Nuked"}, &bench_ym2612_start, &device_stop_ym2612, &device_reset_ym2612,
+		&ym2612_stream_update, &bench_ym2612_setup, &bench_ym2612_keyon, &bench_ym2612_stream},
+	{"YM2151", {"MAME"}, &bench_ym2151_start, &device_stop_ym2151, &device_reset_ym2151,
+		&ym2151_update, &bench_ym2151_setup, &bench_ym2151_keyon, NULL},
+	{"YM2203", {"MAME"}, &bench_ym2203_start, &device_stop_ym2203, &device_reset_ym2203,
+		&ym2203_stream_update, &bench_ym2203_setup, &bench_ym2203_keyon, NULL},
+	{"YM2608", {"MAME"}, &bench_ym2608_start, &device_stop_ym2608, &device_reset_ym2608,
+		&ym2608_stream_update, &bench_ym2608_setup, &bench_ym2608_keyon, NULL},
+	{"YM2610", {"MAME"}, &bench_ym2610_start, &device_stop_ym2610, &device_reset_ym2610,
+		&ym2610_stream_update, &bench_ym2610_setup, &bench_ym2610_keyon, NULL},
+	{"YM3812", {"DOSBox", "MAME"}, &bench_ym3812_start, &device_stop_ym3812, &device_reset_ym3812,
+		&ym3812_stream_update, &bench_ym3812_setup, &bench_ym3812_keyon, NULL},
+	{"YMF262", {"DOSBox", "MAME"}, &bench_ymf262_start, &device_stop_ymf262, &device_reset_ymf262,
+		&ymf262_stream_update, &bench_ymf262_setup, &bench_ymf262_keyon, NULL},
+	{"YMF278B", {"MAME"}, &bench_ymf278b_start, &device_stop_ymf278b, &device_reset_ymf278b,
+		&ymf278b_pcm_update, &bench_ymf278b_setup, &bench_ymf278b_keyon, NULL},
+	{"YMZ280B", {"MAME"}, &bench_ymz280b_start, &device_stop_ymz280b, &device_reset_ymz280b,
+		&ymz280b_update, &bench_ymz280b_setup, &bench_ymz280b_keyon, NULL},
+	{"AY8910", {"EMU2149", "MAME"}, &bench_ay8910_start, &device_stop_ayxx, &device_reset_ayxx,
+		&ayxx_stream_update, &bench_ay8910_keyon, &bench_ay8910_keyon, &bench_ay8910_stream},
+	{"GameBoy", {"MAME"}, &bench_gb_start, &device_stop_gameboy_sound, &device_reset_gameboy_sound,
+		&gameboy_update, &bench_gb_setup, &bench_gb_keyon, NULL},
+	{"NES APU", {"NSFPlay", "MAME"}, &bench_nes_start, &device_stop_nes, &device_reset_nes,
+		&nes_stream_update, &bench_nes_setup, &bench_nes_keyon, &bench_nes_stream},
+	{"MultiPCM", {"MAME"}, &bench_multipcm_start, &device_stop_multipcm, &device_reset_multipcm,
+		&MultiPCM_update, &bench_multipcm_setup, &bench_multipcm_keyon, NULL},
+	{"OKIM6295", {"MAME"}, &bench_okim6295_start, &device_stop_okim6295, &device_reset_okim6295,
+		&okim6295_update, &bench_okim6295_setup, &bench_okim6295_keyon, NULL},
+	{"K051649", {"MAME"}, &bench_k051649_start, &device_stop_k051649, &device_reset_k051649,
+		&k051649_update, &bench_k051649_setup, &bench_k051649_keyon, &bench_k051649_stream},
+	{"K054539", {"MAME"}, &bench_k054539_start, &device_stop_k054539, &device_reset_k054539,
+		&k054539_update, &bench_k054539_setup, &bench_k054539_keyon, NULL},
+	{"HuC6280", {"Ootake", "MAME"}, &bench_c6280_start, &device_stop_c6280, &device_reset_c6280,
+		&c6280_update, &bench_c6280_setup, &bench_c6280_keyon, &bench_c6280_stream},
+	{"C140", {"MAME"}, &bench_c140_start, &device_stop_c140, &device_reset_c140,
+		&c140_update, &bench_c140_setup, &bench_c140_keyon, NULL},
+	{"Pokey", {"MAME"}, &bench_pokey_start, &device_stop_pokey, &device_reset_pokey,
+		&pokey_update, &bench_pokey_setup, &bench_pokey_keyon, &bench_pokey_stream},
+	{"QSound", {"MAME"}, &bench_qsound_start, &device_stop_qsound, &device_reset_qsound,
+		&qsound_update, &bench_qsound_setup, &bench_qsound_keyon, NULL},
+	{"SCSP", {"yam"}, &bench_scsp_start, &device_stop_scsp, &device_reset_scsp,
+		&SCSP_Update, &bench_scsp_setup, &bench_scsp_keyon, NULL},
+	{"SAA1099", {"MAME"}, &bench_saa1099_start, &device_stop_saa1099, &device_reset_saa1099,
+		&saa1099_update, &bench_saa1099_setup, &bench_saa1099_keyon, &bench_saa1099_stream},
+	{"C352", {"MAME"}, &bench_c352_start, &device_stop_c352, &device_reset_c352,
+		&c352_update, &bench_c352_setup, &bench_c352_keyon, NULL},
+	{"SegaPCM", {"MAME"}, &bench_segapcm_start, &device_stop_segapcm, &device_reset_segapcm,
+		&SEGAPCM_update, &bench_segapcm_setup, &bench_segapcm_keyon, NULL},
+	{"RF5C68", {"MAME"}, &bench_rf5c68_start, &device_stop_rf5c68, &device_reset_rf5c68,
+		&rf5c68_update, &bench_rf5c68_setup, &bench_rf5c68_keyon, &bench_rf5c68_stream},
+	{NULL}
+};
+
+
+static void RenderBlocks(const BENCH_DEF* Def, BENCH_CHIP* BC, UINT8 Scenario, UINT32 Samples)
+{
+	UINT32 SmplPos;
+	UINT32 BlkLen;
+	UINT32 CurSmpl;
+
+	for (SmplPos = 0; SmplPos < Samples; SmplPos += BlkLen)
+	{
+		BlkLen = Samples - SmplPos;
+		if (BlkLen > BlockSize)
+			BlkLen = BlockSize;
+
+		switch(Scenario)
+		{
+		case SCN_KEYON:
+			Def->KeyOn(BC);
+			Def->Update(BC->Chip, StreamBufs, BlkLen);
+			break;
+		case SCN_STREAM:
+			// VGMPlay renders up to every write, so a stream of writes means single-sample updates
+			for (CurSmpl = 0; CurSmpl < BlkLen; CurSmpl ++)
+			{
+				Def->Stream(BC);
+				Def->Update(BC->Chip, StreamBufs, 1);
+			}
+			break;
+		default:
+			Def->Update(BC->Chip, StreamBufs, BlkLen);
+			break;
+		}
+	}
+
+	return;
+}
+
+static bool BenchRun(const BENCH_DEF* Def, UINT8 Core, UINT8 Scenario, BENCH_RESULT* Result)
+{
+	BENCH_CHIP BC;
+	UINT32 SmplRate;
+	UINT32 Samples;
+	double StartTime;
+	UINT64 StartCycles;
+
+	memset(&BC, 0x00, sizeof(BENCH_CHIP));
+	BC.Core = Core;
+	BC.Seed = 0x5EED;
+	SmplRate = Def->Start(&BC);
+	if (! SmplRate || BC.Chip == NULL)
+		return false;
+	Def->Reset(BC.Chip);
+	Def->Setup(&BC);
+
+	Samples = (UINT32)(SmplRate * BenchSecs + 0.5);
+	if (! Samples)
+		Samples = 1;
+	// warm up the caches and lazily built tables
+	RenderBlocks(Def, &BC, Scenario, SmplRate / 10);
+
+	StartCycles = GetCycles();
+	StartTime = GetTime();
+	RenderBlocks(Def, &BC, Scenario, Samples);
+	Result->Time = GetTime() - StartTime;
+#ifdef BENCH_HAS_TSC
+	Result->Cycles = (double)(GetCycles() - StartCycles);
+#else
+	Result->Cycles = -1.0;
+#endif
+
+	Def->Stop(BC.Chip);
+
+	Result->Chip = Def->Name;
+	Result->Core = Def->Cores[Core];
+	Result->CoreID = Core;
+	Result->Scenario = Scenario;
+	Result->SmplRate = SmplRate;
+	Result->Samples = Samples;
+	return true;
+}
+
+static void PrintResultHeader(FILE* hFile)
+{
+	fprintf(hFile, "%-9s %-8s %-7s %6s %10s %12s %10s %10s\n",
+			"chip", "core", "test", "rate", "ns/smpl", "smpl/s", "cyc/smpl", "x realtime");
+	return;
+}
+
+static void PrintResult(FILE* hFile, const BENCH_RESULT* Res)
+{
+	char CycStr[0x20];
+
+	if (Res->Cycles >= 0.0)
+		sprintf(CycStr, "%.1f", Res->Cycles / Res->Samples);
+	else
+		strcpy(CycStr, "-");
+	fprintf(hFile, "%-9s %-8s %-7s %6u %10.1f %12.0f %10s %10.1f\n",
+			Res->Chip, Res->Core, SCN_NAMES[Res->Scenario], Res->SmplRate,
+			Res->Time * 1000000000.0 / Res->Samples, Res->Samples / Res->Time, CycStr,
+			Res->Samples / Res->Time / Res->SmplRate);
+	fflush(hFile);
+	return;
+}
+
+static void WriteJSON(FILE* hFile)
+{
+	const BENCH_RESULT* Res;
+	UINT32 CurRes;
+
+	fprintf(hFile, "{\n");
+	fprintf(hFile, "  \"seconds\": %g,\n  \"runs\": %u,\n  \"block\": %u,\n", BenchSecs, BenchRuns, BlockSize);
+	fprintf(hFile, "  \"results\": [\n");
+	for (CurRes = 0; CurRes < ResultCount; CurRes ++)
+	{
+		Res = &Results[CurRes];
+		fprintf(hFile, "    {\"chip\": \"%s\", \"core\": \"%s\", \"scenario\": \"%s\", "
+				"\"sample_rate\": %u, \"samples\": %u, ",
+				Res->Chip, Res->Core, SCN_NAMES[Res->Scenario], Res->SmplRate, Res->Samples);
+		fprintf(hFile, "\"ns_per_sample\": %.3f, \"samples_per_sec\": %.1f, ",
+				Res->Time * 1000000000.0 / Res->Samples, Res->Samples / Res->Time);
+		if (Res->Cycles >= 0.0)
+			fprintf(hFile, "\"cycles_per_sample\": %.2f, ", Res->Cycles / Res->Samples);
+		else
+			fprintf(hFile, "\"cycles_per_sample\": null, ");
+		fprintf(hFile, "\"realtime_factor\": %.2f}%s\n", Res->Samples / Res->Time / Res->SmplRate,
+				(CurRes + 1 < ResultCount) ? "," : "");
+	}
+	fprintf(hFile, "  ]\n}\n");
+
+	return;
+}
+
+static void WriteProfile(FILE* hFile)
+{
+	// The core profile for the player's render budget (see LoadCoreProfile):
+	// the share of real time a core needs, taken from its slowest scenario.
+	const BENCH_RESULT* Res;
+	UINT32 CurRes;
+	UINT32 ScnRes;
+	double Load;
+	double MaxLoad;
+
+	fprintf(hFile, "# VGMPlay core profile, written by vgmbench\n");
+	fprintf(hFile, "# chip<TAB>core<TAB>load (share of real time, slowest scenario)\n");
+	for (CurRes = 0; CurRes < ResultCount; CurRes ++)
+	{
+		Res = &Results[CurRes];
+		if (CurRes > 0 && Res[-1].Chip == Res->Chip && Res[-1].CoreID == Res->CoreID)
+			continue;	// the scenarios of a core follow each other
+
+		MaxLoad = 0.0;
+		for (ScnRes = CurRes; ScnRes < ResultCount; ScnRes ++)
+		{
+			if (Results[ScnRes].Chip != Res->Chip || Results[ScnRes].CoreID != Res->CoreID)
+				break;
+			Load = Results[ScnRes].Time * Results[ScnRes].SmplRate / Results[ScnRes].Samples;
+			if (Load > MaxLoad)
+				MaxLoad = Load;
+		}
+		fprintf(hFile, "%s\t%u\t%.6f\n", Res->Chip, Res->CoreID, MaxLoad);
+	}
+
+	return;
+}
+
+static void ListChips(void)
+{
+	const BENCH_DEF* Def;
+	UINT8 CurCore;
+
+	for (Def = BENCH_CHIPS; Def->Name != NULL; Def ++)
+	{
+		printf("%-9s", Def->Name);
+		for (CurCore = 0; CurCore < 3 && Def->Cores[CurCore] != NULL; CurCore ++)
+			printf(" %u=%s", CurCore, Def->Cores[CurCore]);
+		printf("%s\n", (Def->Stream != NULL) ? "  (stream)" : "");
+	}
+
+	return;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n"
+		"Runs every sound core with synthetic register traffic and reports its speed.\n", name);
+#ifdef VGMBENCH_HAS_GETOPT
+	fputs("\n"
+		"Options:\n"
+		"--chip {name}        (default: all chips, see --list)\n"
+		"--core {number}      (default: all cores)\n"
+		"--scenario {voices|keyon|stream|all}  (default: all)\n"
+		"--seconds {number}   audio time per run (default: 5)\n"
+		"--runs {number}      the best run counts (default: 3)\n"
+		"--block {samples}    samples per update call (default: 256)\n"
+		"--json {file|-}      write the results as JSON\n"
+		"--profile {file}     write the core profile for the player's RenderBudget\n"
+		"--list\n"
+		"\n", stderr);
+#else
+	fputs("Options not supported in this build (compiled without getopt.)\n", stderr);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	const BENCH_DEF* Def;
+	const char* ChipName;
+	const char* JSONFile;
+	const char* ProfileFile;
+	FILE* hTable;
+	FILE* hJSON;
+	FILE* hProfile;
+	INT32 CoreSel;
+	INT32 ScnSel;
+	UINT8 CurCore;
+	UINT8 CurScn;
+	UINT32 CurRun;
+	BENCH_RESULT BestRes;
+	BENCH_RESULT RunRes;
+	int c;
+
+	ChipName = NULL;
+	JSONFile = NULL;
+	ProfileFile = NULL;
+	memset(&BestRes, 0x00, sizeof(BENCH_RESULT));
+	CoreSel = -1;
+	ScnSel = -1;
+
+	// Parse command line arguments
+#ifdef VGMBENCH_HAS_GETOPT
+	static struct option long_options[] = {
+		{ "chip", required_argument, NULL, 'c' },
+		{ "core", required_argument, NULL, 'e' },
+		{ "scenario", required_argument, NULL, 's' },
+		{ "seconds", required_argument, NULL, 't' },
+		{ "runs", required_argument, NULL, 'r' },
+		{ "block", required_argument, NULL, 'b' },
+		{ "json", required_argument, NULL, 'j' },
+		{ "profile", required_argument, NULL, 'p' },
+		{ "list", no_argument, NULL, 'l' },
+		{ "help", no_argument, NULL, '?' },
+		{ NULL, 0, NULL, 0 }
+	};
+	while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+		switch (c) {
+		case 'c':
+			ChipName = optarg;
+			break;
+		case 'e':
+			CoreSel = atoi(optarg);
+			break;
+		case 's':
+			if (! strcasecmp(optarg, "all")) {
+				ScnSel = -1;
+			} else {
+				for (ScnSel = 0; ScnSel < SCN_COUNT; ScnSel ++) {
+					if (! strcasecmp(optarg, SCN_NAMES[ScnSel]))
+						break;
+				}
+				if (ScnSel >= SCN_COUNT) {
+					fprintf(stderr, "Error: unknown scenario %s.\n", optarg);
+					usage(argv[0]);
+					return 1;
+				}
+			}
+			break;
+		case 't':
+			BenchSecs = atof(optarg);
+			if (BenchSecs <= 0.0) {
+				fputs("Error: the time must be positive.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'r':
+			c = atoi(optarg);
+			if (c <= 0) {
+				fputs("Error: run count must be at least 1.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			BenchRuns = c;
+			break;
+		case 'b':
+			c = atoi(optarg);
+			if (c <= 0 || c > MAX_BLOCK) {
+				fprintf(stderr, "Error: block size must be 1..%u.\n", MAX_BLOCK);
+				usage(argv[0]);
+				return 1;
+			}
+			BlockSize = c;
+			break;
+		case 'j':
+			JSONFile = optarg;
+			break;
+		case 'p':
+			ProfileFile = optarg;
+			break;
+		case 'l':
+			ListChips();
+			return 0;
+		case '?':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+#endif
+
+	if (ChipName != NULL)
+	{
+		for (Def = BENCH_CHIPS; Def->Name != NULL; Def ++)
+		{
+			if (! strcasecmp(Def->Name, ChipName))
+				break;
+		}
+		if (Def->Name == NULL)
+		{
+			fprintf(stderr, "vgmbench: unknown chip %s (see --list)\n", ChipName);
+			return 1;
+		}
+	}
+
+	MakeBenchROM();
+	for (c = 0; c < OUT_PAIRS_MAX * 2; c ++)
+		StreamBufs[c] = (stream_sample_t*)calloc(MAX_BLOCK, sizeof(stream_sample_t));
+
+	// the table goes to stderr when the JSON goes to stdout
+	hTable = (JSONFile != NULL && ! strcmp(JSONFile, "-")) ? stderr : stdout;
+	PrintResultHeader(hTable);
+	for (Def = BENCH_CHIPS; Def->Name != NULL; Def ++)
+	{
+		if (ChipName != NULL && strcasecmp(Def->Name, ChipName))
+			continue;
+		for (CurCore = 0; CurCore < 3 && Def->Cores[CurCore] != NULL; CurCore ++)
+		{
+			if (CoreSel >= 0 && CurCore != CoreSel)
+				continue;
+			for (CurScn = 0; CurScn < SCN_COUNT; CurScn ++)
+			{
+				if (ScnSel >= 0 && CurScn != ScnSel)
+					continue;
+				if (CurScn == SCN_STREAM && Def->Stream == NULL)
+					continue;
+				if (ResultCount >= MAX_RESULTS)
+					break;
+
+				for (CurRun = 0; CurRun < BenchRuns; CurRun ++)
+				{
+					if (! BenchRun(Def, CurCore, CurScn, &RunRes))
+						break;
+					if (! CurRun || RunRes.Time < BestRes.Time)
+						BestRes = RunRes;
+				}
+				if (CurRun < BenchRuns)
+				{
+					fprintf(stderr, "vgmbench: failed to start %s (%s)\n", Def->Name, Def->Cores[CurCore]);
+					break;
+				}
+				PrintResult(hTable, &BestRes);
+				Results[ResultCount] = BestRes;
+				ResultCount ++;
+			}
+		}
+	}
+
+	if (JSONFile != NULL)
+	{
+		hJSON = strcmp(JSONFile, "-") ? fopen(JSONFile, "wt") : stdout;
+		if (hJSON == NULL)
+		{
+			fprintf(stderr, "vgmbench: error: can't write %s\n", JSONFile);
+		}
+		else
+		{
+			WriteJSON(hJSON);
+			if (hJSON != stdout)
+				fclose(hJSON);
+		}
+	}
+
+	if (ProfileFile != NULL)
+	{
+		hProfile = fopen(ProfileFile, "wt");
+		if (hProfile == NULL)
+		{
+			fprintf(stderr, "vgmbench: error: can't write %s\n", ProfileFile);
+		}
+		else
+		{
+			WriteProfile(hProfile);
+			fclose(hProfile);
+		}
+	}
+
+	for (c = 0; c < OUT_PAIRS_MAX * 2; c ++)
+		free(StreamBufs[c]);
+	free(BenchROM);
+
+	return 0;
+}
@@ -0,0 +1,880 @@
+/*
+ *  This file is part of VGMPlay <https://github.com/vgmrips/vgmplay>
+ *
+ *  vgmperf - measures how fast whole VGMs render and checks the output against known hashes
+ *  Every file runs through OpenVGMFile, PlayVGM and FillBuffer, like in vgm2wav.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>
+#define PSAPI_VERSION	2	// GetProcessMemoryInfo from kernel32, no psapi.lib needed
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+#ifndef _MSC_VER
+// This turns command line options on (using getopt.h) unless you are using MSVC / Visual Studio, which doesn't have it.
+#define VGMPERF_HAS_GETOPT
+#include <getopt.h>
+#endif
+
+#ifdef _MSC_VER
+#define strcasecmp	_stricmp
+#define strncasecmp	_strnicmp
+#endif
+
+#include "chips/mamedef.h"
+#include "stdbool.h"
+#include "VGMPlay.h"
+
+#ifdef WIN32
+#define DIR_SEP		'\\'
+#else
+#define DIR_SEP		'/'
+#endif
+
+#define FNV_OFFSET	0xCBF29CE484222325ULL
+#define FNV_PRIME	0x00000100000001B3ULL
+
+#define HASH_NONE		0x00	// no golden hash list
+#define HASH_OK			0x01
+#define HASH_MISMATCH	0x02
+#define HASH_NEW		0x03	// not in the golden hash list
+
+typedef struct perf_file
+{
+	char* FileName;
+
+	bool Failed;
+	bool Unstable;		// the runs didn't render the same samples
+	bool Silent;		// the output was all zeros or no chip rendered a sample
+	UINT8 HashState;
+	UINT32 Samples;
+	UINT64 Hash;
+	double OpenTime;	// OpenVGMFile and PlayVGM
+	double RenderTime;	// FillBuffer calls of the fastest run
+	RENDER_PROFILE Profile;	// of the fastest run
+} PERF_FILE;
+
+typedef struct golden_hash
+{
+	char* FileName;
+	UINT32 Samples;
+	UINT64 Hash;
+} GOLDEN_HASH;
+
+UINT8 CmdList[0x100]; // used by VGMPlay.c and VGMPlay_AddFmts.c
+bool ErrorHappened;   // used by VGMPlay.c and VGMPlay_AddFmts.c
+
+static PERF_FILE* Files = NULL;
+static UINT32 FileCount = 0;
+static UINT32 FileAlloc = 0;
+
+static GOLDEN_HASH* Golden = NULL;
+static UINT32 GoldenCount = 0;
+
+static UINT32 PerfRuns = 1;
+static bool Profiling = true;
+static bool HashOutput = false;
+static bool HashCheck = false;	// calculate the hashes (--hash or --golden)
+
+static double GetTime(void)
+{
+#ifdef WIN32
+	LARGE_INTEGER Freq;
+	LARGE_INTEGER Count;
+
+	QueryPerformanceFrequency(&Freq);
+	QueryPerformanceCounter(&Count);
+	return (double)Count.QuadPart / (double)Freq.QuadPart;
+#else
+	struct timespec TS;
+
+	clock_gettime(CLOCK_MONOTONIC, &TS);
+	return TS.tv_sec + TS.tv_nsec / 1000000000.0;
+#endif
+}
+
+static UINT32 GetPeakMemory(void)
+{
+	// peak resident memory of the process in KB
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS MemInfo;
+
+	if (! GetProcessMemoryInfo(GetCurrentProcess(), &MemInfo, sizeof(MemInfo)))
+		return 0;
+	return (UINT32)(MemInfo.PeakWorkingSetSize / 1024);
+#else
+	struct rusage Usage;
+
+	if (getrusage(RUSAGE_SELF, &Usage))
+		return 0;
+#ifdef __APPLE__
+	return (UINT32)(Usage.ru_maxrss / 1024);	// bytes
+#else
+	return (UINT32)Usage.ru_maxrss;
+#endif
+#endif
+}
+
+static char* StrDupLen(const char* Str, size_t Len)
+{
+	char* RetStr;
+
+	RetStr = (char*)malloc(Len + 1);
+	memcpy(RetStr, Str, Len);
+	RetStr[Len] = '\0';
+	return RetStr;
+}
+
+static const char* GetFileTitle(const char* FilePath)
+{
+	const char* TempPnt;
+
+	TempPnt = strrchr(FilePath, '/');
+#ifdef WIN32
+	if (TempPnt == NULL || strrchr(FilePath, '\\') > TempPnt)
+		TempPnt = strrchr(FilePath, '\\');
+#endif
+	return (TempPnt == NULL) ? FilePath : TempPnt + 1;
+}
+
+static const char* GetFileExtention(const char* FilePath)
+{
+	const char* TempPnt;
+
+	TempPnt = strrchr(GetFileTitle(FilePath), '.');
+	return (TempPnt == NULL) ? "" : TempPnt + 1;
+}
+
+static char* CombinePath(const char* BasePath, size_t BaseLen, const char* FileName)
+{
+	char* RetStr;
+
+	RetStr = (char*)malloc(BaseLen + 1 + strlen(FileName) + 1);
+	memcpy(RetStr, BasePath, BaseLen);
+	if (BaseLen && BasePath[BaseLen - 1] != '/' && BasePath[BaseLen - 1] != DIR_SEP)
+		RetStr[BaseLen ++] = DIR_SEP;
+	strcpy(RetStr + BaseLen, FileName);
+	return RetStr;
+}
+
+static bool IsVGMFile(const char* FileName)
+{
+	const char* Ext;
+
+	Ext = GetFileExtention(FileName);
+	return ! strcasecmp(Ext, "vgm") || ! strcasecmp(Ext, "vgz");
+}
+
+static void AddFile(const char* FileName)
+{
+	PERF_FILE* File;
+
+	if (FileCount >= FileAlloc)
+	{
+		FileAlloc = FileAlloc ? (FileAlloc * 2) : 0x100;
+		Files = (PERF_FILE*)realloc(Files, FileAlloc * sizeof(PERF_FILE));
+	}
+	File = &Files[FileCount];
+	memset(File, 0x00, sizeof(PERF_FILE));
+	File->FileName = StrDupLen(FileName, strlen(FileName));
+	FileCount ++;
+
+	return;
+}
+
+static int FileCompare(const void* A, const void* B)
+{
+	return strcmp(((const PERF_FILE*)A)->FileName, ((const PERF_FILE*)B)->FileName);
+}
+
+static bool AddDirectory(const char* DirName)
+{
+	char* FilePath;
+	UINT32 FirstFile;
+#ifdef WIN32
+	WIN32_FIND_DATAA FindData;
+	HANDLE hFind;
+
+	FirstFile = FileCount;
+	FilePath = CombinePath(DirName, strlen(DirName), "*");
+	hFind = FindFirstFileA(FilePath, &FindData);
+	free(FilePath);
+	if (hFind == INVALID_HANDLE_VALUE)
+		return false;
+	do
+	{
+		if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			continue;
+		if (! IsVGMFile(FindData.cFileName))
+			continue;
+		FilePath = CombinePath(DirName, strlen(DirName), FindData.cFileName);
+		AddFile(FilePath);
+		free(FilePath);
+	} while(FindNextFileA(hFind, &FindData));
+	FindClose(hFind);
+#else
+	DIR* hDir;
+	struct dirent* Entry;
+	struct stat FileStat;
+
+	FirstFile = FileCount;
+	hDir = opendir(DirName);
+	if (hDir == NULL)
+		return false;
+	while((Entry = readdir(hDir)) != NULL)
+	{
+		if (! IsVGMFile(Entry->d_name))
+			continue;
+		FilePath = CombinePath(DirName, strlen(DirName), Entry->d_name);
+		if (! stat(FilePath, &FileStat) && S_ISREG(FileStat.st_mode))
+			AddFile(FilePath);
+		free(FilePath);
+	}
+	closedir(hDir);
+#endif
+
+	// the directory order is random, but the reports should be comparable
+	qsort(&Files[FirstFile], FileCount - FirstFile, sizeof(PERF_FILE), &FileCompare);
+	return true;
+}
+
+static bool AddInput(const char* Input)
+{
+#ifdef WIN32
+	DWORD Attr;
+
+	Attr = GetFileAttributesA(Input);
+	if (Attr != INVALID_FILE_ATTRIBUTES && (Attr & FILE_ATTRIBUTE_DIRECTORY))
+		return AddDirectory(Input);
+#else
+	struct stat FileStat;
+
+	if (! stat(Input, &FileStat) && S_ISDIR(FileStat.st_mode))
+		return AddDirectory(Input);
+#endif
+
+	AddFile(Input);
+	return true;
+}
+
+static bool LoadGoldenHashes(const char* ListName)
+{
+	// one file per line, as written by --hash: hash samples file_name
+	FILE* hFile;
+	char Line[0x400];
+	size_t LineLen;
+	unsigned long long Hash;
+	unsigned int Samples;
+	int NamePos;
+	UINT32 Alloc;
+
+	hFile = fopen(ListName, "rt");
+	if (hFile == NULL)
+		return false;
+
+	Alloc = 0;
+	while(fgets(Line, sizeof(Line), hFile) != NULL)
+	{
+		LineLen = strlen(Line);
+		while(LineLen && (Line[LineLen - 1] == '\n' || Line[LineLen - 1] == '\r'))
+			LineLen --;
+		Line[LineLen] = '\0';
+		if (Line[0] == '\0' || Line[0] == '#')
+			continue;
+		if (sscanf(Line, "%llx %u %n", &Hash, &Samples, &NamePos) < 2 || Line[NamePos] == '\0')
+			continue;
+
+		if (GoldenCount >= Alloc)
+		{
+			Alloc = Alloc ? (Alloc * 2) : 0x100;
+			Golden = (GOLDEN_HASH*)realloc(Golden, Alloc * sizeof(GOLDEN_HASH));
+		}
+		Golden[GoldenCount].FileName = StrDupLen(&Line[NamePos], strlen(&Line[NamePos]));
+		Golden[GoldenCount].Samples = Samples;
+		Golden[GoldenCount].Hash = Hash;
+		GoldenCount ++;
+	}
+
+	fclose(hFile);
+	return true;
+}
+
+static bool SetChipMute(VGM_PLAYER* p, const char* MuteStr)
+{
+	// chip_name:mask, the mask goes to both chips of the type
+	const char* SepPos;
+	char* EndPtr;
+	UINT32 MuteMask;
+	UINT8 CurChip;
+	UINT8 CurCSet;
+	CHIP_OPTS* TempCOpt;
+
+	SepPos = strchr(MuteStr, ':');
+	if (SepPos == NULL)
+		return false;
+	MuteMask = (UINT32)strtoul(SepPos + 1, &EndPtr, 0);
+	if (EndPtr == SepPos + 1 || *EndPtr != '\0')
+		return false;
+
+	for (CurChip = 0x00; CurChip < CHIP_COUNT; CurChip ++)
+	{
+		if (strlen(GetChipName(CurChip)) == (size_t)(SepPos - MuteStr) &&
+			! strncasecmp(GetChipName(CurChip), MuteStr, SepPos - MuteStr))
+			break;
+	}
+	if (CurChip >= CHIP_COUNT)
+		return false;
+
+	for (CurCSet = 0x00; CurCSet < 0x02; CurCSet ++)
+	{
+		TempCOpt = (CHIP_OPTS*)&p->ChipOpts[CurCSet] + CurChip;
+		TempCOpt->ChnMute1 = MuteMask;
+	}
+	return true;
+}
+
+static const GOLDEN_HASH* FindGoldenHash(const char* FileName)
+{
+	UINT32 CurHash;
+
+	for (CurHash = 0; CurHash < GoldenCount; CurHash ++)
+	{
+		if (! strcmp(Golden[CurHash].FileName, FileName))
+			return &Golden[CurHash];
+	}
+	return NULL;
+}
+
+static UINT64 HashSamples(UINT64 Hash, const WAVE_16BS* Buffer, UINT32 Length)
+{
+	// FNV-1a over the little endian sample data, so the hashes are the same on all machines
+	UINT32 CurSmpl;
+	UINT16 Smpl[2];
+	UINT8 CurChn;
+
+	for (CurSmpl = 0; CurSmpl < Length; CurSmpl ++)
+	{
+		Smpl[0] = (UINT16)Buffer[CurSmpl].Left;
+		Smpl[1] = (UINT16)Buffer[CurSmpl].Right;
+		for (CurChn = 0; CurChn < 2; CurChn ++)
+		{
+			Hash = (Hash ^ (Smpl[CurChn] & 0xFF)) * FNV_PRIME;
+			Hash = (Hash ^ (Smpl[CurChn] >> 8)) * FNV_PRIME;
+		}
+	}
+
+	return Hash;
+}
+
+static bool IsSilence(const WAVE_16BS* Buffer, UINT32 Length)
+{
+	UINT32 CurSmpl;
+
+	for (CurSmpl = 0; CurSmpl < Length; CurSmpl ++)
+	{
+		if (Buffer[CurSmpl].Left || Buffer[CurSmpl].Right)
+			return false;
+	}
+
+	return true;
+}
+
+static bool RenderRun(void* vgmp, PERF_FILE* File, WAVE_16BS* Buffer, UINT32 RunNum)
+{
+	VGM_PLAYER* p = (VGM_PLAYER*)vgmp;
+	RENDER_PROFILE Profile;
+	CHIP_STATS ChipStats[CHIP_COUNT * 0x02 + 0x06];
+	UINT32 ChipCnt;
+	UINT32 CurChip;
+	UINT64 ChipSmpls;
+	bool Silent;
+	double StartTime;
+	double OpenTime;
+	double RenderTime;
+	UINT32 Samples;
+	UINT32 BufLen;
+	UINT64 Hash;
+
+	StartTime = GetTime();
+	if (! OpenVGMFile(vgmp, File->FileName))
+		return false;
+	srand(1);	// some cores take their noise from rand()
+	PlayVGM(vgmp);
+	OpenTime = GetTime() - StartTime;
+
+	// only the FillBuffer calls count, hashing the output doesn't
+	RenderTime = 0.0;
+	Samples = 0;
+	Hash = FNV_OFFSET;
+	Silent = true;
+	while(! p->EndPlay)
+	{
+		StartTime = GetTime();
+		BufLen = FillBuffer(vgmp, Buffer, p->SampleRate);
+		RenderTime += GetTime() - StartTime;
+		if (HashCheck)
+			Hash = HashSamples(Hash, Buffer, BufLen);
+		if (Silent)
+			Silent = IsSilence(Buffer, BufLen);
+		Samples += BufLen;
+	}
+	GetRenderProfile(vgmp, &Profile);
+	// Silence proves nothing about the output, so it fails the file.
+	// (GetChipStats returns 0 if the player is compiled without the chip counters.)
+	ChipCnt = GetChipStats(vgmp, ChipStats, CHIP_COUNT * 0x02 + 0x06);
+	if (ChipCnt)
+	{
+		ChipSmpls = 0;
+		for (CurChip = 0; CurChip < ChipCnt; CurChip ++)
+			ChipSmpls += ChipStats[CurChip].Samples;
+		if (! ChipSmpls)
+			Silent = true;
+	}
+
+	StopVGM(vgmp);
+	CloseVGMFile(vgmp);
+
+	if (! RunNum)
+	{
+		File->Samples = Samples;
+		File->Hash = Hash;
+		File->Silent = Silent;
+	}
+	else if (Samples != File->Samples || Hash != File->Hash)
+	{
+		File->Unstable = true;
+	}
+	if (! RunNum || OpenTime < File->OpenTime)
+		File->OpenTime = OpenTime;
+	if (! RunNum || RenderTime < File->RenderTime)
+	{
+		File->RenderTime = RenderTime;
+		File->Profile = Profile;
+	}
+
+	return true;
+}
+
+static double StagePercent(const RENDER_PROFILE* Profile, UINT64 Time)
+{
+	return Profile->Total ? Time * 100.0 / Profile->Total : 0.0;
+}
+
+static void PrintFileHeader(FILE* hFile)
+{
+	fprintf(hFile, "%-32s %8s %8s %8s %8s", "File", "Audio s", "Open ms", "Render s", "Speed");
+	if (Profiling)
+		fprintf(hFile, " %6s %6s %6s %6s", "Intp%", "Chip%", "Rsmp%", "Mix%");
+	if (HashCheck)
+		fprintf(hFile, "  %-16s", "Hash");
+	fputc('\n', hFile);
+
+	return;
+}
+
+static void PrintFile(FILE* hFile, const PERF_FILE* File, UINT32 SmplRate)
+{
+	static const char* HASH_STATES[] = {"", "  ok", "  MISMATCH", "  new"};
+	const RENDER_PROFILE* Prof = &File->Profile;
+
+	if (File->Failed)
+	{
+		fprintf(hFile, "%-32.32s  failed to open\n", GetFileTitle(File->FileName));
+		return;
+	}
+	fprintf(hFile, "%-32.32s %8.1f %8.2f %8.3f %7.1fx", GetFileTitle(File->FileName),
+			(double)File->Samples / SmplRate, File->OpenTime * 1000.0, File->RenderTime,
+			File->RenderTime > 0.0 ? File->Samples / File->RenderTime / SmplRate : 0.0);
+	if (Profiling)
+		fprintf(hFile, " %6.1f %6.1f %6.1f %6.1f", StagePercent(Prof, Prof->Interpret),
+				StagePercent(Prof, Prof->ChipUpdate), StagePercent(Prof, Prof->Resample),
+				StagePercent(Prof, Prof->Mix));
+	if (HashCheck)
+		fprintf(hFile, "  %016llx%s%s", (unsigned long long)File->Hash,
+				HASH_STATES[File->HashState], File->Unstable ? "  UNSTABLE" : "");
+	if (File->Silent)
+		fprintf(hFile, "  SILENT");
+	fputc('\n', hFile);
+
+	return;
+}
+
+static void WriteJSONString(FILE* hFile, const char* Str)
+{
+	fputc('"', hFile);
+	for (; *Str != '\0'; Str ++)
+	{
+		if (*Str == '"' || *Str == '\\')
+			fprintf(hFile, "\\%c", *Str);
+		else if ((UINT8)*Str < 0x20)
+			fprintf(hFile, "\\u%04x", (UINT8)*Str);
+		else
+			fputc(*Str, hFile);
+	}
+	fputc('"', hFile);
+
+	return;
+}
+
+static void WriteJSON(FILE* hFile, UINT32 SmplRate, double AudioTime, double RenderTime, UINT32 PeakMem)
+{
+	static const char* HASH_STATES[] = {"null", "\"ok\"", "\"mismatch\"", "\"new\""};
+	const PERF_FILE* File;
+	const RENDER_PROFILE* Prof;
+	UINT32 CurFile;
+
+	fprintf(hFile, "{\n");
+	fprintf(hFile, "  \"sample_rate\": %u,\n  \"runs\": %u,\n", SmplRate, PerfRuns);
+	fprintf(hFile, "  \"audio_sec\": %.3f,\n  \"render_sec\": %.3f,\n  \"realtime_factor\": %.2f,\n",
+			AudioTime, RenderTime, (RenderTime > 0.0) ? AudioTime / RenderTime : 0.0);
+	fprintf(hFile, "  \"peak_rss_kb\": %u,\n", PeakMem);
+	fprintf(hFile, "  \"files\": [\n");
+	for (CurFile = 0; CurFile < FileCount; CurFile ++)
+	{
+		File = &Files[CurFile];
+		Prof = &File->Profile;
+		fprintf(hFile, "    {\"file\": ");
+		WriteJSONString(hFile, File->FileName);
+		if (File->Failed)
+		{
+			fprintf(hFile, ", \"failed\": true}");
+		}
+		else
+		{
+			fprintf(hFile, ", \"samples\": %u, \"open_ms\": %.3f, \"render_sec\": %.4f, \"realtime_factor\": %.2f",
+					File->Samples, File->OpenTime * 1000.0, File->RenderTime,
+					File->RenderTime > 0.0 ? File->Samples / File->RenderTime / SmplRate : 0.0);
+			if (Profiling)
+				fprintf(hFile, ", \"stages_ns\": {\"interpret\": %llu, \"chip_update\": %llu, "
+						"\"resample\": %llu, \"mix\": %llu, \"total\": %llu}",
+						(unsigned long long)Prof->Interpret, (unsigned long long)Prof->ChipUpdate,
+						(unsigned long long)Prof->Resample, (unsigned long long)Prof->Mix,
+						(unsigned long long)Prof->Total);
+			if (HashCheck)
+				fprintf(hFile, ", \"hash\": \"%016llx\", \"golden\": %s, \"stable\": %s",
+						(unsigned long long)File->Hash, HASH_STATES[File->HashState],
+						File->Unstable ? "false" : "true");
+			fprintf(hFile, ", \"silent\": %s}", File->Silent ? "true" : "false");
+		}
+		fprintf(hFile, "%s\n", (CurFile + 1 < FileCount) ? "," : "");
+	}
+	fprintf(hFile, "  ]\n}\n");
+
+	return;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [options] input...\n"
+		"input can be a directory (all .vgm/.vgz files in it) or a single VGM file.\n"
+		"Renders every file and reports its speed, open time and the time of the render stages.\n"
+		"With threads, Chip%% and Rsmp%% are the time of all threads and can add up to more than 100%%.\n"
+		"Files that render only silence count as failed.\n", name);
+#ifdef VGMPERF_HAS_GETOPT
+	fputs("\n"
+		"Options:\n"
+		"--loop-count {number}\n"
+		"--fade-ms {number}\n"
+		"--runs {number}      the fastest run counts (default: 1)\n"
+		"--threads {number}   render threads of the player\n"
+		"--resample-mode {0|1|2}\n"
+		"--no-block-render\n"
+		"--pre-decode\n"
+		"--step-synth\n"
+		"--mute {chip}:{mask}  mute the channels of a chip (e.g. QSound:0x0F)\n"
+		"--budget {share}     real time share for the chips, picks the cores (needs --core-profile)\n"
+		"--core-profile {file}  core profile written by vgmbench --profile\n"
+		"--no-profile         don't measure the render stages\n"
+		"--hash               write the output hashes to stdout (a golden hash list)\n"
+		"--golden {file}      compare the output hashes with a golden hash list\n"
+		"--json {file|-}      write the results as JSON\n"
+		"\n", stderr);
+#else
+	fputs("Options not supported in this build (compiled without getopt.)\n", stderr);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	void* vgmp;
+	VGM_PLAYER* p;
+	WAVE_16BS* Buffer;
+	PERF_FILE* File;
+	const GOLDEN_HASH* GHash;
+	const char* GoldenFile;
+	const char* JSONFile;
+	FILE* hTable;
+	FILE* hJSON;
+	UINT32 CurFile;
+	UINT32 CurRun;
+	UINT32 Failed;
+	UINT32 Mismatches;
+	UINT32 SilentCnt;
+	UINT32 PeakMem;
+	double AudioTime;
+	double RenderTime;
+	int ArgIdx;
+	int c;
+
+	vgmp = VGMPlay_Init();
+	VGMPlay_Init2(vgmp);
+	p = (VGM_PLAYER *) vgmp;
+	p->VGMMaxLoop = 2;
+	p->FadeTime = 5000;
+	GoldenFile = NULL;
+	JSONFile = NULL;
+
+	// Parse command line arguments
+#ifdef VGMPERF_HAS_GETOPT
+	static struct option long_options[] = {
+		{ "loop-count", required_argument, NULL, 'l' },
+		{ "fade-ms", required_argument, NULL, 'f' },
+		{ "runs", required_argument, NULL, 'r' },
+		{ "threads", required_argument, NULL, 'T' },
+		{ "resample-mode", required_argument, NULL, 'R' },
+		{ "no-block-render", no_argument, NULL, 'B' },
+		{ "pre-decode", no_argument, NULL, 'P' },
+		{ "step-synth", no_argument, NULL, 'X' },
+		{ "mute", required_argument, NULL, 'M' },
+		{ "budget", required_argument, NULL, 'b' },
+		{ "core-profile", required_argument, NULL, 'c' },
+		{ "no-profile", no_argument, NULL, 'N' },
+		{ "hash", no_argument, NULL, 'H' },
+		{ "golden", required_argument, NULL, 'g' },
+		{ "json", required_argument, NULL, 'j' },
+		{ "help", no_argument, NULL, '?' },
+		{ NULL, 0, NULL, 0 }
+	};
+	while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+		switch (c) {
+		case 'l':
+			c = atoi(optarg);
+			if (c <= 0) {
+				fputs("Error: loop count must be at least 1.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			p->VGMMaxLoop = c;
+			break;
+		case 'f':
+			p->FadeTime = atoi(optarg);
+			break;
+		case 'r':
+			c = atoi(optarg);
+			if (c <= 0) {
+				fputs("Error: run count must be at least 1.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			PerfRuns = c;
+			break;
+		case 'T':
+			c = atoi(optarg);
+			if (c <= 0 || c > 0xFF) {
+				fputs("Error: thread count must be between 1 and 255.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			p->RenderThreads = c;
+			break;
+		case 'R':
+			c = atoi(optarg);
+			if (c < 0 || c > 2) {
+				fputs("Error: resample mode must be 0, 1 or 2.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			p->ResampleMode = c;
+			break;
+		case 'B':
+			p->BlockRender = false;
+			break;
+		case 'P':
+			p->PreDecode = true;
+			break;
+		case 'X':
+			p->StepSynth = true;
+			break;
+		case 'M':
+			if (! SetChipMute(p, optarg)) {
+				fprintf(stderr, "Error: invalid mute option %s\n", optarg);
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'b':
+			p->RenderBudget = (float)atof(optarg);
+			if (p->RenderBudget <= 0.0f) {
+				fputs("Error: the budget must be positive.\n", stderr);
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'c':
+			if (! LoadCoreProfile(vgmp, optarg)) {
+				fprintf(stderr, "vgmperf: error: failed to read %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'N':
+			Profiling = false;
+			break;
+		case 'H':
+			HashOutput = true;
+			break;
+		case 'g':
+			GoldenFile = optarg;
+			break;
+		case 'j':
+			JSONFile = optarg;
+			break;
+		case '?':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	ArgIdx = optind;
+#else
+	ArgIdx = 1;
+#endif
+	if (ArgIdx >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+	if (HashOutput && JSONFile != NULL && ! strcmp(JSONFile, "-")) {
+		fputs("Error: --hash and --json - both write to stdout.\n", stderr);
+		return 1;
+	}
+
+	if (GoldenFile != NULL && ! LoadGoldenHashes(GoldenFile))
+	{
+		fprintf(stderr, "vgmperf: error: failed to read %s\n", GoldenFile);
+		return 1;
+	}
+	HashCheck = HashOutput || GoldenFile != NULL;
+	p->RenderProfile = Profiling;
+
+	for (; ArgIdx < argc; ArgIdx ++)
+	{
+		if (! AddInput(argv[ArgIdx]))
+			fprintf(stderr, "vgmperf: error: failed to read %s\n", argv[ArgIdx]);
+	}
+	if (! FileCount)
+	{
+		fputs("vgmperf: no files to render\n", stderr);
+		return 1;
+	}
+	// The fading steps depend on the buffer size, so it's the same as in vgm2wav
+	// to get the same output.
+	Buffer = (WAVE_16BS*)malloc(p->SampleRate * sizeof(WAVE_16BS));
+
+	// the table goes to stderr when the hashes or the JSON go to stdout
+	hTable = (HashOutput || (JSONFile != NULL && ! strcmp(JSONFile, "-"))) ? stderr : stdout;
+	PrintFileHeader(hTable);
+	Failed = 0;
+	Mismatches = 0;
+	SilentCnt = 0;
+	AudioTime = 0.0;
+	RenderTime = 0.0;
+	for (CurFile = 0; CurFile < FileCount; CurFile ++)
+	{
+		File = &Files[CurFile];
+		for (CurRun = 0; CurRun < PerfRuns; CurRun ++)
+		{
+			if (! RenderRun(vgmp, File, Buffer, CurRun))
+				break;
+		}
+		if (CurRun < PerfRuns)
+		{
+			File->Failed = true;
+			Failed ++;
+			PrintFile(hTable, File, p->SampleRate);
+			continue;
+		}
+
+		if (GoldenFile != NULL)
+		{
+			GHash = FindGoldenHash(File->FileName);
+			if (GHash == NULL)
+				File->HashState = HASH_NEW;
+			else if (GHash->Hash == File->Hash && GHash->Samples == File->Samples)
+				File->HashState = HASH_OK;
+			else
+				File->HashState = HASH_MISMATCH;
+			if (File->HashState == HASH_MISMATCH)
+				Mismatches ++;
+		}
+		if (File->Unstable)
+			Mismatches ++;
+		if (File->Silent)
+			SilentCnt ++;
+		if (HashOutput)
+			printf("%016llx %u %s\n", (unsigned long long)File->Hash, File->Samples, File->FileName);
+		PrintFile(hTable, File, p->SampleRate);
+		AudioTime += (double)File->Samples / p->SampleRate;
+		RenderTime += File->RenderTime;
+	}
+	PeakMem = GetPeakMemory();
+
+	fprintf(hTable, "vgmperf: %u of %u files rendered, %.1f s of audio in %.2f s (%.1fx realtime)\n",
+			FileCount - Failed, FileCount, AudioTime, RenderTime,
+			(RenderTime > 0.0) ? AudioTime / RenderTime : 0.0);
+	fprintf(hTable, "vgmperf: peak memory %u KB\n", PeakMem);
+	if (HashCheck && Mismatches)
+		fprintf(hTable, "vgmperf: %u files don't match\n", Mismatches);
+	if (SilentCnt)
+		fprintf(hTable, "vgmperf: %u files rendered only silence\n", SilentCnt);
+
+	if (JSONFile != NULL)
+	{
+		hJSON = strcmp(JSONFile, "-") ? fopen(JSONFile, "wt") : stdout;
+		if (hJSON == NULL)
+		{
+			fprintf(stderr, "vgmperf: error: can't write %s\n", JSONFile);
+		}
+		else
+		{
+			WriteJSON(hJSON, p->SampleRate, AudioTime, RenderTime, PeakMem);
+			if (hJSON != stdout)
+				fclose(hJSON);
+		}
+	}
+
+	VGMPlay_Deinit(vgmp);
+	free(Buffer);
+	for (CurFile = 0; CurFile < FileCount; CurFile ++)
+		free(Files[CurFile].FileName);
+	free(Files);
+	for (CurFile = 0; CurFile < GoldenCount; CurFile ++)
+		free(Golden[CurFile].FileName);
+	free(Golden);
+
+	return (Failed || Mismatches || SilentCnt) ? 1 : 0;
+}
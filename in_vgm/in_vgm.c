@@ -346,6 +346,7 @@ void LoadConfigurationFile(void)
 	ReadIni_Integer	("Playback",	"ChipSmplRate",	&Options.ChipRate);
 	ReadIni_IntByte	("Playback",	"ChipSmplMode",	&p->CHIP_SAMPLING_MODE);
 	ReadIni_Boolean	("Playback",	"SurroundSnd",	&p->SurroundSound);
+	ReadIni_Integer	("Playback",	"SeekIndexTime",	&p->SeekIndexTime);
 
 	ReadIni_String	("Tags",		"TitleFormat",	 Options.TitleFormat, 0x80);
 	ReadIni_Boolean	("Tags",		"UseJapTags",	&Options.JapTags);
@@ -511,6 +512,7 @@ void SaveConfigurationFile(void)
 	WriteIni_Integer("Playback",	"ChipSmplRate",	Options.ChipRate);
 	WriteIni_Integer("Playback",	"ChipSmplMode",	p->CHIP_SAMPLING_MODE);
 	WriteIni_Boolean("Playback",	"SurroundSnd",	p->SurroundSound);
+	WriteIni_Integer("Playback",	"SeekIndexTime",	p->SeekIndexTime);
 
 	WriteIni_String	("Tags",		"TitleFormat",	Options.TitleFormat);
 	WriteIni_Boolean("Tags",		"UseJapTags",	Options.JapTags);